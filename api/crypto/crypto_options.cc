@@ -18,6 +18,7 @@ CryptoOptions::CryptoOptions() {}
 CryptoOptions::CryptoOptions(const CryptoOptions& other) {
   srtp = other.srtp;
   sframe = other.sframe;
+  dtls = other.dtls;
 }
 
 CryptoOptions::~CryptoOptions() {}
@@ -29,6 +30,13 @@ CryptoOptions CryptoOptions::NoGcm() {
   return options;
 }
 
+// static
+CryptoOptions CryptoOptions::WithGcm() {
+  CryptoOptions options;
+  options.srtp.enable_gcm_crypto_suites = true;
+  return options;
+}
+
 std::vector<int> CryptoOptions::GetSupportedDtlsSrtpCryptoSuites() const {
   std::vector<int> crypto_suites;
   if (srtp.enable_gcm_crypto_suites) {
@@ -57,6 +65,9 @@ bool CryptoOptions::operator==(const CryptoOptions& other) const {
     struct SFrame {
       bool require_frame_encryption;
     } sframe;
+    struct Dtls {
+      bool enable_session_resumption;
+    } dtls;
   };
   static_assert(sizeof(data_being_tested_for_equality) == sizeof(*this),
                 "Did you add something to CryptoOptions and forget to "
@@ -68,7 +79,9 @@ bool CryptoOptions::operator==(const CryptoOptions& other) const {
          srtp.enable_encrypted_rtp_header_extensions ==
              other.srtp.enable_encrypted_rtp_header_extensions &&
          sframe.require_frame_encryption ==
-             other.sframe.require_frame_encryption;
+             other.sframe.require_frame_encryption &&
+         dtls.enable_session_resumption ==
+             other.dtls.enable_session_resumption;
 }
 
 bool CryptoOptions::operator!=(const CryptoOptions& other) const {
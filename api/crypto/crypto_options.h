@@ -28,6 +28,12 @@ struct CryptoOptions {
   // default values set by the constructor.
   static CryptoOptions NoGcm();
 
+  // Helper method to return an instance of the CryptoOptions with GCM crypto
+  // suites enabled, which are then preferred over the AES-CM ones. With AES-NI
+  // and carry-less multiplication, AES-GCM costs much less per packet than
+  // AES-CM with HMAC-SHA1.
+  static CryptoOptions WithGcm();
+
   // Returns a list of the supported DTLS-SRTP Crypto suites based on this set
   // of crypto options.
   std::vector<int> GetSupportedDtlsSrtpCryptoSuites() const;
@@ -59,6 +65,15 @@ struct CryptoOptions {
     // FrameDecryptor attached to them before they are able to receive packets.
     bool require_frame_encryption = false;
   } sframe;
+
+  // DTLS Related Peer Connection options.
+  struct Dtls {
+    // If set to true, the DTLS handshakes resume the sessions of earlier
+    // connections of the same PeerConnectionFactory between the same
+    // certificates, which saves a round trip and the public key operations.
+    // The peer certificate is still verified against the signaled fingerprint.
+    bool enable_session_resumption = false;
+  } dtls;
 };
 
 }  // namespace webrtc
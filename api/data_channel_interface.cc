@@ -40,4 +40,12 @@ bool DataChannelInterface::negotiated() const {
   return false;
 }
 
+bool DataChannelInterface::SendBatch(rtc::ArrayView<const DataBuffer> buffers) {
+  bool success = true;
+  for (const DataBuffer& buffer : buffers) {
+    success = Send(buffer) && success;
+  }
+  return success;
+}
+
 }  // namespace webrtc
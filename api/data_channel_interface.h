@@ -19,6 +19,7 @@
 #include <string>
 
 #include "absl/types/optional.h"
+#include "api/array_view.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/copy_on_write_buffer.h"
 #include "rtc_base/ref_count.h"
@@ -176,6 +177,13 @@ class DataChannelInterface : public rtc::RefCountInterface {
   // buffer.
   virtual bool Send(const DataBuffer& buffer) = 0;
 
+  // Sends |buffers| in order, like calling Send() for each of them, but allows
+  // the implementation to hand them to the transport together instead of one
+  // at a time. This is more efficient for bulk transfers; the buffered amount
+  // and OnBufferedAmountChange work as if Send() had been used. The default
+  // implementation simply calls Send() for each buffer.
+  virtual bool SendBatch(rtc::ArrayView<const DataBuffer> buffers);
+
  protected:
   ~DataChannelInterface() override = default;
 };
@@ -11,6 +11,7 @@
 #include "api/peer_connection_interface.h"
 #include "api/dtls_transport_interface.h"
 #include "api/sctp_transport_interface.h"
+#include "rtc_base/crypto_worker_pool.h"
 
 namespace webrtc {
 
@@ -117,6 +117,7 @@
 #include "rtc_base/system/rtc_export.h"
 
 namespace rtc {
+class CryptoWorkerPool;
 class SSLIdentity;
 class Thread;
 }  // namespace rtc
@@ -1292,6 +1293,11 @@ struct PeerConnectionFactoryDependencies final {
       network_state_predictor_factory;
   std::unique_ptr<NetworkControllerFactoryInterface> network_controller_factory;
   std::unique_ptr<MediaTransportFactory> media_transport_factory;
+  // If set, the default certificate generators of the PeerConnections
+  // generate their certificates on this pool instead of the network thread.
+  // Not set by default, as the pool has threads of its own and may generate
+  // certificates ahead of time.
+  rtc::scoped_refptr<rtc::CryptoWorkerPool> crypto_worker_pool;
 };
 
 // PeerConnectionFactoryInterface is the factory interface used for creating
@@ -1339,8 +1345,11 @@ class PeerConnectionFactoryInterface : public rtc::RefCountInterface {
     // party supports DTLS 1.0 and the other DTLS 1.2, DTLS 1.0 will be used.
     rtc::SSLProtocolVersion ssl_max_version = rtc::SSL_PROTOCOL_DTLS_12;
 
-    // Sets crypto related options, e.g. enabled cipher suites.
-    CryptoOptions crypto_options = CryptoOptions::NoGcm();
+    // Sets crypto related options, e.g. enabled cipher suites. The GCM crypto
+    // suites are used by default when the remote end supports them. This
+    // applies to both DTLS-SRTP and SDES; with SDES the GCM cryptos are listed
+    // first in offers.
+    CryptoOptions crypto_options = CryptoOptions::WithGcm();
   };
 
   // Set the options to be used for subsequently created PeerConnections.
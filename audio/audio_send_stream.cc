@@ -380,6 +380,12 @@ void AudioSendStream::SetMuted(bool muted) {
   channel_send_->SetInputMute(muted);
 }
 
+void AudioSendStream::SetSharedEncoder(
+    rtc::scoped_refptr<SharedAudioEncoder> shared_encoder) {
+  RTC_DCHECK(worker_thread_checker_.IsCurrent());
+  channel_send_->SetSharedEncoder(std::move(shared_encoder));
+}
+
 webrtc::AudioSendStream::Stats AudioSendStream::GetStats() const {
   return GetStats(true);
 }
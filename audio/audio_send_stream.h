@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "audio/channel_send.h"
+#include "audio/shared_audio_encoder.h"
 #include "audio/transport_feedback_packet_loss_tracker.h"
 #include "call/audio_send_stream.h"
 #include "call/audio_state.h"
@@ -78,6 +79,10 @@ class AudioSendStream final : public webrtc::AudioSendStream,
   webrtc::AudioSendStream::Stats GetStats(
       bool has_remote_tracks) const override;
 
+  // Lets this stream share the encoding with other streams that send the
+  // same audio. See SharedAudioEncoder.
+  void SetSharedEncoder(rtc::scoped_refptr<SharedAudioEncoder> shared_encoder);
+
   void SignalNetworkState(NetworkState state);
   void DeliverRtcp(const uint8_t* packet, size_t length);
 
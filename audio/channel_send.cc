@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/types/optional.h"
 #include "api/array_view.h"
 #include "api/call/transport.h"
 #include "api/crypto/frame_encryptor_interface.h"
@@ -107,6 +108,8 @@ class ChannelSend : public ChannelSendInterface,
   void ModifyEncoder(rtc::FunctionView<void(std::unique_ptr<AudioEncoder>*)>
                          modifier) override;
   void CallEncoder(rtc::FunctionView<void(AudioEncoder*)> modifier) override;
+  void SetSharedEncoder(
+      rtc::scoped_refptr<SharedAudioEncoder> shared_encoder) override;
 
   // API methods
   void StartSend() override;
@@ -192,6 +195,21 @@ class ChannelSend : public ChannelSendInterface,
 
   int SetSendRtpHeaderExtension(bool enable, RTPExtensionType type, int id);
 
+  // Payload type and format of an encoder, as registered for sending.
+  struct SendPayload {
+    int payload_type;
+    int rtp_timestamp_rate_hz;
+    size_t num_channels;
+  };
+
+  // Registers |payload| for sending with the RTP/RTCP module, or with the
+  // media transport.
+  void RegisterSendPayload(const SendPayload& payload);
+
+  // Registers the payload of the shared encoder while its packets are sent,
+  // and restores the registration of the own encoder when they stop.
+  void SetSharedSendPayloadActive(bool active) RTC_RUN_ON(encoder_queue_);
+
   int32_t SendRtpAudio(AudioFrameType frameType,
                        uint8_t payloadType,
                        uint32_t timeStamp,
@@ -240,7 +258,30 @@ class ChannelSend : public ChannelSendInterface,
   std::unique_ptr<RTPSenderAudio> rtp_sender_audio_;
 
   std::unique_ptr<AudioCodingModule> audio_coding_;
+  // Input timestamp of |audio_coding_|, which only sees the frames that are
+  // not taken from the shared encoder.
   uint32_t _timeStamp RTC_GUARDED_BY(encoder_queue_);
+  // Set while the channel subscribes to a SharedAudioEncoder.
+  std::unique_ptr<SharedAudioEncoder::Subscription> shared_encoder_subscription_
+      RTC_GUARDED_BY(encoder_queue_);
+  // True while the input is encoded by the shared encoder.
+  bool encoding_with_shared_encoder_ RTC_GUARDED_BY(encoder_queue_) = false;
+  // RTP timestamp of the next input frame, before the offset added by the
+  // RTP/RTCP module. Advances with every frame, whichever encoder takes it.
+  uint32_t rtp_timestamp_ RTC_GUARDED_BY(encoder_queue_) = 0;
+  // Added to the timestamps of |audio_coding_|, to account for the frames
+  // encoded by the shared encoder.
+  uint32_t own_encoder_timestamp_offset_ RTC_GUARDED_BY(encoder_queue_) = 0;
+  // False while |audio_coding_| holds frames of an incomplete packet. The
+  // channel only switches to the shared encoder between packets.
+  bool own_encoder_idle_ RTC_GUARDED_BY(encoder_queue_) = true;
+
+  rtc::CriticalSection send_payload_lock_;
+  // Payload of the encoder set by SetEncoder().
+  absl::optional<SendPayload> encoder_payload_
+      RTC_GUARDED_BY(send_payload_lock_);
+  // True while the payload of the shared encoder is registered instead.
+  bool shared_send_payload_active_ RTC_GUARDED_BY(send_payload_lock_) = false;
 
   // uses
   ProcessThread* const _moduleProcessThreadPtr;
@@ -480,6 +521,13 @@ int32_t ChannelSend::SendData(AudioFrameType frameType,
   RTC_DCHECK_RUN_ON(&encoder_queue_);
   rtc::ArrayView<const uint8_t> payload(payloadData, payloadSize);
 
+  if (encoding_with_shared_encoder_) {
+    SetSharedSendPayloadActive(true);
+  } else {
+    timeStamp += own_encoder_timestamp_offset_;
+    own_encoder_idle_ = true;
+  }
+
   if (media_transport() != nullptr) {
     if (frameType == AudioFrameType::kEmptyFrame) {
       // TODO(bugs.webrtc.org/9719): Media transport Send doesn't support
@@ -779,22 +827,66 @@ void ChannelSend::SetEncoder(int payload_type,
   RTC_DCHECK_GE(payload_type, 0);
   RTC_DCHECK_LE(payload_type, 127);
 
+  {
+    rtc::CritScope cs(&send_payload_lock_);
+    encoder_payload_ = SendPayload{payload_type, encoder->RtpTimestampRateHz(),
+                                   encoder->NumChannels()};
+    // Otherwise registered when the shared encoder stops sending.
+    if (!shared_send_payload_active_) {
+      RegisterSendPayload(*encoder_payload_);
+    }
+  }
+  audio_coding_->SetEncoder(std::move(encoder));
+}
+
+void ChannelSend::SetSharedEncoder(
+    rtc::scoped_refptr<SharedAudioEncoder> shared_encoder) {
+  RTC_DCHECK_RUN_ON(&worker_thread_checker_);
+  encoder_queue_.PostTask([this, shared_encoder]() {
+    RTC_DCHECK_RUN_ON(&encoder_queue_);
+    // An incomplete packet of the old shared encoder is dropped.
+    encoding_with_shared_encoder_ = false;
+    SetSharedSendPayloadActive(false);
+    shared_encoder_subscription_ =
+        shared_encoder ? SharedAudioEncoder::Subscribe(shared_encoder)
+                       : nullptr;
+  });
+}
+
+void ChannelSend::RegisterSendPayload(const SendPayload& payload) {
   // The RTP/RTCP module needs to know the RTP timestamp rate (i.e. clockrate)
   // as well as some other things, so we collect this info and send it along.
-  _rtpRtcpModule->RegisterSendPayloadFrequency(payload_type,
-                                               encoder->RtpTimestampRateHz());
-  rtp_sender_audio_->RegisterAudioPayload("audio", payload_type,
-                                          encoder->RtpTimestampRateHz(),
-                                          encoder->NumChannels(), 0);
+  _rtpRtcpModule->RegisterSendPayloadFrequency(payload.payload_type,
+                                               payload.rtp_timestamp_rate_hz);
+  rtp_sender_audio_->RegisterAudioPayload("audio", payload.payload_type,
+                                          payload.rtp_timestamp_rate_hz,
+                                          payload.num_channels, 0);
 
   if (media_transport_config_.media_transport) {
     rtc::CritScope cs(&media_transport_lock_);
-    media_transport_payload_type_ = payload_type;
+    media_transport_payload_type_ = payload.payload_type;
     // TODO(nisse): Currently broken for G722, since timestamps passed through
     // encoder use RTP clock rather than sample count, and they differ for G722.
-    media_transport_sampling_frequency_ = encoder->RtpTimestampRateHz();
+    media_transport_sampling_frequency_ = payload.rtp_timestamp_rate_hz;
+  }
+}
+
+void ChannelSend::SetSharedSendPayloadActive(bool active) {
+  rtc::CritScope cs(&send_payload_lock_);
+  if (active == shared_send_payload_active_) {
+    return;
+  }
+  shared_send_payload_active_ = active;
+  if (active) {
+    RTC_DCHECK(shared_encoder_subscription_);
+    const SharedAudioEncoder* shared_encoder =
+        shared_encoder_subscription_->encoder();
+    RegisterSendPayload(SendPayload{shared_encoder->payload_type(),
+                                    shared_encoder->rtp_timestamp_rate_hz(),
+                                    shared_encoder->num_channels()});
+  } else if (encoder_payload_) {
+    RegisterSendPayload(*encoder_payload_);
   }
-  audio_coding_->SetEncoder(std::move(encoder));
 }
 
 void ChannelSend::ModifyEncoder(
@@ -1136,17 +1228,51 @@ void ChannelSend::ProcessAndEncodeAudioOnTaskQueue(AudioFrame* audio_input) {
 
   // Add 10ms of raw (PCM) audio data to the encoder @ 32kHz.
 
+  int rtp_timestamp_rate_hz = audio_input->sample_rate_hz_;
+  {
+    rtc::CritScope cs(&send_payload_lock_);
+    if (encoder_payload_) {
+      rtp_timestamp_rate_hz = encoder_payload_->rtp_timestamp_rate_hz;
+    }
+  }
+
+  if (shared_encoder_subscription_ &&
+      (encoding_with_shared_encoder_ || own_encoder_idle_)) {
+    encoding_with_shared_encoder_ = true;
+    if (shared_encoder_subscription_->Encode(*audio_input, rtp_timestamp_,
+                                             this)) {
+      rtp_timestamp_ += SharedAudioEncoder::RtpTimestampDuration(
+          *audio_input,
+          shared_encoder_subscription_->encoder()->rtp_timestamp_rate_hz());
+      // The offset is added to the timestamps of |audio_coding_|, so it
+      // advances at the RTP timestamp rate of the own encoder.
+      own_encoder_timestamp_offset_ += SharedAudioEncoder::RtpTimestampDuration(
+          *audio_input, rtp_timestamp_rate_hz);
+      return;
+    }
+    // The input differs from the shared one, e.g. because of muting. Encode
+    // it here, and go back to the shared encoder once the input matches again.
+    encoding_with_shared_encoder_ = false;
+    SetSharedSendPayloadActive(false);
+  }
+
   // The ACM resamples internally.
   audio_input->timestamp_ = _timeStamp;
+
   // This call will trigger AudioPacketizationCallback::SendData if encoding
   // is done and payload is ready for packetization and transmission.
   // Otherwise, it will return without invoking the callback.
+  const bool own_encoder_was_idle = own_encoder_idle_;
+  own_encoder_idle_ = false;
   if (audio_coding_->Add10MsData(*audio_input) < 0) {
     RTC_DLOG(LS_ERROR) << "ACM::Add10MsData() failed.";
+    own_encoder_idle_ = own_encoder_was_idle;
     return;
   }
 
   _timeStamp += static_cast<uint32_t>(audio_input->samples_per_channel_);
+  rtp_timestamp_ += SharedAudioEncoder::RtpTimestampDuration(
+      *audio_input, rtp_timestamp_rate_hz);
 }
 
 ANAStats ChannelSend::GetANAStatistics() const {
@@ -22,6 +22,7 @@
 #include "api/media_transport_config.h"
 #include "api/media_transport_interface.h"
 #include "api/task_queue/task_queue_factory.h"
+#include "audio/shared_audio_encoder.h"
 #include "modules/rtp_rtcp/include/report_block_data.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp.h"
 #include "modules/rtp_rtcp/source/rtp_sender_audio.h"
@@ -76,6 +77,13 @@ class ChannelSendInterface {
   virtual void ModifyEncoder(
       rtc::FunctionView<void(std::unique_ptr<AudioEncoder>*)> modifier) = 0;
   virtual void CallEncoder(rtc::FunctionView<void(AudioEncoder*)> modifier) = 0;
+  // Takes the encoding from |shared_encoder| whenever the input is identical
+  // to its source, and encodes with the own encoder otherwise. The RTP
+  // timestamps stay continuous across the switches, and the payload of the
+  // own encoder is registered again when the shared one stops sending. Pass
+  // null to stop using it.
+  virtual void SetSharedEncoder(
+      rtc::scoped_refptr<SharedAudioEncoder> shared_encoder) = 0;
 
   virtual void SetLocalSSRC(uint32_t ssrc) = 0;
   // Use 0 to indicate that the extension should not be registered.
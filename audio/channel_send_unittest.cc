@@ -0,0 +1,195 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "audio/channel_send.h"
+
+#include <math.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/audio/audio_frame.h"
+#include "api/audio_codecs/L16/audio_encoder_L16.h"
+#include "api/audio_codecs/g722/audio_encoder_g722.h"
+#include "api/crypto/crypto_options.h"
+#include "api/media_transport_config.h"
+#include "api/test/fake_media_transport.h"
+#include "audio/shared_audio_encoder.h"
+#include "logging/rtc_event_log/rtc_event_log.h"
+#include "modules/utility/include/mock/mock_process_thread.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "test/mock_transport.h"
+#include "test/time_controller/simulated_time_controller.h"
+
+namespace webrtc {
+namespace voe {
+namespace {
+
+using ::testing::NiceMock;
+
+constexpr int kSampleRateHz = 48000;
+constexpr size_t kSamplesPerChannel = kSampleRateHz / 100;
+constexpr int kOwnPayloadType = 100;
+constexpr int kSharedPayloadType = 101;
+constexpr int kG722PayloadType = 9;
+constexpr uint32_t kSsrc = 333;
+
+std::unique_ptr<AudioEncoder> CreateEncoder(int payload_type) {
+  AudioEncoderL16::Config config;
+  config.sample_rate_hz = kSampleRateHz;
+  config.num_channels = 1;
+  config.frame_size_ms = 20;
+  return AudioEncoderL16::MakeAudioEncoder(config, payload_type);
+}
+
+struct SentFrame {
+  int payload_type;
+  uint32_t timestamp;
+};
+
+class RecordingMediaTransport : public FakeMediaTransport {
+ public:
+  RecordingMediaTransport() : FakeMediaTransport(MediaTransportSettings()) {}
+
+  RTCError SendAudioFrame(uint64_t channel_id,
+                          MediaTransportEncodedAudioFrame frame) override {
+    frames.push_back({frame.payload_type(), frame.starting_sample_index()});
+    return RTCError::OK();
+  }
+
+  std::vector<SentFrame> frames;
+};
+
+class ChannelSendTest : public ::testing::Test {
+ protected:
+  ChannelSendTest()
+      : time_controller_(Timestamp::seconds(1000)),
+        channel_(CreateChannelSend(time_controller_.GetClock(),
+                                   time_controller_.GetTaskQueueFactory(),
+                                   &process_thread_,
+                                   MediaTransportConfig(&media_transport_),
+                                   /*overhead_observer=*/nullptr,
+                                   &transport_,
+                                   /*rtcp_rtt_stats=*/nullptr,
+                                   &event_log_,
+                                   /*frame_encryptor=*/nullptr,
+                                   CryptoOptions(),
+                                   /*extmap_allow_mixed=*/false,
+                                   /*rtcp_report_interval_ms=*/5000)) {
+    channel_->SetLocalSSRC(kSsrc);
+    channel_->SetEncoder(kOwnPayloadType, CreateEncoder(kOwnPayloadType));
+    channel_->StartSend();
+  }
+
+  ~ChannelSendTest() override {
+    time_controller_.InvokeWithControlledYield(
+        [this] { channel_->StopSend(); });
+  }
+
+  // Generates the next 10 ms of a tone, lets the shared encoder encode it and
+  // sends it through the channel.
+  void SendFrame(SharedAudioEncoder* shared_encoder) {
+    int16_t audio[kSamplesPerChannel];
+    for (int16_t& sample : audio) {
+      sample = static_cast<int16_t>(
+          8000.f * sinf(2.f * 3.14159265f * 440.f * sample_index_++ /
+                        kSampleRateHz));
+    }
+    auto frame = absl::make_unique<AudioFrame>();
+    frame->UpdateFrame(0, audio, kSamplesPerChannel, kSampleRateHz,
+                       AudioFrame::kNormalSpeech, AudioFrame::kVadActive, 1);
+    shared_encoder->Encode(*frame);
+    channel_->ProcessAndEncodeAudio(std::move(frame));
+    time_controller_.Sleep(TimeDelta::ms(10));
+  }
+
+  GlobalSimulatedTimeController time_controller_;
+  NiceMock<MockProcessThread> process_thread_;
+  RecordingMediaTransport media_transport_;
+  NiceMock<MockTransport> transport_;
+  RtcEventLogNull event_log_;
+  std::unique_ptr<ChannelSendInterface> channel_;
+  size_t sample_index_ = 0;
+};
+
+}  // namespace
+
+TEST_F(ChannelSendTest, SharedEncoderKeepsTimestampsContinuous) {
+  rtc::scoped_refptr<SharedAudioEncoder> shared_encoder =
+      SharedAudioEncoder::Create(kSharedPayloadType,
+                                 CreateEncoder(kSharedPayloadType));
+  channel_->SetSharedEncoder(shared_encoder);
+  time_controller_.Sleep(TimeDelta::Zero());
+
+  SendFrame(shared_encoder);
+  SendFrame(shared_encoder);
+  // Muting fades the input out and in again, so that it differs from the
+  // shared signal for three frames.
+  channel_->SetInputMute(true);
+  SendFrame(shared_encoder);
+  SendFrame(shared_encoder);
+  channel_->SetInputMute(false);
+  SendFrame(shared_encoder);
+  // Matches the shared signal, but completes the packet of the own encoder.
+  SendFrame(shared_encoder);
+  for (int i = 0; i < 4; ++i) {
+    SendFrame(shared_encoder);
+  }
+  channel_->SetSharedEncoder(nullptr);
+  SendFrame(shared_encoder);
+  SendFrame(shared_encoder);
+
+  const std::vector<SentFrame> expected = {
+      {kSharedPayloadType, 0},
+      {kOwnPayloadType, 2 * kSamplesPerChannel},
+      {kOwnPayloadType, 4 * kSamplesPerChannel},
+      {kSharedPayloadType, 6 * kSamplesPerChannel},
+      {kSharedPayloadType, 8 * kSamplesPerChannel},
+      {kOwnPayloadType, 10 * kSamplesPerChannel}};
+  ASSERT_EQ(expected.size(), media_transport_.frames.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].payload_type,
+              media_transport_.frames[i].payload_type);
+    EXPECT_EQ(expected[i].timestamp, media_transport_.frames[i].timestamp);
+  }
+  EXPECT_EQ(6, shared_encoder->GetStats().num_reused_frames);
+}
+
+TEST_F(ChannelSendTest, OwnEncoderTimestampsUseItsOwnRtpRate) {
+  // G722 encodes 16 kHz audio, but its RTP clock runs at 8 kHz.
+  channel_->SetEncoder(kG722PayloadType,
+                       AudioEncoderG722::MakeAudioEncoder(
+                           AudioEncoderG722::Config(), kG722PayloadType));
+  rtc::scoped_refptr<SharedAudioEncoder> shared_encoder =
+      SharedAudioEncoder::Create(kSharedPayloadType,
+                                 CreateEncoder(kSharedPayloadType));
+  channel_->SetSharedEncoder(shared_encoder);
+  time_controller_.Sleep(TimeDelta::Zero());
+
+  SendFrame(shared_encoder);
+  SendFrame(shared_encoder);
+  channel_->SetSharedEncoder(nullptr);
+  SendFrame(shared_encoder);
+  SendFrame(shared_encoder);
+
+  ASSERT_EQ(2u, media_transport_.frames.size());
+  EXPECT_EQ(kSharedPayloadType, media_transport_.frames[0].payload_type);
+  EXPECT_EQ(0u, media_transport_.frames[0].timestamp);
+  EXPECT_EQ(kG722PayloadType, media_transport_.frames[1].payload_type);
+  // The two frames taken from the shared encoder last 20 ms, which are 160
+  // ticks of the 8 kHz RTP clock of G722.
+  EXPECT_EQ(160u, media_transport_.frames[1].timestamp);
+}
+
+}  // namespace voe
+}  // namespace webrtc
@@ -78,6 +78,8 @@ class MockChannelSend : public voe::ChannelSendInterface {
       void(rtc::FunctionView<void(std::unique_ptr<AudioEncoder>*)> modifier));
   MOCK_METHOD1(CallEncoder,
                void(rtc::FunctionView<void(AudioEncoder*)> modifier));
+  MOCK_METHOD1(SetSharedEncoder,
+               void(rtc::scoped_refptr<SharedAudioEncoder> shared_encoder));
   MOCK_METHOD3(SetRid,
                void(const std::string& rid,
                     int extension_id,
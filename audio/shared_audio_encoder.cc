@@ -0,0 +1,251 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "audio/shared_audio_encoder.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/numerics/safe_conversions.h"
+#include "rtc_base/ref_counted_object.h"
+
+namespace webrtc {
+
+namespace {
+
+bool SameAudio(const AudioFrame& a, const AudioFrame& b) {
+  if (a.samples_per_channel_ != b.samples_per_channel_ ||
+      a.num_channels_ != b.num_channels_ ||
+      a.sample_rate_hz_ != b.sample_rate_hz_) {
+    return false;
+  }
+  if (a.muted() || b.muted()) {
+    return a.muted() == b.muted();
+  }
+  return memcmp(a.data(), b.data(),
+                a.samples_per_channel_ * a.num_channels_ * sizeof(int16_t)) ==
+         0;
+}
+
+}  // namespace
+
+constexpr size_t SharedAudioEncoder::kHistorySize;
+
+SharedAudioEncoder::Subscription::Subscription(
+    rtc::scoped_refptr<SharedAudioEncoder> encoder,
+    int id)
+    : encoder_(std::move(encoder)), id_(id) {}
+
+SharedAudioEncoder::Subscription::~Subscription() {
+  encoder_->RemoveSubscriber(id_);
+}
+
+bool SharedAudioEncoder::Subscription::Encode(
+    const AudioFrame& frame,
+    uint32_t rtp_timestamp,
+    AudioPacketizationCallback* callback) {
+  return encoder_->EncodeForSubscriber(id_, frame, rtp_timestamp, callback);
+}
+
+rtc::scoped_refptr<SharedAudioEncoder> SharedAudioEncoder::Create(
+    int payload_type,
+    std::unique_ptr<AudioEncoder> encoder) {
+  return new rtc::RefCountedObject<SharedAudioEncoder>(payload_type,
+                                                       std::move(encoder));
+}
+
+SharedAudioEncoder::SharedAudioEncoder(int payload_type,
+                                       std::unique_ptr<AudioEncoder> encoder)
+    : payload_type_(payload_type),
+      rtp_timestamp_rate_hz_(encoder->RtpTimestampRateHz()),
+      num_channels_(encoder->NumChannels()),
+      audio_coding_(AudioCodingModule::Create(AudioCodingModule::Config())),
+      packet_collector_(this) {
+  RTC_DCHECK_GE(payload_type, 0);
+  RTC_DCHECK_LE(payload_type, 127);
+  audio_coding_->SetEncoder(std::move(encoder));
+  int error = audio_coding_->RegisterTransportCallback(&packet_collector_);
+  RTC_DCHECK_EQ(0, error);
+}
+
+SharedAudioEncoder::~SharedAudioEncoder() {
+  RTC_DCHECK(subscribers_.empty());
+  audio_coding_->RegisterTransportCallback(nullptr);
+}
+
+void SharedAudioEncoder::ModifyEncoder(
+    rtc::FunctionView<void(std::unique_ptr<AudioEncoder>*)> modifier) {
+  // The audio coding module is thread safe.
+  audio_coding_->ModifyEncoder(modifier);
+}
+
+std::unique_ptr<SharedAudioEncoder::Subscription>
+SharedAudioEncoder::Subscribe(rtc::scoped_refptr<SharedAudioEncoder> encoder) {
+  const int id = encoder->AddSubscriber();
+  return std::unique_ptr<Subscription>(
+      new Subscription(std::move(encoder), id));
+}
+
+uint32_t SharedAudioEncoder::RtpTimestampDuration(const AudioFrame& frame,
+                                                  int rtp_timestamp_rate_hz) {
+  RTC_DCHECK_GT(frame.sample_rate_hz_, 0);
+  return rtc::dchecked_cast<uint32_t>(rtc::CheckedDivExact(
+      int64_t{frame.samples_per_channel_} * rtp_timestamp_rate_hz,
+      int64_t{frame.sample_rate_hz_}));
+}
+
+SharedAudioEncoder::Stats SharedAudioEncoder::GetStats() const {
+  rtc::CritScope cs(&crit_);
+  return stats_;
+}
+
+int SharedAudioEncoder::AddSubscriber() {
+  rtc::CritScope cs(&crit_);
+  const int id = next_subscriber_id_++;
+  subscribers_[id].reset(new Subscriber());
+  ++stats_.num_subscribers;
+  return id;
+}
+
+void SharedAudioEncoder::RemoveSubscriber(int id) {
+  rtc::CritScope cs(&crit_);
+  RTC_DCHECK(subscribers_.find(id) != subscribers_.end());
+  subscribers_.erase(id);
+  --stats_.num_subscribers;
+}
+
+void SharedAudioEncoder::Encode(const AudioFrame& frame) {
+  rtc::CritScope cs(&crit_);
+  EncodedFrame& encoded = FrameAt(num_frames_);
+  encoded.input.CopyFrom(frame);
+  encoded.input.timestamp_ = next_timestamp_;
+  encoded.rtp_timestamp = next_rtp_timestamp_;
+  encoded.starts_packet = next_frame_starts_packet_;
+  encoded.num_packets = 0;
+  ++num_frames_;
+  next_timestamp_ += static_cast<uint32_t>(frame.samples_per_channel_);
+  next_rtp_timestamp_ += RtpTimestampDuration(frame, rtp_timestamp_rate_hz_);
+
+  // The audio coding module delivers the packets completed by this frame to
+  // |packet_collector_|, synchronously.
+  frame_being_encoded_ = &encoded;
+  if (audio_coding_->Add10MsData(encoded.input) < 0) {
+    RTC_DLOG(LS_ERROR) << "ACM::Add10MsData() failed.";
+  }
+  frame_being_encoded_ = nullptr;
+  next_frame_starts_packet_ = encoded.num_packets > 0;
+  ++stats_.num_encoded_frames;
+}
+
+bool SharedAudioEncoder::EncodeForSubscriber(
+    int id,
+    const AudioFrame& frame,
+    uint32_t rtp_timestamp,
+    AudioPacketizationCallback* callback) {
+  Subscriber* subscriber;
+  uint32_t timestamp_offset;
+  size_t num_packets;
+  {
+    rtc::CritScope cs(&crit_);
+    auto it = subscribers_.find(id);
+    RTC_DCHECK(it != subscribers_.end());
+    subscriber = it->second.get();
+
+    int64_t index = subscriber->next_frame_index;
+    bool available;
+    if (index < 0) {
+      index = FindFrame(frame);
+      available = index >= 0;
+    } else {
+      available = index < num_frames_ &&
+                  num_frames_ - index <= static_cast<int64_t>(kHistorySize) &&
+                  SameAudio(FrameAt(index).input, frame);
+      if (!available) {
+        RTC_LOG(LS_INFO) << "Input of subscriber " << id
+                         << " diverged from the shared encoder source.";
+      }
+    }
+    if (!available) {
+      // Search for the source again with the next frame.
+      subscriber->next_frame_index = -1;
+      ++stats_.num_diverged_frames;
+      return false;
+    }
+    subscriber->next_frame_index = index + 1;
+    ++stats_.num_reused_frames;
+
+    // Copy the packets out, so that they are not overwritten by the source
+    // while being sent.
+    const EncodedFrame& encoded = FrameAt(index);
+    timestamp_offset = rtp_timestamp - encoded.rtp_timestamp;
+    num_packets = encoded.num_packets;
+    if (subscriber->packets.size() < num_packets) {
+      subscriber->packets.resize(num_packets);
+    }
+    for (size_t i = 0; i < num_packets; ++i) {
+      const Packet& packet = encoded.packets[i];
+      Packet& copy = subscriber->packets[i];
+      copy.frame_type = packet.frame_type;
+      copy.payload_type = packet.payload_type;
+      copy.timestamp = packet.timestamp;
+      copy.payload.SetData(packet.payload);
+    }
+  }
+
+  for (size_t i = 0; i < num_packets; ++i) {
+    const Packet& packet = subscriber->packets[i];
+    callback->SendData(packet.frame_type, packet.payload_type,
+                       packet.timestamp + timestamp_offset,
+                       packet.payload.data(), packet.payload.size());
+  }
+  return true;
+}
+
+SharedAudioEncoder::EncodedFrame& SharedAudioEncoder::FrameAt(int64_t index) {
+  return history_[index % kHistorySize];
+}
+
+int64_t SharedAudioEncoder::FindFrame(const AudioFrame& frame) {
+  const int64_t oldest =
+      std::max<int64_t>(0, num_frames_ - static_cast<int64_t>(kHistorySize));
+  for (int64_t index = num_frames_ - 1; index >= oldest; --index) {
+    const EncodedFrame& encoded = FrameAt(index);
+    if (encoded.starts_packet && SameAudio(encoded.input, frame)) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+int32_t SharedAudioEncoder::PacketCollector::SendData(
+    AudioFrameType frame_type,
+    uint8_t payload_type,
+    uint32_t timestamp,
+    const uint8_t* payload_data,
+    size_t payload_len_bytes) {
+  // Only called from within Encode(), which holds the lock.
+  EncodedFrame* encoded = encoder_->frame_being_encoded_;
+  RTC_DCHECK(encoded);
+  if (encoded->packets.size() <= encoded->num_packets) {
+    encoded->packets.resize(encoded->num_packets + 1);
+  }
+  Packet& packet = encoded->packets[encoded->num_packets++];
+  packet.frame_type = frame_type;
+  packet.payload_type = payload_type;
+  packet.timestamp = timestamp;
+  packet.payload.SetData(payload_data, payload_len_bytes);
+  return 0;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef AUDIO_SHARED_AUDIO_ENCODER_H_
+#define AUDIO_SHARED_AUDIO_ENCODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "api/audio/audio_frame.h"
+#include "api/audio_codecs/audio_encoder.h"
+#include "api/function_view.h"
+#include "api/scoped_refptr.h"
+#include "modules/audio_coding/include/audio_coding_module.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Encodes one audio signal on behalf of many send streams. On a conferencing
+// server most participants receive the very same mix, and encoding it once
+// instead of once per stream saves most of the encoding CPU.
+//
+// The producer of the shared signal, e.g. the mixer, is the only source of
+// the encoder: it passes every 10 ms frame to Encode() before it hands the
+// frame to the send streams. Every stream holds a Subscription and keeps
+// feeding it its own input frames. A subscriber never encodes; if its input is
+// identical to a frame of the source, it reuses the packets that frame
+// completed, with the RTP timestamps translated to the timeline of the
+// subscriber, so that every stream keeps its own RTP state. If its input
+// differs, e.g. because the stream is muted, Subscription::Encode() fails and
+// the stream has to encode that frame on its own. The subscription stays
+// valid and the stream rejoins once its input matches the source again.
+//
+// The encoder settings, including the target bitrate, are shared by all
+// subscribers and are controlled through ModifyEncoder().
+class SharedAudioEncoder : public rtc::RefCountInterface {
+ public:
+  struct Stats {
+    // Number of source frames encoded.
+    int64_t num_encoded_frames = 0;
+    // Number of subscriber frames that reused the encoding of a source frame.
+    int64_t num_reused_frames = 0;
+    // Number of subscriber frames that could not be taken from the source.
+    int64_t num_diverged_frames = 0;
+    int num_subscribers = 0;
+  };
+
+  class Subscription {
+   public:
+    ~Subscription();
+
+    // Looks up the source frame identical to |frame| and sends the packets it
+    // completed to |callback|. |rtp_timestamp| is the RTP timestamp of |frame|
+    // on the timeline of the subscriber. Returns false, and sends nothing, if
+    // the input differs from the source or the source frame is not available;
+    // the caller then has to encode |frame| itself. A subscriber only joins
+    // the source, initially and after a failure, at a frame that starts a new
+    // packet.
+    bool Encode(const AudioFrame& frame,
+                uint32_t rtp_timestamp,
+                AudioPacketizationCallback* callback);
+
+    SharedAudioEncoder* encoder() const { return encoder_.get(); }
+
+   private:
+    friend class SharedAudioEncoder;
+    Subscription(rtc::scoped_refptr<SharedAudioEncoder> encoder, int id);
+
+    const rtc::scoped_refptr<SharedAudioEncoder> encoder_;
+    const int id_;
+
+    RTC_DISALLOW_COPY_AND_ASSIGN(Subscription);
+  };
+
+  static rtc::scoped_refptr<SharedAudioEncoder> Create(
+      int payload_type,
+      std::unique_ptr<AudioEncoder> encoder);
+
+  int payload_type() const { return payload_type_; }
+  int rtp_timestamp_rate_hz() const { return rtp_timestamp_rate_hz_; }
+  size_t num_channels() const { return num_channels_; }
+
+  // Same as AudioCodingModule::ModifyEncoder(). The encoder must not be
+  // replaced by one with a different payload type, timestamp rate or number
+  // of channels.
+  void ModifyEncoder(
+      rtc::FunctionView<void(std::unique_ptr<AudioEncoder>*)> modifier);
+
+  // Encodes the next 10 ms frame of the shared signal. Must be called by the
+  // single source of the signal, for every frame and before any subscriber
+  // delivers it.
+  void Encode(const AudioFrame& frame);
+
+  // Can be called from any thread. Each subscription is used from one thread
+  // at a time.
+  static std::unique_ptr<Subscription> Subscribe(
+      rtc::scoped_refptr<SharedAudioEncoder> encoder);
+
+  // Returns the number of RTP timestamp units covered by |frame| when it is
+  // encoded at |rtp_timestamp_rate_hz|. This is how the audio coding module
+  // advances the RTP timestamp, i.e. by the input samples converted with
+  // AudioEncoder::RtpTimestampRateHz() / SampleRateHz() after resampling.
+  static uint32_t RtpTimestampDuration(const AudioFrame& frame,
+                                       int rtp_timestamp_rate_hz);
+
+  Stats GetStats() const;
+
+ protected:
+  SharedAudioEncoder(int payload_type, std::unique_ptr<AudioEncoder> encoder);
+  ~SharedAudioEncoder() override;
+
+ private:
+  // Number of recently encoded frames kept around for subscribers that lag
+  // behind the source.
+  static constexpr size_t kHistorySize = 16;
+
+  struct Packet {
+    AudioFrameType frame_type;
+    uint8_t payload_type;
+    uint32_t timestamp;
+    rtc::Buffer payload;
+  };
+
+  struct EncodedFrame {
+    AudioFrame input;
+    // RTP timestamp of the frame on the timeline of the source.
+    uint32_t rtp_timestamp = 0;
+    // True if the frame is the first one of a packet.
+    bool starts_packet = false;
+    std::vector<Packet> packets;
+    size_t num_packets = 0;
+  };
+
+  struct Subscriber {
+    // Index of the next frame to be delivered, or -1 if the subscriber has not
+    // joined the source.
+    int64_t next_frame_index = -1;
+    // Packets copied out of the history, so that they can be sent without
+    // holding the lock.
+    std::vector<Packet> packets;
+  };
+
+  class PacketCollector : public AudioPacketizationCallback {
+   public:
+    explicit PacketCollector(SharedAudioEncoder* encoder) : encoder_(encoder) {}
+    // Only called by |audio_coding_| from within Encode(), which holds
+    // |crit_|. The analysis can't follow the lock through the audio coding
+    // module, hence it is disabled here.
+    int32_t SendData(AudioFrameType frame_type,
+                     uint8_t payload_type,
+                     uint32_t timestamp,
+                     const uint8_t* payload_data,
+                     size_t payload_len_bytes) override
+        RTC_NO_THREAD_SAFETY_ANALYSIS;
+
+   private:
+    SharedAudioEncoder* const encoder_;
+  };
+
+  int AddSubscriber();
+  void RemoveSubscriber(int id);
+  bool EncodeForSubscriber(int id,
+                           const AudioFrame& frame,
+                           uint32_t rtp_timestamp,
+                           AudioPacketizationCallback* callback);
+
+  EncodedFrame& FrameAt(int64_t index) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Returns the index of the most recent frame in the history that starts a
+  // packet and has the same content as |frame|, or -1 if there is none.
+  int64_t FindFrame(const AudioFrame& frame)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  const int payload_type_;
+  const int rtp_timestamp_rate_hz_;
+  const size_t num_channels_;
+
+  rtc::CriticalSection crit_;
+  const std::unique_ptr<AudioCodingModule> audio_coding_;
+  PacketCollector packet_collector_;
+  std::array<EncodedFrame, kHistorySize> history_ RTC_GUARDED_BY(crit_);
+  int64_t num_frames_ RTC_GUARDED_BY(crit_) = 0;
+  uint32_t next_timestamp_ RTC_GUARDED_BY(crit_) = 0;
+  uint32_t next_rtp_timestamp_ RTC_GUARDED_BY(crit_) = 0;
+  bool next_frame_starts_packet_ RTC_GUARDED_BY(crit_) = true;
+  // Set while encoding.
+  EncodedFrame* frame_being_encoded_ RTC_GUARDED_BY(crit_) = nullptr;
+  std::map<int, std::unique_ptr<Subscriber>> subscribers_ RTC_GUARDED_BY(crit_);
+  int next_subscriber_id_ RTC_GUARDED_BY(crit_) = 0;
+  Stats stats_ RTC_GUARDED_BY(crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(SharedAudioEncoder);
+};
+
+}  // namespace webrtc
+
+#endif  // AUDIO_SHARED_AUDIO_ENCODER_H_
@@ -0,0 +1,429 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "audio/shared_audio_encoder.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "api/audio_codecs/g722/audio_encoder_g722.h"
+#include "api/audio_codecs/opus/audio_encoder_opus.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kSampleRateHz = 48000;
+constexpr size_t kSamplesPerChannel = kSampleRateHz / 100;
+constexpr int kPayloadType = 111;
+
+std::unique_ptr<AudioEncoder> CreateOpusEncoder() {
+  AudioEncoderOpusConfig config;
+  return AudioEncoderOpus::MakeAudioEncoder(config, kPayloadType);
+}
+
+rtc::scoped_refptr<SharedAudioEncoder> CreateSharedEncoder() {
+  return SharedAudioEncoder::Create(kPayloadType, CreateOpusEncoder());
+}
+
+// Generates 10 ms frames of a tone, like a mix that is sent to many
+// participants.
+class MixGenerator {
+ public:
+  MixGenerator(float frequency_hz, int sample_rate_hz)
+      : frequency_hz_(frequency_hz), sample_rate_hz_(sample_rate_hz) {}
+  explicit MixGenerator(float frequency_hz)
+      : MixGenerator(frequency_hz, kSampleRateHz) {}
+
+  void Next(AudioFrame* frame) {
+    const size_t samples_per_channel = sample_rate_hz_ / 100;
+    int16_t audio[kSamplesPerChannel];
+    for (size_t i = 0; i < samples_per_channel; ++i) {
+      audio[i] = static_cast<int16_t>(
+          8000.f * sinf(2.f * 3.14159265f * frequency_hz_ * sample_index_++ /
+                        sample_rate_hz_));
+    }
+    frame->UpdateFrame(0, audio, samples_per_channel, sample_rate_hz_,
+                       AudioFrame::kNormalSpeech, AudioFrame::kVadActive, 1);
+  }
+
+ private:
+  const float frequency_hz_;
+  const int sample_rate_hz_;
+  size_t sample_index_ = 0;
+};
+
+struct SentPacket {
+  uint32_t timestamp;
+  std::vector<uint8_t> payload;
+};
+
+class PacketSink : public AudioPacketizationCallback {
+ public:
+  int32_t SendData(AudioFrameType frame_type,
+                   uint8_t payload_type,
+                   uint32_t timestamp,
+                   const uint8_t* payload_data,
+                   size_t payload_len_bytes) override {
+    EXPECT_EQ(kPayloadType, payload_type);
+    packets.push_back(
+        {timestamp, std::vector<uint8_t>(payload_data,
+                                         payload_data + payload_len_bytes)});
+    return 0;
+  }
+
+  std::vector<SentPacket> packets;
+};
+
+// A send stream with its own RTP timeline, which advances with every frame
+// whether or not it can be taken from the shared encoder.
+class Stream {
+ public:
+  Stream(rtc::scoped_refptr<SharedAudioEncoder> encoder, uint32_t timestamp)
+      : subscription_(SharedAudioEncoder::Subscribe(encoder)),
+        rtp_timestamp_rate_hz_(encoder->rtp_timestamp_rate_hz()),
+        timestamp_(timestamp) {}
+
+  bool Encode(const AudioFrame& frame) {
+    const uint32_t timestamp = timestamp_;
+    timestamp_ +=
+        SharedAudioEncoder::RtpTimestampDuration(frame, rtp_timestamp_rate_hz_);
+    return subscription_->Encode(frame, timestamp, &sink_);
+  }
+
+  const std::vector<SentPacket>& packets() const { return sink_.packets; }
+
+ private:
+  const std::unique_ptr<SharedAudioEncoder::Subscription> subscription_;
+  const int rtp_timestamp_rate_hz_;
+  uint32_t timestamp_;
+  PacketSink sink_;
+};
+
+}  // namespace
+
+TEST(SharedAudioEncoderTest, EncodesSourceOnceForAllSubscribers) {
+  rtc::scoped_refptr<SharedAudioEncoder> encoder = CreateSharedEncoder();
+  Stream stream1(encoder, 1000);
+  Stream stream2(encoder, 123456);
+  Stream stream3(encoder, 0xFFFFFF00);
+  EXPECT_EQ(3, encoder->GetStats().num_subscribers);
+
+  MixGenerator mix(440.f);
+  AudioFrame frame;
+  for (int i = 0; i < 100; ++i) {
+    mix.Next(&frame);
+    encoder->Encode(frame);
+    EXPECT_TRUE(stream1.Encode(frame));
+    EXPECT_TRUE(stream2.Encode(frame));
+    EXPECT_TRUE(stream3.Encode(frame));
+  }
+
+  const SharedAudioEncoder::Stats stats = encoder->GetStats();
+  EXPECT_EQ(100, stats.num_encoded_frames);
+  EXPECT_EQ(300, stats.num_reused_frames);
+  EXPECT_EQ(0, stats.num_diverged_frames);
+
+  // 20 ms packets, with the same payloads and the timestamps of each stream.
+  ASSERT_EQ(50u, stream1.packets().size());
+  ASSERT_EQ(50u, stream2.packets().size());
+  ASSERT_EQ(50u, stream3.packets().size());
+  for (size_t i = 0; i < stream1.packets().size(); ++i) {
+    EXPECT_EQ(stream1.packets()[i].payload, stream2.packets()[i].payload);
+    EXPECT_EQ(stream1.packets()[i].payload, stream3.packets()[i].payload);
+    const uint32_t expected_offset = i * 2 * kSamplesPerChannel;
+    EXPECT_EQ(1000 + expected_offset, stream1.packets()[i].timestamp);
+    EXPECT_EQ(123456 + expected_offset, stream2.packets()[i].timestamp);
+    EXPECT_EQ(0xFFFFFF00 + expected_offset, stream3.packets()[i].timestamp);
+  }
+}
+
+TEST(SharedAudioEncoderTest, MatchesOwnEncoder) {
+  rtc::scoped_refptr<SharedAudioEncoder> encoder = CreateSharedEncoder();
+  Stream stream(encoder, 0);
+  std::unique_ptr<AudioEncoder> own_encoder = CreateOpusEncoder();
+
+  MixGenerator mix(300.f);
+  AudioFrame frame;
+  rtc::Buffer own_encoded;
+  std::vector<std::vector<uint8_t>> own_payloads;
+  for (int i = 0; i < 50; ++i) {
+    mix.Next(&frame);
+    encoder->Encode(frame);
+    EXPECT_TRUE(stream.Encode(frame));
+    own_encoded.Clear();
+    own_encoder->Encode(
+        i * kSamplesPerChannel,
+        rtc::ArrayView<const int16_t>(frame.data(), kSamplesPerChannel),
+        &own_encoded);
+    if (!own_encoded.empty()) {
+      own_payloads.emplace_back(own_encoded.begin(), own_encoded.end());
+    }
+  }
+  ASSERT_EQ(own_payloads.size(), stream.packets().size());
+  for (size_t i = 0; i < own_payloads.size(); ++i) {
+    EXPECT_EQ(own_payloads[i], stream.packets()[i].payload);
+  }
+}
+
+TEST(SharedAudioEncoderTest, LaggingSubscriberReusesHistory) {
+  rtc::scoped_refptr<SharedAudioEncoder> encoder = CreateSharedEncoder();
+  Stream stream1(encoder, 0);
+  Stream stream2(encoder, 0);
+
+  MixGenerator mix(440.f);
+  std::vector<AudioFrame> frames(8);
+  for (AudioFrame& frame : frames) {
+    mix.Next(&frame);
+    encoder->Encode(frame);
+  }
+  for (const AudioFrame& frame : frames) {
+    EXPECT_TRUE(stream1.Encode(frame));
+  }
+  for (const AudioFrame& frame : frames) {
+    EXPECT_TRUE(stream2.Encode(frame));
+  }
+  EXPECT_EQ(8, encoder->GetStats().num_encoded_frames);
+  EXPECT_EQ(16, encoder->GetStats().num_reused_frames);
+  ASSERT_EQ(4u, stream1.packets().size());
+  ASSERT_EQ(stream1.packets().size(), stream2.packets().size());
+  for (size_t i = 0; i < stream1.packets().size(); ++i) {
+    EXPECT_EQ(stream1.packets()[i].payload, stream2.packets()[i].payload);
+  }
+}
+
+TEST(SharedAudioEncoderTest, LateSubscriberJoinsAtStartOfPacket) {
+  rtc::scoped_refptr<SharedAudioEncoder> encoder = CreateSharedEncoder();
+  Stream stream1(encoder, 0);
+
+  MixGenerator mix(440.f);
+  AudioFrame frame;
+  for (int i = 0; i < 10; ++i) {
+    mix.Next(&frame);
+    encoder->Encode(frame);
+    EXPECT_TRUE(stream1.Encode(frame));
+  }
+  Stream stream2(encoder, 5000);
+  // The last frame completes a packet, the rest of which is missing.
+  EXPECT_FALSE(stream2.Encode(frame));
+  for (int i = 0; i < 10; ++i) {
+    mix.Next(&frame);
+    encoder->Encode(frame);
+    EXPECT_TRUE(stream1.Encode(frame));
+    EXPECT_TRUE(stream2.Encode(frame));
+  }
+  const SharedAudioEncoder::Stats stats = encoder->GetStats();
+  EXPECT_EQ(20, stats.num_encoded_frames);
+  EXPECT_EQ(30, stats.num_reused_frames);
+  EXPECT_EQ(1, stats.num_diverged_frames);
+
+  // The packets of the late stream continue its own timeline.
+  ASSERT_EQ(5u, stream2.packets().size());
+  for (size_t i = 0; i < stream2.packets().size(); ++i) {
+    EXPECT_EQ(5000 + (2 * i + 1) * kSamplesPerChannel,
+              stream2.packets()[i].timestamp);
+    EXPECT_EQ(stream1.packets()[i + 5].payload, stream2.packets()[i].payload);
+  }
+}
+
+TEST(SharedAudioEncoderTest, DivergingSubscribersDeliveringFirstDoNotTakeOver) {
+  rtc::scoped_refptr<SharedAudioEncoder> encoder = CreateSharedEncoder();
+  Stream muted_stream(encoder, 0);
+  Stream diverging_stream(encoder, 0);
+  Stream stream(encoder, 0);
+  std::unique_ptr<AudioEncoder> own_encoder = CreateOpusEncoder();
+
+  MixGenerator mix(440.f);
+  MixGenerator other_mix(500.f);
+  AudioFrame frame;
+  AudioFrame muted_frame;
+  AudioFrame other_frame;
+  rtc::Buffer own_encoded;
+  std::vector<std::vector<uint8_t>> own_payloads;
+  for (int i = 0; i < 20; ++i) {
+    mix.Next(&frame);
+    other_mix.Next(&other_frame);
+    muted_frame.CopyFrom(frame);
+    muted_frame.Mute();
+    // The subscribers with other input deliver before the source, and before
+    // the subscriber that has the shared input.
+    EXPECT_FALSE(muted_stream.Encode(muted_frame));
+    EXPECT_FALSE(diverging_stream.Encode(other_frame));
+    encoder->Encode(frame);
+    EXPECT_FALSE(muted_stream.Encode(muted_frame));
+    EXPECT_FALSE(diverging_stream.Encode(other_frame));
+    EXPECT_TRUE(stream.Encode(frame));
+
+    own_encoded.Clear();
+    own_encoder->Encode(
+        i * kSamplesPerChannel,
+        rtc::ArrayView<const int16_t>(frame.data(), kSamplesPerChannel),
+        &own_encoded);
+    if (!own_encoded.empty()) {
+      own_payloads.emplace_back(own_encoded.begin(), own_encoded.end());
+    }
+  }
+
+  const SharedAudioEncoder::Stats stats = encoder->GetStats();
+  EXPECT_EQ(20, stats.num_encoded_frames);
+  EXPECT_EQ(20, stats.num_reused_frames);
+  EXPECT_EQ(80, stats.num_diverged_frames);
+  EXPECT_TRUE(muted_stream.packets().empty());
+  EXPECT_TRUE(diverging_stream.packets().empty());
+  ASSERT_EQ(own_payloads.size(), stream.packets().size());
+  for (size_t i = 0; i < own_payloads.size(); ++i) {
+    EXPECT_EQ(own_payloads[i], stream.packets()[i].payload);
+  }
+}
+
+TEST(SharedAudioEncoderTest, RejoinsAfterDivergingWithContinuousTimestamps) {
+  rtc::scoped_refptr<SharedAudioEncoder> encoder = CreateSharedEncoder();
+  Stream stream(encoder, 1000);
+
+  MixGenerator mix(440.f);
+  AudioFrame frame;
+  for (int i = 0; i < 8; ++i) {
+    mix.Next(&frame);
+    encoder->Encode(frame);
+    if (i == 4) {
+      // E.g. muted for one frame.
+      AudioFrame muted_frame;
+      muted_frame.CopyFrom(frame);
+      muted_frame.Mute();
+      EXPECT_FALSE(stream.Encode(muted_frame));
+    } else if (i == 5) {
+      // Matches again, but in the middle of a packet.
+      EXPECT_FALSE(stream.Encode(frame));
+    } else {
+      EXPECT_TRUE(stream.Encode(frame));
+    }
+  }
+  EXPECT_EQ(2, encoder->GetStats().num_diverged_frames);
+
+  // The packet of frames 4 and 5 is left to the own encoder of the stream.
+  ASSERT_EQ(3u, stream.packets().size());
+  EXPECT_EQ(1000u, stream.packets()[0].timestamp);
+  EXPECT_EQ(1000u + 2 * kSamplesPerChannel, stream.packets()[1].timestamp);
+  EXPECT_EQ(1000u + 6 * kSamplesPerChannel, stream.packets()[2].timestamp);
+}
+
+TEST(SharedAudioEncoderTest, ConvertsTimestampsToRtpTimestampRate) {
+  // G.722 has an RTP timestamp rate of 8 kHz, half its sample rate.
+  for (int input_rate_hz : {16000, 48000}) {
+    rtc::scoped_refptr<SharedAudioEncoder> encoder = SharedAudioEncoder::Create(
+        kPayloadType,
+        AudioEncoderG722::MakeAudioEncoder(AudioEncoderG722Config(),
+                                           kPayloadType));
+    EXPECT_EQ(8000, encoder->rtp_timestamp_rate_hz());
+    Stream stream1(encoder, 1000);
+    std::unique_ptr<Stream> stream2;
+
+    MixGenerator mix(440.f, input_rate_hz);
+    AudioFrame frame;
+    for (int i = 0; i < 10; ++i) {
+      mix.Next(&frame);
+      EXPECT_EQ(80u, SharedAudioEncoder::RtpTimestampDuration(frame, 8000));
+      encoder->Encode(frame);
+      EXPECT_TRUE(stream1.Encode(frame));
+      if (i == 4) {
+        stream2.reset(new Stream(encoder, 50000));
+      }
+      if (stream2) {
+        EXPECT_TRUE(stream2->Encode(frame));
+      }
+    }
+
+    // 20 ms packets are 160 RTP timestamp units apart.
+    ASSERT_EQ(5u, stream1.packets().size());
+    for (size_t i = 0; i < stream1.packets().size(); ++i) {
+      EXPECT_EQ(1000 + 160 * i, stream1.packets()[i].timestamp);
+    }
+    // The second stream joined at its frame 0, the shared frame 4.
+    ASSERT_EQ(3u, stream2->packets().size());
+    for (size_t i = 0; i < stream2->packets().size(); ++i) {
+      EXPECT_EQ(50000 + 160 * i, stream2->packets()[i].timestamp);
+    }
+  }
+}
+
+TEST(SharedAudioEncoderTest, DetectsSubscriberTooFarBehind) {
+  rtc::scoped_refptr<SharedAudioEncoder> encoder = CreateSharedEncoder();
+  Stream stream(encoder, 0);
+
+  MixGenerator mix(440.f);
+  std::vector<AudioFrame> frames(40);
+  for (AudioFrame& frame : frames) {
+    mix.Next(&frame);
+    encoder->Encode(frame);
+    if (&frame == &frames[0]) {
+      EXPECT_TRUE(stream.Encode(frame));
+    }
+  }
+  // The encoding of the next frame is no longer in the history.
+  EXPECT_FALSE(stream.Encode(frames[1]));
+}
+
+// Compares the encoding CPU of a conference with 100 listeners and 3 active
+// speakers. Each speaker hears the mix of the other two, and the listeners all
+// hear the mix of the three, so there are only four distinct signals.
+TEST(SharedAudioEncoderTest, DISABLED_Benchmark) {
+  constexpr int kNumParticipants = 100;
+  constexpr int kNumSpeakers = 3;
+  constexpr int kNumFrames = 1000;
+
+  for (bool shared : {false, true}) {
+    std::vector<MixGenerator> mixes;
+    std::vector<rtc::scoped_refptr<SharedAudioEncoder>> encoders;
+    for (int m = 0; m <= kNumSpeakers; ++m) {
+      mixes.emplace_back(200.f + 100.f * m);
+    }
+
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::vector<int> mix_of_encoder;
+    std::vector<int> encoder_of_stream;
+    for (int p = 0; p < kNumParticipants; ++p) {
+      // Participant p < kNumSpeakers is a speaker and hears mix p, the rest
+      // hear mix kNumSpeakers.
+      const int mix = std::min(p, kNumSpeakers);
+      if (!shared || p <= kNumSpeakers) {
+        encoders.push_back(CreateSharedEncoder());
+        mix_of_encoder.push_back(mix);
+      }
+      encoder_of_stream.push_back(shared ? mix : p);
+      streams.emplace_back(
+          new Stream(encoders[encoder_of_stream.back()], 1000 * p));
+    }
+
+    std::vector<AudioFrame> frames(mixes.size());
+    int64_t elapsed_us = 0;
+    for (int i = 0; i < kNumFrames; ++i) {
+      for (size_t m = 0; m < mixes.size(); ++m) {
+        mixes[m].Next(&frames[m]);
+      }
+      const int64_t start_us = rtc::TimeMicros();
+      for (size_t e = 0; e < encoders.size(); ++e) {
+        encoders[e]->Encode(frames[mix_of_encoder[e]]);
+      }
+      for (size_t s = 0; s < streams.size(); ++s) {
+        streams[s]->Encode(frames[mix_of_encoder[encoder_of_stream[s]]]);
+      }
+      elapsed_us += rtc::TimeMicros() - start_us;
+    }
+    printf("%s encoders: %.1f ms of CPU per second of audio\n",
+           shared ? "Shared" : "Separate",
+           elapsed_us / 1000.0 / (kNumFrames / 100.0));
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,544 @@
+/*
+ * http://www.kurims.kyoto-u.ac.jp/~ooura/fft.html
+ * Copyright Takuya OOURA, 1996-2001
+ *
+ * You may use, copy, modify and distribute this code for any purpose (include
+ * commercial use) and without fee. Please refer to this package when you modify
+ * this code.
+ *
+ * Changes by the WebRTC authors:
+ *    - Moved the code into a class with precomputed tables.
+ *    - Merged cft1st() and cftmdl() into a single radix-4 stage.
+ *    - Added SSE2, AVX2 and NEON implementations of the butterfly stages.
+ *
+ *  All changes are covered by the WebRTC license and IP grant:
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_audio/fft/real_fft.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+namespace {
+
+// The SIMD implementations need at least two radix-4 stages.
+constexpr size_t kMinSimdLength = 16;
+
+bool IsPowerOfTwo(size_t n) {
+  return n != 0 && (n & (n - 1)) == 0;
+}
+
+RealFft::Backend ClampBackend(size_t length, RealFft::Backend backend) {
+  return length < kMinSimdLength ? RealFft::Backend::kC : backend;
+}
+
+// Computes the offsets used by Ooura's bitrv2() for |n| values.
+std::vector<size_t> ComputeBitReversalOffsets(size_t n) {
+  std::vector<size_t> ip(1, 0);
+  size_t l = n;
+  size_t m = 1;
+  while ((m << 3) < l) {
+    l >>= 1;
+    ip.resize(2 * m);
+    for (size_t j = 0; j < m; ++j) {
+      ip[m + j] = ip[j] + l;
+    }
+    m <<= 1;
+  }
+  return ip;
+}
+
+void SwapComplex(float* a, size_t j1, size_t k1) {
+  const float xr = a[j1];
+  const float xi = a[j1 + 1];
+  a[j1] = a[k1];
+  a[j1 + 1] = a[k1 + 1];
+  a[k1] = xr;
+  a[k1 + 1] = xi;
+}
+
+// Ooura's bitrv2() using the precomputed offsets in |ip|.
+void ApplyBitReversal(size_t n, const size_t* ip, float* a) {
+  size_t l = n;
+  size_t m = 1;
+  while ((m << 3) < l) {
+    l >>= 1;
+    m <<= 1;
+  }
+  const size_t m2 = 2 * m;
+  if ((m << 3) == l) {
+    for (size_t k = 0; k < m; ++k) {
+      for (size_t j = 0; j < k; ++j) {
+        size_t j1 = 2 * j + ip[k];
+        size_t k1 = 2 * k + ip[j];
+        SwapComplex(a, j1, k1);
+        j1 += m2;
+        k1 += 2 * m2;
+        SwapComplex(a, j1, k1);
+        j1 += m2;
+        k1 -= m2;
+        SwapComplex(a, j1, k1);
+        j1 += m2;
+        k1 += 2 * m2;
+        SwapComplex(a, j1, k1);
+      }
+      const size_t j1 = 2 * k + m2 + ip[k];
+      SwapComplex(a, j1, j1 + m2);
+    }
+  } else {
+    for (size_t k = 1; k < m; ++k) {
+      for (size_t j = 0; j < k; ++j) {
+        size_t j1 = 2 * j + ip[k];
+        size_t k1 = 2 * k + ip[j];
+        SwapComplex(a, j1, k1);
+        j1 += m2;
+        k1 += m2;
+        SwapComplex(a, j1, k1);
+      }
+    }
+  }
+}
+
+// Returns cos(|x|) and sin(|x|) computed in double precision, as done by the
+// C implementation.
+float Cosine(float x) {
+  return static_cast<float>(cos(static_cast<double>(x)));
+}
+float Sine(float x) {
+  return static_cast<float>(sin(static_cast<double>(x)));
+}
+
+// Ooura's makewt(): twiddle factors of the complex FFT of |4 * nw| values.
+std::vector<float> ComputeTwiddles(size_t nw) {
+  std::vector<float> w(nw, 0.f);
+  if (nw > 2) {
+    const size_t nwh = nw >> 1;
+    const float delta = atanf(1.0f) / nwh;
+    w[0] = 1;
+    w[1] = 0;
+    w[nwh] = Cosine(delta * nwh);
+    w[nwh + 1] = w[nwh];
+    if (nwh > 2) {
+      for (size_t j = 2; j < nwh; j += 2) {
+        const float x = Cosine(delta * j);
+        const float y = Sine(delta * j);
+        w[j] = x;
+        w[j + 1] = y;
+        w[nw - j] = y;
+        w[nw - j + 1] = x;
+      }
+      const std::vector<size_t> ip = ComputeBitReversalOffsets(nw);
+      ApplyBitReversal(nw, ip.data(), w.data());
+    }
+  }
+  return w;
+}
+
+// Ooura's makect(): cosine table of the real FFT post-processing.
+std::vector<float> ComputeCosineTable(size_t nc) {
+  std::vector<float> c(nc, 0.f);
+  if (nc > 1) {
+    const size_t nch = nc >> 1;
+    const float delta = atanf(1.0f) / nch;
+    c[0] = Cosine(delta * nch);
+    c[nch] = 0.5f * c[0];
+    for (size_t j = 1; j < nch; ++j) {
+      c[j] = 0.5f * Cosine(delta * j);
+      c[nc - j] = 0.5f * Sine(delta * j);
+    }
+  }
+  return c;
+}
+
+}  // namespace
+
+RealFft::Backend RealFft::DetectBackend() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2) != 0) {
+    return Backend::kAvx2;
+  }
+#endif
+  if (WebRtc_GetCPUInfo(kSSE2) != 0) {
+    return Backend::kSse2;
+  }
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+  return Backend::kNeon;
+#endif
+
+  return Backend::kC;
+}
+
+bool RealFft::IsBackendAvailable(Backend backend) {
+  switch (backend) {
+    case Backend::kC:
+      return true;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Backend::kAvx2:
+      return WebRtc_GetCPUInfo(kAVX2) != 0;
+#endif
+    case Backend::kSse2:
+      return WebRtc_GetCPUInfo(kSSE2) != 0;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+    case Backend::kNeon:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+RealFft::RealFft(size_t length) : RealFft(length, DetectBackend()) {}
+
+RealFft::RealFft(size_t length, Backend backend)
+    : length_(length),
+      backend_(ClampBackend(length, backend)),
+      ip_(ComputeBitReversalOffsets(length)) {
+  RTC_CHECK_GE(length_, 2);
+  RTC_CHECK(IsPowerOfTwo(length_));
+  RTC_DCHECK(IsBackendAvailable(backend_));
+
+  // Twiddle factors of the radix-4 stages. Block 0 has unit twiddles and
+  // block 1 only uses |wk1r|; both are stored for completeness.
+  const size_t num_blocks = std::max<size_t>(length_ >> 3, 2);
+  wk1r_.resize(2 * num_blocks);
+  wk1i_.resize(2 * num_blocks);
+  wk2r_.resize(2 * num_blocks);
+  wk2i_.resize(2 * num_blocks);
+  wk3r_.resize(2 * num_blocks);
+  wk3i_.resize(2 * num_blocks);
+  auto set_twiddles = [this](size_t b, float wk1r, float wk1i, float wk2r,
+                             float wk2i, float wk3r, float wk3i) {
+    wk1r_[2 * b] = wk1r_[2 * b + 1] = wk1r;
+    wk1i_[2 * b] = -wk1i;
+    wk1i_[2 * b + 1] = wk1i;
+    wk2r_[2 * b] = wk2r_[2 * b + 1] = wk2r;
+    wk2i_[2 * b] = -wk2i;
+    wk2i_[2 * b + 1] = wk2i;
+    wk3r_[2 * b] = wk3r_[2 * b + 1] = wk3r;
+    wk3i_[2 * b] = -wk3i;
+    wk3i_[2 * b + 1] = wk3i;
+  };
+  set_twiddles(0, 1.f, 0.f, 1.f, 0.f, 1.f, 0.f);
+  if (length_ >= kMinSimdLength) {
+    const std::vector<float> w = ComputeTwiddles(length_ >> 2);
+    set_twiddles(1, w[2], w[3], 0.f, 1.f, -w[2], w[3]);
+    for (size_t b = 2; b < num_blocks; b += 2) {
+      const size_t k1 = b;
+      const size_t k2 = 2 * k1;
+      const float wk2r = w[k1];
+      const float wk2i = w[k1 + 1];
+      float wk1r = w[k2];
+      float wk1i = w[k2 + 1];
+      set_twiddles(b, wk1r, wk1i, wk2r, wk2i, wk1r - 2 * wk2i * wk1i,
+                   2 * wk2i * wk1r - wk1i);
+      wk1r = w[k2 + 2];
+      wk1i = w[k2 + 3];
+      set_twiddles(b + 1, wk1r, wk1i, -wk2i, wk2r, wk1r - 2 * wk2r * wk1i,
+                   2 * wk2r * wk1r - wk1i);
+    }
+  }
+
+  // Weights of the real FFT post-processing.
+  const size_t nc = length_ >> 2;
+  if (nc > 1) {
+    const std::vector<float> c = ComputeCosineTable(nc);
+    rft_wkr_.resize(nc);
+    rft_wki_.resize(nc);
+    for (size_t k = 1; k < nc; ++k) {
+      rft_wkr_[k] = 0.5f - c[nc - k];
+      rft_wki_[k] = c[k];
+    }
+  }
+}
+
+RealFft::~RealFft() = default;
+
+void RealFft::Forward(float* a) const {
+  RTC_DCHECK(a);
+  if (length_ > 4) {
+    BitReverse(a);
+    Cftsub(/*backward=*/false, a);
+    Rftfsub(a);
+  } else if (length_ == 4) {
+    Cftsub(/*backward=*/false, a);
+  }
+  const float xi = a[0] - a[1];
+  a[0] += a[1];
+  a[1] = xi;
+}
+
+void RealFft::Inverse(float* a) const {
+  RTC_DCHECK(a);
+  a[1] = 0.5f * (a[0] - a[1]);
+  a[0] -= a[1];
+  if (length_ > 4) {
+    Rftbsub(a);
+    BitReverse(a);
+    Cftsub(/*backward=*/true, a);
+  } else if (length_ == 4) {
+    Cftsub(/*backward=*/false, a);
+  }
+}
+
+void RealFft::BitReverse(float* a) const {
+  ApplyBitReversal(length_, ip_.data(), a);
+}
+
+void RealFft::Cftsub(bool backward, float* a) const {
+  switch (backend_) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Backend::kAvx2:
+      Cftsub_AVX2(backward, a);
+      return;
+#endif
+    case Backend::kSse2:
+      Cftsub_SSE2(backward, a);
+      return;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+    case Backend::kNeon:
+      Cftsub_NEON(backward, a);
+      return;
+#endif
+    default:
+      Cftsub_C(backward, a);
+  }
+}
+
+void RealFft::Rftfsub(float* a) const {
+  switch (backend_) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Backend::kAvx2:
+      Rftfsub_AVX2(a);
+      return;
+#endif
+    case Backend::kSse2:
+      Rftfsub_SSE2(a);
+      return;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+    case Backend::kNeon:
+      Rftfsub_NEON(a);
+      return;
+#endif
+    default:
+      Rftfsub_C(a);
+  }
+}
+
+void RealFft::Rftbsub(float* a) const {
+  switch (backend_) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Backend::kAvx2:
+      Rftbsub_AVX2(a);
+      return;
+#endif
+    case Backend::kSse2:
+      Rftbsub_SSE2(a);
+      return;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+    case Backend::kNeon:
+      Rftbsub_NEON(a);
+      return;
+#endif
+    default:
+      Rftbsub_C(a);
+  }
+}
+
+void RealFft::Radix4Block_C(size_t l, size_t b, float* a) const {
+  float x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
+  const size_t k = b * (l << 2);
+  if (b == 1) {
+    // Simplified butterflies since wk1r == wk1i, wk2 = (0, 1) and
+    // wk3 = (-wk1r, wk1r).
+    const float wk1r = wk1r_[2];
+    for (size_t j = k; j < l + k; j += 2) {
+      const size_t j1 = j + l;
+      const size_t j2 = j1 + l;
+      const size_t j3 = j2 + l;
+      x0r = a[j] + a[j1];
+      x0i = a[j + 1] + a[j1 + 1];
+      x1r = a[j] - a[j1];
+      x1i = a[j + 1] - a[j1 + 1];
+      x2r = a[j2] + a[j3];
+      x2i = a[j2 + 1] + a[j3 + 1];
+      x3r = a[j2] - a[j3];
+      x3i = a[j2 + 1] - a[j3 + 1];
+      a[j] = x0r + x2r;
+      a[j + 1] = x0i + x2i;
+      a[j2] = x2i - x0i;
+      a[j2 + 1] = x0r - x2r;
+      x0r = x1r - x3i;
+      x0i = x1i + x3r;
+      a[j1] = wk1r * (x0r - x0i);
+      a[j1 + 1] = wk1r * (x0r + x0i);
+      x0r = x3i + x1r;
+      x0i = x3r - x1i;
+      a[j3] = wk1r * (x0i - x0r);
+      a[j3 + 1] = wk1r * (x0i + x0r);
+    }
+    return;
+  }
+
+  const float wk1r = wk1r_[2 * b];
+  const float wk1i = wk1i_[2 * b + 1];
+  const float wk2r = wk2r_[2 * b];
+  const float wk2i = wk2i_[2 * b + 1];
+  const float wk3r = wk3r_[2 * b];
+  const float wk3i = wk3i_[2 * b + 1];
+  for (size_t j = k; j < l + k; j += 2) {
+    const size_t j1 = j + l;
+    const size_t j2 = j1 + l;
+    const size_t j3 = j2 + l;
+    x0r = a[j] + a[j1];
+    x0i = a[j + 1] + a[j1 + 1];
+    x1r = a[j] - a[j1];
+    x1i = a[j + 1] - a[j1 + 1];
+    x2r = a[j2] + a[j3];
+    x2i = a[j2 + 1] + a[j3 + 1];
+    x3r = a[j2] - a[j3];
+    x3i = a[j2 + 1] - a[j3 + 1];
+    a[j] = x0r + x2r;
+    a[j + 1] = x0i + x2i;
+    x0r -= x2r;
+    x0i -= x2i;
+    a[j2] = wk2r * x0r - wk2i * x0i;
+    a[j2 + 1] = wk2r * x0i + wk2i * x0r;
+    x0r = x1r - x3i;
+    x0i = x1i + x3r;
+    a[j1] = wk1r * x0r - wk1i * x0i;
+    a[j1 + 1] = wk1r * x0i + wk1i * x0r;
+    x0r = x1r + x3i;
+    x0i = x1i - x3r;
+    a[j3] = wk3r * x0r - wk3i * x0i;
+    a[j3 + 1] = wk3r * x0i + wk3i * x0r;
+  }
+}
+
+void RealFft::Cftsub_C(bool backward, float* a) const {
+  const size_t n = length_;
+  float x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
+
+  // Radix-4 stages (Ooura's cft1st() for |l| == 2 and cftmdl() otherwise).
+  size_t l = 2;
+  for (; (l << 2) < n; l <<= 2) {
+    for (size_t b = 0; b * (l << 2) < n; ++b) {
+      Radix4Block_C(l, b, a);
+    }
+  }
+
+  // Last stage, without twiddles.
+  if ((l << 2) == n) {
+    for (size_t j = 0; j < l; j += 2) {
+      const size_t j1 = j + l;
+      const size_t j2 = j1 + l;
+      const size_t j3 = j2 + l;
+      x0r = a[j] + a[j1];
+      x1r = a[j] - a[j1];
+      x2r = a[j2] + a[j3];
+      x2i = a[j2 + 1] + a[j3 + 1];
+      x3r = a[j2] - a[j3];
+      x3i = a[j2 + 1] - a[j3 + 1];
+      if (backward) {
+        x0i = -a[j + 1] - a[j1 + 1];
+        x1i = -a[j + 1] + a[j1 + 1];
+        a[j] = x0r + x2r;
+        a[j + 1] = x0i - x2i;
+        a[j2] = x0r - x2r;
+        a[j2 + 1] = x0i + x2i;
+        a[j1] = x1r - x3i;
+        a[j1 + 1] = x1i - x3r;
+        a[j3] = x1r + x3i;
+        a[j3 + 1] = x1i + x3r;
+      } else {
+        x0i = a[j + 1] + a[j1 + 1];
+        x1i = a[j + 1] - a[j1 + 1];
+        a[j] = x0r + x2r;
+        a[j + 1] = x0i + x2i;
+        a[j2] = x0r - x2r;
+        a[j2 + 1] = x0i - x2i;
+        a[j1] = x1r - x3i;
+        a[j1 + 1] = x1i + x3r;
+        a[j3] = x1r + x3i;
+        a[j3 + 1] = x1i - x3r;
+      }
+    }
+  } else {
+    for (size_t j = 0; j < l; j += 2) {
+      const size_t j1 = j + l;
+      x0r = a[j] - a[j1];
+      if (backward) {
+        x0i = -a[j + 1] + a[j1 + 1];
+        a[j] += a[j1];
+        a[j + 1] = -a[j + 1] - a[j1 + 1];
+      } else {
+        x0i = a[j + 1] - a[j1 + 1];
+        a[j] += a[j1];
+        a[j + 1] += a[j1 + 1];
+      }
+      a[j1] = x0r;
+      a[j1 + 1] = x0i;
+    }
+  }
+}
+
+void RealFft::Rftfsub_C(float* a) const {
+  const size_t n = length_;
+  const size_t m = n >> 1;
+  for (size_t j = 2, kk = 1; j < m; j += 2, ++kk) {
+    const size_t k = n - j;
+    const float wkr = rft_wkr_[kk];
+    const float wki = rft_wki_[kk];
+    const float xr = a[j] - a[k];
+    const float xi = a[j + 1] + a[k + 1];
+    const float yr = wkr * xr - wki * xi;
+    const float yi = wkr * xi + wki * xr;
+    a[j] -= yr;
+    a[j + 1] -= yi;
+    a[k] += yr;
+    a[k + 1] -= yi;
+  }
+}
+
+void RealFft::Rftbsub_C(float* a) const {
+  const size_t n = length_;
+  const size_t m = n >> 1;
+  a[1] = -a[1];
+  for (size_t j = 2, kk = 1; j < m; j += 2, ++kk) {
+    const size_t k = n - j;
+    const float wkr = rft_wkr_[kk];
+    const float wki = rft_wki_[kk];
+    const float xr = a[j] - a[k];
+    const float xi = a[j + 1] + a[k + 1];
+    const float yr = wkr * xr + wki * xi;
+    const float yi = wkr * xi - wki * xr;
+    a[j] -= yr;
+    a[j + 1] = yi - a[j + 1];
+    a[k] += yr;
+    a[k + 1] = yi - a[k + 1];
+  }
+  a[m + 1] = -a[m + 1];
+}
+
+}  // namespace webrtc
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_AUDIO_FFT_REAL_FFT_H_
+#define COMMON_AUDIO_FFT_REAL_FFT_H_
+
+#include <stddef.h>
+#include <vector>
+
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/gtest_prod_util.h"
+#include "rtc_base/system/arch.h"
+
+namespace webrtc {
+
+// Real-valued FFT of power-of-two length based on Ooura's split-radix
+// algorithm, shared by the audio processing modules. The twiddle factors are
+// precomputed at construction and the butterfly stages are dispatched to SSE2,
+// AVX2 or NEON implementations when available.
+//
+// The transforms are computed in place using the same packed format as
+// WebRtc_rdft(), which all implementations reproduce exactly:
+//   Forward(): a[0] = R[0], a[1] = R[n / 2] and, for 0 < k < n / 2,
+//              a[2 * k] = R[k], a[2 * k + 1] = I[k], where
+//              R[k] = sum_j a[j] * cos(2 * pi * j * k / n) and
+//              I[k] = sum_j a[j] * sin(2 * pi * j * k / n).
+//   Inverse(): takes the Forward() layout and returns the time domain signal
+//              scaled by n / 2.
+class RealFft {
+ public:
+  // Implementations of the butterfly stages.
+  enum class Backend { kC, kSse2, kAvx2, kNeon };
+
+  // Returns the fastest backend supported by the build and by the CPU.
+  static Backend DetectBackend();
+
+  // Returns true if |backend| can be used with the current build and CPU.
+  static bool IsBackendAvailable(Backend backend);
+
+  // |length| must be a power of two and at least 2.
+  explicit RealFft(size_t length);
+  // Uses |backend|, which must be available. Lengths below 16 always use the C
+  // implementation.
+  RealFft(size_t length, Backend backend);
+  ~RealFft();
+
+  size_t length() const { return length_; }
+  Backend backend() const { return backend_; }
+
+  // Computes the forward transform of the |length()| values in |a|.
+  void Forward(float* a) const;
+
+  // Computes the inverse transform of the |length()| values in |a|.
+  void Inverse(float* a) const;
+
+ private:
+  FRIEND_TEST_ALL_PREFIXES(RealFftTest, TwiddleTables);
+
+  void BitReverse(float* a) const;
+
+  // Complex FFT of |length()| / 2 values (Ooura's cftfsub() and cftbsub()).
+  void Cftsub(bool backward, float* a) const;
+  // Spectrum post-processing of the forward and inverse real transforms
+  // (Ooura's rftfsub() and rftbsub()).
+  void Rftfsub(float* a) const;
+  void Rftbsub(float* a) const;
+
+  // Radix-4 butterflies of block |b| of the stage with stride |l|.
+  void Radix4Block_C(size_t l, size_t b, float* a) const;
+
+  void Cftsub_C(bool backward, float* a) const;
+  void Rftfsub_C(float* a) const;
+  void Rftbsub_C(float* a) const;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  void Cftsub_SSE2(bool backward, float* a) const;
+  void Rftfsub_SSE2(float* a) const;
+  void Rftbsub_SSE2(float* a) const;
+#if defined(WEBRTC_ENABLE_AVX2)
+  // Implemented in real_fft_avx2.cc, which is built with AVX2 support.
+  void Cftsub_AVX2(bool backward, float* a) const;
+  void Rftfsub_AVX2(float* a) const;
+  void Rftbsub_AVX2(float* a) const;
+#endif
+#endif
+#if defined(WEBRTC_HAS_NEON)
+  void Cftsub_NEON(bool backward, float* a) const;
+  void Rftfsub_NEON(float* a) const;
+  void Rftbsub_NEON(float* a) const;
+#endif
+
+  const size_t length_;
+  const Backend backend_;
+
+  // Bit reversal offsets of Ooura's bitrv2().
+  std::vector<size_t> ip_;
+
+  // Twiddle factors of the radix-4 butterflies, one set per butterfly block
+  // |b|. Each factor is stored twice to match the interleaved layout of the
+  // data: |wk*r_[2 * b]| == |wk*r_[2 * b + 1]| holds the real part, and
+  // |wk*i_[2 * b]| == -|wk*i_[2 * b + 1]| holds the negated imaginary part
+  // followed by the imaginary part.
+  std::vector<float> wk1r_;
+  std::vector<float> wk1i_;
+  std::vector<float> wk2r_;
+  std::vector<float> wk2i_;
+  std::vector<float> wk3r_;
+  std::vector<float> wk3i_;
+
+  // Weights of the real transform post-processing, indexed by the bin |k| and
+  // precomputed as 0.5 - c[n / 4 - k] and c[k], where c is Ooura's cosine
+  // table.
+  std::vector<float> rft_wkr_;
+  std::vector<float> rft_wki_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RealFft);
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_AUDIO_FFT_REAL_FFT_H_
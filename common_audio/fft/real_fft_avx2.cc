@@ -0,0 +1,316 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "common_audio/fft/real_fft.h"
+#include "rtc_base/checks.h"
+
+// Same butterflies as in real_fft_sse2.cc with four interleaved complex values
+// per vector. Fused multiply-adds are deliberately not used, so that the
+// results stay bit exact with the C implementation.
+
+namespace webrtc {
+
+namespace {
+
+inline __m256 SwapReIm(__m256 x) {
+  return _mm256_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+inline __m256 DuplicateRe(__m256 x) {
+  return _mm256_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0));
+}
+
+inline __m256 DuplicateIm(__m256 x) {
+  return _mm256_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1));
+}
+
+inline __m256 ComplexMul(__m256 x, __m256 wr, __m256 wi) {
+  return _mm256_add_ps(_mm256_mul_ps(wr, x), _mm256_mul_ps(wi, SwapReIm(x)));
+}
+
+inline __m256 LoadPair(const float* p) {
+  return _mm256_castpd_ps(
+      _mm256_broadcast_sd(reinterpret_cast<const double*>(p)));
+}
+
+// Loads four floats from |low| and four floats from |high|.
+inline __m256 LoadLanes(const float* low, const float* high) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)),
+                              _mm_loadu_ps(high), 1);
+}
+
+inline void StoreLanes(__m256 x, float* low, float* high) {
+  _mm_storeu_ps(low, _mm256_castps256_ps128(x));
+  _mm_storeu_ps(high, _mm256_extractf128_ps(x, 1));
+}
+
+inline void Butterfly(__m256 a0,
+                      __m256 a1,
+                      __m256 a2,
+                      __m256 a3,
+                      __m256 neg_re,
+                      __m256* y0,
+                      __m256* y1,
+                      __m256* y2,
+                      __m256* y3) {
+  const __m256 x0 = _mm256_add_ps(a0, a1);
+  const __m256 x1 = _mm256_sub_ps(a0, a1);
+  const __m256 x2 = _mm256_add_ps(a2, a3);
+  const __m256 x3 = _mm256_sub_ps(a2, a3);
+  const __m256 i_x3 = _mm256_xor_ps(SwapReIm(x3), neg_re);
+  *y0 = _mm256_add_ps(x0, x2);
+  *y1 = _mm256_add_ps(x1, i_x3);
+  *y2 = _mm256_sub_ps(x0, x2);
+  *y3 = _mm256_sub_ps(x1, i_x3);
+}
+
+// Splits the 8 interleaved complex values in |x0| and |x1| into real and
+// imaginary parts.
+inline void Deinterleave(__m256 x0, __m256 x1, __m256* re, __m256* im) {
+  const __m256i order = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+  *re = _mm256_permutevar8x32_ps(
+      _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0)), order);
+  *im = _mm256_permutevar8x32_ps(
+      _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1)), order);
+}
+
+// Inverse of Deinterleave().
+inline void Interleave(__m256 re, __m256 im, __m256* x0, __m256* x1) {
+  const __m256 low = _mm256_unpacklo_ps(re, im);
+  const __m256 high = _mm256_unpackhi_ps(re, im);
+  *x0 = _mm256_permute2f128_ps(low, high, 0x20);
+  *x1 = _mm256_permute2f128_ps(low, high, 0x31);
+}
+
+inline __m256 Reverse(__m256 x) {
+  return _mm256_permutevar8x32_ps(x,
+                                  _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+}  // namespace
+
+void RealFft::Cftsub_AVX2(bool backward, float* a) const {
+  const size_t n = length_;
+  RTC_DCHECK_GE(n, 16);
+  const __m256 neg_re = _mm256_setr_ps(-0.f, 0.f, -0.f, 0.f, -0.f, 0.f, -0.f,
+                                       0.f);
+  const __m256 neg_im = _mm256_setr_ps(0.f, -0.f, 0.f, -0.f, 0.f, -0.f, 0.f,
+                                       -0.f);
+  const __m256 neg_all = _mm256_set1_ps(-0.f);
+  __m256 y0, y1, y2, y3;
+
+  // First radix-4 stage (l == 2). Each 128-bit lane holds one complex value
+  // from each of two consecutive blocks, so that four blocks are processed per
+  // iteration.
+  Radix4Block_C(2, 0, a);
+  Radix4Block_C(2, 1, a);
+  size_t j = 16;
+  size_t b = 2;
+  for (; j + 32 <= n; j += 32, b += 4) {
+    const __m256 a00 = LoadLanes(&a[j], &a[j + 16]);
+    const __m256 a04 = LoadLanes(&a[j + 4], &a[j + 20]);
+    const __m256 a08 = LoadLanes(&a[j + 8], &a[j + 24]);
+    const __m256 a12 = LoadLanes(&a[j + 12], &a[j + 28]);
+    Butterfly(_mm256_shuffle_ps(a00, a08, _MM_SHUFFLE(1, 0, 1, 0)),
+              _mm256_shuffle_ps(a00, a08, _MM_SHUFFLE(3, 2, 3, 2)),
+              _mm256_shuffle_ps(a04, a12, _MM_SHUFFLE(1, 0, 1, 0)),
+              _mm256_shuffle_ps(a04, a12, _MM_SHUFFLE(3, 2, 3, 2)), neg_re,
+              &y0, &y1, &y2, &y3);
+    y1 = ComplexMul(y1, _mm256_loadu_ps(&wk1r_[2 * b]),
+                    _mm256_loadu_ps(&wk1i_[2 * b]));
+    y2 = ComplexMul(y2, _mm256_loadu_ps(&wk2r_[2 * b]),
+                    _mm256_loadu_ps(&wk2i_[2 * b]));
+    y3 = ComplexMul(y3, _mm256_loadu_ps(&wk3r_[2 * b]),
+                    _mm256_loadu_ps(&wk3i_[2 * b]));
+    StoreLanes(_mm256_shuffle_ps(y0, y1, _MM_SHUFFLE(1, 0, 1, 0)), &a[j],
+               &a[j + 16]);
+    StoreLanes(_mm256_shuffle_ps(y2, y3, _MM_SHUFFLE(1, 0, 1, 0)), &a[j + 4],
+               &a[j + 20]);
+    StoreLanes(_mm256_shuffle_ps(y0, y1, _MM_SHUFFLE(3, 2, 3, 2)), &a[j + 8],
+               &a[j + 24]);
+    StoreLanes(_mm256_shuffle_ps(y2, y3, _MM_SHUFFLE(3, 2, 3, 2)), &a[j + 12],
+               &a[j + 28]);
+  }
+  for (; j < n; j += 8, ++b) {
+    Radix4Block_C(2, b, a);
+  }
+
+  // Remaining radix-4 stages.
+  size_t l = 8;
+  for (; (l << 2) < n; l <<= 2) {
+    const size_t m = l << 2;
+    // Block 0, with unit twiddles.
+    for (size_t j = 0; j < l; j += 8) {
+      Butterfly(_mm256_loadu_ps(&a[j]), _mm256_loadu_ps(&a[j + l]),
+                _mm256_loadu_ps(&a[j + 2 * l]), _mm256_loadu_ps(&a[j + 3 * l]),
+                neg_re, &y0, &y1, &y2, &y3);
+      _mm256_storeu_ps(&a[j], y0);
+      _mm256_storeu_ps(&a[j + l], y1);
+      _mm256_storeu_ps(&a[j + 2 * l], y2);
+      _mm256_storeu_ps(&a[j + 3 * l], y3);
+    }
+    // Block 1, where wk1r == wk1i, wk2 = (0, 1) and wk3 = (-wk1r, wk1r).
+    const __m256 wk1r = _mm256_set1_ps(wk1r_[2]);
+    for (size_t j = m; j < l + m; j += 8) {
+      Butterfly(_mm256_loadu_ps(&a[j]), _mm256_loadu_ps(&a[j + l]),
+                _mm256_loadu_ps(&a[j + 2 * l]), _mm256_loadu_ps(&a[j + 3 * l]),
+                neg_re, &y0, &y1, &y2, &y3);
+      y1 = _mm256_mul_ps(wk1r, _mm256_add_ps(DuplicateRe(y1),
+                                             _mm256_xor_ps(DuplicateIm(y1),
+                                                           neg_re)));
+      y2 = _mm256_xor_ps(SwapReIm(y2), neg_re);
+      y3 = _mm256_mul_ps(
+          wk1r, _mm256_add_ps(_mm256_xor_ps(DuplicateIm(y3), neg_all),
+                              _mm256_xor_ps(DuplicateRe(y3), neg_re)));
+      _mm256_storeu_ps(&a[j], y0);
+      _mm256_storeu_ps(&a[j + l], y1);
+      _mm256_storeu_ps(&a[j + 2 * l], y2);
+      _mm256_storeu_ps(&a[j + 3 * l], y3);
+    }
+    // Other blocks.
+    for (size_t k = 2 * m, b = 2; k < n; k += m, ++b) {
+      const __m256 wk1r = LoadPair(&wk1r_[2 * b]);
+      const __m256 wk1i = LoadPair(&wk1i_[2 * b]);
+      const __m256 wk2r = LoadPair(&wk2r_[2 * b]);
+      const __m256 wk2i = LoadPair(&wk2i_[2 * b]);
+      const __m256 wk3r = LoadPair(&wk3r_[2 * b]);
+      const __m256 wk3i = LoadPair(&wk3i_[2 * b]);
+      for (size_t j = k; j < l + k; j += 8) {
+        Butterfly(_mm256_loadu_ps(&a[j]), _mm256_loadu_ps(&a[j + l]),
+                  _mm256_loadu_ps(&a[j + 2 * l]),
+                  _mm256_loadu_ps(&a[j + 3 * l]), neg_re, &y0, &y1, &y2, &y3);
+        _mm256_storeu_ps(&a[j], y0);
+        _mm256_storeu_ps(&a[j + l], ComplexMul(y1, wk1r, wk1i));
+        _mm256_storeu_ps(&a[j + 2 * l], ComplexMul(y2, wk2r, wk2i));
+        _mm256_storeu_ps(&a[j + 3 * l], ComplexMul(y3, wk3r, wk3i));
+      }
+    }
+  }
+
+  // Last stage, without twiddles. The inverse transform conjugates the output.
+  const __m256 conjugate = backward ? neg_im : _mm256_setzero_ps();
+  if ((l << 2) == n) {
+    for (size_t j = 0; j < l; j += 8) {
+      Butterfly(_mm256_loadu_ps(&a[j]), _mm256_loadu_ps(&a[j + l]),
+                _mm256_loadu_ps(&a[j + 2 * l]), _mm256_loadu_ps(&a[j + 3 * l]),
+                neg_re, &y0, &y1, &y2, &y3);
+      _mm256_storeu_ps(&a[j], _mm256_xor_ps(y0, conjugate));
+      _mm256_storeu_ps(&a[j + l], _mm256_xor_ps(y1, conjugate));
+      _mm256_storeu_ps(&a[j + 2 * l], _mm256_xor_ps(y2, conjugate));
+      _mm256_storeu_ps(&a[j + 3 * l], _mm256_xor_ps(y3, conjugate));
+    }
+  } else {
+    for (size_t j = 0; j < l; j += 8) {
+      const __m256 a0 = _mm256_loadu_ps(&a[j]);
+      const __m256 a1 = _mm256_loadu_ps(&a[j + l]);
+      _mm256_storeu_ps(&a[j], _mm256_xor_ps(_mm256_add_ps(a0, a1), conjugate));
+      _mm256_storeu_ps(&a[j + l],
+                       _mm256_xor_ps(_mm256_sub_ps(a0, a1), conjugate));
+    }
+  }
+}
+
+void RealFft::Rftfsub_AVX2(float* a) const {
+  const size_t n = length_;
+  const size_t m = n >> 1;
+  size_t j = 2;
+  size_t kk = 1;
+  // Eight bins per iteration. The bins mirrored around n / 4 are reversed
+  // after loading and before storing.
+  for (; j + 15 < m; j += 16, kk += 8) {
+    const __m256 wkr = _mm256_loadu_ps(&rft_wkr_[kk]);
+    const __m256 wki = _mm256_loadu_ps(&rft_wki_[kk]);
+    __m256 a_j_re, a_j_im, a_k_re, a_k_im;
+    Deinterleave(_mm256_loadu_ps(&a[j]), _mm256_loadu_ps(&a[j + 8]), &a_j_re,
+                 &a_j_im);
+    Deinterleave(_mm256_loadu_ps(&a[n - j - 14]),
+                 _mm256_loadu_ps(&a[n - j - 6]), &a_k_re, &a_k_im);
+    a_k_re = Reverse(a_k_re);
+    a_k_im = Reverse(a_k_im);
+    const __m256 xr = _mm256_sub_ps(a_j_re, a_k_re);
+    const __m256 xi = _mm256_add_ps(a_j_im, a_k_im);
+    const __m256 yr =
+        _mm256_sub_ps(_mm256_mul_ps(wkr, xr), _mm256_mul_ps(wki, xi));
+    const __m256 yi =
+        _mm256_add_ps(_mm256_mul_ps(wkr, xi), _mm256_mul_ps(wki, xr));
+    __m256 x0, x1;
+    Interleave(_mm256_sub_ps(a_j_re, yr), _mm256_sub_ps(a_j_im, yi), &x0, &x1);
+    _mm256_storeu_ps(&a[j], x0);
+    _mm256_storeu_ps(&a[j + 8], x1);
+    Interleave(Reverse(_mm256_add_ps(a_k_re, yr)),
+               Reverse(_mm256_sub_ps(a_k_im, yi)), &x0, &x1);
+    _mm256_storeu_ps(&a[n - j - 14], x0);
+    _mm256_storeu_ps(&a[n - j - 6], x1);
+  }
+  for (; j < m; j += 2, ++kk) {
+    const size_t k = n - j;
+    const float wkr = rft_wkr_[kk];
+    const float wki = rft_wki_[kk];
+    const float xr = a[j] - a[k];
+    const float xi = a[j + 1] + a[k + 1];
+    const float yr = wkr * xr - wki * xi;
+    const float yi = wkr * xi + wki * xr;
+    a[j] -= yr;
+    a[j + 1] -= yi;
+    a[k] += yr;
+    a[k + 1] -= yi;
+  }
+}
+
+void RealFft::Rftbsub_AVX2(float* a) const {
+  const size_t n = length_;
+  const size_t m = n >> 1;
+  a[1] = -a[1];
+  size_t j = 2;
+  size_t kk = 1;
+  for (; j + 15 < m; j += 16, kk += 8) {
+    const __m256 wkr = _mm256_loadu_ps(&rft_wkr_[kk]);
+    const __m256 wki = _mm256_loadu_ps(&rft_wki_[kk]);
+    __m256 a_j_re, a_j_im, a_k_re, a_k_im;
+    Deinterleave(_mm256_loadu_ps(&a[j]), _mm256_loadu_ps(&a[j + 8]), &a_j_re,
+                 &a_j_im);
+    Deinterleave(_mm256_loadu_ps(&a[n - j - 14]),
+                 _mm256_loadu_ps(&a[n - j - 6]), &a_k_re, &a_k_im);
+    a_k_re = Reverse(a_k_re);
+    a_k_im = Reverse(a_k_im);
+    const __m256 xr = _mm256_sub_ps(a_j_re, a_k_re);
+    const __m256 xi = _mm256_add_ps(a_j_im, a_k_im);
+    const __m256 yr =
+        _mm256_add_ps(_mm256_mul_ps(wkr, xr), _mm256_mul_ps(wki, xi));
+    const __m256 yi =
+        _mm256_sub_ps(_mm256_mul_ps(wkr, xi), _mm256_mul_ps(wki, xr));
+    __m256 x0, x1;
+    Interleave(_mm256_sub_ps(a_j_re, yr), _mm256_sub_ps(yi, a_j_im), &x0, &x1);
+    _mm256_storeu_ps(&a[j], x0);
+    _mm256_storeu_ps(&a[j + 8], x1);
+    Interleave(Reverse(_mm256_add_ps(a_k_re, yr)),
+               Reverse(_mm256_sub_ps(yi, a_k_im)), &x0, &x1);
+    _mm256_storeu_ps(&a[n - j - 14], x0);
+    _mm256_storeu_ps(&a[n - j - 6], x1);
+  }
+  for (; j < m; j += 2, ++kk) {
+    const size_t k = n - j;
+    const float wkr = rft_wkr_[kk];
+    const float wki = rft_wki_[kk];
+    const float xr = a[j] - a[k];
+    const float xi = a[j + 1] + a[k + 1];
+    const float yr = wkr * xr + wki * xi;
+    const float yi = wkr * xi - wki * xr;
+    a[j] -= yr;
+    a[j + 1] = yi - a[j + 1];
+    a[k] += yr;
+    a[k + 1] = yi - a[k + 1];
+  }
+  a[m + 1] = -a[m + 1];
+}
+
+}  // namespace webrtc
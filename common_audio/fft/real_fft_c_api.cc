@@ -0,0 +1,37 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_audio/fft/real_fft_c_api.h"
+
+#include "common_audio/fft/real_fft.h"
+#include "rtc_base/checks.h"
+
+struct WebRtcRealFft {
+  explicit WebRtcRealFft(size_t length) : fft(length) {}
+  const webrtc::RealFft fft;
+};
+
+WebRtcRealFft* WebRtc_CreateRealFft(size_t length) {
+  return new WebRtcRealFft(length);
+}
+
+void WebRtc_FreeRealFft(WebRtcRealFft* handle) {
+  delete handle;
+}
+
+void WebRtc_RealFftForward(const WebRtcRealFft* handle, float* data) {
+  RTC_DCHECK(handle);
+  handle->fft.Forward(data);
+}
+
+void WebRtc_RealFftInverse(const WebRtcRealFft* handle, float* data) {
+  RTC_DCHECK(handle);
+  handle->fft.Inverse(data);
+}
@@ -0,0 +1,39 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// C interface of webrtc::RealFft, for the audio processing modules written in
+// C. Refer to real_fft.h for documentation.
+
+#ifndef COMMON_AUDIO_FFT_REAL_FFT_C_API_H_
+#define COMMON_AUDIO_FFT_REAL_FFT_C_API_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct WebRtcRealFft WebRtcRealFft;
+
+// Creates a transform of |length| values, which must be a power of two and at
+// least 2. The SIMD backend is selected at runtime.
+WebRtcRealFft* WebRtc_CreateRealFft(size_t length);
+void WebRtc_FreeRealFft(WebRtcRealFft* handle);
+
+// Computes the forward and inverse transforms in place, with the same layout
+// as WebRtc_rdft().
+void WebRtc_RealFftForward(const WebRtcRealFft* handle, float* data);
+void WebRtc_RealFftInverse(const WebRtcRealFft* handle, float* data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMMON_AUDIO_FFT_REAL_FFT_C_API_H_
@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <arm_neon.h>
+
+#include "common_audio/fft/real_fft.h"
+#include "rtc_base/checks.h"
+
+// NEON version of the butterflies in real_fft_sse2.cc. Multiplications and
+// additions are kept separate (no vmlaq_f32()/vfmaq_f32()) so that the results
+// stay bit exact with the C implementation.
+
+namespace webrtc {
+
+namespace {
+
+inline float32x4_t Xor(float32x4_t x, uint32x4_t mask) {
+  return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(x), mask));
+}
+
+inline float32x4_t SwapReIm(float32x4_t x) {
+  return vrev64q_f32(x);
+}
+
+inline float32x4_t DuplicateRe(float32x4_t x) {
+  return vtrnq_f32(x, x).val[0];
+}
+
+inline float32x4_t DuplicateIm(float32x4_t x) {
+  return vtrnq_f32(x, x).val[1];
+}
+
+inline float32x4_t ComplexMul(float32x4_t x, float32x4_t wr, float32x4_t wi) {
+  return vaddq_f32(vmulq_f32(wr, x), vmulq_f32(wi, SwapReIm(x)));
+}
+
+inline float32x4_t LoadPair(const float* p) {
+  const float32x2_t pair = vld1_f32(p);
+  return vcombine_f32(pair, pair);
+}
+
+// Reverses the order of the four values in |x|.
+inline float32x4_t Reverse(float32x4_t x) {
+  const float32x4_t swapped = vrev64q_f32(x);
+  return vcombine_f32(vget_high_f32(swapped), vget_low_f32(swapped));
+}
+
+inline void Butterfly(float32x4_t a0,
+                      float32x4_t a1,
+                      float32x4_t a2,
+                      float32x4_t a3,
+                      uint32x4_t neg_re,
+                      float32x4_t* y0,
+                      float32x4_t* y1,
+                      float32x4_t* y2,
+                      float32x4_t* y3) {
+  const float32x4_t x0 = vaddq_f32(a0, a1);
+  const float32x4_t x1 = vsubq_f32(a0, a1);
+  const float32x4_t x2 = vaddq_f32(a2, a3);
+  const float32x4_t x3 = vsubq_f32(a2, a3);
+  const float32x4_t i_x3 = Xor(SwapReIm(x3), neg_re);
+  *y0 = vaddq_f32(x0, x2);
+  *y1 = vaddq_f32(x1, i_x3);
+  *y2 = vsubq_f32(x0, x2);
+  *y3 = vsubq_f32(x1, i_x3);
+}
+
+}  // namespace
+
+void RealFft::Cftsub_NEON(bool backward, float* a) const {
+  const size_t n = length_;
+  RTC_DCHECK_GE(n, 16);
+  static const uint32_t kNegRe[4] = {0x80000000u, 0, 0x80000000u, 0};
+  static const uint32_t kNegIm[4] = {0, 0x80000000u, 0, 0x80000000u};
+  const uint32x4_t neg_re = vld1q_u32(kNegRe);
+  const uint32x4_t neg_im = vld1q_u32(kNegIm);
+  const uint32x4_t neg_all = vdupq_n_u32(0x80000000u);
+  float32x4_t y0, y1, y2, y3;
+
+  // First radix-4 stage (l == 2), two blocks per iteration.
+  Radix4Block_C(2, 0, a);
+  Radix4Block_C(2, 1, a);
+  for (size_t j = 16, b = 2; j < n; j += 16, b += 2) {
+    const float32x4_t a00 = vld1q_f32(&a[j]);
+    const float32x4_t a04 = vld1q_f32(&a[j + 4]);
+    const float32x4_t a08 = vld1q_f32(&a[j + 8]);
+    const float32x4_t a12 = vld1q_f32(&a[j + 12]);
+    Butterfly(vcombine_f32(vget_low_f32(a00), vget_low_f32(a08)),
+              vcombine_f32(vget_high_f32(a00), vget_high_f32(a08)),
+              vcombine_f32(vget_low_f32(a04), vget_low_f32(a12)),
+              vcombine_f32(vget_high_f32(a04), vget_high_f32(a12)), neg_re,
+              &y0, &y1, &y2, &y3);
+    y1 = ComplexMul(y1, vld1q_f32(&wk1r_[2 * b]), vld1q_f32(&wk1i_[2 * b]));
+    y2 = ComplexMul(y2, vld1q_f32(&wk2r_[2 * b]), vld1q_f32(&wk2i_[2 * b]));
+    y3 = ComplexMul(y3, vld1q_f32(&wk3r_[2 * b]), vld1q_f32(&wk3i_[2 * b]));
+    vst1q_f32(&a[j], vcombine_f32(vget_low_f32(y0), vget_low_f32(y1)));
+    vst1q_f32(&a[j + 4], vcombine_f32(vget_low_f32(y2), vget_low_f32(y3)));
+    vst1q_f32(&a[j + 8], vcombine_f32(vget_high_f32(y0), vget_high_f32(y1)));
+    vst1q_f32(&a[j + 12], vcombine_f32(vget_high_f32(y2), vget_high_f32(y3)));
+  }
+
+  // Remaining radix-4 stages.
+  size_t l = 8;
+  for (; (l << 2) < n; l <<= 2) {
+    const size_t m = l << 2;
+    // Block 0, with unit twiddles.
+    for (size_t j = 0; j < l; j += 4) {
+      Butterfly(vld1q_f32(&a[j]), vld1q_f32(&a[j + l]),
+                vld1q_f32(&a[j + 2 * l]), vld1q_f32(&a[j + 3 * l]), neg_re,
+                &y0, &y1, &y2, &y3);
+      vst1q_f32(&a[j], y0);
+      vst1q_f32(&a[j + l], y1);
+      vst1q_f32(&a[j + 2 * l], y2);
+      vst1q_f32(&a[j + 3 * l], y3);
+    }
+    // Block 1, where wk1r == wk1i, wk2 = (0, 1) and wk3 = (-wk1r, wk1r).
+    const float32x4_t wk1r = vdupq_n_f32(wk1r_[2]);
+    for (size_t j = m; j < l + m; j += 4) {
+      Butterfly(vld1q_f32(&a[j]), vld1q_f32(&a[j + l]),
+                vld1q_f32(&a[j + 2 * l]), vld1q_f32(&a[j + 3 * l]), neg_re,
+                &y0, &y1, &y2, &y3);
+      y1 = vmulq_f32(wk1r,
+                     vaddq_f32(DuplicateRe(y1), Xor(DuplicateIm(y1), neg_re)));
+      y2 = Xor(SwapReIm(y2), neg_re);
+      y3 = vmulq_f32(wk1r, vaddq_f32(Xor(DuplicateIm(y3), neg_all),
+                                     Xor(DuplicateRe(y3), neg_re)));
+      vst1q_f32(&a[j], y0);
+      vst1q_f32(&a[j + l], y1);
+      vst1q_f32(&a[j + 2 * l], y2);
+      vst1q_f32(&a[j + 3 * l], y3);
+    }
+    // Other blocks.
+    for (size_t k = 2 * m, b = 2; k < n; k += m, ++b) {
+      const float32x4_t wk1r = LoadPair(&wk1r_[2 * b]);
+      const float32x4_t wk1i = LoadPair(&wk1i_[2 * b]);
+      const float32x4_t wk2r = LoadPair(&wk2r_[2 * b]);
+      const float32x4_t wk2i = LoadPair(&wk2i_[2 * b]);
+      const float32x4_t wk3r = LoadPair(&wk3r_[2 * b]);
+      const float32x4_t wk3i = LoadPair(&wk3i_[2 * b]);
+      for (size_t j = k; j < l + k; j += 4) {
+        Butterfly(vld1q_f32(&a[j]), vld1q_f32(&a[j + l]),
+                  vld1q_f32(&a[j + 2 * l]), vld1q_f32(&a[j + 3 * l]), neg_re,
+                  &y0, &y1, &y2, &y3);
+        vst1q_f32(&a[j], y0);
+        vst1q_f32(&a[j + l], ComplexMul(y1, wk1r, wk1i));
+        vst1q_f32(&a[j + 2 * l], ComplexMul(y2, wk2r, wk2i));
+        vst1q_f32(&a[j + 3 * l], ComplexMul(y3, wk3r, wk3i));
+      }
+    }
+  }
+
+  // Last stage, without twiddles. The inverse transform conjugates the output.
+  const uint32x4_t conjugate = backward ? neg_im : vdupq_n_u32(0);
+  if ((l << 2) == n) {
+    for (size_t j = 0; j < l; j += 4) {
+      Butterfly(vld1q_f32(&a[j]), vld1q_f32(&a[j + l]),
+                vld1q_f32(&a[j + 2 * l]), vld1q_f32(&a[j + 3 * l]), neg_re,
+                &y0, &y1, &y2, &y3);
+      vst1q_f32(&a[j], Xor(y0, conjugate));
+      vst1q_f32(&a[j + l], Xor(y1, conjugate));
+      vst1q_f32(&a[j + 2 * l], Xor(y2, conjugate));
+      vst1q_f32(&a[j + 3 * l], Xor(y3, conjugate));
+    }
+  } else {
+    for (size_t j = 0; j < l; j += 4) {
+      const float32x4_t a0 = vld1q_f32(&a[j]);
+      const float32x4_t a1 = vld1q_f32(&a[j + l]);
+      vst1q_f32(&a[j], Xor(vaddq_f32(a0, a1), conjugate));
+      vst1q_f32(&a[j + l], Xor(vsubq_f32(a0, a1), conjugate));
+    }
+  }
+}
+
+void RealFft::Rftfsub_NEON(float* a) const {
+  const size_t n = length_;
+  const size_t m = n >> 1;
+  size_t j = 2;
+  size_t kk = 1;
+  // Four bins per iteration. The bins mirrored around n / 4 are reversed after
+  // loading and before storing.
+  for (; j + 7 < m; j += 8, kk += 4) {
+    const float32x4_t wkr = vld1q_f32(&rft_wkr_[kk]);
+    const float32x4_t wki = vld1q_f32(&rft_wki_[kk]);
+    float32x4x2_t a_j = vld2q_f32(&a[j]);
+    float32x4x2_t a_k = vld2q_f32(&a[n - j - 6]);
+    const float32x4_t a_k_re = Reverse(a_k.val[0]);
+    const float32x4_t a_k_im = Reverse(a_k.val[1]);
+    const float32x4_t xr = vsubq_f32(a_j.val[0], a_k_re);
+    const float32x4_t xi = vaddq_f32(a_j.val[1], a_k_im);
+    const float32x4_t yr = vsubq_f32(vmulq_f32(wkr, xr), vmulq_f32(wki, xi));
+    const float32x4_t yi = vaddq_f32(vmulq_f32(wkr, xi), vmulq_f32(wki, xr));
+    a_j.val[0] = vsubq_f32(a_j.val[0], yr);
+    a_j.val[1] = vsubq_f32(a_j.val[1], yi);
+    a_k.val[0] = Reverse(vaddq_f32(a_k_re, yr));
+    a_k.val[1] = Reverse(vsubq_f32(a_k_im, yi));
+    vst2q_f32(&a[j], a_j);
+    vst2q_f32(&a[n - j - 6], a_k);
+  }
+  for (; j < m; j += 2, ++kk) {
+    const size_t k = n - j;
+    const float wkr = rft_wkr_[kk];
+    const float wki = rft_wki_[kk];
+    const float xr = a[j] - a[k];
+    const float xi = a[j + 1] + a[k + 1];
+    const float yr = wkr * xr - wki * xi;
+    const float yi = wkr * xi + wki * xr;
+    a[j] -= yr;
+    a[j + 1] -= yi;
+    a[k] += yr;
+    a[k + 1] -= yi;
+  }
+}
+
+void RealFft::Rftbsub_NEON(float* a) const {
+  const size_t n = length_;
+  const size_t m = n >> 1;
+  a[1] = -a[1];
+  size_t j = 2;
+  size_t kk = 1;
+  for (; j + 7 < m; j += 8, kk += 4) {
+    const float32x4_t wkr = vld1q_f32(&rft_wkr_[kk]);
+    const float32x4_t wki = vld1q_f32(&rft_wki_[kk]);
+    float32x4x2_t a_j = vld2q_f32(&a[j]);
+    float32x4x2_t a_k = vld2q_f32(&a[n - j - 6]);
+    const float32x4_t a_k_re = Reverse(a_k.val[0]);
+    const float32x4_t a_k_im = Reverse(a_k.val[1]);
+    const float32x4_t xr = vsubq_f32(a_j.val[0], a_k_re);
+    const float32x4_t xi = vaddq_f32(a_j.val[1], a_k_im);
+    const float32x4_t yr = vaddq_f32(vmulq_f32(wkr, xr), vmulq_f32(wki, xi));
+    const float32x4_t yi = vsubq_f32(vmulq_f32(wkr, xi), vmulq_f32(wki, xr));
+    a_j.val[0] = vsubq_f32(a_j.val[0], yr);
+    a_j.val[1] = vsubq_f32(yi, a_j.val[1]);
+    a_k.val[0] = Reverse(vaddq_f32(a_k_re, yr));
+    a_k.val[1] = Reverse(vsubq_f32(yi, a_k_im));
+    vst2q_f32(&a[j], a_j);
+    vst2q_f32(&a[n - j - 6], a_k);
+  }
+  for (; j < m; j += 2, ++kk) {
+    const size_t k = n - j;
+    const float wkr = rft_wkr_[kk];
+    const float wki = rft_wki_[kk];
+    const float xr = a[j] - a[k];
+    const float xi = a[j + 1] + a[k + 1];
+    const float yr = wkr * xr + wki * xi;
+    const float yi = wkr * xi - wki * xr;
+    a[j] -= yr;
+    a[j + 1] = yi - a[j + 1];
+    a[k] += yr;
+    a[k + 1] = yi - a[k + 1];
+  }
+  a[m + 1] = -a[m + 1];
+}
+
+}  // namespace webrtc
@@ -0,0 +1,284 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+#include "common_audio/fft/real_fft.h"
+#include "rtc_base/checks.h"
+
+// The butterflies below perform the same floating point operations as the C
+// implementation in real_fft.cc, hence the results are bit exact. Each vector
+// holds two interleaved complex values.
+
+namespace webrtc {
+
+namespace {
+
+// (r0, i0, r1, i1) -> (i0, r0, i1, r1).
+inline __m128 SwapReIm(__m128 x) {
+  return _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+// (r0, i0, r1, i1) -> (r0, r0, r1, r1).
+inline __m128 DuplicateRe(__m128 x) {
+  return _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0));
+}
+
+// (r0, i0, r1, i1) -> (i0, i0, i1, i1).
+inline __m128 DuplicateIm(__m128 x) {
+  return _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1));
+}
+
+// (r0, i0, r1, i1) -> (r1, i1, r0, i0).
+inline __m128 SwapComplex(__m128 x) {
+  return _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+// Computes |w| * |x|, where the twiddle factor |w| is given as (wr, wr) and
+// (-wi, wi) pairs.
+inline __m128 ComplexMul(__m128 x, __m128 wr, __m128 wi) {
+  return _mm_add_ps(_mm_mul_ps(wr, x), _mm_mul_ps(wi, SwapReIm(x)));
+}
+
+// Broadcasts the pair of floats at |p|.
+inline __m128 LoadPair(const float* p) {
+  return _mm_castpd_ps(_mm_load1_pd(reinterpret_cast<const double*>(p)));
+}
+
+// Radix-4 butterflies without twiddles: computes x0 + x2, x1 + i * x3,
+// x0 - x2 and x1 - i * x3, where x0 = a0 + a1, x1 = a0 - a1, x2 = a2 + a3 and
+// x3 = a2 - a3.
+inline void Butterfly(__m128 a0,
+                      __m128 a1,
+                      __m128 a2,
+                      __m128 a3,
+                      __m128 neg_re,
+                      __m128* y0,
+                      __m128* y1,
+                      __m128* y2,
+                      __m128* y3) {
+  const __m128 x0 = _mm_add_ps(a0, a1);
+  const __m128 x1 = _mm_sub_ps(a0, a1);
+  const __m128 x2 = _mm_add_ps(a2, a3);
+  const __m128 x3 = _mm_sub_ps(a2, a3);
+  const __m128 i_x3 = _mm_xor_ps(SwapReIm(x3), neg_re);
+  *y0 = _mm_add_ps(x0, x2);
+  *y1 = _mm_add_ps(x1, i_x3);
+  *y2 = _mm_sub_ps(x0, x2);
+  *y3 = _mm_sub_ps(x1, i_x3);
+}
+
+}  // namespace
+
+void RealFft::Cftsub_SSE2(bool backward, float* a) const {
+  const size_t n = length_;
+  RTC_DCHECK_GE(n, 16);
+  const __m128 neg_re = _mm_set_ps(0.f, -0.f, 0.f, -0.f);
+  const __m128 neg_im = _mm_set_ps(-0.f, 0.f, -0.f, 0.f);
+  const __m128 neg_all = _mm_set1_ps(-0.f);
+  __m128 y0, y1, y2, y3;
+
+  // First radix-4 stage (l == 2). The vectors hold one complex value from each
+  // of two consecutive blocks, so that the blocks can have different
+  // twiddles. The first two blocks use special butterflies.
+  Radix4Block_C(2, 0, a);
+  Radix4Block_C(2, 1, a);
+  for (size_t j = 16, b = 2; j < n; j += 16, b += 2) {
+    const __m128 a00 = _mm_loadu_ps(&a[j]);
+    const __m128 a04 = _mm_loadu_ps(&a[j + 4]);
+    const __m128 a08 = _mm_loadu_ps(&a[j + 8]);
+    const __m128 a12 = _mm_loadu_ps(&a[j + 12]);
+    Butterfly(_mm_shuffle_ps(a00, a08, _MM_SHUFFLE(1, 0, 1, 0)),
+              _mm_shuffle_ps(a00, a08, _MM_SHUFFLE(3, 2, 3, 2)),
+              _mm_shuffle_ps(a04, a12, _MM_SHUFFLE(1, 0, 1, 0)),
+              _mm_shuffle_ps(a04, a12, _MM_SHUFFLE(3, 2, 3, 2)), neg_re, &y0,
+              &y1, &y2, &y3);
+    y1 = ComplexMul(y1, _mm_loadu_ps(&wk1r_[2 * b]),
+                    _mm_loadu_ps(&wk1i_[2 * b]));
+    y2 = ComplexMul(y2, _mm_loadu_ps(&wk2r_[2 * b]),
+                    _mm_loadu_ps(&wk2i_[2 * b]));
+    y3 = ComplexMul(y3, _mm_loadu_ps(&wk3r_[2 * b]),
+                    _mm_loadu_ps(&wk3i_[2 * b]));
+    _mm_storeu_ps(&a[j], _mm_shuffle_ps(y0, y1, _MM_SHUFFLE(1, 0, 1, 0)));
+    _mm_storeu_ps(&a[j + 4], _mm_shuffle_ps(y2, y3, _MM_SHUFFLE(1, 0, 1, 0)));
+    _mm_storeu_ps(&a[j + 8], _mm_shuffle_ps(y0, y1, _MM_SHUFFLE(3, 2, 3, 2)));
+    _mm_storeu_ps(&a[j + 12], _mm_shuffle_ps(y2, y3, _MM_SHUFFLE(3, 2, 3, 2)));
+  }
+
+  // Remaining radix-4 stages.
+  size_t l = 8;
+  for (; (l << 2) < n; l <<= 2) {
+    const size_t m = l << 2;
+    // Block 0, with unit twiddles.
+    for (size_t j = 0; j < l; j += 4) {
+      Butterfly(_mm_loadu_ps(&a[j]), _mm_loadu_ps(&a[j + l]),
+                _mm_loadu_ps(&a[j + 2 * l]), _mm_loadu_ps(&a[j + 3 * l]),
+                neg_re, &y0, &y1, &y2, &y3);
+      _mm_storeu_ps(&a[j], y0);
+      _mm_storeu_ps(&a[j + l], y1);
+      _mm_storeu_ps(&a[j + 2 * l], y2);
+      _mm_storeu_ps(&a[j + 3 * l], y3);
+    }
+    // Block 1, where wk1r == wk1i, wk2 = (0, 1) and wk3 = (-wk1r, wk1r).
+    const __m128 wk1r = _mm_set1_ps(wk1r_[2]);
+    for (size_t j = m; j < l + m; j += 4) {
+      Butterfly(_mm_loadu_ps(&a[j]), _mm_loadu_ps(&a[j + l]),
+                _mm_loadu_ps(&a[j + 2 * l]), _mm_loadu_ps(&a[j + 3 * l]),
+                neg_re, &y0, &y1, &y2, &y3);
+      y1 = _mm_mul_ps(wk1r, _mm_add_ps(DuplicateRe(y1),
+                                       _mm_xor_ps(DuplicateIm(y1), neg_re)));
+      y2 = _mm_xor_ps(SwapReIm(y2), neg_re);
+      y3 = _mm_mul_ps(wk1r, _mm_add_ps(_mm_xor_ps(DuplicateIm(y3), neg_all),
+                                       _mm_xor_ps(DuplicateRe(y3), neg_re)));
+      _mm_storeu_ps(&a[j], y0);
+      _mm_storeu_ps(&a[j + l], y1);
+      _mm_storeu_ps(&a[j + 2 * l], y2);
+      _mm_storeu_ps(&a[j + 3 * l], y3);
+    }
+    // Other blocks.
+    for (size_t k = 2 * m, b = 2; k < n; k += m, ++b) {
+      const __m128 wk1r = LoadPair(&wk1r_[2 * b]);
+      const __m128 wk1i = LoadPair(&wk1i_[2 * b]);
+      const __m128 wk2r = LoadPair(&wk2r_[2 * b]);
+      const __m128 wk2i = LoadPair(&wk2i_[2 * b]);
+      const __m128 wk3r = LoadPair(&wk3r_[2 * b]);
+      const __m128 wk3i = LoadPair(&wk3i_[2 * b]);
+      for (size_t j = k; j < l + k; j += 4) {
+        Butterfly(_mm_loadu_ps(&a[j]), _mm_loadu_ps(&a[j + l]),
+                  _mm_loadu_ps(&a[j + 2 * l]), _mm_loadu_ps(&a[j + 3 * l]),
+                  neg_re, &y0, &y1, &y2, &y3);
+        _mm_storeu_ps(&a[j], y0);
+        _mm_storeu_ps(&a[j + l], ComplexMul(y1, wk1r, wk1i));
+        _mm_storeu_ps(&a[j + 2 * l], ComplexMul(y2, wk2r, wk2i));
+        _mm_storeu_ps(&a[j + 3 * l], ComplexMul(y3, wk3r, wk3i));
+      }
+    }
+  }
+
+  // Last stage, without twiddles. The inverse transform conjugates the output.
+  const __m128 conjugate = backward ? neg_im : _mm_setzero_ps();
+  if ((l << 2) == n) {
+    for (size_t j = 0; j < l; j += 4) {
+      Butterfly(_mm_loadu_ps(&a[j]), _mm_loadu_ps(&a[j + l]),
+                _mm_loadu_ps(&a[j + 2 * l]), _mm_loadu_ps(&a[j + 3 * l]),
+                neg_re, &y0, &y1, &y2, &y3);
+      _mm_storeu_ps(&a[j], _mm_xor_ps(y0, conjugate));
+      _mm_storeu_ps(&a[j + l], _mm_xor_ps(y1, conjugate));
+      _mm_storeu_ps(&a[j + 2 * l], _mm_xor_ps(y2, conjugate));
+      _mm_storeu_ps(&a[j + 3 * l], _mm_xor_ps(y3, conjugate));
+    }
+  } else {
+    for (size_t j = 0; j < l; j += 4) {
+      const __m128 a0 = _mm_loadu_ps(&a[j]);
+      const __m128 a1 = _mm_loadu_ps(&a[j + l]);
+      _mm_storeu_ps(&a[j], _mm_xor_ps(_mm_add_ps(a0, a1), conjugate));
+      _mm_storeu_ps(&a[j + l], _mm_xor_ps(_mm_sub_ps(a0, a1), conjugate));
+    }
+  }
+}
+
+void RealFft::Rftfsub_SSE2(float* a) const {
+  const size_t n = length_;
+  const size_t m = n >> 1;
+  size_t j = 2;
+  size_t kk = 1;
+  // Four bins per iteration. Note that the bins mirrored around n / 4 are
+  // loaded in reverse order.
+  for (; j + 7 < m; j += 8, kk += 4) {
+    const __m128 wkr = _mm_loadu_ps(&rft_wkr_[kk]);
+    const __m128 wki = _mm_loadu_ps(&rft_wki_[kk]);
+    const __m128 a_j_0 = _mm_loadu_ps(&a[j]);
+    const __m128 a_j_4 = _mm_loadu_ps(&a[j + 4]);
+    const __m128 a_k_0 = _mm_loadu_ps(&a[n - j - 6]);
+    const __m128 a_k_4 = _mm_loadu_ps(&a[n - j - 2]);
+    const __m128 a_j_re = _mm_shuffle_ps(a_j_0, a_j_4, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 a_j_im = _mm_shuffle_ps(a_j_0, a_j_4, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 a_k_re = _mm_shuffle_ps(a_k_4, a_k_0, _MM_SHUFFLE(0, 2, 0, 2));
+    const __m128 a_k_im = _mm_shuffle_ps(a_k_4, a_k_0, _MM_SHUFFLE(1, 3, 1, 3));
+    const __m128 xr = _mm_sub_ps(a_j_re, a_k_re);
+    const __m128 xi = _mm_add_ps(a_j_im, a_k_im);
+    const __m128 yr = _mm_sub_ps(_mm_mul_ps(wkr, xr), _mm_mul_ps(wki, xi));
+    const __m128 yi = _mm_add_ps(_mm_mul_ps(wkr, xi), _mm_mul_ps(wki, xr));
+    const __m128 a_j_re_new = _mm_sub_ps(a_j_re, yr);
+    const __m128 a_j_im_new = _mm_sub_ps(a_j_im, yi);
+    const __m128 a_k_re_new = _mm_add_ps(a_k_re, yr);
+    const __m128 a_k_im_new = _mm_sub_ps(a_k_im, yi);
+    _mm_storeu_ps(&a[j], _mm_unpacklo_ps(a_j_re_new, a_j_im_new));
+    _mm_storeu_ps(&a[j + 4], _mm_unpackhi_ps(a_j_re_new, a_j_im_new));
+    const __m128 a_k_0_new = _mm_unpackhi_ps(a_k_re_new, a_k_im_new);
+    const __m128 a_k_4_new = _mm_unpacklo_ps(a_k_re_new, a_k_im_new);
+    _mm_storeu_ps(&a[n - j - 6], SwapComplex(a_k_0_new));
+    _mm_storeu_ps(&a[n - j - 2], SwapComplex(a_k_4_new));
+  }
+  for (; j < m; j += 2, ++kk) {
+    const size_t k = n - j;
+    const float wkr = rft_wkr_[kk];
+    const float wki = rft_wki_[kk];
+    const float xr = a[j] - a[k];
+    const float xi = a[j + 1] + a[k + 1];
+    const float yr = wkr * xr - wki * xi;
+    const float yi = wkr * xi + wki * xr;
+    a[j] -= yr;
+    a[j + 1] -= yi;
+    a[k] += yr;
+    a[k + 1] -= yi;
+  }
+}
+
+void RealFft::Rftbsub_SSE2(float* a) const {
+  const size_t n = length_;
+  const size_t m = n >> 1;
+  a[1] = -a[1];
+  size_t j = 2;
+  size_t kk = 1;
+  for (; j + 7 < m; j += 8, kk += 4) {
+    const __m128 wkr = _mm_loadu_ps(&rft_wkr_[kk]);
+    const __m128 wki = _mm_loadu_ps(&rft_wki_[kk]);
+    const __m128 a_j_0 = _mm_loadu_ps(&a[j]);
+    const __m128 a_j_4 = _mm_loadu_ps(&a[j + 4]);
+    const __m128 a_k_0 = _mm_loadu_ps(&a[n - j - 6]);
+    const __m128 a_k_4 = _mm_loadu_ps(&a[n - j - 2]);
+    const __m128 a_j_re = _mm_shuffle_ps(a_j_0, a_j_4, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 a_j_im = _mm_shuffle_ps(a_j_0, a_j_4, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 a_k_re = _mm_shuffle_ps(a_k_4, a_k_0, _MM_SHUFFLE(0, 2, 0, 2));
+    const __m128 a_k_im = _mm_shuffle_ps(a_k_4, a_k_0, _MM_SHUFFLE(1, 3, 1, 3));
+    const __m128 xr = _mm_sub_ps(a_j_re, a_k_re);
+    const __m128 xi = _mm_add_ps(a_j_im, a_k_im);
+    const __m128 yr = _mm_add_ps(_mm_mul_ps(wkr, xr), _mm_mul_ps(wki, xi));
+    const __m128 yi = _mm_sub_ps(_mm_mul_ps(wkr, xi), _mm_mul_ps(wki, xr));
+    const __m128 a_j_re_new = _mm_sub_ps(a_j_re, yr);
+    const __m128 a_j_im_new = _mm_sub_ps(yi, a_j_im);
+    const __m128 a_k_re_new = _mm_add_ps(a_k_re, yr);
+    const __m128 a_k_im_new = _mm_sub_ps(yi, a_k_im);
+    _mm_storeu_ps(&a[j], _mm_unpacklo_ps(a_j_re_new, a_j_im_new));
+    _mm_storeu_ps(&a[j + 4], _mm_unpackhi_ps(a_j_re_new, a_j_im_new));
+    const __m128 a_k_0_new = _mm_unpackhi_ps(a_k_re_new, a_k_im_new);
+    const __m128 a_k_4_new = _mm_unpacklo_ps(a_k_re_new, a_k_im_new);
+    _mm_storeu_ps(&a[n - j - 6], SwapComplex(a_k_0_new));
+    _mm_storeu_ps(&a[n - j - 2], SwapComplex(a_k_4_new));
+  }
+  for (; j < m; j += 2, ++kk) {
+    const size_t k = n - j;
+    const float wkr = rft_wkr_[kk];
+    const float wki = rft_wki_[kk];
+    const float xr = a[j] - a[k];
+    const float xi = a[j + 1] + a[k + 1];
+    const float yr = wkr * xr + wki * xi;
+    const float yi = wkr * xi - wki * xr;
+    a[j] -= yr;
+    a[j + 1] = yi - a[j + 1];
+    a[k] += yr;
+    a[k + 1] = yi - a[k + 1];
+  }
+  a[m + 1] = -a[m + 1];
+}
+
+}  // namespace webrtc
@@ -0,0 +1,197 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_audio/fft/real_fft.h"
+
+#include <math.h>
+
+#include <random>
+#include <vector>
+
+#include "common_audio/third_party/fft4g/fft4g.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kMaxLength = 4096;
+
+std::vector<RealFft::Backend> AvailableBackends() {
+  std::vector<RealFft::Backend> backends;
+  for (RealFft::Backend backend :
+       {RealFft::Backend::kC, RealFft::Backend::kSse2,
+        RealFft::Backend::kAvx2, RealFft::Backend::kNeon}) {
+    if (RealFft::IsBackendAvailable(backend)) {
+      backends.push_back(backend);
+    }
+  }
+  return backends;
+}
+
+std::vector<float> RandomSignal(size_t length, std::mt19937* generator) {
+  std::uniform_real_distribution<float> distribution(-32768.f, 32767.f);
+  std::vector<float> x(length);
+  for (float& sample : x) {
+    sample = distribution(*generator);
+  }
+  return x;
+}
+
+// Reference implementation.
+class Fft4g {
+ public:
+  explicit Fft4g(size_t length)
+      : length_(length), ip_(2 + length, 0), w_(length / 2, 0.f) {}
+
+  void Forward(float* a) { WebRtc_rdft(length_, 1, a, ip_.data(), w_.data()); }
+  void Inverse(float* a) { WebRtc_rdft(length_, -1, a, ip_.data(), w_.data()); }
+
+ private:
+  const size_t length_;
+  std::vector<size_t> ip_;
+  std::vector<float> w_;
+};
+
+}  // namespace
+
+TEST(RealFftTest, DetectedBackendIsAvailable) {
+  EXPECT_TRUE(RealFft::IsBackendAvailable(RealFft::DetectBackend()));
+  EXPECT_TRUE(RealFft::IsBackendAvailable(RealFft::Backend::kC));
+}
+
+TEST(RealFftTest, ShortLengthsUseC) {
+  for (size_t length = 2; length < 16; length <<= 1) {
+    RealFft fft(length, RealFft::DetectBackend());
+    EXPECT_EQ(RealFft::Backend::kC, fft.backend());
+  }
+}
+
+TEST(RealFftTest, TwiddleTables) {
+  RealFft fft(64, RealFft::Backend::kC);
+  const float kCos45 = static_cast<float>(cos(atan(1.0)));
+  EXPECT_NEAR(kCos45, fft.wk1r_[2], 1e-7f);
+  for (size_t b = 0; b < fft.wk1r_.size() / 2; ++b) {
+    EXPECT_EQ(fft.wk1r_[2 * b], fft.wk1r_[2 * b + 1]);
+    EXPECT_EQ(fft.wk1i_[2 * b], -fft.wk1i_[2 * b + 1]);
+    EXPECT_EQ(fft.wk2r_[2 * b], fft.wk2r_[2 * b + 1]);
+    EXPECT_EQ(fft.wk2i_[2 * b], -fft.wk2i_[2 * b + 1]);
+    EXPECT_EQ(fft.wk3r_[2 * b], fft.wk3r_[2 * b + 1]);
+    EXPECT_EQ(fft.wk3i_[2 * b], -fft.wk3i_[2 * b + 1]);
+    // The twiddles are on the unit circle.
+    EXPECT_NEAR(1.f,
+                fft.wk1r_[2 * b] * fft.wk1r_[2 * b] +
+                    fft.wk1i_[2 * b] * fft.wk1i_[2 * b],
+                1e-6f);
+    EXPECT_NEAR(1.f,
+                fft.wk2r_[2 * b] * fft.wk2r_[2 * b] +
+                    fft.wk2i_[2 * b] * fft.wk2i_[2 * b],
+                1e-6f);
+  }
+}
+
+// All the backends must be bit exact with WebRtc_rdft().
+TEST(RealFftTest, BitExactWithFft4g) {
+  std::mt19937 generator(42);
+  for (RealFft::Backend backend : AvailableBackends()) {
+    for (size_t length = 2; length <= kMaxLength; length <<= 1) {
+      SCOPED_TRACE(static_cast<int>(backend));
+      SCOPED_TRACE(length);
+      RealFft fft(length, backend);
+      Fft4g reference(length);
+      const std::vector<float> x = RandomSignal(length, &generator);
+
+      std::vector<float> expected = x;
+      std::vector<float> actual = x;
+      reference.Forward(expected.data());
+      fft.Forward(actual.data());
+      ASSERT_EQ(expected, actual);
+
+      reference.Inverse(expected.data());
+      fft.Inverse(actual.data());
+      ASSERT_EQ(expected, actual);
+    }
+  }
+}
+
+TEST(RealFftTest, InverseOfForwardIsScaledIdentity) {
+  std::mt19937 generator(42);
+  for (RealFft::Backend backend : AvailableBackends()) {
+    for (size_t length = 2; length <= kMaxLength; length <<= 1) {
+      SCOPED_TRACE(static_cast<int>(backend));
+      SCOPED_TRACE(length);
+      RealFft fft(length, backend);
+      const std::vector<float> x = RandomSignal(length, &generator);
+      std::vector<float> y = x;
+      fft.Forward(y.data());
+      fft.Inverse(y.data());
+      const float scale = 2.f / length;
+      for (size_t i = 0; i < length; ++i) {
+        EXPECT_NEAR(x[i], scale * y[i], 1e-6f * 32768.f);
+      }
+    }
+  }
+}
+
+TEST(RealFftTest, ForwardOfImpulse) {
+  for (RealFft::Backend backend : AvailableBackends()) {
+    RealFft fft(128, backend);
+    std::vector<float> x(128, 0.f);
+    x[0] = 1.f;
+    fft.Forward(x.data());
+    EXPECT_EQ(1.f, x[0]);
+    EXPECT_EQ(1.f, x[1]);
+    for (size_t k = 1; k < 64; ++k) {
+      EXPECT_NEAR(1.f, x[2 * k], 1e-6f);
+      EXPECT_NEAR(0.f, x[2 * k + 1], 1e-6f);
+    }
+  }
+}
+
+// Compares the speed of the backends with WebRtc_rdft(), which computes the
+// twiddle factors on the first call and the bit reversal offsets every call.
+TEST(RealFftTest, DISABLED_Benchmark) {
+  constexpr int kNumIterations = 100000;
+  std::mt19937 generator(42);
+  for (size_t length : {128, 256, 512}) {
+    const std::vector<float> x = RandomSignal(length, &generator);
+    std::vector<float> y = x;
+
+    Fft4g reference(length);
+    int64_t start = rtc::TimeNanos();
+    for (int i = 0; i < kNumIterations; ++i) {
+      reference.Forward(y.data());
+      reference.Inverse(y.data());
+      y = x;
+    }
+    const int64_t reference_ns = rtc::TimeNanos() - start;
+    printf("Length %zu, fft4g: %.1f ns per forward and inverse pair\n", length,
+           static_cast<double>(reference_ns) / kNumIterations);
+
+    for (RealFft::Backend backend : AvailableBackends()) {
+      RealFft fft(length, backend);
+      start = rtc::TimeNanos();
+      for (int i = 0; i < kNumIterations; ++i) {
+        fft.Forward(y.data());
+        fft.Inverse(y.data());
+        y = x;
+      }
+      const int64_t elapsed_ns = rtc::TimeNanos() - start;
+      printf(
+          "Length %zu, backend %d: %.1f ns per forward and inverse pair "
+          "(%.2fx)\n",
+          length, static_cast<int>(backend),
+          static_cast<double>(elapsed_ns) / kNumIterations,
+          static_cast<double>(reference_ns) / elapsed_ns);
+    }
+  }
+}
+
+}  // namespace webrtc
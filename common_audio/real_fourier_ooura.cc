@@ -11,9 +11,7 @@
 #include "common_audio/real_fourier_ooura.h"
 
 #include <algorithm>
-#include <cmath>
 
-#include "common_audio/third_party/fft4g/fft4g.h"
 #include "rtc_base/checks.h"
 
 namespace webrtc {
@@ -27,21 +25,13 @@ void Conjugate(complex<float>* array, size_t complex_length) {
                 [=](complex<float>& v) { v = std::conj(v); });
 }
 
-size_t ComputeWorkIpSize(size_t fft_length) {
-  return static_cast<size_t>(
-      2 + std::ceil(std::sqrt(static_cast<float>(fft_length))));
-}
-
 }  // namespace
 
 RealFourierOoura::RealFourierOoura(int fft_order)
     : order_(fft_order),
       length_(FftLength(order_)),
       complex_length_(ComplexLength(order_)),
-      // Zero-initializing work_ip_ will cause rdft to initialize these work
-      // arrays on the first call.
-      work_ip_(new size_t[ComputeWorkIpSize(length_)]()),
-      work_w_(new float[complex_length_]()) {
+      fft_(length_) {
   RTC_CHECK_GE(fft_order, 1);
 }
 
@@ -53,7 +43,7 @@ void RealFourierOoura::Forward(const float* src, complex<float>* dest) const {
     // http://en.cppreference.com/w/cpp/numeric/complex
     auto* dest_float = reinterpret_cast<float*>(dest);
     std::copy(src, src + length_, dest_float);
-    WebRtc_rdft(length_, 1, dest_float, work_ip_.get(), work_w_.get());
+    fft_.Forward(dest_float);
   }
 
   // Ooura places real[n/2] in imag[0].
@@ -77,7 +67,7 @@ void RealFourierOoura::Inverse(const complex<float>* src, float* dest) const {
         complex<float>(dest_complex[0].real(), src[complex_length_ - 1].real());
   }
 
-  WebRtc_rdft(length_, -1, dest, work_ip_.get(), work_w_.get());
+  fft_.Inverse(dest);
 
   // Ooura returns a scaled version.
   const float scale = 2.0f / length_;
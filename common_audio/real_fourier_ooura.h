@@ -13,8 +13,8 @@
 
 #include <stddef.h>
 #include <complex>
-#include <memory>
 
+#include "common_audio/fft/real_fft.h"
 #include "common_audio/real_fourier.h"
 
 namespace webrtc {
@@ -33,10 +33,7 @@ class RealFourierOoura : public RealFourier {
   const int order_;
   const size_t length_;
   const size_t complex_length_;
-  // These are work arrays for Ooura. The names are based on the comments in
-  // fft4g.c.
-  const std::unique_ptr<size_t[]> work_ip_;
-  const std::unique_ptr<float[]> work_w_;
+  const RealFft fft_;
 };
 
 }  // namespace webrtc
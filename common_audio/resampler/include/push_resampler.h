@@ -18,8 +18,9 @@ namespace webrtc {
 
 class PushSincResampler;
 
-// Wraps PushSincResampler to provide stereo support.
-// TODO(ajm): add support for an arbitrary number of channels.
+// Wraps PushSincResampler to provide support for interleaved audio with an
+// arbitrary number of channels. All the channels are resampled in a single
+// pass (see PushSincResampler::ResampleMultiChannel()).
 template <typename T>
 class PushResampler {
  public:
@@ -43,11 +44,15 @@ class PushResampler {
 
   struct ChannelResampler {
     std::unique_ptr<PushSincResampler> resampler;
-    std::vector<T> source;
-    std::vector<T> destination;
+    std::vector<float> source;
+    std::vector<float> destination;
   };
 
   std::vector<ChannelResampler> channel_resamplers_;
+  // Pointers into |channel_resamplers_| for multi-channel resampling.
+  std::vector<PushSincResampler*> resamplers_;
+  std::vector<float*> source_pointers_;
+  std::vector<float*> destination_pointers_;
 };
 }  // namespace webrtc
 
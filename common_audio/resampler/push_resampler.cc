@@ -13,7 +13,6 @@
 #include <stdint.h>
 #include <string.h>
 
-#include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
 #include "common_audio/include/audio_util.h"
 #include "common_audio/resampler/push_sinc_resampler.h"
@@ -55,6 +54,15 @@ void CheckExpectedBufferSizes(size_t src_length,
   RTC_DCHECK_GE(dst_capacity, dst_size_10ms);
 #endif
 }
+
+void StoreSample(float value, float* destination) {
+  *destination = value;
+}
+
+void StoreSample(float value, int16_t* destination) {
+  *destination = FloatS16ToS16(value);
+}
+
 }  // namespace
 
 template <typename T>
@@ -90,6 +98,9 @@ int PushResampler<T>::InitializeIfNeeded(int src_sample_rate_hz,
   const size_t dst_size_10ms_mono =
       static_cast<size_t>(dst_sample_rate_hz / 100);
   channel_resamplers_.clear();
+  resamplers_.clear();
+  source_pointers_.clear();
+  destination_pointers_.clear();
   for (size_t i = 0; i < num_channels; ++i) {
     channel_resamplers_.push_back(ChannelResampler());
     auto channel_resampler = channel_resamplers_.rbegin();
@@ -98,6 +109,11 @@ int PushResampler<T>::InitializeIfNeeded(int src_sample_rate_hz,
     channel_resampler->source.resize(src_size_10ms_mono);
     channel_resampler->destination.resize(dst_size_10ms_mono);
   }
+  for (auto& channel_resampler : channel_resamplers_) {
+    resamplers_.push_back(channel_resampler.resampler.get());
+    source_pointers_.push_back(channel_resampler.source.data());
+    destination_pointers_.push_back(channel_resampler.destination.data());
+  }
 
   return 0;
 }
@@ -120,27 +136,25 @@ int PushResampler<T>::Resample(const T* src,
   const size_t src_length_mono = src_length / num_channels_;
   const size_t dst_capacity_mono = dst_capacity / num_channels_;
 
-  absl::InlinedVector<T*, 8> source_pointers;
-  for (auto& resampler : channel_resamplers_) {
-    source_pointers.push_back(resampler.source.data());
+  // Deinterleave and convert to float.
+  for (size_t ch = 0; ch < num_channels_; ++ch) {
+    float* const source = source_pointers_[ch];
+    for (size_t i = 0, j = ch; i < src_length_mono; ++i, j += num_channels_) {
+      source[i] = static_cast<float>(src[j]);
+    }
   }
 
-  Deinterleave(src, src_length_mono, num_channels_, source_pointers.data());
-
-  size_t dst_length_mono = 0;
+  const size_t dst_length_mono = PushSincResampler::ResampleMultiChannel(
+      resamplers_, source_pointers_.data(), src_length_mono,
+      destination_pointers_.data(), dst_capacity_mono);
 
-  for (auto& resampler : channel_resamplers_) {
-    dst_length_mono = resampler.resampler->Resample(
-        resampler.source.data(), src_length_mono, resampler.destination.data(),
-        dst_capacity_mono);
+  // Interleave and convert from float.
+  for (size_t ch = 0; ch < num_channels_; ++ch) {
+    const float* const destination = destination_pointers_[ch];
+    for (size_t i = 0, j = ch; i < dst_length_mono; ++i, j += num_channels_) {
+      StoreSample(destination[i], &dst[j]);
+    }
   }
-
-  absl::InlinedVector<T*, 8> destination_pointers;
-  for (auto& resampler : channel_resamplers_) {
-    destination_pointers.push_back(resampler.destination.data());
-  }
-
-  Interleave(destination_pointers.data(), dst_length_mono, num_channels_, dst);
   return static_cast<int>(dst_length_mono * num_channels_);
 }
 
@@ -9,7 +9,16 @@
  */
 
 #include "common_audio/resampler/include/push_resampler.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "common_audio/resampler/push_sinc_resampler.h"
 #include "rtc_base/checks.h"  // RTC_DCHECK_IS_ON
+#include "rtc_base/time_utils.h"
 #include "test/gtest.h"
 
 // Quality testing of PushResampler is handled through output_mixer_unittest.cc.
@@ -49,4 +58,86 @@ TEST(PushResamplerTest, VerifiesBadInputParameters3) {
 #endif
 #endif
 
+namespace {
+
+// Fills |interleaved| with a different sine wave for each channel.
+template <typename T>
+void FillInterleaved(size_t num_channels, size_t frame_index, T* interleaved,
+                     size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    const size_t channel = i % num_channels;
+    const size_t sample = frame_index * length / num_channels + i / num_channels;
+    interleaved[i] = static_cast<T>(
+        8000.f * sinf(0.01f * (channel + 1) * static_cast<float>(sample)));
+  }
+}
+
+}  // namespace
+
+// Checks that resampling all the channels in a single pass gives the same
+// output as resampling each channel independently.
+TEST(PushResamplerTest, MultiChannelMatchesSingleChannel) {
+  constexpr size_t kNumChannels = 3;
+  constexpr int kSrcRate = 48000;
+  constexpr int kDstRate = 16000;
+  constexpr size_t kSrcFrames = kSrcRate / 100;
+  constexpr size_t kDstFrames = kDstRate / 100;
+  PushResampler<float> resampler;
+  ASSERT_EQ(0, resampler.InitializeIfNeeded(kSrcRate, kDstRate, kNumChannels));
+  std::vector<std::unique_ptr<PushSincResampler>> mono_resamplers;
+  for (size_t ch = 0; ch < kNumChannels; ++ch) {
+    mono_resamplers.push_back(
+        absl::make_unique<PushSincResampler>(kSrcFrames, kDstFrames));
+  }
+  std::vector<float> src(kSrcFrames * kNumChannels);
+  std::vector<float> dst(kDstFrames * kNumChannels);
+  std::vector<float> mono_src(kSrcFrames);
+  std::vector<float> mono_dst(kDstFrames);
+  for (size_t frame = 0; frame < 10; ++frame) {
+    SCOPED_TRACE(frame);
+    FillInterleaved(kNumChannels, frame, src.data(), src.size());
+    ASSERT_EQ(static_cast<int>(dst.size()),
+              resampler.Resample(src.data(), src.size(), dst.data(),
+                                 dst.size()));
+    for (size_t ch = 0; ch < kNumChannels; ++ch) {
+      for (size_t i = 0; i < kSrcFrames; ++i) {
+        mono_src[i] = src[i * kNumChannels + ch];
+      }
+      mono_resamplers[ch]->Resample(mono_src.data(), kSrcFrames,
+                                    mono_dst.data(), kDstFrames);
+      for (size_t i = 0; i < kDstFrames; ++i) {
+        ASSERT_EQ(mono_dst[i], dst[i * kNumChannels + ch]);
+      }
+    }
+  }
+}
+
+// Benchmark for PushResampler covering the most common sample rate pairs and
+// channel counts.
+TEST(PushResamplerTest, DISABLED_Benchmark) {
+  constexpr int kRatePairs[][2] = {{48000, 16000}, {16000, 48000},
+                                   {48000, 44100}, {44100, 48000},
+                                   {48000, 32000}, {32000, 48000}};
+  constexpr int kNumFrames = 10000;
+  for (size_t num_channels : {1, 2, 8}) {
+    for (const auto& rates : kRatePairs) {
+      PushResampler<int16_t> resampler;
+      ASSERT_EQ(0, resampler.InitializeIfNeeded(rates[0], rates[1],
+                                                num_channels));
+      std::vector<int16_t> src(rates[0] / 100 * num_channels);
+      std::vector<int16_t> dst(rates[1] / 100 * num_channels);
+      FillInterleaved(num_channels, 0, src.data(), src.size());
+      const int64_t start = rtc::TimeNanos();
+      for (int i = 0; i < kNumFrames; ++i) {
+        resampler.Resample(src.data(), src.size(), dst.data(), dst.size());
+      }
+      const double us_per_frame = static_cast<double>(rtc::TimeNanos() -
+                                                      start) /
+                                  rtc::kNumNanosecsPerMicrosec / kNumFrames;
+      printf("%d Hz -> %d Hz, %zu channel(s): %.2f us per 10 ms\n", rates[0],
+             rates[1], num_channels, us_per_frame);
+    }
+  }
+}
+
 }  // namespace webrtc
@@ -12,6 +12,7 @@
 
 #include <cstring>
 
+#include "absl/container/inlined_vector.h"
 #include "common_audio/include/audio_util.h"
 #include "rtc_base/checks.h"
 
@@ -77,6 +78,41 @@ size_t PushSincResampler::Resample(const float* source,
   return destination_frames_;
 }
 
+size_t PushSincResampler::ResampleMultiChannel(
+    rtc::ArrayView<PushSincResampler* const> resamplers,
+    const float* const* sources,
+    size_t source_length,
+    float* const* destinations,
+    size_t destination_capacity) {
+  RTC_DCHECK(!resamplers.empty());
+  PushSincResampler* const reference = resamplers[0];
+  absl::InlinedVector<SincResampler*, 8> sinc_resamplers;
+  for (size_t i = 0; i < resamplers.size(); ++i) {
+    PushSincResampler* const resampler = resamplers[i];
+    RTC_CHECK_EQ(source_length, resampler->resampler_->request_frames());
+    RTC_CHECK_EQ(reference->destination_frames_,
+                 resampler->destination_frames_);
+    RTC_CHECK_GE(destination_capacity, resampler->destination_frames_);
+    RTC_DCHECK_EQ(reference->first_pass_, resampler->first_pass_);
+    resampler->source_ptr_ = sources[i];
+    resampler->source_available_ = source_length;
+    sinc_resamplers.push_back(resampler->resampler_.get());
+  }
+
+  // Prime the buffers on the first pass as done in Resample().
+  if (reference->first_pass_) {
+    SincResampler::ResampleMultiChannel(
+        sinc_resamplers, reference->resampler_->ChunkSize(), destinations);
+  }
+
+  SincResampler::ResampleMultiChannel(
+      sinc_resamplers, reference->destination_frames_, destinations);
+  for (PushSincResampler* resampler : resamplers) {
+    resampler->source_ptr_ = nullptr;
+  }
+  return reference->destination_frames_;
+}
+
 void PushSincResampler::Run(size_t frames, float* destination) {
   // Ensure we are only asked for the available samples. This would fail if
   // Run() was triggered more than once per Resample() call.
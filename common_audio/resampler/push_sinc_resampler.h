@@ -15,6 +15,7 @@
 #include <stdint.h>
 #include <memory>
 
+#include "api/array_view.h"
 #include "common_audio/resampler/sinc_resampler.h"
 #include "rtc_base/constructor_magic.h"
 
@@ -46,6 +47,19 @@ class PushSincResampler : public SincResamplerCallback {
                   float* destination,
                   size_t destination_capacity);
 
+  // Resamples one block for each resampler in |resamplers|, reading from the
+  // corresponding item of |sources| and writing into the corresponding item
+  // of |destinations|, in a single pass (see
+  // SincResampler::ResampleMultiChannel()). The output is the same as calling
+  // Resample() on each resampler. All the resamplers must have been created
+  // with the same block sizes and must only be driven through this method.
+  static size_t ResampleMultiChannel(
+      rtc::ArrayView<PushSincResampler* const> resamplers,
+      const float* const* sources,
+      size_t source_frames,
+      float* const* destinations,
+      size_t destination_capacity);
+
   // Delay due to the filter kernel. Essentially, the time after which an input
   // sample will appear in the resampled output.
   static float AlgorithmicDelaySeconds(int source_rate_hz) {
@@ -122,7 +122,7 @@ const size_t SincResampler::kKernelSize;
 
 // If we know the minimum architecture at compile time, avoid CPU detection.
 #if defined(WEBRTC_ARCH_X86_FAMILY)
-#if defined(__SSE2__)
+#if defined(__SSE2__) && !defined(WEBRTC_ENABLE_AVX2)
 #define CONVOLVE_FUNC Convolve_SSE
 void SincResampler::InitializeCPUSpecificFeatures() {}
 #else
@@ -132,6 +132,12 @@ void SincResampler::InitializeCPUSpecificFeatures() {}
 #define CONVOLVE_FUNC convolve_proc_
 
 void SincResampler::InitializeCPUSpecificFeatures() {
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3)) {
+    convolve_proc_ = Convolve_AVX2;
+    return;
+  }
+#endif
   convolve_proc_ = WebRtc_GetCPUInfo(kSSE2) ? Convolve_SSE : Convolve_C;
 }
 #endif
@@ -151,21 +157,23 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
       read_cb_(read_cb),
       request_frames_(request_frames),
       input_buffer_size_(request_frames_ + kKernelSize),
-      // Create input buffers with a 16-byte alignment for SSE optimizations.
+      // Create input buffers with a 32-byte alignment for SIMD optimizations.
       kernel_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_pre_sinc_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_window_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       input_buffer_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * input_buffer_size_, 16))),
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+          AlignedMalloc(sizeof(float) * input_buffer_size_, 32))),
+#if defined(WEBRTC_ARCH_X86_FAMILY) && \
+    (!defined(__SSE2__) || defined(WEBRTC_ENABLE_AVX2))
       convolve_proc_(nullptr),
 #endif
       r1_(input_buffer_.get()),
       r2_(input_buffer_.get() + kKernelSize / 2) {
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+#if defined(WEBRTC_ARCH_X86_FAMILY) && \
+    (!defined(__SSE2__) || defined(WEBRTC_ENABLE_AVX2))
   InitializeCPUSpecificFeatures();
   RTC_DCHECK(convolve_proc_);
 #endif
@@ -301,10 +309,10 @@ void SincResampler::Resample(size_t frames, float* destination) {
       const float* const k1 = kernel_ptr + offset_idx * kKernelSize;
       const float* const k2 = k1 + kKernelSize;
 
-      // Ensure |k1|, |k2| are 16-byte aligned for SIMD usage.  Should always be
-      // true so long as kKernelSize is a multiple of 16.
-      RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k1) % 16);
-      RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k2) % 16);
+      // Ensure |k1|, |k2| are 32-byte aligned for SIMD usage.  Should always be
+      // true so long as kKernelSize is a multiple of 32.
+      RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k1) % 32);
+      RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k2) % 32);
 
       // Initialize input pointer based on quantized |virtual_source_idx_|.
       const float* const input_ptr = r1_ + source_idx;
@@ -338,6 +346,87 @@ void SincResampler::Resample(size_t frames, float* destination) {
   }
 }
 
+void SincResampler::ResampleMultiChannel(
+    rtc::ArrayView<SincResampler* const> resamplers,
+    size_t frames,
+    float* const* destinations) {
+  RTC_DCHECK(!resamplers.empty());
+  // The first resampler drives the kernel position for all the channels.
+  SincResampler* const reference = resamplers[0];
+  for (SincResampler* resampler : resamplers) {
+    RTC_DCHECK_EQ(reference->io_sample_rate_ratio_,
+                  resampler->io_sample_rate_ratio_);
+    RTC_DCHECK_EQ(reference->request_frames_, resampler->request_frames_);
+    RTC_DCHECK_EQ(reference->virtual_source_idx_,
+                  resampler->virtual_source_idx_);
+    RTC_DCHECK_EQ(reference->buffer_primed_, resampler->buffer_primed_);
+  }
+  const size_t num_channels = resamplers.size();
+  size_t remaining_frames = frames;
+  size_t output_idx = 0;
+
+  // Step (1) -- Prime the input buffers at the start of the input stream.
+  if (!reference->buffer_primed_ && remaining_frames) {
+    for (SincResampler* resampler : resamplers) {
+      resampler->read_cb_->Run(resampler->request_frames_, resampler->r0_);
+      resampler->buffer_primed_ = true;
+    }
+  }
+
+  // Step (2) -- Resample all the channels.  The kernels are the same for all
+  // the resamplers since they share the sample rate ratio.
+  const double current_io_ratio = reference->io_sample_rate_ratio_;
+  const float* const kernel_ptr = reference->kernel_storage_.get();
+  while (remaining_frames) {
+    for (int i = static_cast<int>(ceil(
+             (reference->block_size_ - reference->virtual_source_idx_) /
+             current_io_ratio));
+         i > 0; --i) {
+      RTC_DCHECK_LT(reference->virtual_source_idx_, reference->block_size_);
+
+      const int source_idx = static_cast<int>(reference->virtual_source_idx_);
+      const double subsample_remainder =
+          reference->virtual_source_idx_ - source_idx;
+      const double virtual_offset_idx =
+          subsample_remainder * kKernelOffsetCount;
+      const int offset_idx = static_cast<int>(virtual_offset_idx);
+      const float* const k1 = kernel_ptr + offset_idx * kKernelSize;
+      const float* const k2 = k1 + kKernelSize;
+      const double kernel_interpolation_factor =
+          virtual_offset_idx - offset_idx;
+      for (size_t c = 0; c < num_channels; ++c) {
+        destinations[c][output_idx] = reference->CONVOLVE_FUNC(
+            resamplers[c]->r1_ + source_idx, k1, k2,
+            kernel_interpolation_factor);
+      }
+      ++output_idx;
+
+      reference->virtual_source_idx_ += current_io_ratio;
+
+      if (!--remaining_frames)
+        break;
+    }
+    if (!remaining_frames)
+      break;
+
+    // Wrap back around to the start.
+    reference->virtual_source_idx_ -= reference->block_size_;
+
+    // Steps (3) to (5) -- See Resample().
+    for (SincResampler* resampler : resamplers) {
+      memcpy(resampler->r1_, resampler->r3_,
+             sizeof(*resampler->input_buffer_.get()) * kKernelSize);
+      if (resampler->r0_ == resampler->r2_)
+        resampler->UpdateRegions(true);
+      resampler->read_cb_->Run(resampler->request_frames_, resampler->r0_);
+    }
+  }
+
+  for (SincResampler* resampler : resamplers) {
+    resampler->virtual_source_idx_ = reference->virtual_source_idx_;
+  }
+}
+
 #undef CONVOLVE_FUNC
 
 size_t SincResampler::ChunkSize() const {
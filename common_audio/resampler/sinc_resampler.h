@@ -17,6 +17,7 @@
 #include <stddef.h>
 #include <memory>
 
+#include "api/array_view.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/gtest_prod_util.h"
 #include "rtc_base/memory/aligned_malloc.h"
@@ -66,6 +67,18 @@ class SincResampler {
   // Resample |frames| of data from |read_cb_| into |destination|.
   void Resample(size_t frames, float* destination);
 
+  // Resamples |frames| of data for each resampler in |resamplers| into the
+  // corresponding item of |destinations| in a single pass over the output:
+  // the kernel position is computed once per output frame and all the
+  // channels are convolved with the same kernels. The output of each
+  // resampler is the same as calling Resample() on it. All the resamplers must
+  // have the same sample rate ratio and request size and must only be driven
+  // through this method.
+  static void ResampleMultiChannel(
+      rtc::ArrayView<SincResampler* const> resamplers,
+      size_t frames,
+      float* const* destinations);
+
   // The maximum size in frames that guarantees Resample() will only make a
   // single call to |read_cb_| for more data.
   size_t ChunkSize() const;
@@ -89,6 +102,7 @@ class SincResampler {
  private:
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, Convolve);
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, ConvolveBenchmark);
+  FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, ConvolveAvx2);
 
   void InitializeKernel();
   void UpdateRegions(bool second_load);
@@ -111,6 +125,12 @@ class SincResampler {
                             const float* k1,
                             const float* k2,
                             double kernel_interpolation_factor);
+#if defined(WEBRTC_ENABLE_AVX2)
+  static float Convolve_AVX2(const float* input_ptr,
+                             const float* k1,
+                             const float* k2,
+                             double kernel_interpolation_factor);
+#endif
 #elif defined(WEBRTC_HAS_NEON)
   static float Convolve_NEON(const float* input_ptr,
                              const float* k1,
@@ -154,7 +174,8 @@ class SincResampler {
 // TODO(ajm): Move to using a global static which must only be initialized
 // once by the user. We're not doing this initially, because we don't have
 // e.g. a LazyInstance helper in webrtc.
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+#if defined(WEBRTC_ARCH_X86_FAMILY) && \
+    (!defined(__SSE2__) || defined(WEBRTC_ENABLE_AVX2))
   typedef float (*ConvolveProc)(const float*,
                                 const float*,
                                 const float*,
@@ -229,6 +229,55 @@ TEST(SincResamplerTest, ConvolveBenchmark) {
 
 #undef CONVOLVE_FUNC
 
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(WEBRTC_ENABLE_AVX2)
+// Ensure that Convolve_AVX2() returns the same value as Convolve_C() and
+// benchmark it.  Skipped on CPUs without AVX2 and FMA support.
+TEST(SincResamplerTest, ConvolveAvx2) {
+  if (!WebRtc_GetCPUInfo(kAVX2) || !WebRtc_GetCPUInfo(kFMA3)) {
+    return;
+  }
+
+  // Initialize a dummy resampler.
+  MockSource mock_source;
+  SincResampler resampler(kSampleRateRatio, SincResampler::kDefaultRequestSize,
+                          &mock_source);
+  static const double kEpsilon = 0.00000005;
+  for (size_t input_offset : {0, 1}) {
+    SCOPED_TRACE(input_offset);
+    const double result = resampler.Convolve_C(
+        resampler.kernel_storage_.get() + input_offset,
+        resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
+        kKernelInterpolationFactor);
+    const double result2 = resampler.Convolve_AVX2(
+        resampler.kernel_storage_.get() + input_offset,
+        resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
+        kKernelInterpolationFactor);
+    EXPECT_NEAR(result2, result, kEpsilon);
+  }
+
+  const int kConvolveIterations = 1000000;
+  int64_t start = rtc::TimeNanos();
+  for (int i = 0; i < kConvolveIterations; ++i) {
+    resampler.Convolve_SSE(
+        resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
+        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+  }
+  const double total_time_sse_us =
+      (rtc::TimeNanos() - start) / rtc::kNumNanosecsPerMicrosec;
+  start = rtc::TimeNanos();
+  for (int i = 0; i < kConvolveIterations; ++i) {
+    resampler.Convolve_AVX2(
+        resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
+        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+  }
+  const double total_time_avx2_us =
+      (rtc::TimeNanos() - start) / rtc::kNumNanosecsPerMicrosec;
+  printf("Convolve_AVX2 (unaligned) took %.2fms; which is %.2fx faster than "
+         "Convolve_SSE.\n", total_time_avx2_us / 1000,
+         total_time_sse_us / total_time_avx2_us);
+}
+#endif
+
 typedef std::tuple<int, int, double, double> SincResamplerTestData;
 class SincResamplerTest
     : public ::testing::TestWithParam<SincResamplerTestData> {
@@ -351,7 +400,7 @@ INSTANTIATE_TEST_SUITE_P(
         std::make_tuple(16000, 44100, kResamplingRMSError, -62.54),
         std::make_tuple(22050, 44100, kResamplingRMSError, -73.53),
         std::make_tuple(32000, 44100, kResamplingRMSError, -63.32),
-        std::make_tuple(44100, 44100, kResamplingRMSError, -73.53),
+        std::make_tuple(44100, 44100, kResamplingRMSError, -73.52),
         std::make_tuple(48000, 44100, -15.01, -64.04),
         std::make_tuple(96000, 44100, -18.49, -25.51),
         std::make_tuple(192000, 44100, -20.50, -13.31),
@@ -359,7 +408,7 @@ INSTANTIATE_TEST_SUITE_P(
         // To 48kHz
         std::make_tuple(8000, 48000, kResamplingRMSError, -63.43),
         std::make_tuple(11025, 48000, kResamplingRMSError, -62.61),
-        std::make_tuple(16000, 48000, kResamplingRMSError, -63.96),
+        std::make_tuple(16000, 48000, kResamplingRMSError, -63.95),
         std::make_tuple(22050, 48000, kResamplingRMSError, -62.42),
         std::make_tuple(32000, 48000, kResamplingRMSError, -64.04),
         std::make_tuple(44100, 48000, kResamplingRMSError, -62.63),
@@ -24,6 +24,7 @@ enum PreservedErrno {
 #include <stdio.h>
 
 #include <memory>
+#include <utility>
 
 #include "absl/algorithm/container.h"
 #include "media/base/codec.h"
@@ -256,12 +257,11 @@ class SctpTransport::UsrSctpWrapper {
 
     VerboseLogPacket(data, length, SCTP_DUMP_OUTBOUND);
     // Note: We have to copy the data; the caller will delete it.
-    rtc::CopyOnWriteBuffer buf(reinterpret_cast<uint8_t*>(data), length);
-    // TODO(deadbeef): Why do we need an AsyncInvoke here? We're already on the
-    // right thread and don't need to unwind the stack.
-    transport->invoker_.AsyncInvoke<void>(
-        RTC_FROM_HERE, transport->network_thread_,
-        rtc::Bind(&SctpTransport::OnPacketFromSctpToNetwork, transport, buf));
+    // The packet is not sent right away, even when called on the network
+    // thread, since sending it could feed a packet back into usrsctp while it
+    // is still holding its locks.
+    transport->QueueOutboundPacket(
+        rtc::CopyOnWriteBuffer(reinterpret_cast<uint8_t*>(data), length));
     return 0;
   }
 
@@ -304,11 +304,9 @@ class SctpTransport::UsrSctpWrapper {
         // A message with a new sid, but haven't seen the EOR for the
         // previous message. Deliver the previous partial message to avoid
         // merging messages from different sid's.
-        transport->invoker_.AsyncInvoke<void>(
-            RTC_FROM_HERE, transport->network_thread_,
-            rtc::Bind(&SctpTransport::OnInboundPacketFromSctpToTransport,
-                      transport, transport->partial_message_,
-                      transport->partial_params_, transport->partial_flags_));
+        transport->QueueInboundPacket(transport->partial_message_,
+                                      transport->partial_params_,
+                                      transport->partial_flags_);
 
         transport->partial_message_.Clear();
       }
@@ -329,12 +327,9 @@ class SctpTransport::UsrSctpWrapper {
         return 1;
       }
 
-      // The ownership of the packet transfers to |invoker_|. Using
+      // The ownership of the packet transfers to the queue. Using
       // CopyOnWriteBuffer is the most convenient way to do this.
-      transport->invoker_.AsyncInvoke<void>(
-          RTC_FROM_HERE, transport->network_thread_,
-          rtc::Bind(&SctpTransport::OnInboundPacketFromSctpToTransport,
-                    transport, transport->partial_message_, params, flags));
+      transport->QueueInboundPacket(transport->partial_message_, params, flags);
 
       transport->partial_message_.Clear();
     }
@@ -923,6 +918,65 @@ sockaddr_conn SctpTransport::GetSctpSockAddr(int port) {
   return sconn;
 }
 
+void SctpTransport::QueueOutboundPacket(rtc::CopyOnWriteBuffer buffer) {
+  bool post_task;
+  {
+    rtc::CritScope cs(&queued_packets_crit_);
+    post_task = outbound_packets_.empty();
+    outbound_packets_.push_back(std::move(buffer));
+  }
+  // A task is already pending if the queue was not empty, and will send this
+  // packet as well.
+  if (post_task) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&SctpTransport::OnPacketsFromSctpToNetwork, this));
+  }
+}
+
+void SctpTransport::QueueInboundPacket(const rtc::CopyOnWriteBuffer& buffer,
+                                       const ReceiveDataParams& params,
+                                       int flags) {
+  bool post_task;
+  {
+    rtc::CritScope cs(&queued_packets_crit_);
+    post_task = inbound_packets_.empty();
+    inbound_packets_.push_back({buffer, params, flags});
+  }
+  if (post_task) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&SctpTransport::OnInboundPacketsFromSctpToTransport, this));
+  }
+}
+
+void SctpTransport::OnPacketsFromSctpToNetwork() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  RTC_DCHECK(outbound_packets_to_send_.empty());
+  {
+    rtc::CritScope cs(&queued_packets_crit_);
+    outbound_packets_to_send_.swap(outbound_packets_);
+  }
+  for (const rtc::CopyOnWriteBuffer& buffer : outbound_packets_to_send_) {
+    OnPacketFromSctpToNetwork(buffer);
+  }
+  outbound_packets_to_send_.clear();
+}
+
+void SctpTransport::OnInboundPacketsFromSctpToTransport() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  RTC_DCHECK(inbound_packets_to_deliver_.empty());
+  {
+    rtc::CritScope cs(&queued_packets_crit_);
+    inbound_packets_to_deliver_.swap(inbound_packets_);
+  }
+  for (const InboundPacket& packet : inbound_packets_to_deliver_) {
+    OnInboundPacketFromSctpToTransport(packet.buffer, packet.params,
+                                       packet.flags);
+  }
+  inbound_packets_to_deliver_.clear();
+}
+
 void SctpTransport::OnPacketFromSctpToNetwork(
     const rtc::CopyOnWriteBuffer& buffer) {
   RTC_DCHECK_RUN_ON(network_thread_);
@@ -22,8 +22,10 @@
 #include "rtc_base/async_invoker.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/thread_annotations.h"
 // For SendDataParams/ReceiveDataParams.
 #include "media/base/media_channel.h"
 #include "media/sctp/sctp_transport_internal.h"
@@ -95,6 +97,8 @@ class SctpTransport : public SctpTransportInternal,
   rtc::Thread* network_thread() const { return network_thread_; }
 
  private:
+  friend class SctpTransportTest;
+
   void ConnectTransportSignals();
   void DisconnectTransportSignals();
 
@@ -126,9 +130,21 @@ class SctpTransport : public SctpTransportInternal,
   void OnSendThresholdCallback();
   sockaddr_conn GetSctpSockAddr(int port);
 
-  // Called using |invoker_| to send packet on the network.
+  // Called from the usrsctp callbacks, on any thread, to pass packets to the
+  // network thread. Packets that arrive while a batch is pending are handled
+  // by the same task, so a burst of packets costs a single thread hop.
+  void QueueOutboundPacket(rtc::CopyOnWriteBuffer buffer);
+  void QueueInboundPacket(const rtc::CopyOnWriteBuffer& buffer,
+                          const ReceiveDataParams& params,
+                          int flags);
+
+  // Called using |invoker_| to handle the queued packets.
+  void OnPacketsFromSctpToNetwork();
+  void OnInboundPacketsFromSctpToTransport();
+
+  // Sends a packet on the network.
   void OnPacketFromSctpToNetwork(const rtc::CopyOnWriteBuffer& buffer);
-  // Called using |invoker_| to decide what to do with the packet.
+  // Decides what to do with the packet.
   // The |flags| parameter is used by SCTP to distinguish notification packets
   // from other types of packets.
   void OnInboundPacketFromSctpToTransport(const rtc::CopyOnWriteBuffer& buffer,
@@ -146,6 +162,23 @@ class SctpTransport : public SctpTransportInternal,
   rtc::Thread* network_thread_;
   // Helps pass inbound/outbound packets asynchronously to the network thread.
   rtc::AsyncInvoker invoker_;
+
+  struct InboundPacket {
+    rtc::CopyOnWriteBuffer buffer;
+    ReceiveDataParams params;
+    int flags;
+  };
+  // Packets queued by the usrsctp callbacks, waiting to be handled on the
+  // network thread.
+  rtc::CriticalSection queued_packets_crit_;
+  std::vector<rtc::CopyOnWriteBuffer> outbound_packets_
+      RTC_GUARDED_BY(queued_packets_crit_);
+  std::vector<InboundPacket> inbound_packets_
+      RTC_GUARDED_BY(queued_packets_crit_);
+  // The batches being handled. Swapped with the queues, so that the capacity
+  // of both is reused.
+  std::vector<rtc::CopyOnWriteBuffer> outbound_packets_to_send_;
+  std::vector<InboundPacket> inbound_packets_to_deliver_;
   // Underlying DTLS transport.
   rtc::PacketTransportInternal* transport_ = nullptr;
 
@@ -10,8 +10,11 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -22,6 +25,7 @@
 #include "rtc_base/logging.h"
 #include "rtc_base/message_queue.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
 #include "test/gtest.h"
 
 namespace {
@@ -65,6 +69,52 @@ class SctpFakeDataReceiver : public sigslot::has_slots<> {
   ReceiveDataParams last_params_;
 };
 
+// Counts the received messages.
+class SctpMessageCounter : public sigslot::has_slots<> {
+ public:
+  void OnDataReceived(const ReceiveDataParams& params,
+                      const rtc::CopyOnWriteBuffer& data) {
+    ++num_messages_;
+  }
+
+  int num_messages() const { return num_messages_; }
+
+ private:
+  int num_messages_ = 0;
+};
+
+// Records the packets read from a DTLS transport and the messages received by
+// an SCTP transport, in the order they arrive. |on_received| runs after each
+// of them has been recorded.
+class SctpPacketRecorder : public sigslot::has_slots<> {
+ public:
+  void OnPacketRead(rtc::PacketTransportInternal* transport,
+                    const char* data,
+                    size_t len,
+                    const int64_t& packet_time_us,
+                    int flags) {
+    received_.emplace_back(data, len);
+    if (on_received_) {
+      on_received_();
+    }
+  }
+
+  void OnDataReceived(const ReceiveDataParams& params,
+                      const rtc::CopyOnWriteBuffer& data) {
+    OnPacketRead(nullptr, data.data<char>(), data.size(), 0, 0);
+  }
+
+  void set_on_received(std::function<void()> on_received) {
+    on_received_ = std::move(on_received);
+  }
+
+  const std::vector<std::string>& received() const { return received_; }
+
+ private:
+  std::vector<std::string> received_;
+  std::function<void()> on_received_;
+};
+
 class SctpTransportObserver : public sigslot::has_slots<> {
  public:
   explicit SctpTransportObserver(SctpTransport* transport) {
@@ -190,6 +240,24 @@ class SctpTransportTest : public ::testing::Test, public sigslot::has_slots<> {
             recv->last_data() == msg);
   }
 
+  // Pass packets to the queues that the usrsctp callbacks use, as if usrsctp
+  // had produced them.
+  static void QueueOutboundPacket(SctpTransport* transport,
+                                  const std::string& packet) {
+    transport->QueueOutboundPacket(
+        rtc::CopyOnWriteBuffer(packet.data(), packet.size()));
+  }
+
+  static void QueueInboundMessage(SctpTransport* transport,
+                                  int sid,
+                                  const std::string& message) {
+    ReceiveDataParams params;
+    params.sid = sid;
+    transport->QueueInboundPacket(
+        rtc::CopyOnWriteBuffer(message.data(), message.size()), params,
+        /*flags=*/0);
+  }
+
   bool ProcessMessagesUntilIdle() {
     rtc::Thread* thread = rtc::Thread::Current();
     while (!thread->empty()) {
@@ -423,6 +491,68 @@ TEST_F(SctpTransportTest, SendData) {
                       << ", recv1.last_data=" << receiver1()->last_data();
 }
 
+// Packets queued by the usrsctp callbacks before the network thread gets to
+// them are handled in one batch, and must keep their order in both directions.
+TEST_F(SctpTransportTest, BatchedPacketsKeepTheirOrder) {
+  FakeDtlsTransport fake_dtls1("fake dtls 1", 0);
+  FakeDtlsTransport fake_dtls2("fake dtls 2", 0);
+  fake_dtls1.SetDestination(&fake_dtls2, /*asymmetric=*/false);
+  SctpTransport transport(rtc::Thread::Current(), &fake_dtls1);
+  SctpPacketRecorder sent_packets;
+  fake_dtls2.SignalReadPacket.connect(&sent_packets,
+                                      &SctpPacketRecorder::OnPacketRead);
+  SctpPacketRecorder received_messages;
+  transport.SignalDataReceived.connect(&received_messages,
+                                       &SctpPacketRecorder::OnDataReceived);
+
+  const std::vector<std::string> kPackets = {"1", "2", "3", "4", "5"};
+  for (const std::string& packet : kPackets) {
+    QueueOutboundPacket(&transport, packet);
+    QueueInboundMessage(&transport, 1, packet);
+  }
+  EXPECT_TRUE(sent_packets.received().empty());
+  EXPECT_TRUE(received_messages.received().empty());
+
+  ASSERT_TRUE(ProcessMessagesUntilIdle());
+  EXPECT_EQ(kPackets, sent_packets.received());
+  EXPECT_EQ(kPackets, received_messages.received());
+}
+
+// A packet queued while a batch is being handled must not be lost, but be
+// handled after that batch.
+TEST_F(SctpTransportTest, PacketQueuedDuringFlushIsDelivered) {
+  FakeDtlsTransport fake_dtls1("fake dtls 1", 0);
+  FakeDtlsTransport fake_dtls2("fake dtls 2", 0);
+  fake_dtls1.SetDestination(&fake_dtls2, /*asymmetric=*/false);
+  SctpTransport transport(rtc::Thread::Current(), &fake_dtls1);
+  SctpPacketRecorder sent_packets;
+  fake_dtls2.SignalReadPacket.connect(&sent_packets,
+                                      &SctpPacketRecorder::OnPacketRead);
+  SctpPacketRecorder received_messages;
+  transport.SignalDataReceived.connect(&received_messages,
+                                       &SctpPacketRecorder::OnDataReceived);
+
+  sent_packets.set_on_received([&] {
+    if (sent_packets.received().size() == 1) {
+      QueueOutboundPacket(&transport, "late");
+    }
+  });
+  received_messages.set_on_received([&] {
+    if (received_messages.received().size() == 1) {
+      QueueInboundMessage(&transport, 1, "late");
+    }
+  });
+  QueueOutboundPacket(&transport, "1");
+  QueueOutboundPacket(&transport, "2");
+  QueueInboundMessage(&transport, 1, "1");
+  QueueInboundMessage(&transport, 1, "2");
+
+  ASSERT_TRUE(ProcessMessagesUntilIdle());
+  const std::vector<std::string> kExpected = {"1", "2", "late"};
+  EXPECT_EQ(kExpected, sent_packets.received());
+  EXPECT_EQ(kExpected, received_messages.received());
+}
+
 // Sends a lot of large messages at once and verifies SDR_BLOCK is returned.
 TEST_F(SctpTransportTest, SendDataBlocked) {
   SetupConnectedTransportsWithTwoStreams();
@@ -592,4 +722,68 @@ TEST_F(SctpTransportTest, RejectsSendTooLargeMessages) {
   EXPECT_FALSE(SendData(transport1(), 1, eleven_characters, &result));
 }
 
+// Measures the message rate and round trip through the SCTP stack for an
+// increasing number of concurrent associations, all served by one network
+// thread as on a server that terminates many data channels.
+TEST_F(SctpTransportTest, DISABLED_BenchmarkConcurrentAssociations) {
+  constexpr int kNumRounds = 100;
+  constexpr int kMessagesPerRound = 10;
+  const std::string message(1000, 'x');
+
+  for (int num_associations : {1, 10, 100}) {
+    std::vector<std::unique_ptr<FakeDtlsTransport>> fake_dtls;
+    std::vector<std::unique_ptr<SctpMessageCounter>> counters;
+    std::vector<std::unique_ptr<SctpTransport>> senders;
+    std::vector<std::unique_ptr<SctpTransport>> receivers;
+    for (int i = 0; i < num_associations; ++i) {
+      fake_dtls.emplace_back(new FakeDtlsTransport("sender", 0));
+      FakeDtlsTransport* sender_dtls = fake_dtls.back().get();
+      fake_dtls.emplace_back(new FakeDtlsTransport("receiver", 0));
+      FakeDtlsTransport* receiver_dtls = fake_dtls.back().get();
+      counters.emplace_back(new SctpMessageCounter());
+      senders.emplace_back(
+          new SctpTransport(rtc::Thread::Current(), sender_dtls));
+      receivers.emplace_back(
+          new SctpTransport(rtc::Thread::Current(), receiver_dtls));
+      receivers.back()->SignalDataReceived.connect(
+          counters.back().get(), &SctpMessageCounter::OnDataReceived);
+      sender_dtls->SetDestination(receiver_dtls, false);
+      senders.back()->OpenStream(1);
+      receivers.back()->OpenStream(1);
+      senders.back()->Start(kTransport1Port, kTransport2Port,
+                            kSctpSendBufferSize);
+      receivers.back()->Start(kTransport2Port, kTransport1Port,
+                              kSctpSendBufferSize);
+    }
+    for (const auto& sender : senders) {
+      ASSERT_TRUE_WAIT(sender->ReadyToSendData(), kDefaultTimeout);
+    }
+
+    int64_t max_round_us = 0;
+    const int64_t start_us = rtc::TimeMicros();
+    for (int round = 1; round <= kNumRounds; ++round) {
+      const int64_t round_start_us = rtc::TimeMicros();
+      for (int m = 0; m < kMessagesPerRound; ++m) {
+        for (const auto& sender : senders) {
+          SendDataResult result;
+          ASSERT_TRUE(SendData(sender.get(), 1, message, &result));
+        }
+      }
+      for (const auto& counter : counters) {
+        ASSERT_EQ_WAIT(round * kMessagesPerRound, counter->num_messages(),
+                       kDefaultTimeout);
+      }
+      max_round_us =
+          std::max(max_round_us, rtc::TimeMicros() - round_start_us);
+    }
+    const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+    const int num_messages = num_associations * kNumRounds * kMessagesPerRound;
+    printf(
+        "%d associations: %.0f messages/s, %.0f us per round (max %d us)\n",
+        num_associations, num_messages * 1e6 / elapsed_us,
+        static_cast<double>(elapsed_us) / kNumRounds,
+        static_cast<int>(max_round_us));
+  }
+}
+
 }  // namespace cricket
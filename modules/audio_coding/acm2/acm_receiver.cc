@@ -36,7 +36,8 @@ AcmReceiver::AcmReceiver(const AudioCodingModule::Config& config)
     : last_audio_buffer_(new int16_t[AudioFrame::kMaxDataSizeSamples]),
       neteq_(NetEq::Create(config.neteq_config, config.decoder_factory)),
       clock_(config.clock),
-      resampled_last_output_frame_(true) {
+      resampled_last_output_frame_(true),
+      last_audio_muted_(false) {
   RTC_DCHECK(clock_);
   memset(last_audio_buffer_.get(), 0,
          sizeof(int16_t) * AudioFrame::kMaxDataSizeSamples);
@@ -144,6 +145,11 @@ int AcmReceiver::GetAudio(int desired_freq_hz,
 
   if (need_resampling && !resampled_last_output_frame_) {
     // Prime the resampler with the last frame.
+    if (last_audio_muted_) {
+      memset(last_audio_buffer_.get(), 0,
+             sizeof(int16_t) * AudioFrame::kMaxDataSizeSamples);
+      last_audio_muted_ = false;
+    }
     int16_t temp_output[AudioFrame::kMaxDataSizeSamples];
     int samples_per_channel_int = resampler_.Resample10Msec(
         last_audio_buffer_.get(), current_sample_rate_hz, desired_freq_hz,
@@ -159,18 +165,25 @@ int AcmReceiver::GetAudio(int desired_freq_hz,
   // TODO(henrik.lundin) Glitches in the output may appear if the output rate
   // from NetEq changes. See WebRTC issue 3923.
   if (need_resampling) {
-    // TODO(yujo): handle this more efficiently for muted frames.
-    int samples_per_channel_int = resampler_.Resample10Msec(
-        audio_frame->data(), current_sample_rate_hz, desired_freq_hz,
-        audio_frame->num_channels_, AudioFrame::kMaxDataSizeSamples,
-        audio_frame->mutable_data());
-    if (samples_per_channel_int < 0) {
-      RTC_LOG(LERROR)
-          << "AcmReceiver::GetAudio - Resampling audio_buffer_ failed.";
-      return -1;
+    if (*muted) {
+      // Resampling silence gives silence, so a muted frame only changes its
+      // rate. The resampler keeps the state of the last audible frame, which
+      // NetEq has faded out before muting.
+      audio_frame->samples_per_channel_ =
+          rtc::CheckedDivExact(desired_freq_hz, 100);
+    } else {
+      int samples_per_channel_int = resampler_.Resample10Msec(
+          audio_frame->data(), current_sample_rate_hz, desired_freq_hz,
+          audio_frame->num_channels_, AudioFrame::kMaxDataSizeSamples,
+          audio_frame->mutable_data());
+      if (samples_per_channel_int < 0) {
+        RTC_LOG(LERROR)
+            << "AcmReceiver::GetAudio - Resampling audio_buffer_ failed.";
+        return -1;
+      }
+      audio_frame->samples_per_channel_ =
+          static_cast<size_t>(samples_per_channel_int);
     }
-    audio_frame->samples_per_channel_ =
-        static_cast<size_t>(samples_per_channel_int);
     audio_frame->sample_rate_hz_ = desired_freq_hz;
     RTC_DCHECK_EQ(
         audio_frame->sample_rate_hz_,
@@ -179,12 +192,16 @@ int AcmReceiver::GetAudio(int desired_freq_hz,
   } else {
     resampled_last_output_frame_ = false;
     // We might end up here ONLY if codec is changed.
-  }
 
-  // Store current audio in |last_audio_buffer_| for next time.
-  memcpy(last_audio_buffer_.get(), audio_frame->data(),
-         sizeof(int16_t) * audio_frame->samples_per_channel_ *
-             audio_frame->num_channels_);
+    // Store current audio in |last_audio_buffer_| for next time. It is only
+    // used to prime the resampler after a frame that was not resampled.
+    last_audio_muted_ = *muted;
+    if (!*muted) {
+      memcpy(last_audio_buffer_.get(), audio_frame->data(),
+             sizeof(int16_t) * audio_frame->samples_per_channel_ *
+                 audio_frame->num_channels_);
+    }
+  }
 
   call_stats_.DecodedByNetEq(audio_frame->speech_type_, *muted);
   return 0;
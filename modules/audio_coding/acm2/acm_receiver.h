@@ -212,6 +212,8 @@ class AcmReceiver {
   const std::unique_ptr<NetEq> neteq_;  // NetEq is thread-safe; no lock needed.
   Clock* const clock_;
   bool resampled_last_output_frame_ RTC_GUARDED_BY(crit_sect_);
+  // True if |last_audio_buffer_| should be treated as silence.
+  bool last_audio_muted_ RTC_GUARDED_BY(crit_sect_);
 };
 
 }  // namespace acm2
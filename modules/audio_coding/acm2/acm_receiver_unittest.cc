@@ -303,6 +303,39 @@ TEST_F(AcmReceiverTestPostDecodeVadPassiveOldApi, MAYBE_PostdecodingVad) {
   EXPECT_EQ(AudioFrame::kVadUnknown, frame.vad_activity_);
 }
 
+class AcmReceiverTestMutedStateOldApi : public AcmReceiverTestOldApi {
+ protected:
+  AcmReceiverTestMutedStateOldApi() {
+    config_.neteq_config.enable_muted_state = true;
+  }
+};
+
+// Muted frames are delivered at the requested rate without being resampled,
+// and stay muted.
+TEST_F(AcmReceiverTestMutedStateOldApi, MutedFramesAreNotResampled) {
+  constexpr int payload_type = 0;
+  const SdpAudioFormat codec = {"PCMU", 8000, 1};
+  const AudioCodecInfo info = SetEncoder(payload_type, codec);
+  receiver_->SetCodecs({{payload_type, codec}});
+  constexpr int kOutSampleRateHz = 48000;
+  InsertOnePacketOfSilence(info);
+
+  AudioFrame frame;
+  bool muted = false;
+  for (int i = 0; i < 1000 && !muted; ++i) {
+    ASSERT_EQ(0, receiver_->GetAudio(kOutSampleRateHz, &frame, &muted));
+  }
+  ASSERT_TRUE(muted);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(0, receiver_->GetAudio(kOutSampleRateHz, &frame, &muted));
+    EXPECT_TRUE(muted);
+    EXPECT_TRUE(frame.muted());
+    EXPECT_EQ(kOutSampleRateHz, frame.sample_rate_hz_);
+    EXPECT_EQ(static_cast<size_t>(kOutSampleRateHz / 100),
+              frame.samples_per_channel_);
+  }
+}
+
 #if defined(WEBRTC_ANDROID)
 #define MAYBE_LastAudioCodec DISABLED_LastAudioCodec
 #else
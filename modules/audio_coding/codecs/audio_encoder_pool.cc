@@ -0,0 +1,218 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/codecs/audio_encoder_pool.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+
+namespace {
+
+// Weight of the latest measurement in the per-stream packet encode time
+// estimate that is used for ordering the work within a batch.
+constexpr float kEncodeTimeSmoothing = 0.1f;
+
+}  // namespace
+
+struct AudioEncoderPool::Stream {
+  Stream(std::unique_ptr<AudioEncoder> encoder, size_t output_buffer_capacity)
+      : encoder(std::move(encoder)) {
+    encoded.EnsureCapacity(output_buffer_capacity);
+  }
+
+  // Returns the expected time to encode the next block. Most codecs buffer
+  // the input until a packet is complete, so only every
+  // Num10MsFramesInNextPacket():th block is expensive.
+  float ExpectedEncodeTimeUs() const {
+    return num_buffered_blocks + 1 >= encoder->Num10MsFramesInNextPacket()
+               ? packet_encode_time_us
+               : 0.f;
+  }
+
+  std::unique_ptr<AudioEncoder> encoder;
+  rtc::Buffer encoded;
+  AudioEncoder::EncodedInfo info;
+  StreamStats stats;
+  size_t num_buffered_blocks = 0;
+  float packet_encode_time_us = 0.f;
+};
+
+struct AudioEncoderPool::Worker {
+  Worker(AudioEncoderPool* pool, int index)
+      : pool(pool),
+        thread(&AudioEncoderPool::WorkerThreadFunc,
+               this,
+               "AudioEncoderPool" + std::to_string(index),
+               rtc::kHighPriority) {}
+
+  AudioEncoderPool* const pool;
+  rtc::Event wake_up;
+  rtc::PlatformThread thread;
+};
+
+AudioEncoderPool::AudioEncoderPool(const Config& config)
+    : output_buffer_capacity_(config.output_buffer_capacity) {
+  RTC_DCHECK_GE(config.num_worker_threads, 0);
+  for (int i = 0; i < config.num_worker_threads; ++i) {
+    workers_.emplace_back(new Worker(this, i));
+    workers_.back()->thread.Start();
+  }
+}
+
+AudioEncoderPool::~AudioEncoderPool() {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  stop_ = true;
+  for (auto& worker : workers_) {
+    worker->wake_up.Set();
+    worker->thread.Stop();
+  }
+}
+
+int AudioEncoderPool::AddStream(std::unique_ptr<AudioEncoder> encoder) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  RTC_DCHECK(encoder);
+  const int stream_id = next_stream_id_++;
+  streams_[stream_id].reset(
+      new Stream(std::move(encoder), output_buffer_capacity_));
+  return stream_id;
+}
+
+std::unique_ptr<AudioEncoder> AudioEncoderPool::RemoveStream(int stream_id) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  auto it = streams_.find(stream_id);
+  RTC_CHECK(it != streams_.end());
+  std::unique_ptr<AudioEncoder> encoder = std::move(it->second->encoder);
+  streams_.erase(it);
+  return encoder;
+}
+
+AudioEncoder* AudioEncoderPool::encoder(int stream_id) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  return GetStream(stream_id).encoder.get();
+}
+
+void AudioEncoderPool::EncodeBatch(rtc::ArrayView<const Input> inputs) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  tasks_.clear();
+  for (const Input& input : inputs) {
+    auto it = streams_.find(input.stream_id);
+    RTC_CHECK(it != streams_.end());
+    tasks_.push_back({it->second.get(), input.rtp_timestamp, input.audio,
+                      input.deadline_us});
+  }
+  std::sort(tasks_.begin(), tasks_.end(), [](const Task& a, const Task& b) {
+    if (a.deadline_us != b.deadline_us) {
+      return a.deadline_us < b.deadline_us;
+    }
+    return a.stream->ExpectedEncodeTimeUs() > b.stream->ExpectedEncodeTimeUs();
+  });
+
+  next_task_ = 0;
+  if (workers_.empty() || tasks_.size() < 2) {
+    for (const Task& task : tasks_) {
+      Encode(task);
+    }
+    return;
+  }
+
+  // The calling thread works on the batch as well.
+  num_participants_left_ = static_cast<int>(workers_.size()) + 1;
+  for (auto& worker : workers_) {
+    worker->wake_up.Set();
+  }
+  RunTasks();
+  batch_done_.Wait(rtc::Event::kForever);
+}
+
+const AudioEncoder::EncodedInfo& AudioEncoderPool::encoded_info(
+    int stream_id) const {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  return GetStream(stream_id).info;
+}
+
+const rtc::Buffer& AudioEncoderPool::encoded(int stream_id) const {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  return GetStream(stream_id).encoded;
+}
+
+AudioEncoderPool::StreamStats AudioEncoderPool::GetStreamStats(
+    int stream_id) const {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  return GetStream(stream_id).stats;
+}
+
+void AudioEncoderPool::WorkerThreadFunc(void* context) {
+  Worker* worker = static_cast<Worker*>(context);
+  worker->pool->WorkerLoop(worker);
+}
+
+void AudioEncoderPool::WorkerLoop(Worker* worker) {
+  while (true) {
+    worker->wake_up.Wait(rtc::Event::kForever);
+    if (stop_) {
+      return;
+    }
+    RunTasks();
+  }
+}
+
+void AudioEncoderPool::RunTasks() {
+  const size_t num_tasks = tasks_.size();
+  for (size_t i = next_task_++; i < num_tasks; i = next_task_++) {
+    Encode(tasks_[i]);
+  }
+  // This must be the last access to the batch state, as the thread that
+  // called EncodeBatch() may start a new batch as soon as it is done.
+  if (--num_participants_left_ == 0) {
+    batch_done_.Set();
+  }
+}
+
+void AudioEncoderPool::Encode(const Task& task) {
+  Stream* stream = task.stream;
+  stream->encoded.Clear();
+  const int64_t start_us = rtc::TimeMicros();
+  stream->info =
+      stream->encoder->Encode(task.rtp_timestamp, task.audio, &stream->encoded);
+  const int64_t end_us = rtc::TimeMicros();
+  const int64_t encode_time_us = end_us - start_us;
+
+  StreamStats& stats = stream->stats;
+  ++stats.num_encoded_blocks;
+  stats.total_encode_time_us += encode_time_us;
+  stats.max_encode_time_us = std::max(stats.max_encode_time_us, encode_time_us);
+  if (end_us > task.deadline_us) {
+    ++stats.num_deadline_misses;
+  }
+
+  if (stream->info.encoded_bytes > 0 || stream->info.send_even_if_empty) {
+    stream->num_buffered_blocks = 0;
+    stream->packet_encode_time_us +=
+        kEncodeTimeSmoothing * (encode_time_us - stream->packet_encode_time_us);
+  } else {
+    ++stream->num_buffered_blocks;
+  }
+}
+
+const AudioEncoderPool::Stream& AudioEncoderPool::GetStream(
+    int stream_id) const {
+  auto it = streams_.find(stream_id);
+  RTC_CHECK(it != streams_.end());
+  return *it->second;
+}
+
+}  // namespace webrtc
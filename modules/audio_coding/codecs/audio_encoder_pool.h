@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_CODING_CODECS_AUDIO_ENCODER_POOL_H_
+#define MODULES_AUDIO_CODING_CODECS_AUDIO_ENCODER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "api/array_view.h"
+#include "api/audio_codecs/audio_encoder.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/event.h"
+#include "rtc_base/thread_checker.h"
+
+namespace webrtc {
+
+// Runs many independent AudioEncoders, e.g. one Opus encoder per personalized
+// mix on a conferencing server, on a pool of worker threads. All the streams
+// are fed with a new 10 ms block at the same time by EncodeBatch(), which
+// spreads the blocks over the workers and returns once all of them have been
+// encoded.
+//
+// Within a batch, blocks are encoded in earliest deadline first order, and
+// among blocks with the same deadline the ones expected to take the longest
+// are started first, which keeps the batch as short as possible. The encoded
+// payloads are written into per-stream buffers that are allocated up front
+// and reused from batch to batch.
+//
+// All methods must be called on the same thread, which also takes part in
+// encoding during EncodeBatch().
+class AudioEncoderPool {
+ public:
+  struct Config {
+    // Number of threads encoding in addition to the thread that calls
+    // EncodeBatch().
+    int num_worker_threads = 3;
+    // Initial capacity of each per-stream output buffer, in bytes.
+    size_t output_buffer_capacity = 1500;
+  };
+
+  struct Input {
+    int stream_id;
+    uint32_t rtp_timestamp;
+    // One 10 ms block, as for AudioEncoder::Encode().
+    rtc::ArrayView<const int16_t> audio;
+    // Time, in rtc::TimeMicros(), by which the block should be encoded.
+    int64_t deadline_us;
+  };
+
+  struct StreamStats {
+    int64_t num_encoded_blocks = 0;
+    int64_t total_encode_time_us = 0;
+    int64_t max_encode_time_us = 0;
+    // Number of blocks whose encoding finished after their deadline.
+    int64_t num_deadline_misses = 0;
+  };
+
+  explicit AudioEncoderPool(const Config& config);
+  ~AudioEncoderPool();
+
+  // Adds a stream encoded by |encoder| and returns its id.
+  int AddStream(std::unique_ptr<AudioEncoder> encoder);
+  // Removes the stream |stream_id| and hands its encoder back.
+  std::unique_ptr<AudioEncoder> RemoveStream(int stream_id);
+
+  // Gives access to the encoder of |stream_id|, e.g. to change its target
+  // bitrate between batches.
+  AudioEncoder* encoder(int stream_id);
+
+  // Encodes one 10 ms block for each of |inputs|, which must refer to distinct
+  // streams.
+  void EncodeBatch(rtc::ArrayView<const Input> inputs);
+
+  // Returns the output of the last EncodeBatch() that included |stream_id|.
+  // The payload stays valid until the next such call.
+  const AudioEncoder::EncodedInfo& encoded_info(int stream_id) const;
+  const rtc::Buffer& encoded(int stream_id) const;
+
+  StreamStats GetStreamStats(int stream_id) const;
+
+ private:
+  struct Stream;
+  struct Worker;
+
+  struct Task {
+    Stream* stream;
+    uint32_t rtp_timestamp;
+    rtc::ArrayView<const int16_t> audio;
+    int64_t deadline_us;
+  };
+
+  static void WorkerThreadFunc(void* context);
+  void WorkerLoop(Worker* worker);
+  // Encodes tasks of the current batch until none are left, and then checks
+  // out of the batch.
+  void RunTasks();
+  static void Encode(const Task& task);
+
+  const Stream& GetStream(int stream_id) const;
+
+  rtc::ThreadChecker thread_checker_;
+  std::map<int, std::unique_ptr<Stream>> streams_;
+  int next_stream_id_ = 0;
+  const size_t output_buffer_capacity_;
+
+  // State of the ongoing batch. |tasks_| is only modified while no worker is
+  // running, and each task is claimed by exactly one thread through
+  // |next_task_|.
+  std::vector<Task> tasks_;
+  std::atomic<size_t> next_task_{0};
+  std::atomic<int> num_participants_left_{0};
+  rtc::Event batch_done_;
+
+  std::atomic<bool> stop_{false};
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(AudioEncoderPool);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_CODING_CODECS_AUDIO_ENCODER_POOL_H_
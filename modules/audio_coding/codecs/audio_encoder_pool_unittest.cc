@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/codecs/audio_encoder_pool.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "api/audio_codecs/opus/audio_encoder_opus_config.h"
+#include "modules/audio_coding/codecs/opus/audio_encoder_opus.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kSampleRateHz = 48000;
+constexpr size_t kBlockSize = kSampleRateHz / 100;
+constexpr int kPayloadType = 111;
+constexpr int64_t kNoDeadline = std::numeric_limits<int64_t>::max();
+
+std::unique_ptr<AudioEncoder> CreateOpusEncoder() {
+  AudioEncoderOpusConfig config;
+  config.bitrate_bps = 32000;
+  return std::unique_ptr<AudioEncoder>(
+      new AudioEncoderOpusImpl(config, kPayloadType));
+}
+
+// Produces a different tone for each stream, so that the payloads of the
+// streams differ.
+class ToneGenerator {
+ public:
+  explicit ToneGenerator(int stream_index)
+      : frequency_hz_(200.f + 50.f * stream_index), audio_(kBlockSize) {}
+
+  rtc::ArrayView<const int16_t> NextBlock() {
+    for (int16_t& sample : audio_) {
+      sample = static_cast<int16_t>(
+          8000.f * sinf(2.f * 3.14159265f * frequency_hz_ * sample_index_++ /
+                        kSampleRateHz));
+    }
+    return audio_;
+  }
+
+ private:
+  const float frequency_hz_;
+  std::vector<int16_t> audio_;
+  size_t sample_index_ = 0;
+};
+
+// Feeds |num_streams| Opus streams through a pool.
+class PoolTester {
+ public:
+  PoolTester(int num_worker_threads, int num_streams)
+      : pool_(MakeConfig(num_worker_threads)) {
+    for (int i = 0; i < num_streams; ++i) {
+      stream_ids_.push_back(pool_.AddStream(CreateOpusEncoder()));
+      generators_.emplace_back(i);
+    }
+  }
+
+  AudioEncoderPool& pool() { return pool_; }
+  const std::vector<int>& stream_ids() const { return stream_ids_; }
+
+  // Encodes one block for all streams and returns the audio that was used.
+  std::vector<rtc::ArrayView<const int16_t>> EncodeBatch(int64_t deadline_us) {
+    std::vector<rtc::ArrayView<const int16_t>> audio;
+    std::vector<AudioEncoderPool::Input> inputs;
+    for (size_t i = 0; i < stream_ids_.size(); ++i) {
+      audio.push_back(generators_[i].NextBlock());
+      inputs.push_back({stream_ids_[i], timestamp_, audio.back(), deadline_us});
+    }
+    pool_.EncodeBatch(inputs);
+    timestamp_ += kBlockSize;
+    return audio;
+  }
+
+  uint32_t timestamp() const { return timestamp_; }
+
+ private:
+  static AudioEncoderPool::Config MakeConfig(int num_worker_threads) {
+    AudioEncoderPool::Config config;
+    config.num_worker_threads = num_worker_threads;
+    return config;
+  }
+
+  AudioEncoderPool pool_;
+  std::vector<int> stream_ids_;
+  std::vector<ToneGenerator> generators_;
+  uint32_t timestamp_ = 0;
+};
+
+}  // namespace
+
+TEST(AudioEncoderPoolTest, MatchesSequentialEncoding) {
+  constexpr int kNumStreams = 10;
+  PoolTester tester(3, kNumStreams);
+  std::vector<std::unique_ptr<AudioEncoder>> reference_encoders;
+  for (int i = 0; i < kNumStreams; ++i) {
+    reference_encoders.push_back(CreateOpusEncoder());
+  }
+
+  rtc::Buffer reference_encoded;
+  int num_packets = 0;
+  for (int block = 0; block < 200; ++block) {
+    const uint32_t timestamp = tester.timestamp();
+    const auto audio = tester.EncodeBatch(kNoDeadline);
+    for (int i = 0; i < kNumStreams; ++i) {
+      const int id = tester.stream_ids()[i];
+      reference_encoded.Clear();
+      const AudioEncoder::EncodedInfo info = reference_encoders[i]->Encode(
+          timestamp, audio[i], &reference_encoded);
+      EXPECT_EQ(info.encoded_bytes,
+                tester.pool().encoded_info(id).encoded_bytes);
+      EXPECT_EQ(info.encoded_timestamp,
+                tester.pool().encoded_info(id).encoded_timestamp);
+      EXPECT_EQ(reference_encoded, tester.pool().encoded(id));
+      if (info.encoded_bytes > 0) {
+        ++num_packets;
+      }
+    }
+  }
+  // 20 ms packets.
+  EXPECT_EQ(kNumStreams * 100, num_packets);
+}
+
+TEST(AudioEncoderPoolTest, WorksWithoutWorkerThreads) {
+  PoolTester tester(0, 3);
+  for (int block = 0; block < 10; ++block) {
+    tester.EncodeBatch(kNoDeadline);
+  }
+  for (int id : tester.stream_ids()) {
+    EXPECT_EQ(10, tester.pool().GetStreamStats(id).num_encoded_blocks);
+    EXPECT_GT(tester.pool().encoded_info(id).encoded_bytes, 0u);
+  }
+}
+
+TEST(AudioEncoderPoolTest, CountsEncodedBlocksAndDeadlineMisses) {
+  PoolTester tester(2, 4);
+  for (int block = 0; block < 10; ++block) {
+    tester.EncodeBatch(kNoDeadline);
+  }
+  // All of these are late.
+  for (int block = 0; block < 5; ++block) {
+    tester.EncodeBatch(rtc::TimeMicros() - 1000);
+  }
+  for (int id : tester.stream_ids()) {
+    const AudioEncoderPool::StreamStats stats =
+        tester.pool().GetStreamStats(id);
+    EXPECT_EQ(15, stats.num_encoded_blocks);
+    EXPECT_EQ(5, stats.num_deadline_misses);
+    EXPECT_GE(stats.total_encode_time_us, stats.max_encode_time_us);
+  }
+}
+
+TEST(AudioEncoderPoolTest, EncodesSubsetOfStreams) {
+  PoolTester tester(2, 4);
+  tester.EncodeBatch(kNoDeadline);
+  ToneGenerator generator(0);
+  const AudioEncoderPool::Input input = {tester.stream_ids()[1], 0,
+                                         generator.NextBlock(), kNoDeadline};
+  tester.pool().EncodeBatch(
+      rtc::ArrayView<const AudioEncoderPool::Input>(&input, 1));
+  EXPECT_EQ(1, tester.pool().GetStreamStats(tester.stream_ids()[0])
+                   .num_encoded_blocks);
+  EXPECT_EQ(2, tester.pool().GetStreamStats(tester.stream_ids()[1])
+                   .num_encoded_blocks);
+}
+
+TEST(AudioEncoderPoolTest, RemoveStreamReturnsEncoder) {
+  PoolTester tester(1, 2);
+  AudioEncoder* encoder = tester.pool().encoder(tester.stream_ids()[0]);
+  std::unique_ptr<AudioEncoder> removed =
+      tester.pool().RemoveStream(tester.stream_ids()[0]);
+  EXPECT_EQ(encoder, removed.get());
+
+  const int id = tester.pool().AddStream(std::move(removed));
+  EXPECT_NE(tester.stream_ids()[0], id);
+  EXPECT_EQ(encoder, tester.pool().encoder(id));
+}
+
+// Measures how many 10 ms batches of 100 Opus streams can be encoded per
+// second for different numbers of worker threads.
+TEST(AudioEncoderPoolTest, DISABLED_Benchmark) {
+  constexpr int kNumStreams = 100;
+  constexpr int kNumBlocks = 500;
+  double single_thread_us = 0.0;
+  for (int num_worker_threads : {0, 1, 3, 7}) {
+    PoolTester tester(num_worker_threads, kNumStreams);
+    int64_t max_batch_us = 0;
+    const int64_t start_us = rtc::TimeMicros();
+    for (int block = 0; block < kNumBlocks; ++block) {
+      const int64_t batch_start_us = rtc::TimeMicros();
+      tester.EncodeBatch(batch_start_us + 10000);
+      max_batch_us =
+          std::max(max_batch_us, rtc::TimeMicros() - batch_start_us);
+    }
+    const double us_per_batch =
+        static_cast<double>(rtc::TimeMicros() - start_us) / kNumBlocks;
+    if (num_worker_threads == 0) {
+      single_thread_us = us_per_batch;
+    }
+    int64_t num_deadline_misses = 0;
+    for (int id : tester.stream_ids()) {
+      num_deadline_misses +=
+          tester.pool().GetStreamStats(id).num_deadline_misses;
+    }
+    printf(
+        "%d worker threads: %.0f us per batch (%.2fx), max %d us, "
+        "%.1fx realtime, %d deadline misses\n",
+        num_worker_threads, us_per_batch, single_thread_us / us_per_batch,
+        static_cast<int>(max_batch_us), 10000.0 / us_per_batch,
+        static_cast<int>(num_deadline_misses));
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+
+#include <memory>
+#include <vector>
+
+#include "api/audio/audio_frame.h"
+#include "api/audio_codecs/L16/audio_decoder_L16.h"
+#include "api/audio_codecs/audio_decoder_factory_template.h"
+#include "modules/audio_coding/neteq/include/neteq.h"
+#include "rtc_base/checks.h"
+#include "test/gtest.h"
+#include "test/testsupport/microbenchmark.h"
+
+namespace webrtc {
+
+// Gets 10 ms of audio from a NetEq that receives a 48 kHz L16 packet of 20 ms
+// every other call, like the NetEq of a call on a good network does.
+TEST(AudioCodingMicrobenchmark, NetEqGetAudio) {
+  constexpr int kSampleRateHz = 48000;
+  constexpr int kPayloadType = 96;
+  constexpr size_t kSamplesPerPacket = kSampleRateHz / 50;
+  NetEq::Config config;
+  config.sample_rate_hz = kSampleRateHz;
+  std::unique_ptr<NetEq> neteq(NetEq::Create(
+      config, CreateAudioDecoderFactory<AudioDecoderL16>()));
+  ASSERT_TRUE(neteq->RegisterPayloadType(
+      kPayloadType, SdpAudioFormat("l16", kSampleRateHz, 1)));
+
+  // A 1 kHz tone, in network byte order.
+  std::vector<uint8_t> payload(kSamplesPerPacket * 2);
+  for (size_t i = 0; i < kSamplesPerPacket; ++i) {
+    const int16_t sample = static_cast<int16_t>(
+        10000 * sin(2 * M_PI * 1000 * i / kSampleRateHz));
+    payload[2 * i] = static_cast<uint16_t>(sample) >> 8;
+    payload[2 * i + 1] = static_cast<uint16_t>(sample) & 0xff;
+  }
+  RTPHeader header;
+  header.payloadType = kPayloadType;
+  header.ssrc = 0x12345678;
+  uint32_t receive_timestamp = 0;
+  auto insert_packet = [&] {
+    RTC_CHECK_EQ(NetEq::kOK,
+                 neteq->InsertPacket(header, payload, receive_timestamp));
+    ++header.sequenceNumber;
+    header.timestamp += kSamplesPerPacket;
+    receive_timestamp += kSamplesPerPacket;
+  };
+  insert_packet();
+  insert_packet();
+
+  AudioFrame frame;
+  bool muted = false;
+  int num_calls = 0;
+  test::RunMicrobenchmark("NetEqGetAudio", [&] {
+    if (++num_calls % 2 == 0)
+      insert_packet();
+    RTC_CHECK_EQ(NetEq::kOK, neteq->GetAudio(&frame, &muted));
+  });
+  EXPECT_FALSE(muted);
+  EXPECT_EQ(frame.samples_per_channel_, kSamplesPerPacket / 2);
+}
+
+}  // namespace webrtc
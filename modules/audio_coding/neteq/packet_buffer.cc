@@ -8,14 +8,13 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
-// This is the implementation of the PacketBuffer class. It is mostly based on
-// an STL list. The list is kept sorted at all times so that the next packet to
-// decode is at the beginning of the list.
+// This is the implementation of the PacketBuffer class. The packets are kept
+// sorted at all times so that the next packet to decode is at the beginning of
+// the buffer.
 
 #include "modules/audio_coding/neteq/packet_buffer.h"
 
 #include <algorithm>
-#include <list>
 #include <memory>
 #include <type_traits>
 #include <utility>
@@ -29,18 +28,6 @@
 
 namespace webrtc {
 namespace {
-// Predicate used when inserting packets in the buffer list.
-// Operator() returns true when |packet| goes before |new_packet|.
-class NewTimestampIsLarger {
- public:
-  explicit NewTimestampIsLarger(const Packet& new_packet)
-      : new_packet_(new_packet) {}
-  bool operator()(const Packet& packet) { return (new_packet_ >= packet); }
-
- private:
-  const Packet& new_packet_;
-};
-
 // Returns true if both payload types are known to the decoder database, and
 // have the same sample rate.
 bool EqualSampleRates(uint8_t pt1,
@@ -64,7 +51,11 @@ void LogPacketDiscarded(int codec_level, StatisticsCalculator* stats) {
 
 PacketBuffer::PacketBuffer(size_t max_number_of_packets,
                            const TickTimer* tick_timer)
-    : max_number_of_packets_(max_number_of_packets), tick_timer_(tick_timer) {}
+    : max_number_of_packets_(max_number_of_packets),
+      // A full buffer is flushed before the next packet is inserted, so there
+      // is always room for at least one packet.
+      slots_(std::max<size_t>(max_number_of_packets, 1)),
+      tick_timer_(tick_timer) {}
 
 // Destructor. All packets in the buffer will be destroyed.
 PacketBuffer::~PacketBuffer() {
@@ -73,11 +64,15 @@ PacketBuffer::~PacketBuffer() {
 
 // Flush the buffer. All packets in the buffer will be destroyed.
 void PacketBuffer::Flush() {
-  buffer_.clear();
+  for (size_t i = 0; i < num_packets_; ++i) {
+    PacketAt(i) = Packet();
+  }
+  first_packet_ = 0;
+  num_packets_ = 0;
 }
 
 bool PacketBuffer::Empty() const {
-  return buffer_.empty();
+  return num_packets_ == 0;
 }
 
 int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
@@ -93,7 +88,7 @@ int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
 
   packet.waiting_time = tick_timer_->GetNewStopwatch();
 
-  if (buffer_.size() >= max_number_of_packets_) {
+  if (num_packets_ >= max_number_of_packets_) {
     // Buffer is full. Flush it.
     Flush();
     stats->FlushedPacketBuffer();
@@ -101,29 +96,26 @@ int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
     return_val = kFlushed;
   }
 
-  // Get an iterator pointing to the place in the buffer where the new packet
-  // should be inserted. The list is searched from the back, since the most
-  // likely case is that the new packet should be near the end of the list.
-  PacketList::reverse_iterator rit = std::find_if(
-      buffer_.rbegin(), buffer_.rend(), NewTimestampIsLarger(packet));
+  // Find the position in the buffer where the new packet should be inserted.
+  const size_t index = UpperBound(packet);
 
-  // The new packet is to be inserted to the right of |rit|. If it has the same
-  // timestamp as |rit|, which has a higher priority, do not insert the new
-  // packet to list.
-  if (rit != buffer_.rend() && packet.timestamp == rit->timestamp) {
+  // The new packet is to be inserted after the packet at |index| - 1. If it
+  // has the same timestamp as that packet, which has a higher priority, do not
+  // insert the new packet.
+  if (index > 0 && packet.timestamp == PacketAt(index - 1).timestamp) {
     LogPacketDiscarded(packet.priority.codec_level, stats);
     return return_val;
   }
 
-  // The new packet is to be inserted to the left of |it|. If it has the same
-  // timestamp as |it|, which has a lower priority, replace |it| with the new
-  // packet.
-  PacketList::iterator it = rit.base();
-  if (it != buffer_.end() && packet.timestamp == it->timestamp) {
-    LogPacketDiscarded(it->priority.codec_level, stats);
-    it = buffer_.erase(it);
+  // The new packet is to be inserted before the packet at |index|. If it has
+  // the same timestamp as that packet, which has a lower priority, replace it
+  // with the new packet.
+  if (index < num_packets_ && packet.timestamp == PacketAt(index).timestamp) {
+    LogPacketDiscarded(PacketAt(index).priority.codec_level, stats);
+    PacketAt(index) = std::move(packet);
+    return return_val;
   }
-  buffer_.insert(it, std::move(packet));  // Insert the packet at that position.
+  InsertAt(index, std::move(packet));
 
   return return_val;
 }
@@ -181,7 +173,7 @@ int PacketBuffer::NextTimestamp(uint32_t* next_timestamp) const {
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  *next_timestamp = buffer_.front().timestamp;
+  *next_timestamp = PacketAt(0).timestamp;
   return kOK;
 }
 
@@ -193,11 +185,11 @@ int PacketBuffer::NextHigherTimestamp(uint32_t timestamp,
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  PacketList::const_iterator it;
-  for (it = buffer_.begin(); it != buffer_.end(); ++it) {
-    if (it->timestamp >= timestamp) {
+  for (size_t i = 0; i < num_packets_; ++i) {
+    const Packet& packet = PacketAt(i);
+    if (packet.timestamp >= timestamp) {
       // Found a packet matching the search.
-      *next_timestamp = it->timestamp;
+      *next_timestamp = packet.timestamp;
       return kOK;
     }
   }
@@ -205,7 +197,7 @@ int PacketBuffer::NextHigherTimestamp(uint32_t timestamp,
 }
 
 const Packet* PacketBuffer::PeekNextPacket() const {
-  return buffer_.empty() ? nullptr : &buffer_.front();
+  return Empty() ? nullptr : &PacketAt(0);
 }
 
 absl::optional<Packet> PacketBuffer::GetNextPacket() {
@@ -214,10 +206,10 @@ absl::optional<Packet> PacketBuffer::GetNextPacket() {
     return absl::nullopt;
   }
 
-  absl::optional<Packet> packet(std::move(buffer_.front()));
+  absl::optional<Packet> packet(std::move(PacketAt(0)));
   // Assert that the packet sanity checks in InsertPacket method works.
   RTC_DCHECK(!packet->empty());
-  buffer_.pop_front();
+  PopFront();
 
   return packet;
 }
@@ -227,24 +219,35 @@ int PacketBuffer::DiscardNextPacket(StatisticsCalculator* stats) {
     return kBufferEmpty;
   }
   // Assert that the packet sanity checks in InsertPacket method works.
-  const Packet& packet = buffer_.front();
+  const Packet& packet = PacketAt(0);
   RTC_DCHECK(!packet.empty());
   LogPacketDiscarded(packet.priority.codec_level, stats);
-  buffer_.pop_front();
+  PopFront();
   return kOK;
 }
 
 void PacketBuffer::DiscardOldPackets(uint32_t timestamp_limit,
                                      uint32_t horizon_samples,
                                      StatisticsCalculator* stats) {
-  buffer_.remove_if([timestamp_limit, horizon_samples, stats](const Packet& p) {
-    if (timestamp_limit == p.timestamp ||
-        !IsObsoleteTimestamp(p.timestamp, timestamp_limit, horizon_samples)) {
-      return false;
-    }
-    LogPacketDiscarded(p.priority.codec_level, stats);
-    return true;
-  });
+  auto is_obsolete = [timestamp_limit, horizon_samples](const Packet& p) {
+    return timestamp_limit != p.timestamp &&
+           IsObsoleteTimestamp(p.timestamp, timestamp_limit, horizon_samples);
+  };
+  // The packets are sorted, so the obsolete ones are at the front of the
+  // buffer, unless there are packets that are even older than the horizon.
+  while (!Empty() && is_obsolete(PacketAt(0))) {
+    LogPacketDiscarded(PacketAt(0).priority.codec_level, stats);
+    PopFront();
+  }
+  if (!Empty() && IsNewerTimestamp(timestamp_limit, PacketAt(0).timestamp)) {
+    RemoveIf([&is_obsolete, stats](const Packet& p) {
+      if (!is_obsolete(p)) {
+        return false;
+      }
+      LogPacketDiscarded(p.priority.codec_level, stats);
+      return true;
+    });
+  }
 }
 
 void PacketBuffer::DiscardAllOldPackets(uint32_t timestamp_limit,
@@ -254,7 +257,7 @@ void PacketBuffer::DiscardAllOldPackets(uint32_t timestamp_limit,
 
 void PacketBuffer::DiscardPacketsWithPayloadType(uint8_t payload_type,
                                                  StatisticsCalculator* stats) {
-  buffer_.remove_if([payload_type, stats](const Packet& p) {
+  RemoveIf([payload_type, stats](const Packet& p) {
     if (p.payload_type != payload_type) {
       return false;
     }
@@ -264,13 +267,14 @@ void PacketBuffer::DiscardPacketsWithPayloadType(uint8_t payload_type,
 }
 
 size_t PacketBuffer::NumPacketsInBuffer() const {
-  return buffer_.size();
+  return num_packets_;
 }
 
 size_t PacketBuffer::NumSamplesInBuffer(size_t last_decoded_length) const {
   size_t num_samples = 0;
   size_t last_duration = last_decoded_length;
-  for (const Packet& packet : buffer_) {
+  for (size_t i = 0; i < num_packets_; ++i) {
+    const Packet& packet = PacketAt(i);
     if (packet.frame) {
       // TODO(hlundin): Verify that it's fine to count all packets and remove
       // this check.
@@ -288,13 +292,14 @@ size_t PacketBuffer::NumSamplesInBuffer(size_t last_decoded_length) const {
 }
 
 size_t PacketBuffer::GetSpanSamples(size_t last_decoded_length) const {
-  if (buffer_.size() == 0) {
+  if (num_packets_ == 0) {
     return 0;
   }
 
-  size_t span = buffer_.back().timestamp - buffer_.front().timestamp;
-  if (buffer_.back().frame && buffer_.back().frame->Duration() > 0) {
-    span += buffer_.back().frame->Duration();
+  const Packet& last_packet = PacketAt(num_packets_ - 1);
+  size_t span = last_packet.timestamp - PacketAt(0).timestamp;
+  if (last_packet.frame && last_packet.frame->Duration() > 0) {
+    span += last_packet.frame->Duration();
   } else {
     span += last_decoded_length;
   }
@@ -304,7 +309,8 @@ size_t PacketBuffer::GetSpanSamples(size_t last_decoded_length) const {
 bool PacketBuffer::ContainsDtxOrCngPacket(
     const DecoderDatabase* decoder_database) const {
   RTC_DCHECK(decoder_database);
-  for (const Packet& packet : buffer_) {
+  for (size_t i = 0; i < num_packets_; ++i) {
+    const Packet& packet = PacketAt(i);
     if ((packet.frame && packet.frame->IsDtxPacket()) ||
         decoder_database->IsComfortNoise(packet.payload_type)) {
       return true;
@@ -313,4 +319,73 @@ bool PacketBuffer::ContainsDtxOrCngPacket(
   return false;
 }
 
+Packet& PacketBuffer::PacketAt(size_t index) {
+  RTC_DCHECK_LT(index, slots_.size());
+  const size_t slot = first_packet_ + index;
+  return slots_[slot < slots_.size() ? slot : slot - slots_.size()];
+}
+
+const Packet& PacketBuffer::PacketAt(size_t index) const {
+  RTC_DCHECK_LT(index, slots_.size());
+  const size_t slot = first_packet_ + index;
+  return slots_[slot < slots_.size() ? slot : slot - slots_.size()];
+}
+
+size_t PacketBuffer::UpperBound(const Packet& packet) const {
+  // Packets most often arrive in order, so check the end of the buffer first.
+  if (num_packets_ == 0 || packet >= PacketAt(num_packets_ - 1)) {
+    return num_packets_;
+  }
+  // Binary search for the first packet that goes after |packet|. The packets
+  // in the buffer span less than half the timestamp range, so the wrap-around
+  // aware ordering is consistent within it.
+  size_t low = 0;
+  size_t high = num_packets_ - 1;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    if (packet >= PacketAt(middle)) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+void PacketBuffer::InsertAt(size_t index, Packet&& packet) {
+  RTC_DCHECK_LE(index, num_packets_);
+  RTC_DCHECK_LT(num_packets_, slots_.size());
+  // Reordered packets are usually close to the end, so make room by moving the
+  // later packets.
+  for (size_t i = num_packets_; i > index; --i) {
+    PacketAt(i) = std::move(PacketAt(i - 1));
+  }
+  PacketAt(index) = std::move(packet);
+  ++num_packets_;
+}
+
+void PacketBuffer::PopFront() {
+  RTC_DCHECK_GT(num_packets_, 0);
+  PacketAt(0) = Packet();
+  first_packet_ = first_packet_ + 1 < slots_.size() ? first_packet_ + 1 : 0;
+  --num_packets_;
+}
+
+template <typename Predicate>
+void PacketBuffer::RemoveIf(Predicate predicate) {
+  size_t num_kept = 0;
+  for (size_t i = 0; i < num_packets_; ++i) {
+    Packet& packet = PacketAt(i);
+    if (predicate(packet)) {
+      packet = Packet();
+    } else {
+      if (num_kept != i) {
+        PacketAt(num_kept) = std::move(packet);
+      }
+      ++num_kept;
+    }
+  }
+  num_packets_ = num_kept;
+}
+
 }  // namespace webrtc
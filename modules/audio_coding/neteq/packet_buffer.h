@@ -11,6 +11,11 @@
 #ifndef MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 #define MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "modules/audio_coding/neteq/decoder_database.h"
 #include "modules/audio_coding/neteq/packet.h"
@@ -23,7 +28,10 @@ class DecoderDatabase;
 class StatisticsCalculator;
 class TickTimer;
 
-// This is the actual buffer holding the packets before decoding.
+// This is the actual buffer holding the packets before decoding. The packets
+// are kept sorted on timestamp in a ring of preallocated slots, so that the
+// common cases of inserting a packet at the end and extracting one from the
+// front take constant time and do not allocate.
 class PacketBuffer {
  public:
   enum BufferReturnCodes {
@@ -144,8 +152,31 @@ class PacketBuffer {
   }
 
  private:
+  // Returns the packet at position |index| in timestamp order.
+  Packet& PacketAt(size_t index);
+  const Packet& PacketAt(size_t index) const;
+
+  // Returns the position at which |packet| should be inserted to keep the
+  // buffer sorted, i.e. the position of the first packet that goes after it.
+  size_t UpperBound(const Packet& packet) const;
+
+  // Inserts |packet| at position |index|, moving the later packets one step.
+  void InsertAt(size_t index, Packet&& packet);
+
+  // Removes the first packet.
+  void PopFront();
+
+  // Removes the packets for which |predicate| returns true, keeping the order
+  // of the remaining ones.
+  template <typename Predicate>
+  void RemoveIf(Predicate predicate);
+
   size_t max_number_of_packets_;
-  PacketList buffer_;
+  // Ring of |max_number_of_packets_| slots, of which |num_packets_| starting
+  // at |first_packet_| are in use.
+  std::vector<Packet> slots_;
+  size_t first_packet_ = 0;
+  size_t num_packets_ = 0;
   const TickTimer* tick_timer_;
   RTC_DISALLOW_COPY_AND_ASSIGN(PacketBuffer);
 };
@@ -11,11 +11,18 @@
 // Unit tests for PacketBuffer class.
 
 #include "modules/audio_coding/neteq/packet_buffer.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "api/audio_codecs/builtin_audio_decoder_factory.h"
 #include "modules/audio_coding/neteq/mock/mock_decoder_database.h"
 #include "modules/audio_coding/neteq/mock/mock_statistics_calculator.h"
 #include "modules/audio_coding/neteq/packet.h"
+#include "modules/audio_coding/neteq/statistics_calculator.h"
 #include "modules/audio_coding/neteq/tick_timer.h"
+#include "rtc_base/time_utils.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
@@ -434,6 +441,48 @@ TEST(PacketBuffer, Reordering) {
   EXPECT_CALL(decoder_database, Die());  // Called when object is deleted.
 }
 
+// Keeps a few packets in a small buffer while inserting and extracting many,
+// so that the packets wrap around the end of the buffer storage, with some of
+// them reordered.
+TEST(PacketBuffer, ReorderingWhileWrappingAround) {
+  TickTimer tick_timer;
+  PacketBuffer buffer(10, &tick_timer);  // 10 packets.
+  const uint32_t ts_increment = 10;
+  PacketGenerator gen(0, 0, 0, ts_increment);
+  StrictMock<MockStatisticsCalculator> mock_stats;
+
+  uint32_t next_extracted_ts = 0;
+  for (int i = 0; i < 100; i += 2) {
+    Packet first = gen.NextPacket(10);
+    Packet second = gen.NextPacket(10);
+    if (i % 6 == 0) {
+      std::swap(first, second);
+    }
+    EXPECT_EQ(PacketBuffer::kOK,
+              buffer.InsertPacket(std::move(first), &mock_stats));
+    EXPECT_EQ(PacketBuffer::kOK,
+              buffer.InsertPacket(std::move(second), &mock_stats));
+    while (buffer.NumPacketsInBuffer() > 5) {
+      const absl::optional<Packet> packet = buffer.GetNextPacket();
+      ASSERT_TRUE(packet);
+      EXPECT_EQ(next_extracted_ts, packet->timestamp);
+      next_extracted_ts += ts_increment;
+    }
+    EXPECT_EQ(std::min<size_t>(i + 2, 5) * ts_increment,
+              buffer.GetSpanSamples(ts_increment));
+  }
+
+  // Discard the packets up to the last one, which are stored on both sides of
+  // the end of the buffer storage.
+  EXPECT_CALL(mock_stats, PacketsDiscarded(1)).Times(4);
+  buffer.DiscardAllOldPackets(next_extracted_ts + 4 * ts_increment,
+                              &mock_stats);
+  EXPECT_EQ(1u, buffer.NumPacketsInBuffer());
+  uint32_t next_ts;
+  EXPECT_EQ(PacketBuffer::kOK, buffer.NextTimestamp(&next_ts));
+  EXPECT_EQ(next_extracted_ts + 4 * ts_increment, next_ts);
+}
+
 // The test first inserts a packet with narrow-band CNG, then a packet with
 // wide-band speech. The expected behavior of the packet buffer is to detect a
 // change in sample rate, even though no speech packet has been inserted before,
@@ -735,4 +784,54 @@ TEST(PacketBuffer, IsObsoleteTimestamp) {
   TestIsObsoleteTimestamp(0x80000001);  // 2^31 + 1.
   TestIsObsoleteTimestamp(0x7FFFFFFF);  // 2^31 - 1.
 }
+
+// Measures the cost of inserting and extracting packets with 1 and 2 seconds
+// of audio in the buffer. Every packet arrives twice, the second time as the
+// redundant payload of a RED packet, and every tenth packet is reordered. For
+// each packet, the buffer is also pruned and queried like NetEq does when
+// deciding on the next operation.
+TEST(PacketBuffer, DISABLED_Benchmark) {
+  constexpr int kFrameSizeSamples = 960;  // 20 ms at 48 kHz.
+  constexpr int kNumPackets = 200000;
+  for (int buffer_ms : {1000, 2000}) {
+    TickTimer tick_timer;
+    StatisticsCalculator stats;
+    PacketBuffer buffer(200, &tick_timer);
+    PacketGenerator gen(0, 0, 0, kFrameSizeSamples);
+    const size_t num_buffered = buffer_ms / 20;
+    std::vector<Packet> packets;
+    for (int i = 0; i < kNumPackets; ++i) {
+      packets.push_back(gen.NextPacket(100));
+    }
+    for (int i = 10; i < kNumPackets; i += 10) {
+      std::swap(packets[i - 1], packets[i]);
+    }
+    std::vector<Packet> redundant_packets;
+    for (const Packet& packet : packets) {
+      redundant_packets.push_back(packet.Clone());
+      redundant_packets.back().priority = Packet::Priority(0, 1);
+    }
+
+    size_t checksum = 0;
+    const int64_t start_us = rtc::TimeMicros();
+    for (int i = 0; i < kNumPackets; ++i) {
+      if (i > 0) {
+        buffer.InsertPacket(std::move(redundant_packets[i - 1]), &stats);
+      }
+      buffer.InsertPacket(std::move(packets[i]), &stats);
+      uint32_t next_ts = 0;
+      buffer.NextTimestamp(&next_ts);
+      buffer.DiscardOldPackets(next_ts, 5 * 48000, &stats);
+      checksum += buffer.NumSamplesInBuffer(kFrameSizeSamples) +
+                  buffer.GetSpanSamples(kFrameSizeSamples);
+      if (buffer.NumPacketsInBuffer() > num_buffered) {
+        checksum += buffer.GetNextPacket()->timestamp;
+      }
+    }
+    const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+    printf("%d ms buffer: %.0f ns per packet (checksum %zu)\n", buffer_ms,
+           1000.0 * elapsed_us / kNumPackets, checksum);
+  }
+}
+
 }  // namespace webrtc
@@ -32,9 +32,6 @@ struct SourceFrame {
       : source_status(source_status), audio_frame(audio_frame), muted(muted) {
     RTC_DCHECK(source_status);
     RTC_DCHECK(audio_frame);
-    if (!muted) {
-      energy = AudioMixerCalculateEnergy(*audio_frame);
-    }
   }
 
   SourceFrame(AudioMixerImpl::SourceStatus* source_status,
@@ -140,6 +137,7 @@ void AudioMixerImpl::CalculateOutputFrequency() {
   rtc::CritScope lock(&crit_);
 
   std::vector<int> preferred_rates;
+  preferred_rates.reserve(audio_source_list_.size());
   std::transform(audio_source_list_.begin(), audio_source_list_.end(),
                  std::back_inserter(preferred_rates),
                  [&](std::unique_ptr<SourceStatus>& a) {
@@ -177,10 +175,16 @@ void AudioMixerImpl::RemoveSource(Source* audio_source) {
 AudioFrameList AudioMixerImpl::GetAudioFromSources() {
   RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
   AudioFrameList result;
+  result.reserve(kMaximumAmountOfMixedAudioSources);
   std::vector<SourceFrame> audio_source_mixing_data_list;
+  audio_source_mixing_data_list.reserve(audio_source_list_.size());
   std::vector<SourceFrame> ramp_list;
+  ramp_list.reserve(audio_source_list_.size());
 
   // Get audio from the audio sources and put it in the SourceFrame vector.
+  // The sources write their audio directly into the frames owned by the
+  // mixer, at the mixing rate.
+  size_t num_unmuted_frames = 0;
   for (auto& source_and_status : audio_source_list_) {
     const auto audio_frame_info =
         source_and_status->audio_source->GetAudioFrameWithInfo(
@@ -190,9 +194,25 @@ AudioFrameList AudioMixerImpl::GetAudioFromSources() {
       RTC_LOG_F(LS_WARNING) << "failed to GetAudioFrameWithInfo() from source";
       continue;
     }
+    const bool muted = audio_frame_info == Source::AudioFrameInfo::kMuted;
     audio_source_mixing_data_list.emplace_back(
-        source_and_status.get(), &source_and_status->audio_frame,
-        audio_frame_info == Source::AudioFrameInfo::kMuted);
+        source_and_status.get(), &source_and_status->audio_frame, muted);
+    if (!muted) {
+      ++num_unmuted_frames;
+    }
+  }
+
+  // The energy only decides which frames to mix when there are more unmuted
+  // frames than can be mixed, which saves a pass over the audio of every
+  // source in calls with few active ones.
+  if (num_unmuted_frames >
+      static_cast<size_t>(kMaximumAmountOfMixedAudioSources)) {
+    for (auto& source_frame : audio_source_mixing_data_list) {
+      if (!source_frame.muted) {
+        source_frame.energy =
+            AudioMixerCalculateEnergy(*source_frame.audio_frame);
+      }
+    }
   }
 
   // Sort frames by sorting function.
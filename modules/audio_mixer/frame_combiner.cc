@@ -79,21 +79,27 @@ void MixToFloatFrame(const std::vector<AudioFrame*>& mix_list,
                      MixingBuffer* mixing_buffer) {
   RTC_DCHECK_LE(samples_per_channel, FrameCombiner::kMaximumChannelSize);
   RTC_DCHECK_LE(number_of_channels, FrameCombiner::kMaximumNumberOfChannels);
-  // Clear the mixing buffer.
-  for (auto& one_channel_buffer : *mixing_buffer) {
-    std::fill(one_channel_buffer.begin(), one_channel_buffer.end(), 0.f);
-  }
-
-  // Convert to FloatS16 and mix.
-  for (size_t i = 0; i < mix_list.size(); ++i) {
-    const AudioFrame* const frame = mix_list[i];
-    for (size_t j = 0; j < std::min(number_of_channels,
-                                    FrameCombiner::kMaximumNumberOfChannels);
-         ++j) {
-      for (size_t k = 0; k < std::min(samples_per_channel,
-                                      FrameCombiner::kMaximumChannelSize);
-           ++k) {
-        (*mixing_buffer)[j][k] += frame->data()[number_of_channels * k + j];
+  const size_t num_channels =
+      std::min(number_of_channels, FrameCombiner::kMaximumNumberOfChannels);
+  const size_t num_samples =
+      std::min(samples_per_channel, FrameCombiner::kMaximumChannelSize);
+
+  // Convert to FloatS16 and mix. The first frame initializes the part of the
+  // mixing buffer that is used, so that it does not have to be cleared.
+  for (size_t j = 0; j < num_channels; ++j) {
+    float* const channel = (*mixing_buffer)[j].data();
+    if (mix_list.empty()) {
+      std::fill(channel, channel + num_samples, 0.f);
+      continue;
+    }
+    const int16_t* const first = mix_list[0]->data();
+    for (size_t k = 0; k < num_samples; ++k) {
+      channel[k] = first[number_of_channels * k + j];
+    }
+    for (size_t i = 1; i < mix_list.size(); ++i) {
+      const int16_t* const data = mix_list[i]->data();
+      for (size_t k = 0; k < num_samples; ++k) {
+        channel[k] += data[number_of_channels * k + j];
       }
     }
   }
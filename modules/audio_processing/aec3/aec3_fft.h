@@ -14,9 +14,9 @@
 #include <array>
 
 #include "api/array_view.h"
+#include "common_audio/fft/real_fft.h"
 #include "modules/audio_processing/aec3/aec3_common.h"
 #include "modules/audio_processing/aec3/fft_data.h"
-#include "modules/audio_processing/utility/ooura_fft.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/constructor_magic.h"
 
@@ -28,19 +28,19 @@ class Aec3Fft {
  public:
   enum class Window { kRectangular, kHanning, kSqrtHanning };
 
-  Aec3Fft() = default;
+  Aec3Fft() : fft_(kFftLength) {}
   // Computes the FFT. Note that both the input and output are modified.
   void Fft(std::array<float, kFftLength>* x, FftData* X) const {
     RTC_DCHECK(x);
     RTC_DCHECK(X);
-    ooura_fft_.Fft(x->data());
+    fft_.Forward(x->data());
     X->CopyFromPackedArray(*x);
   }
   // Computes the inverse Fft.
   void Ifft(const FftData& X, std::array<float, kFftLength>* x) const {
     RTC_DCHECK(x);
     X.CopyToPackedArray(x);
-    ooura_fft_.InverseFft(x->data());
+    fft_.Inverse(x->data());
   }
 
   // Windows the input using a Hanning window, and then adds padding of
@@ -64,7 +64,7 @@ class Aec3Fft {
                  FftData* X) const;
 
  private:
-  const OouraFft ooura_fft_;
+  const RealFft fft_;
 
   RTC_DISALLOW_COPY_AND_ASSIGN(Aec3Fft);
 };
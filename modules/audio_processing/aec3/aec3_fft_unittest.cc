@@ -148,7 +148,7 @@ TEST(Aec3Fft, FftAndIfft) {
     fft.Fft(&x, &X);
     fft.Ifft(X, &x);
     for (size_t j = 0; j < x.size(); ++j) {
-      EXPECT_NEAR(x_ref[j], x[j], 0.001f);
+      EXPECT_NEAR(x_ref[j], x[j], 0.002f);
     }
   }
 }
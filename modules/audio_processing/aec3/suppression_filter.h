@@ -17,7 +17,6 @@
 #include "modules/audio_processing/aec3/aec3_common.h"
 #include "modules/audio_processing/aec3/aec3_fft.h"
 #include "modules/audio_processing/aec3/fft_data.h"
-#include "modules/audio_processing/utility/ooura_fft.h"
 #include "rtc_base/constructor_magic.h"
 
 namespace webrtc {
@@ -36,7 +35,6 @@ class SuppressionFilter {
  private:
   const Aec3Optimization optimization_;
   const int sample_rate_hz_;
-  const OouraFft ooura_fft_;
   const Aec3Fft fft_;
   std::vector<std::array<float, kFftLengthBy2>> e_output_old_;
   RTC_DISALLOW_COPY_AND_ASSIGN(SuppressionFilter);
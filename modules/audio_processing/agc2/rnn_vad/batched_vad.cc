@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/agc2/rnn_vad/batched_vad.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace rnn_vad {
+
+BatchedVad::BatchedVad(size_t num_streams)
+    : BatchedVad(num_streams, DetectOptimization()) {}
+
+BatchedVad::BatchedVad(size_t num_streams, Optimization optimization)
+    : rnn_vad_(num_streams, optimization),
+      feature_vectors_(num_streams * kFeatureVectorSize),
+      is_silence_(new bool[num_streams]) {
+  features_extractors_.reserve(num_streams);
+  for (size_t i = 0; i < num_streams; ++i) {
+    features_extractors_.push_back(absl::make_unique<FeaturesExtractor>());
+  }
+  std::fill(is_silence_.get(), is_silence_.get() + num_streams, true);
+}
+
+BatchedVad::~BatchedVad() = default;
+
+void BatchedVad::Reset() {
+  for (auto& features_extractor : features_extractors_) {
+    features_extractor->Reset();
+  }
+  rnn_vad_.Reset();
+  std::fill(is_silence_.get(), is_silence_.get() + num_streams(), true);
+}
+
+void BatchedVad::ComputeFeatures(
+    size_t stream_index,
+    rtc::ArrayView<const float, kFrameSize10ms24kHz> frame) {
+  RTC_DCHECK_LT(stream_index, num_streams());
+  is_silence_[stream_index] =
+      features_extractors_[stream_index]->CheckSilenceComputeFeatures(
+          frame, {&feature_vectors_[stream_index * kFeatureVectorSize],
+                  kFeatureVectorSize});
+}
+
+void BatchedVad::ComputeVadProbabilities(
+    rtc::ArrayView<float> vad_probabilities) {
+  rnn_vad_.ComputeVadProbabilities(
+      feature_vectors_, {is_silence_.get(), num_streams()}, vad_probabilities);
+}
+
+}  // namespace rnn_vad
+}  // namespace webrtc
@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_AGC2_RNN_VAD_BATCHED_VAD_H_
+#define MODULES_AUDIO_PROCESSING_AGC2_RNN_VAD_BATCHED_VAD_H_
+
+#include <stddef.h>
+#include <memory>
+#include <vector>
+
+#include "api/array_view.h"
+#include "modules/audio_processing/agc2/rnn_vad/common.h"
+#include "modules/audio_processing/agc2/rnn_vad/features_extraction.h"
+#include "modules/audio_processing/agc2/rnn_vad/rnn.h"
+#include "modules/audio_processing/agc2/rnn_vad/vector_math.h"
+
+namespace webrtc {
+namespace rnn_vad {
+
+// RNN VAD for many independent streams sampled at 24 kHz. Pitch search and
+// spectral features are computed independently for each stream whereas the
+// RNN is evaluated for all the streams at once (see BatchedRnnBasedVad).
+//
+// For each 10 ms frame, call ComputeFeatures() once for every stream and then
+// ComputeVadProbabilities(). Calls to ComputeFeatures() for different streams
+// do not share any state and can run concurrently on different threads.
+class BatchedVad {
+ public:
+  // Uses the best optimization available on the current CPU.
+  explicit BatchedVad(size_t num_streams);
+  BatchedVad(size_t num_streams, Optimization optimization);
+  BatchedVad(const BatchedVad&) = delete;
+  BatchedVad& operator=(const BatchedVad&) = delete;
+  ~BatchedVad();
+  size_t num_streams() const { return features_extractors_.size(); }
+  void Reset();
+  // Analyzes a 10 ms frame of the stream with index |stream_index|.
+  void ComputeFeatures(size_t stream_index,
+                       rtc::ArrayView<const float, kFrameSize10ms24kHz> frame);
+  // Computes the probability of voice (range: [0.0, 1.0]) of each stream for
+  // the frames analyzed with ComputeFeatures(). |vad_probabilities| must have
+  // |num_streams()| items.
+  void ComputeVadProbabilities(rtc::ArrayView<float> vad_probabilities);
+
+ private:
+  std::vector<std::unique_ptr<FeaturesExtractor>> features_extractors_;
+  BatchedRnnBasedVad rnn_vad_;
+  std::vector<float> feature_vectors_;
+  // Not an std::vector<bool> so that different items can be written
+  // concurrently.
+  std::unique_ptr<bool[]> is_silence_;
+};
+
+}  // namespace rnn_vad
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_AGC2_RNN_VAD_BATCHED_VAD_H_
@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/agc2/rnn_vad/batched_vad.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "common_audio/resampler/push_sinc_resampler.h"
+#include "modules/audio_processing/agc2/rnn_vad/features_extraction.h"
+#include "modules/audio_processing/agc2/rnn_vad/rnn.h"
+#include "modules/audio_processing/agc2/rnn_vad/test_utils.h"
+#include "modules/audio_processing/test/performance_timer.h"
+#include "rtc_base/logging.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace rnn_vad {
+namespace test {
+namespace {
+
+constexpr size_t kFrameSize10ms48kHz = 480;
+
+// Reads the test PCM samples and returns them decimated to 24 kHz.
+std::vector<float> ReadDecimatedSamples() {
+  auto samples_reader = CreatePcmSamplesReader(kFrameSize10ms48kHz);
+  const size_t num_frames = samples_reader.second;
+  std::array<float, kFrameSize10ms48kHz> samples;
+  PushSincResampler decimator(kFrameSize10ms48kHz, kFrameSize10ms24kHz);
+  std::vector<float> decimated_samples(num_frames * kFrameSize10ms24kHz);
+  for (size_t i = 0; i < num_frames; ++i) {
+    samples_reader.first->ReadChunk(samples);
+    decimator.Resample(samples.data(), samples.size(),
+                       &decimated_samples[i * kFrameSize10ms24kHz],
+                       kFrameSize10ms24kHz);
+  }
+  return decimated_samples;
+}
+
+// Returns the 10 ms frame with index |frame_index| of stream |stream_index|.
+// The streams read the same samples with a different delay.
+rtc::ArrayView<const float, kFrameSize10ms24kHz> GetFrame(
+    const std::vector<float>& samples,
+    size_t stream_index,
+    size_t frame_index) {
+  const size_t num_frames = samples.size() / kFrameSize10ms24kHz;
+  const size_t i = (frame_index + 17 * stream_index) % num_frames;
+  return rtc::ArrayView<const float, kFrameSize10ms24kHz>(
+      &samples[i * kFrameSize10ms24kHz], kFrameSize10ms24kHz);
+}
+
+}  // namespace
+
+// Checks that the batched VAD computes, for each stream, the same probability
+// as a VAD dedicated to that stream.
+TEST(RnnVadTest, BatchedVadMatchesSingleStreamVad) {
+  constexpr size_t kNumStreams = 4;
+  const std::vector<float> samples = ReadDecimatedSamples();
+  const size_t num_frames = samples.size() / kFrameSize10ms24kHz;
+
+  BatchedVad batched_vad(kNumStreams);
+  std::vector<std::unique_ptr<FeaturesExtractor>> features_extractors;
+  std::vector<std::unique_ptr<RnnBasedVad>> vads;
+  for (size_t s = 0; s < kNumStreams; ++s) {
+    features_extractors.push_back(absl::make_unique<FeaturesExtractor>());
+    vads.push_back(absl::make_unique<RnnBasedVad>());
+  }
+  std::array<float, kFeatureVectorSize> feature_vector;
+  std::array<float, kNumStreams> vad_probabilities;
+  for (size_t i = 0; i < num_frames; ++i) {
+    SCOPED_TRACE(i);
+    for (size_t s = 0; s < kNumStreams; ++s) {
+      batched_vad.ComputeFeatures(s, GetFrame(samples, s, i));
+    }
+    batched_vad.ComputeVadProbabilities(vad_probabilities);
+    for (size_t s = 0; s < kNumStreams; ++s) {
+      SCOPED_TRACE(s);
+      const bool is_silence =
+          features_extractors[s]->CheckSilenceComputeFeatures(
+              GetFrame(samples, s, i), feature_vector);
+      EXPECT_FLOAT_EQ(vads[s]->ComputeVadProbability(feature_vector, is_silence),
+                      vad_probabilities[s]);
+    }
+  }
+}
+
+// Performance test for the batched VAD which reports how many streams can be
+// analyzed in real-time by one core. Keep disabled and only enable locally to
+// measure performance (see DISABLED_RnnVadPerformance).
+TEST(RnnVadTest, DISABLED_BatchedVadPerformance) {
+  const std::vector<float> samples = ReadDecimatedSamples();
+  const size_t num_frames = samples.size() / kFrameSize10ms24kHz;
+  const float audio_duration_us = 1e4f * num_frames;
+  for (size_t num_streams : {1, 10, 100, 500}) {
+    BatchedVad batched_vad(num_streams);
+    std::vector<float> vad_probabilities(num_streams);
+    constexpr size_t number_of_tests = 10;
+    ::webrtc::test::PerformanceTimer perf_timer(number_of_tests);
+    for (size_t k = 0; k < number_of_tests; ++k) {
+      batched_vad.Reset();
+      perf_timer.StartTimer();
+      for (size_t i = 0; i < num_frames; ++i) {
+        for (size_t s = 0; s < num_streams; ++s) {
+          batched_vad.ComputeFeatures(s, GetFrame(samples, s, i));
+        }
+        batched_vad.ComputeVadProbabilities(vad_probabilities);
+      }
+      perf_timer.StopTimer();
+    }
+    const double average_us = perf_timer.GetDurationAverage();
+    RTC_LOG(LS_INFO) << "streams: " << num_streams
+                     << ", streams per core: "
+                     << audio_duration_us * num_streams / average_us;
+  }
+}
+
+}  // namespace test
+}  // namespace rnn_vad
+}  // namespace webrtc
@@ -48,17 +48,64 @@ using rnnoise::RectifiedLinearUnit;
 using rnnoise::SigmoidApproximated;
 using rnnoise::TansigApproximated;
 
+namespace {
+
+// Converts the bias terms to float.
+std::vector<float> GetBias(rtc::ArrayView<const int8_t> bias) {
+  return std::vector<float>(bias.begin(), bias.end());
+}
+
+// Transposes and converts to float the weights of a fully-connected layer.
+// The input layout is [input_size][output_size], the output one is
+// [output_size][input_size].
+std::vector<float> GetTransposedWeights(rtc::ArrayView<const int8_t> weights,
+                                        size_t output_size) {
+  RTC_DCHECK_GT(output_size, 0);
+  const size_t input_size = rtc::CheckedDivExact(weights.size(), output_size);
+  std::vector<float> transposed(weights.size());
+  for (size_t o = 0; o < output_size; ++o) {
+    for (size_t i = 0; i < input_size; ++i) {
+      transposed[o * input_size + i] = weights[i * output_size + o];
+    }
+  }
+  return transposed;
+}
+
+// Transposes and converts to float the weights of a GRU layer. The input
+// layout is [input_size][3][output_size], the output one is
+// [3][output_size][input_size].
+std::vector<float> GetTransposedGruWeights(rtc::ArrayView<const int8_t> weights,
+                                           size_t input_size,
+                                           size_t output_size) {
+  const size_t stride = 3 * output_size;
+  RTC_DCHECK_LE(input_size * stride, weights.size());
+  std::vector<float> transposed(input_size * stride);
+  for (size_t g = 0; g < 3; ++g) {
+    for (size_t o = 0; o < output_size; ++o) {
+      for (size_t i = 0; i < input_size; ++i) {
+        transposed[(g * output_size + o) * input_size + i] =
+            weights[i * stride + g * output_size + o];
+      }
+    }
+  }
+  return transposed;
+}
+
+}  // namespace
+
 FullyConnectedLayer::FullyConnectedLayer(
     const size_t input_size,
     const size_t output_size,
     const rtc::ArrayView<const int8_t> bias,
     const rtc::ArrayView<const int8_t> weights,
-    float (*const activation_function)(float))
+    float (*const activation_function)(float),
+    Optimization optimization)
     : input_size_(input_size),
       output_size_(output_size),
-      bias_(bias),
-      weights_(weights),
-      activation_function_(activation_function) {
+      bias_(GetBias(bias)),
+      weights_(GetTransposedWeights(weights, output_size)),
+      activation_function_(activation_function),
+      vector_math_(optimization) {
   RTC_DCHECK_LE(output_size_, kFullyConnectedLayersMaxUnits)
       << "Static over-allocation of fully-connected layers output vectors is "
          "not sufficient.";
@@ -75,16 +122,23 @@ rtc::ArrayView<const float> FullyConnectedLayer::GetOutput() const {
 }
 
 void FullyConnectedLayer::ComputeOutput(rtc::ArrayView<const float> input) {
-  // TODO(bugs.chromium.org/9076): Optimize using SSE/AVX fused multiply-add
-  // operations.
+  ComputeOutputs(input, {output_.data(), output_size_});
+}
+
+void FullyConnectedLayer::ComputeOutputs(rtc::ArrayView<const float> inputs,
+                                         rtc::ArrayView<float> outputs) const {
+  const size_t batch_size = rtc::CheckedDivExact(inputs.size(), input_size_);
+  RTC_DCHECK_EQ(outputs.size(), batch_size * output_size_);
+  rtc::ArrayView<const float> weights(weights_);
   for (size_t o = 0; o < output_size_; ++o) {
-    output_[o] = bias_[o];
-    // TODO(bugs.chromium.org/9076): Benchmark how different layouts for
-    // |weights_| change the performance across different platforms.
-    for (size_t i = 0; i < input_size_; ++i) {
-      output_[o] += input[i] * weights_[i * output_size_ + o];
+    const auto weights_o = weights.subview(o * input_size_, input_size_);
+    for (size_t b = 0; b < batch_size; ++b) {
+      outputs[b * output_size_ + o] = (*activation_function_)(
+          kWeightsScale *
+          (bias_[o] +
+           vector_math_.DotProduct(
+               inputs.subview(b * input_size_, input_size_), weights_o)));
     }
-    output_[o] = (*activation_function_)(kWeightsScale * output_[o]);
   }
 }
 
@@ -94,13 +148,20 @@ GatedRecurrentLayer::GatedRecurrentLayer(
     const rtc::ArrayView<const int8_t> bias,
     const rtc::ArrayView<const int8_t> weights,
     const rtc::ArrayView<const int8_t> recurrent_weights,
-    float (*const activation_function)(float))
+    float (*const activation_function)(float),
+    Optimization optimization)
     : input_size_(input_size),
       output_size_(output_size),
-      bias_(bias),
-      weights_(weights),
-      recurrent_weights_(recurrent_weights),
-      activation_function_(activation_function) {
+      bias_(GetBias(bias)),
+      weights_(GetTransposedGruWeights(weights, input_size, output_size)),
+      recurrent_weights_(GetTransposedGruWeights(recurrent_weights,
+                                                 output_size,
+                                                 output_size)),
+      activation_function_(activation_function),
+      vector_math_(optimization),
+      update_(output_size),
+      reset_state_(output_size),
+      output_(output_size) {
   RTC_DCHECK_LE(output_size_, kRecurrentLayersMaxUnits)
       << "Static over-allocation of recurrent layers state vectors is not "
       << "sufficient.";
@@ -108,8 +169,8 @@ GatedRecurrentLayer::GatedRecurrentLayer(
       << "Mismatching output size and bias terms array size.";
   RTC_DCHECK_EQ(3 * input_size_ * output_size_, weights_.size())
       << "Mismatching input-output size and weight coefficients array size.";
-  RTC_DCHECK_EQ(3 * input_size_ * output_size_, recurrent_weights_.size())
-      << "Mismatching input-output size and recurrent weight coefficients array"
+  RTC_DCHECK_EQ(3 * output_size_ * output_size_, recurrent_weights_.size())
+      << "Mismatching output size and recurrent weight coefficients array"
       << " size.";
   Reset();
 }
@@ -125,82 +186,112 @@ void GatedRecurrentLayer::Reset() {
 }
 
 void GatedRecurrentLayer::ComputeOutput(rtc::ArrayView<const float> input) {
-  // TODO(bugs.chromium.org/9076): Optimize using SSE/AVX fused multiply-add
-  // operations.
-  // Stride and offset used to read parameter arrays.
-  const size_t stride = 3 * output_size_;
+  ComputeOutputs(input, {state_.data(), output_size_});
+}
+
+void GatedRecurrentLayer::ComputeOutputs(rtc::ArrayView<const float> inputs,
+                                         rtc::ArrayView<float> states) {
+  const size_t batch_size = rtc::CheckedDivExact(inputs.size(), input_size_);
+  RTC_DCHECK_EQ(states.size(), batch_size * output_size_);
+  if (update_.size() < states.size()) {
+    update_.resize(states.size());
+    reset_state_.resize(states.size());
+    output_.resize(states.size());
+  }
+  rtc::ArrayView<const float> weights(weights_);
+  rtc::ArrayView<const float> recurrent_weights(recurrent_weights_);
+  rtc::ArrayView<const float> reset_state(reset_state_.data(), states.size());
+  auto input = [&](size_t b) {
+    return inputs.subview(b * input_size_, input_size_);
+  };
+  auto state = [&](size_t b) {
+    return rtc::ArrayView<const float>(states).subview(b * output_size_,
+                                                       output_size_);
+  };
+  // Offsets used to read the parameters of each gate.
   size_t offset = 0;
+  size_t recurrent_offset = 0;
 
   // Compute update gates.
-  std::array<float, kRecurrentLayersMaxUnits> update;
   for (size_t o = 0; o < output_size_; ++o) {
-    update[o] = bias_[o];
-    // TODO(bugs.chromium.org/9076): Benchmark how different layouts for
-    // |weights_| and |recurrent_weights_| change the performance across
-    // different platforms.
-    for (size_t i = 0; i < input_size_; ++i) {  // Add input.
-      update[o] += input[i] * weights_[i * stride + o];
+    const auto weights_o = weights.subview(offset, input_size_);
+    const auto recurrent_weights_o =
+        recurrent_weights.subview(recurrent_offset, output_size_);
+    for (size_t b = 0; b < batch_size; ++b) {
+      update_[b * output_size_ + o] = SigmoidApproximated(
+          kWeightsScale *
+          (bias_[o] + vector_math_.DotProduct(input(b), weights_o) +
+           vector_math_.DotProduct(state(b), recurrent_weights_o)));
     }
-    for (size_t s = 0; s < output_size_; ++s) {
-      update[o] += state_[s] * recurrent_weights_[s * stride + o];
-    }  // Add state.
-    update[o] = SigmoidApproximated(kWeightsScale * update[o]);
+    offset += input_size_;
+    recurrent_offset += output_size_;
   }
 
-  // Compute reset gates.
-  offset += output_size_;
-  std::array<float, kRecurrentLayersMaxUnits> reset;
+  // Compute reset gates and apply them to the state.
   for (size_t o = 0; o < output_size_; ++o) {
-    reset[o] = bias_[offset + o];
-    for (size_t i = 0; i < input_size_; ++i) {  // Add input.
-      reset[o] += input[i] * weights_[offset + i * stride + o];
-    }
-    for (size_t s = 0; s < output_size_; ++s) {  // Add state.
-      reset[o] += state_[s] * recurrent_weights_[offset + s * stride + o];
+    const auto weights_o = weights.subview(offset, input_size_);
+    const auto recurrent_weights_o =
+        recurrent_weights.subview(recurrent_offset, output_size_);
+    for (size_t b = 0; b < batch_size; ++b) {
+      const float reset = SigmoidApproximated(
+          kWeightsScale *
+          (bias_[output_size_ + o] +
+           vector_math_.DotProduct(input(b), weights_o) +
+           vector_math_.DotProduct(state(b), recurrent_weights_o)));
+      reset_state_[b * output_size_ + o] = states[b * output_size_ + o] * reset;
     }
-    reset[o] = SigmoidApproximated(kWeightsScale * reset[o]);
+    offset += input_size_;
+    recurrent_offset += output_size_;
   }
 
   // Compute output.
-  offset += output_size_;
-  std::array<float, kRecurrentLayersMaxUnits> output;
   for (size_t o = 0; o < output_size_; ++o) {
-    output[o] = bias_[offset + o];
-    for (size_t i = 0; i < input_size_; ++i) {  // Add input.
-      output[o] += input[i] * weights_[offset + i * stride + o];
+    const auto weights_o = weights.subview(offset, input_size_);
+    const auto recurrent_weights_o =
+        recurrent_weights.subview(recurrent_offset, output_size_);
+    for (size_t b = 0; b < batch_size; ++b) {
+      const size_t k = b * output_size_ + o;
+      const float output = (*activation_function_)(
+          kWeightsScale *
+          (bias_[2 * output_size_ + o] +
+           vector_math_.DotProduct(input(b), weights_o) +
+           vector_math_.DotProduct(
+               reset_state.subview(b * output_size_, output_size_),
+               recurrent_weights_o)));
+      // Update output through the update gates.
+      output_[k] = update_[k] * states[k] + (1.f - update_[k]) * output;
     }
-    for (size_t s = 0; s < output_size_;
-         ++s) {  // Add state through reset gates.
-      output[o] +=
-          state_[s] * recurrent_weights_[offset + s * stride + o] * reset[s];
-    }
-    output[o] = (*activation_function_)(kWeightsScale * output[o]);
-    // Update output through the update gates.
-    output[o] = update[o] * state_[o] + (1.f - update[o]) * output[o];
+    offset += input_size_;
+    recurrent_offset += output_size_;
   }
 
-  // Update the state. Not done in the previous loop since that would pollute
-  // the current state and lead to incorrect output values.
-  std::copy(output.begin(), output.end(), state_.begin());
+  // Update the states. Not done in the previous loop since that would pollute
+  // the current states and lead to incorrect output values.
+  std::copy(output_.begin(), output_.begin() + states.size(), states.begin());
 }
 
-RnnBasedVad::RnnBasedVad()
+RnnBasedVad::RnnBasedVad() : RnnBasedVad(DetectOptimization()) {}
+
+RnnBasedVad::RnnBasedVad(Optimization optimization)
     : input_layer_(kInputLayerInputSize,
                    kInputLayerOutputSize,
                    kInputDenseBias,
                    kInputDenseWeights,
-                   TansigApproximated),
+                   TansigApproximated,
+                   optimization),
       hidden_layer_(kInputLayerOutputSize,
                     kHiddenLayerOutputSize,
                     kHiddenGruBias,
                     kHiddenGruWeights,
                     kHiddenGruRecurrentWeights,
-                    RectifiedLinearUnit),
+                    RectifiedLinearUnit,
+                    optimization),
       output_layer_(kHiddenLayerOutputSize,
                     kOutputLayerOutputSize,
                     kOutputDenseBias,
                     kOutputDenseWeights,
-                    SigmoidApproximated) {
+                    SigmoidApproximated,
+                    optimization) {
   // Input-output chaining size checks.
   RTC_DCHECK_EQ(input_layer_.output_size(), hidden_layer_.input_size())
       << "The input and the hidden layers sizes do not match.";
@@ -228,5 +319,102 @@ float RnnBasedVad::ComputeVadProbability(
   return vad_output[0];
 }
 
+BatchedRnnBasedVad::BatchedRnnBasedVad(size_t num_streams)
+    : BatchedRnnBasedVad(num_streams, DetectOptimization()) {}
+
+BatchedRnnBasedVad::BatchedRnnBasedVad(size_t num_streams,
+                                       Optimization optimization)
+    : num_streams_(num_streams),
+      input_layer_(kInputLayerInputSize,
+                   kInputLayerOutputSize,
+                   kInputDenseBias,
+                   kInputDenseWeights,
+                   TansigApproximated,
+                   optimization),
+      hidden_layer_(kInputLayerOutputSize,
+                    kHiddenLayerOutputSize,
+                    kHiddenGruBias,
+                    kHiddenGruWeights,
+                    kHiddenGruRecurrentWeights,
+                    RectifiedLinearUnit,
+                    optimization),
+      output_layer_(kHiddenLayerOutputSize,
+                    kOutputLayerOutputSize,
+                    kOutputDenseBias,
+                    kOutputDenseWeights,
+                    SigmoidApproximated,
+                    optimization),
+      hidden_states_(num_streams * kHiddenLayerOutputSize, 0.f) {
+  static_assert(kOutputLayerOutputSize == 1, "");
+  active_streams_.reserve(num_streams_);
+  active_feature_vectors_.resize(num_streams_ * kFeatureVectorSize);
+  active_input_layer_outputs_.resize(num_streams_ * kInputLayerOutputSize);
+  active_hidden_states_.resize(num_streams_ * kHiddenLayerOutputSize);
+  active_vad_probabilities_.resize(num_streams_);
+}
+
+BatchedRnnBasedVad::~BatchedRnnBasedVad() = default;
+
+void BatchedRnnBasedVad::Reset() {
+  std::fill(hidden_states_.begin(), hidden_states_.end(), 0.f);
+}
+
+void BatchedRnnBasedVad::Reset(size_t stream_index) {
+  RTC_DCHECK_LT(stream_index, num_streams_);
+  auto state = hidden_states_.begin() + stream_index * kHiddenLayerOutputSize;
+  std::fill(state, state + kHiddenLayerOutputSize, 0.f);
+}
+
+void BatchedRnnBasedVad::ComputeVadProbabilities(
+    rtc::ArrayView<const float> feature_vectors,
+    rtc::ArrayView<const bool> is_silence,
+    rtc::ArrayView<float> vad_probabilities) {
+  RTC_DCHECK_EQ(feature_vectors.size(), num_streams_ * kFeatureVectorSize);
+  RTC_DCHECK_EQ(is_silence.size(), num_streams_);
+  RTC_DCHECK_EQ(vad_probabilities.size(), num_streams_);
+  // Pack the non-silent streams; reset the silent ones.
+  active_streams_.clear();
+  for (size_t s = 0; s < num_streams_; ++s) {
+    if (is_silence[s]) {
+      Reset(s);
+      vad_probabilities[s] = 0.f;
+      continue;
+    }
+    const size_t a = active_streams_.size();
+    active_streams_.push_back(s);
+    std::copy(feature_vectors.begin() + s * kFeatureVectorSize,
+              feature_vectors.begin() + (s + 1) * kFeatureVectorSize,
+              active_feature_vectors_.begin() + a * kFeatureVectorSize);
+    std::copy(hidden_states_.begin() + s * kHiddenLayerOutputSize,
+              hidden_states_.begin() + (s + 1) * kHiddenLayerOutputSize,
+              active_hidden_states_.begin() + a * kHiddenLayerOutputSize);
+  }
+  const size_t num_active = active_streams_.size();
+  if (num_active == 0) {
+    return;
+  }
+
+  // Evaluate the RNN for the whole batch.
+  input_layer_.ComputeOutputs(
+      {active_feature_vectors_.data(), num_active * kFeatureVectorSize},
+      {active_input_layer_outputs_.data(), num_active * kInputLayerOutputSize});
+  rtc::ArrayView<float> active_hidden_states(
+      active_hidden_states_.data(), num_active * kHiddenLayerOutputSize);
+  hidden_layer_.ComputeOutputs(
+      {active_input_layer_outputs_.data(), num_active * kInputLayerOutputSize},
+      active_hidden_states);
+  output_layer_.ComputeOutputs(active_hidden_states,
+                               {active_vad_probabilities_.data(), num_active});
+
+  // Unpack.
+  for (size_t a = 0; a < num_active; ++a) {
+    const size_t s = active_streams_[a];
+    std::copy(active_hidden_states.begin() + a * kHiddenLayerOutputSize,
+              active_hidden_states.begin() + (a + 1) * kHiddenLayerOutputSize,
+              hidden_states_.begin() + s * kHiddenLayerOutputSize);
+    vad_probabilities[s] = active_vad_probabilities_[a];
+  }
+}
+
 }  // namespace rnn_vad
 }  // namespace webrtc
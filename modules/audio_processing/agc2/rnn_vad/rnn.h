@@ -14,9 +14,11 @@
 #include <stddef.h>
 #include <sys/types.h>
 #include <array>
+#include <vector>
 
 #include "api/array_view.h"
 #include "modules/audio_processing/agc2/rnn_vad/common.h"
+#include "modules/audio_processing/agc2/rnn_vad/vector_math.h"
 
 namespace webrtc {
 namespace rnn_vad {
@@ -33,14 +35,17 @@ constexpr size_t kFullyConnectedLayersMaxUnits = 24;
 // recurrent layer.
 constexpr size_t kRecurrentLayersMaxUnits = 24;
 
-// Fully-connected layer.
+// Fully-connected layer. The weights are stored transposed and converted to
+// float so that each output unit is computed as a dot product between
+// contiguous vectors.
 class FullyConnectedLayer {
  public:
   FullyConnectedLayer(const size_t input_size,
                       const size_t output_size,
                       const rtc::ArrayView<const int8_t> bias,
                       const rtc::ArrayView<const int8_t> weights,
-                      float (*const activation_function)(float));
+                      float (*const activation_function)(float),
+                      Optimization optimization);
   FullyConnectedLayer(const FullyConnectedLayer&) = delete;
   FullyConnectedLayer& operator=(const FullyConnectedLayer&) = delete;
   ~FullyConnectedLayer();
@@ -49,19 +54,28 @@ class FullyConnectedLayer {
   rtc::ArrayView<const float> GetOutput() const;
   // Computes the fully-connected layer output.
   void ComputeOutput(rtc::ArrayView<const float> input);
+  // Computes the outputs for a batch of input vectors stored contiguously in
+  // |inputs| and writes them contiguously into |outputs|. The weights of each
+  // output unit are read once for the whole batch.
+  void ComputeOutputs(rtc::ArrayView<const float> inputs,
+                      rtc::ArrayView<float> outputs) const;
 
  private:
   const size_t input_size_;
   const size_t output_size_;
-  const rtc::ArrayView<const int8_t> bias_;
-  const rtc::ArrayView<const int8_t> weights_;
+  const std::vector<float> bias_;
+  // Weights with layout [output_size][input_size].
+  const std::vector<float> weights_;
   float (*const activation_function_)(float);
+  const VectorMath vector_math_;
   // The output vector of a recurrent layer has length equal to |output_size_|.
   // However, for efficiency, over-allocation is used.
   std::array<float, kFullyConnectedLayersMaxUnits> output_;
 };
 
-// Recurrent layer with gated recurrent units (GRUs).
+// Recurrent layer with gated recurrent units (GRUs). As for
+// FullyConnectedLayer, the weights are stored transposed and converted to
+// float.
 class GatedRecurrentLayer {
  public:
   GatedRecurrentLayer(const size_t input_size,
@@ -69,7 +83,8 @@ class GatedRecurrentLayer {
                       const rtc::ArrayView<const int8_t> bias,
                       const rtc::ArrayView<const int8_t> weights,
                       const rtc::ArrayView<const int8_t> recurrent_weights,
-                      float (*const activation_function)(float));
+                      float (*const activation_function)(float),
+                      Optimization optimization);
   GatedRecurrentLayer(const GatedRecurrentLayer&) = delete;
   GatedRecurrentLayer& operator=(const GatedRecurrentLayer&) = delete;
   ~GatedRecurrentLayer();
@@ -79,23 +94,39 @@ class GatedRecurrentLayer {
   void Reset();
   // Computes the recurrent layer output and updates the status.
   void ComputeOutput(rtc::ArrayView<const float> input);
+  // Batched version of ComputeOutput() for independent sequences. Updates the
+  // states stored contiguously in |states| given the input vectors stored
+  // contiguously in |inputs|. The internal state is neither used nor updated.
+  void ComputeOutputs(rtc::ArrayView<const float> inputs,
+                      rtc::ArrayView<float> states);
 
  private:
   const size_t input_size_;
   const size_t output_size_;
-  const rtc::ArrayView<const int8_t> bias_;
-  const rtc::ArrayView<const int8_t> weights_;
-  const rtc::ArrayView<const int8_t> recurrent_weights_;
+  const std::vector<float> bias_;
+  // Weights with layout [3][output_size][input_size], where the first index
+  // selects the update gate, the reset gate and the output.
+  const std::vector<float> weights_;
+  // Recurrent weights with layout [3][output_size][output_size].
+  const std::vector<float> recurrent_weights_;
   float (*const activation_function_)(float);
+  const VectorMath vector_math_;
   // The state vector of a recurrent layer has length equal to |output_size_|.
   // However, to avoid dynamic allocation, over-allocation is used.
   std::array<float, kRecurrentLayersMaxUnits> state_;
+  // Scratch buffers for the update gates, the state after the reset gates and
+  // the output. They are sized for one sequence and grown for larger batches.
+  std::vector<float> update_;
+  std::vector<float> reset_state_;
+  std::vector<float> output_;
 };
 
 // Recurrent network based VAD.
 class RnnBasedVad {
  public:
+  // Uses the best optimization available on the current CPU.
   RnnBasedVad();
+  explicit RnnBasedVad(Optimization optimization);
   RnnBasedVad(const RnnBasedVad&) = delete;
   RnnBasedVad& operator=(const RnnBasedVad&) = delete;
   ~RnnBasedVad();
@@ -111,6 +142,48 @@ class RnnBasedVad {
   FullyConnectedLayer output_layer_;
 };
 
+// Recurrent network based VAD for many independent streams. The network
+// weights are shared and, for each frame, the RNN is evaluated for all the
+// non-silent streams at once so that matrix-vector products become
+// matrix-matrix products.
+class BatchedRnnBasedVad {
+ public:
+  // Uses the best optimization available on the current CPU.
+  explicit BatchedRnnBasedVad(size_t num_streams);
+  BatchedRnnBasedVad(size_t num_streams, Optimization optimization);
+  BatchedRnnBasedVad(const BatchedRnnBasedVad&) = delete;
+  BatchedRnnBasedVad& operator=(const BatchedRnnBasedVad&) = delete;
+  ~BatchedRnnBasedVad();
+  size_t num_streams() const { return num_streams_; }
+  // Resets the state of all the streams.
+  void Reset();
+  // Resets the state of one stream.
+  void Reset(size_t stream_index);
+  // Computes the probability of voice (range: [0.0, 1.0]) for each stream.
+  // |feature_vectors| contains |num_streams()| feature vectors stored
+  // contiguously and |is_silence| has one flag per stream. The result is
+  // written into |vad_probabilities|, which must have |num_streams()| items.
+  // For each stream, the result equals that of
+  // RnnBasedVad::ComputeVadProbability().
+  void ComputeVadProbabilities(rtc::ArrayView<const float> feature_vectors,
+                               rtc::ArrayView<const bool> is_silence,
+                               rtc::ArrayView<float> vad_probabilities);
+
+ private:
+  const size_t num_streams_;
+  FullyConnectedLayer input_layer_;
+  GatedRecurrentLayer hidden_layer_;
+  FullyConnectedLayer output_layer_;
+  // Hidden layer state of each stream.
+  std::vector<float> hidden_states_;
+  // Buffers holding the non-silent streams packed contiguously.
+  std::vector<size_t> active_streams_;
+  std::vector<float> active_feature_vectors_;
+  std::vector<float> active_input_layer_outputs_;
+  std::vector<float> active_hidden_states_;
+  std::vector<float> active_vad_probabilities_;
+};
+
 }  // namespace rnn_vad
 }  // namespace webrtc
 
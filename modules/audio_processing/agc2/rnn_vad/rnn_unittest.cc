@@ -9,7 +9,10 @@
  */
 
 #include <array>
+#include <memory>
+#include <vector>
 
+#include "absl/memory/memory.h"
 #include "modules/audio_processing/agc2/rnn_vad/rnn.h"
 #include "modules/audio_processing/agc2/rnn_vad/test_utils.h"
 #include "rtc_base/checks.h"
@@ -59,16 +62,9 @@ void TestGatedRecurrentLayer(
   }
 }
 
-}  // namespace
-
-// Checks that the output of a fully connected layer is within tolerance given
-// test input data.
-TEST(RnnVadTest, CheckFullyConnectedLayerOutput) {
-  const std::array<int8_t, 1> bias = {-50};
-  const std::array<int8_t, 24> weights = {
-      127,  127,  127, 127,  127,  20,  127,  -126, -126, -54, 14,  125,
-      -126, -126, 127, -125, -126, 127, -127, -127, -57,  -30, 127, 80};
-  FullyConnectedLayer fc(24, 1, bias, weights, SigmoidApproximated);
+// Checks the output of a fully connected layer with 24 inputs and 1 output
+// created with the parameters of the CheckFullyConnectedLayerOutput test.
+void CheckFullyConnectedLayerOutput(FullyConnectedLayer* fc) {
   // Test on different inputs.
   {
     const std::array<float, 24> input_vector = {
@@ -77,7 +73,7 @@ TEST(RnnVadTest, CheckFullyConnectedLayerOutput) {
         0.f,           0.0461241305f, 0.106401242f, 0.223070428f, 0.630603909f,
         0.690453172f,  0.f,           0.387645692f, 0.166913897f, 0.f,
         0.0327451192f, 0.f,           0.136149868f, 0.446351469f};
-    TestFullyConnectedLayer(&fc, input_vector, 0.436567038f);
+    TestFullyConnectedLayer(fc, input_vector, 0.436567038f);
   }
   {
     const std::array<float, 24> input_vector = {
@@ -89,7 +85,7 @@ TEST(RnnVadTest, CheckFullyConnectedLayerOutput) {
         0.9688586f,    0.0320267938f, 0.244722098f,
         0.312745273f,  0.f,           0.00650715502f,
         0.312553257f,  1.62619662f,   0.782880902f};
-    TestFullyConnectedLayer(&fc, input_vector, 0.874741316f);
+    TestFullyConnectedLayer(fc, input_vector, 0.874741316f);
   }
   {
     const std::array<float, 24> input_vector = {
@@ -101,7 +97,43 @@ TEST(RnnVadTest, CheckFullyConnectedLayerOutput) {
         1.20532358f,   0.0254284926f, 0.283327013f,
         0.726210058f,  0.0550272502f, 0.000344108557f,
         0.369803518f,  1.56680179f,   0.997883797f};
-    TestFullyConnectedLayer(&fc, input_vector, 0.672785878f);
+    TestFullyConnectedLayer(fc, input_vector, 0.672785878f);
+  }
+}
+
+// Checks the output of a GRU layer with 5 inputs and 4 outputs created with
+// the parameters of the CheckGatedRecurrentLayer test.
+void CheckGatedRecurrentLayerOutput(GatedRecurrentLayer* gru) {
+  // Test on different inputs.
+  {
+    const std::array<float, 20> input_sequence = {
+        0.89395463f, 0.93224651f, 0.55788344f, 0.32341808f, 0.93355054f,
+        0.13475326f, 0.97370994f, 0.14253306f, 0.93710381f, 0.76093364f,
+        0.65780413f, 0.41657975f, 0.49403164f, 0.46843281f, 0.75138855f,
+        0.24517593f, 0.47657707f, 0.57064998f, 0.435184f,   0.19319285f};
+    const std::array<float, 16> expected_output_sequence = {
+        0.0239123f,  0.5773077f,  0.f,         0.f,
+        0.01282811f, 0.64330572f, 0.f,         0.04863098f,
+        0.00781069f, 0.75267816f, 0.f,         0.02579715f,
+        0.00471378f, 0.59162533f, 0.11087593f, 0.01334511f};
+    TestGatedRecurrentLayer(gru, input_sequence, expected_output_sequence);
+  }
+}
+
+}  // namespace
+
+// Checks that the output of a fully connected layer is within tolerance given
+// test input data.
+TEST(RnnVadTest, CheckFullyConnectedLayerOutput) {
+  const std::array<int8_t, 1> bias = {-50};
+  const std::array<int8_t, 24> weights = {
+      127,  127,  127, 127,  127,  20,  127,  -126, -126, -54, 14,  125,
+      -126, -126, 127, -125, -126, 127, -127, -127, -57,  -30, 127, 80};
+  for (Optimization optimization : GetOptimizationsToTest()) {
+    SCOPED_TRACE(static_cast<int>(optimization));
+    FullyConnectedLayer fc(24, 1, bias, weights, SigmoidApproximated,
+                           optimization);
+    CheckFullyConnectedLayerOutput(&fc);
   }
 }
 
@@ -122,21 +154,49 @@ TEST(RnnVadTest, CheckGatedRecurrentLayer) {
       64,  -62, 117, 85,  -51,  -43, 54,  -105, 120, 56,  -128, -107,
       39,  50,  -17, -47, -117, 14,  108, 12,   -7,  -72, 103,  -87,
       -66, 82,  84,  100, -98,  102, -49, 44,   122, 106, -20,  -69};
-  GatedRecurrentLayer gru(5, 4, bias, weights, recurrent_weights,
-                          RectifiedLinearUnit);
-  // Test on different inputs.
-  {
-    const std::array<float, 20> input_sequence = {
-        0.89395463f, 0.93224651f, 0.55788344f, 0.32341808f, 0.93355054f,
-        0.13475326f, 0.97370994f, 0.14253306f, 0.93710381f, 0.76093364f,
-        0.65780413f, 0.41657975f, 0.49403164f, 0.46843281f, 0.75138855f,
-        0.24517593f, 0.47657707f, 0.57064998f, 0.435184f,   0.19319285f};
-    const std::array<float, 16> expected_output_sequence = {
-        0.0239123f,  0.5773077f,  0.f,         0.f,
-        0.01282811f, 0.64330572f, 0.f,         0.04863098f,
-        0.00781069f, 0.75267816f, 0.f,         0.02579715f,
-        0.00471378f, 0.59162533f, 0.11087593f, 0.01334511f};
-    TestGatedRecurrentLayer(&gru, input_sequence, expected_output_sequence);
+  for (Optimization optimization : GetOptimizationsToTest()) {
+    SCOPED_TRACE(static_cast<int>(optimization));
+    GatedRecurrentLayer gru(5, 4, bias, weights, recurrent_weights,
+                            RectifiedLinearUnit, optimization);
+    CheckGatedRecurrentLayerOutput(&gru);
+  }
+}
+
+// Checks that the batched RNN VAD computes, for each stream, the same
+// probabilities as an RNN VAD instance dedicated to that stream.
+TEST(RnnVadTest, BatchedRnnBasedVadMatchesRnnBasedVad) {
+  constexpr size_t kNumStreams = 5;
+  constexpr size_t kNumFrames = 50;
+  for (Optimization optimization : GetOptimizationsToTest()) {
+    SCOPED_TRACE(static_cast<int>(optimization));
+    BatchedRnnBasedVad batched_vad(kNumStreams, optimization);
+    std::vector<std::unique_ptr<RnnBasedVad>> vads;
+    for (size_t s = 0; s < kNumStreams; ++s) {
+      vads.push_back(absl::make_unique<RnnBasedVad>(optimization));
+    }
+    std::array<float, kNumStreams * kFeatureVectorSize> feature_vectors;
+    std::array<bool, kNumStreams> is_silence;
+    std::array<float, kNumStreams> vad_probabilities;
+    for (size_t i = 0; i < kNumFrames; ++i) {
+      SCOPED_TRACE(i);
+      for (size_t s = 0; s < kNumStreams; ++s) {
+        // Stream |s| is silent every |s + 2| frames.
+        is_silence[s] = (i % (s + 2)) == 0;
+        for (size_t k = 0; k < kFeatureVectorSize; ++k) {
+          feature_vectors[s * kFeatureVectorSize + k] =
+              0.05f * static_cast<float>((i * 7 + s * 3 + k) % 41) - 1.f;
+        }
+      }
+      batched_vad.ComputeVadProbabilities(feature_vectors, is_silence,
+                                          vad_probabilities);
+      for (size_t s = 0; s < kNumStreams; ++s) {
+        SCOPED_TRACE(s);
+        const float expected = vads[s]->ComputeVadProbability(
+            {&feature_vectors[s * kFeatureVectorSize], kFeatureVectorSize},
+            is_silence[s]);
+        EXPECT_FLOAT_EQ(expected, vad_probabilities[s]);
+      }
+    }
   }
 }
 
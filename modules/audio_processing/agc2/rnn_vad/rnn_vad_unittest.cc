@@ -152,6 +152,48 @@ TEST(RnnVadTest, DISABLED_RnnVadPerformance) {
                 perf_timer.GetDurationStandardDeviation());
 }
 
+// Performance test for the RNN inference only, for each optimization available
+// on the current CPU. The features are pre-computed. Keep disabled and only
+// enable locally to measure performance (see DISABLED_RnnVadPerformance).
+TEST(RnnVadTest, DISABLED_RnnPerformance) {
+  // Pre-compute the feature vectors.
+  auto samples_reader = CreatePcmSamplesReader(kFrameSize10ms48kHz);
+  const size_t num_frames = samples_reader.second;
+  std::array<float, kFrameSize10ms48kHz> samples_48k;
+  std::array<float, kFrameSize10ms24kHz> samples_24k;
+  PushSincResampler decimator(kFrameSize10ms48kHz, kFrameSize10ms24kHz);
+  FeaturesExtractor features_extractor;
+  std::vector<float> feature_vectors(num_frames * kFeatureVectorSize);
+  std::vector<bool> is_silence(num_frames);
+  for (size_t i = 0; i < num_frames; ++i) {
+    samples_reader.first->ReadChunk(samples_48k);
+    decimator.Resample(samples_48k.data(), samples_48k.size(),
+                       samples_24k.data(), samples_24k.size());
+    is_silence[i] = features_extractor.CheckSilenceComputeFeatures(
+        samples_24k, {&feature_vectors[i * kFeatureVectorSize],
+                      kFeatureVectorSize});
+  }
+  // Run the RNN with each optimization.
+  for (Optimization optimization : GetOptimizationsToTest()) {
+    RnnBasedVad rnn_vad(optimization);
+    constexpr size_t number_of_tests = 100;
+    ::webrtc::test::PerformanceTimer perf_timer(number_of_tests);
+    for (size_t k = 0; k < number_of_tests; ++k) {
+      rnn_vad.Reset();
+      perf_timer.StartTimer();
+      for (size_t i = 0; i < num_frames; ++i) {
+        rnn_vad.ComputeVadProbability(
+            {&feature_vectors[i * kFeatureVectorSize], kFeatureVectorSize},
+            is_silence[i]);
+      }
+      perf_timer.StopTimer();
+    }
+    RTC_LOG(LS_INFO) << "optimization: " << static_cast<int>(optimization)
+                     << ", average time per frame (us): "
+                     << perf_timer.GetDurationAverage() / num_frames;
+  }
+}
+
 }  // namespace test
 }  // namespace rnn_vad
 }  // namespace webrtc
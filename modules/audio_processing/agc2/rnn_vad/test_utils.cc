@@ -46,6 +46,17 @@ void ExpectNearAbsolute(rtc::ArrayView<const float> expected,
   }
 }
 
+std::vector<Optimization> GetOptimizationsToTest() {
+  std::vector<Optimization> optimizations = {Optimization::kNone};
+  for (Optimization optimization :
+       {Optimization::kSse2, Optimization::kAvx2, Optimization::kNeon}) {
+    if (IsOptimizationAvailable(optimization)) {
+      optimizations.push_back(optimization);
+    }
+  }
+  return optimizations;
+}
+
 std::pair<std::unique_ptr<BinaryFileReader<int16_t, float>>, const size_t>
 CreatePcmSamplesReader(const size_t frame_length) {
   auto ptr = absl::make_unique<BinaryFileReader<int16_t, float>>(
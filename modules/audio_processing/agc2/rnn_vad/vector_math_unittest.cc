@@ -0,0 +1,43 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/agc2/rnn_vad/vector_math.h"
+
+#include <vector>
+
+#include "modules/audio_processing/agc2/rnn_vad/test_utils.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace rnn_vad {
+namespace test {
+
+// Checks that the optimized dot product implementations match the reference
+// one for sizes which are and which are not multiples of the SIMD width.
+TEST(RnnVadTest, VectorMathDotProduct) {
+  for (size_t size : {0, 1, 3, 4, 7, 8, 9, 24, 42, 97}) {
+    SCOPED_TRACE(size);
+    std::vector<float> x(size);
+    std::vector<float> y(size);
+    for (size_t i = 0; i < size; ++i) {
+      x[i] = 0.1f * (static_cast<int>(i % 13) - 6);
+      y[i] = 0.3f * (static_cast<int>(i % 7) - 3);
+    }
+    const float expected = VectorMath(Optimization::kNone).DotProduct(x, y);
+    for (Optimization optimization : GetOptimizationsToTest()) {
+      SCOPED_TRACE(static_cast<int>(optimization));
+      EXPECT_NEAR(expected, VectorMath(optimization).DotProduct(x, y), 1e-5f);
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace rnn_vad
+}  // namespace webrtc
@@ -11,6 +11,7 @@
 #include "modules/audio_processing/audio_processing_impl.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <type_traits>
@@ -150,6 +151,19 @@ static const size_t kMaxAllowedValuesOfSamplesPerFrame = 480;
 // TODO(peah): Decrease this once we properly handle hugely unbalanced
 // reverse and forward call numbers.
 static const size_t kMaxNumFramesToBuffer = 100;
+
+// Inserts |item| into a render queue without ever waiting for the capture side.
+// If the capture side has fallen more than kMaxNumFramesToBuffer frames behind,
+// the item is discarded and counted in |num_dropped_items|.
+template <typename T, typename QueueItemVerifier>
+void InsertRenderQueueItem(SwapQueue<T, QueueItemVerifier>* queue,
+                           T* item,
+                           std::atomic<int>* num_dropped_items) {
+  RTC_DCHECK(queue);
+  if (!queue->Insert(item)) {
+    num_dropped_items->fetch_add(1, std::memory_order_relaxed);
+  }
+}
 }  // namespace
 
 // Throughout webrtc, it's assumed that success is represented by zero.
@@ -693,6 +707,10 @@ void AudioProcessingImpl::ApplyConfig(const AudioProcessing::Config& config) {
       config.noise_suppression.enabled);
   public_submodules_->noise_suppression->set_level(
       NsConfigLevelToInterfaceLevel(config.noise_suppression.level));
+  public_submodules_->noise_suppression->set_implementation(
+      config.noise_suppression.use_vectorized_core
+          ? NoiseSuppression::kVectorized
+          : NoiseSuppression::kReference);
 
   InitializeLowCutFilter();
 
@@ -735,6 +753,13 @@ void AudioProcessingImpl::ApplyConfig(const AudioProcessing::Config& config) {
     private_submodules_->voice_detector->Initialize(
         proc_split_sample_rate_hz());
   }
+
+  UpdateConfigSnapshot();
+}
+
+void AudioProcessingImpl::UpdateConfigSnapshot() {
+  rtc::CritScope cs_config_snapshot(&crit_config_snapshot_);
+  config_snapshot_ = config_;
 }
 
 void AudioProcessingImpl::ApplyAgc1Config(
@@ -979,6 +1004,7 @@ void AudioProcessingImpl::HandleCaptureRuntimeSettings() {
         setting.GetFloat(&value);
         int int_value = static_cast<int>(value + .5f);
         config_.gain_controller1.compression_gain_db = int_value;
+        UpdateConfigSnapshot();
         int error = agc1()->set_compression_gain_db(int_value);
         RTC_DCHECK_EQ(kNoError, error);
         break;
@@ -988,6 +1014,7 @@ void AudioProcessingImpl::HandleCaptureRuntimeSettings() {
           float value;
           setting.GetFloat(&value);
           config_.gain_controller2.fixed_digital.gain_db = value;
+          UpdateConfigSnapshot();
           private_submodules_->gain_controller2->ApplyConfig(
               config_.gain_controller2);
         }
@@ -1042,14 +1069,9 @@ void AudioProcessingImpl::QueueBandedRenderAudio(AudioBuffer* audio) {
                                                 num_reverse_channels(),
                                                 &aec_render_queue_buffer_);
 
-    if (!aec_render_signal_queue_->Insert(&aec_render_queue_buffer_)) {
-      // The data queue is full and needs to be emptied.
-      EmptyQueuedRenderAudio();
-
-      // Retry the insert (should always work).
-      bool result = aec_render_signal_queue_->Insert(&aec_render_queue_buffer_);
-      RTC_DCHECK(result);
-    }
+    InsertRenderQueueItem(aec_render_signal_queue_.get(),
+                          &aec_render_queue_buffer_,
+                          &num_dropped_render_queue_items_);
   }
 
   if (private_submodules_->echo_control_mobile) {
@@ -1058,28 +1080,17 @@ void AudioProcessingImpl::QueueBandedRenderAudio(AudioBuffer* audio) {
                                                  &aecm_render_queue_buffer_);
     RTC_DCHECK(aecm_render_signal_queue_);
     // Insert the samples into the queue.
-    if (!aecm_render_signal_queue_->Insert(&aecm_render_queue_buffer_)) {
-      // The data queue is full and needs to be emptied.
-      EmptyQueuedRenderAudio();
-
-      // Retry the insert (should always work).
-      bool result =
-          aecm_render_signal_queue_->Insert(&aecm_render_queue_buffer_);
-      RTC_DCHECK(result);
-    }
+    InsertRenderQueueItem(aecm_render_signal_queue_.get(),
+                          &aecm_render_queue_buffer_,
+                          &num_dropped_render_queue_items_);
   }
 
   if (!constants_.use_experimental_agc) {
     GainControlImpl::PackRenderAudioBuffer(audio, &agc_render_queue_buffer_);
     // Insert the samples into the queue.
-    if (!agc_render_signal_queue_->Insert(&agc_render_queue_buffer_)) {
-      // The data queue is full and needs to be emptied.
-      EmptyQueuedRenderAudio();
-
-      // Retry the insert (should always work).
-      bool result = agc_render_signal_queue_->Insert(&agc_render_queue_buffer_);
-      RTC_DCHECK(result);
-    }
+    InsertRenderQueueItem(agc_render_signal_queue_.get(),
+                          &agc_render_queue_buffer_,
+                          &num_dropped_render_queue_items_);
   }
 }
 
@@ -1087,14 +1098,9 @@ void AudioProcessingImpl::QueueNonbandedRenderAudio(AudioBuffer* audio) {
   ResidualEchoDetector::PackRenderAudioBuffer(audio, &red_render_queue_buffer_);
 
   // Insert the samples into the queue.
-  if (!red_render_signal_queue_->Insert(&red_render_queue_buffer_)) {
-    // The data queue is full and needs to be emptied.
-    EmptyQueuedRenderAudio();
-
-    // Retry the insert (should always work).
-    bool result = red_render_signal_queue_->Insert(&red_render_queue_buffer_);
-    RTC_DCHECK(result);
-  }
+  InsertRenderQueueItem(red_render_signal_queue_.get(),
+                        &red_render_queue_buffer_,
+                        &num_dropped_render_queue_items_);
 }
 
 void AudioProcessingImpl::AllocateRenderQueue() {
@@ -1147,7 +1153,12 @@ void AudioProcessingImpl::AllocateRenderQueue() {
 }
 
 void AudioProcessingImpl::EmptyQueuedRenderAudio() {
-  rtc::CritScope cs_capture(&crit_capture_);
+  const int num_dropped_items = num_dropped_render_queue_items_.exchange(0);
+  if (num_dropped_items > 0) {
+    RTC_LOG(LS_WARNING) << "The render queues were full. " << num_dropped_items
+                        << " items of render data were discarded.";
+  }
+
   if (private_submodules_->echo_cancellation) {
     RTC_DCHECK(aec_render_signal_queue_);
     while (aec_render_signal_queue_->Remove(&aec_capture_queue_buffer_)) {
@@ -1779,9 +1790,8 @@ void AudioProcessingImpl::MutateConfig(
 }
 
 AudioProcessing::Config AudioProcessingImpl::GetConfig() const {
-  rtc::CritScope cs_render(&crit_render_);
-  rtc::CritScope cs_capture(&crit_capture_);
-  return config_;
+  rtc::CritScope cs(&crit_config_snapshot_);
+  return config_snapshot_;
 }
 
 bool AudioProcessingImpl::UpdateActiveSubmoduleStates() {
@@ -11,6 +11,7 @@
 #ifndef MODULES_AUDIO_PROCESSING_AUDIO_PROCESSING_IMPL_H_
 #define MODULES_AUDIO_PROCESSING_AUDIO_PROCESSING_IMPL_H_
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <vector>
@@ -254,12 +255,18 @@ class AudioProcessingImpl : public AudioProcessing {
   void ApplyAgc1Config(const Config::GainController1& agc_config)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_capture_);
 
+  // Publishes |config_| to GetConfig(). Must be called whenever |config_|
+  // changes.
+  void UpdateConfigSnapshot() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_capture_);
+
   // Returns a direct pointer to the AGC1 submodule: either a GainControlImpl
   // or GainControlForExperimentalAgc instance.
   GainControl* agc1();
   const GainControl* agc1() const;
 
-  void EmptyQueuedRenderAudio();
+  // Hands the render side data queued since the last call over to the capture
+  // side submodules.
+  void EmptyQueuedRenderAudio() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_capture_);
   void AllocateRenderQueue()
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_render_, crit_capture_);
   void QueueBandedRenderAudio(AudioBuffer* audio)
@@ -323,6 +330,13 @@ class AudioProcessingImpl : public AudioProcessing {
   // Struct containing the Config specifying the behavior of APM.
   AudioProcessing::Config config_;
 
+  // Copy of |config_| that is returned by GetConfig(). It has a lock of its
+  // own so that querying the configuration never waits for an ongoing render
+  // or capture call, and never holds up one.
+  rtc::CriticalSection crit_config_snapshot_ RTC_ACQUIRED_AFTER(crit_capture_);
+  AudioProcessing::Config config_snapshot_
+      RTC_GUARDED_BY(crit_config_snapshot_);
+
   // Class containing information about what submodules are active.
   ApmSubmoduleStates submodule_states_;
 
@@ -451,6 +465,11 @@ class AudioProcessingImpl : public AudioProcessing {
       agc_render_signal_queue_;
   std::unique_ptr<SwapQueue<std::vector<float>, RenderQueueItemVerifier<float>>>
       red_render_signal_queue_;
+
+  // Number of items that did not fit into the render queues since the capture
+  // side last emptied them. The render side never waits for the capture side,
+  // so it drops data rather than blocking when the queues are full.
+  std::atomic<int> num_dropped_render_queue_items_{0};
 };
 
 }  // namespace webrtc
@@ -10,7 +10,10 @@
 
 #include "modules/audio_processing/audio_processing_impl.h"
 
+#include <stdio.h>
+
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -20,6 +23,7 @@
 #include "rtc_base/event.h"
 #include "rtc_base/platform_thread.h"
 #include "rtc_base/random.h"
+#include "rtc_base/time_utils.h"
 #include "system_wrappers/include/sleep.h"
 #include "test/gtest.h"
 
@@ -1091,8 +1095,133 @@ void RenderProcessor::ApplyRuntimeSettingScheme() {
                frame_data_.input_number_of_channels);
 }
 
+// Prints the distribution of the API call durations in |durations_us|.
+void PrintCallDurations(const char* api_call,
+                        std::vector<int64_t>* durations_us) {
+  ASSERT_FALSE(durations_us->empty());
+  std::sort(durations_us->begin(), durations_us->end());
+  int64_t total_us = 0;
+  for (int64_t duration_us : *durations_us) {
+    total_us += duration_us;
+  }
+  const size_t num_calls = durations_us->size();
+  printf("%s() duration: mean %.1f us, median %lld us, "
+         "99th percentile %lld us, max %lld us\n",
+         api_call, static_cast<double>(total_us) / num_calls,
+         static_cast<long long>((*durations_us)[num_calls / 2]),
+         static_cast<long long>((*durations_us)[num_calls * 99 / 100]),
+         static_cast<long long>(durations_us->back()));
+}
+
+// Stress setup for measuring how long the audio threads can be held up by each
+// other and by a third thread using APM: the render thread mostly runs in real
+// time but occasionally delivers bursts that overflow the render queues, and a
+// query thread keeps reading the configuration and the statistics.
+class ApiCallLatencyStressTest : public ::testing::Test {
+ protected:
+  static constexpr int kSampleRateHz = 48000;
+  static constexpr int kNumFramesPerChunk = kSampleRateHz / 100;
+  static constexpr int kMaxRenderBurstLength = 250;
+
+  ApiCallLatencyStressTest()
+      : render_thread_(RenderThreadFunc,
+                       this,
+                       "render",
+                       rtc::kRealtimePriority),
+        query_thread_(QueryThreadFunc, this, "query", rtc::kNormalPriority),
+        apm_(AudioProcessingBuilder().Create()) {}
+
+  void StartThreads() {
+    render_thread_.Start();
+    query_thread_.Start();
+  }
+
+  void StopThreads() {
+    done_ = true;
+    render_thread_.Stop();
+    query_thread_.Stop();
+  }
+
+  static void RenderThreadFunc(void* context) {
+    ApiCallLatencyStressTest* test =
+        static_cast<ApiCallLatencyStressTest*>(context);
+    AudioFrameData frame_data(kNumFramesPerChunk);
+    const StreamConfig stream_config(kSampleRateHz, 1);
+    while (!test->done_) {
+      const int burst_length = test->rand_gen_.RandInt(20) == 0
+                                   ? kMaxRenderBurstLength
+                                   : test->rand_gen_.RandInt(1, 3);
+      for (int k = 0; k < burst_length; ++k) {
+        PopulateAudioFrame(&frame_data.input_frame[0], 0.5f, 1,
+                           kNumFramesPerChunk, &test->rand_gen_);
+        const int64_t start_us = rtc::TimeMicros();
+        EXPECT_EQ(AudioProcessing::kNoError,
+                  test->apm_->ProcessReverseStream(
+                      &frame_data.input_frame[0], stream_config,
+                      stream_config, &frame_data.output_frame[0]));
+        test->render_durations_us_.push_back(rtc::TimeMicros() - start_us);
+      }
+      SleepMs(10 * burst_length);
+    }
+  }
+
+  static void QueryThreadFunc(void* context) {
+    ApiCallLatencyStressTest* test =
+        static_cast<ApiCallLatencyStressTest*>(context);
+    while (!test->done_) {
+      EXPECT_TRUE(test->apm_->GetConfig().echo_canceller.enabled);
+      test->apm_->GetStatistics(/*has_remote_tracks=*/true);
+      SleepMs(1);
+    }
+  }
+
+  std::atomic<bool> done_{false};
+  RandomGenerator rand_gen_;
+  // Only accessed by the render thread while it runs.
+  std::vector<int64_t> render_durations_us_;
+  rtc::PlatformThread render_thread_;
+  rtc::PlatformThread query_thread_;
+  std::unique_ptr<AudioProcessing> apm_;
+};
+
 }  // anonymous namespace
 
+// Reports the distributions of the ProcessStream() and ProcessReverseStream()
+// call durations under the load of ApiCallLatencyStressTest.
+TEST_F(ApiCallLatencyStressTest, DISABLED_WorstCaseApiCallLatency) {
+  AudioProcessing::Config apm_config;
+  apm_config.echo_canceller.enabled = true;
+  apm_config.residual_echo_detector.enabled = true;
+  apm_config.noise_suppression.enabled = true;
+  apm_config.gain_controller1.enabled = true;
+  apm_config.gain_controller1.mode =
+      AudioProcessing::Config::GainController1::kAdaptiveDigital;
+  apm_->ApplyConfig(apm_config);
+
+  constexpr int kNumCaptureCalls = 1500;
+  AudioFrameData frame_data(kNumFramesPerChunk);
+  const StreamConfig stream_config(kSampleRateHz, 1);
+  std::vector<int64_t> capture_durations_us;
+  capture_durations_us.reserve(kNumCaptureCalls);
+
+  StartThreads();
+  for (int k = 0; k < kNumCaptureCalls; ++k) {
+    PopulateAudioFrame(&frame_data.input_frame[0], 0.03125f, 1,
+                       kNumFramesPerChunk, &rand_gen_);
+    const int64_t start_us = rtc::TimeMicros();
+    apm_->set_stream_delay_ms(0);
+    EXPECT_EQ(AudioProcessing::kNoError,
+              apm_->ProcessStream(&frame_data.input_frame[0], stream_config,
+                                  stream_config, &frame_data.output_frame[0]));
+    capture_durations_us.push_back(rtc::TimeMicros() - start_us);
+    SleepMs(10);
+  }
+  StopThreads();
+
+  PrintCallDurations("ProcessStream", &capture_durations_us);
+  PrintCallDurations("ProcessReverseStream", &render_durations_us_);
+}
+
 TEST_P(AudioProcessingImplLockTest, LockTest) {
   // Run test and verify that it did not time out.
   ASSERT_TRUE(RunTest());
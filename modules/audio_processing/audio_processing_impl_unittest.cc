@@ -10,6 +10,7 @@
 
 #include "modules/audio_processing/audio_processing_impl.h"
 
+#include <atomic>
 #include <memory>
 
 #include "absl/memory/memory.h"
@@ -18,6 +19,8 @@
 #include "modules/audio_processing/test/echo_control_mock.h"
 #include "modules/audio_processing/test/test_utils.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
 #include "rtc_base/ref_counted_object.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
@@ -141,6 +144,42 @@ class TestRenderPreProcessor : public CustomProcessing {
   static constexpr float ProcessSample(float x) { return 2.f * x; }
 };
 
+// Capture post-processor that, once armed, parks the capture thread in the
+// middle of ProcessStream(), i.e., while APM holds its capture lock.
+class BlockingCapturePostProcessor : public CustomProcessing {
+ public:
+  BlockingCapturePostProcessor(rtc::Event* entered, rtc::Event* release)
+      : entered_(entered), release_(release) {}
+  void Initialize(int sample_rate_hz, int num_channels) override {}
+  void Process(AudioBuffer* audio) override {
+    if (block_next_call_.exchange(false)) {
+      entered_->Set();
+      release_->Wait(rtc::Event::kForever);
+    }
+  }
+  std::string ToString() const override {
+    return "BlockingCapturePostProcessor";
+  }
+  void SetRuntimeSetting(AudioProcessing::RuntimeSetting setting) override {}
+  void BlockNextCall() { block_next_call_ = true; }
+
+ private:
+  rtc::Event* const entered_;
+  rtc::Event* const release_;
+  std::atomic<bool> block_next_call_{false};
+};
+
+struct CaptureCall {
+  AudioProcessing* apm;
+  AudioFrame* frame;
+  int result;
+};
+
+void ProcessStreamThreadFunc(void* context) {
+  CaptureCall* call = static_cast<CaptureCall*>(context);
+  call->result = call->apm->ProcessStream(call->frame);
+}
+
 }  // namespace
 
 TEST(AudioProcessingImplTest, AudioParameterChangeTriggersInit) {
@@ -211,6 +250,46 @@ TEST(AudioProcessingImplTest, UpdateCapturePreGainRuntimeSetting) {
       << "Frame should be amplified.";
 }
 
+TEST(AudioProcessingImplTest, RuntimeGainsSurviveConfigProxySetters) {
+  std::unique_ptr<AudioProcessing> apm(AudioProcessingBuilder().Create());
+  webrtc::AudioProcessing::Config apm_config;
+  apm_config.gain_controller1.enabled = true;
+  apm_config.gain_controller2.enabled = true;
+  apm->ApplyConfig(apm_config);
+
+  AudioFrame frame;
+  InitializeAudioFrame(16000, 1, &frame);
+  FillFixedFrame(1000, &frame);
+  apm->set_stream_analog_level(100);
+  apm->ProcessStream(&frame);
+
+  constexpr int kCompressionGainDb = 15;
+  constexpr float kFixedPostGainDb = 6.f;
+  apm->SetRuntimeSetting(
+      AudioProcessing::RuntimeSetting::CreateCompressionGainDb(
+          kCompressionGainDb));
+  apm->SetRuntimeSetting(
+      AudioProcessing::RuntimeSetting::CreateCaptureFixedPostGain(
+          kFixedPostGainDb));
+  // The runtime settings are applied by the next capture call.
+  apm->set_stream_analog_level(100);
+  apm->ProcessStream(&frame);
+  EXPECT_EQ(kCompressionGainDb,
+            apm->GetConfig().gain_controller1.compression_gain_db);
+  EXPECT_EQ(kFixedPostGainDb,
+            apm->GetConfig().gain_controller2.fixed_digital.gain_db);
+
+  // The proxies apply a modified copy of GetConfig(), which must not revert
+  // the gains set at runtime.
+  apm->gain_control()->enable_limiter(false);
+  apm->noise_suppression()->Enable(true);
+  const AudioProcessing::Config config = apm->GetConfig();
+  EXPECT_FALSE(config.gain_controller1.enable_limiter);
+  EXPECT_TRUE(config.noise_suppression.enabled);
+  EXPECT_EQ(kCompressionGainDb, config.gain_controller1.compression_gain_db);
+  EXPECT_EQ(kFixedPostGainDb, config.gain_controller2.fixed_digital.gain_db);
+}
+
 TEST(AudioProcessingImplTest,
      EchoControllerObservesPreAmplifierEchoPathGainChange) {
   // Tests that the echo controller observes an echo path gain change when the
@@ -396,4 +475,58 @@ TEST(AudioProcessingImplTest, RenderPreProcessorBeforeEchoDetector) {
             test_echo_detector->last_render_audio_first_sample());
 }
 
+TEST(AudioProcessingImplTest, RenderDoesNotWaitForCapture) {
+  constexpr int kTimeoutMs = 10000;
+  rtc::Event capture_entered;
+  rtc::Event release_capture;
+  auto post_processor = absl::make_unique<BlockingCapturePostProcessor>(
+      &capture_entered, &release_capture);
+  BlockingCapturePostProcessor* post_processor_ptr = post_processor.get();
+  std::unique_ptr<AudioProcessing> apm(
+      AudioProcessingBuilder()
+          .SetCapturePostProcessing(std::move(post_processor))
+          .Create());
+
+  constexpr int kSampleRateHz = 16000;
+  AudioFrame render_frame;
+  InitializeAudioFrame(kSampleRateHz, 1, &render_frame);
+  FillFixedFrame(1000, &render_frame);
+  AudioFrame capture_frame;
+  InitializeAudioFrame(kSampleRateHz, 1, &capture_frame);
+  FillFixedFrame(1000, &capture_frame);
+
+  // Settle the stream formats so that no reinitialization is needed below.
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->ProcessReverseStream(&render_frame));
+  ASSERT_EQ(AudioProcessing::kNoError, apm->ProcessStream(&capture_frame));
+
+  // Park the capture thread inside ProcessStream().
+  post_processor_ptr->BlockNextCall();
+  CaptureCall capture_call = {apm.get(), &capture_frame,
+                              AudioProcessing::kUnspecifiedError};
+  rtc::PlatformThread capture_thread(ProcessStreamThreadFunc, &capture_call,
+                                     "capture");
+  capture_thread.Start();
+  ASSERT_TRUE(capture_entered.Wait(kTimeoutMs));
+
+  // Render well past the capacity of the render queues. None of these calls
+  // may wait for the capture thread.
+  for (int i = 0; i < 300; ++i) {
+    ASSERT_EQ(AudioProcessing::kNoError,
+              apm->ProcessReverseStream(&render_frame));
+  }
+  // The configuration can be read while the capture thread is busy.
+  EXPECT_FALSE(apm->GetConfig().echo_canceller.enabled);
+
+  release_capture.Set();
+  capture_thread.Stop();
+  EXPECT_EQ(AudioProcessing::kNoError, capture_call.result);
+
+  // Capture recovers once the dropped render frames have been accounted for.
+  ASSERT_EQ(AudioProcessing::kNoError, apm->ProcessStream(&capture_frame));
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->ProcessReverseStream(&render_frame));
+  ASSERT_EQ(AudioProcessing::kNoError, apm->ProcessStream(&capture_frame));
+}
+
 }  // namespace webrtc
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+
+#include <memory>
+
+#include "api/audio/audio_frame.h"
+#include "modules/audio_processing/include/audio_processing.h"
+#include "rtc_base/checks.h"
+#include "test/gtest.h"
+#include "test/testsupport/microbenchmark.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kSampleRateHz = 48000;
+constexpr size_t kSamplesPerChannel = kSampleRateHz / 100;
+
+// Fills |frame| with 10 ms of a tone of |frequency_hz| that starts at
+// |sample_index|.
+void GenerateTone(int frequency_hz, size_t sample_index, AudioFrame* frame) {
+  int16_t* data = frame->mutable_data();
+  for (size_t i = 0; i < kSamplesPerChannel; ++i) {
+    data[i] = static_cast<int16_t>(
+        5000 * sin(2 * M_PI * frequency_hz * (sample_index + i) /
+                   kSampleRateHz));
+  }
+}
+
+}  // namespace
+
+// Processes 10 ms of 48 kHz mono render and capture audio with the submodules
+// that a call on a desktop client enables.
+TEST(AudioProcessingMicrobenchmark, ApmProcessStream) {
+  std::unique_ptr<AudioProcessing> apm(AudioProcessingBuilder().Create());
+  AudioProcessing::Config config;
+  config.high_pass_filter.enabled = true;
+  config.echo_canceller.enabled = true;
+  config.noise_suppression.enabled = true;
+  config.gain_controller1.enabled = true;
+  config.gain_controller1.mode =
+      AudioProcessing::Config::GainController1::kAdaptiveDigital;
+  apm->ApplyConfig(config);
+
+  AudioFrame render_frame;
+  AudioFrame capture_frame;
+  for (AudioFrame* frame : {&render_frame, &capture_frame}) {
+    frame->sample_rate_hz_ = kSampleRateHz;
+    frame->samples_per_channel_ = kSamplesPerChannel;
+    frame->num_channels_ = 1;
+  }
+  size_t sample_index = 0;
+  test::RunMicrobenchmark("ApmProcessStream", [&] {
+    GenerateTone(440, sample_index, &render_frame);
+    GenerateTone(1000, sample_index, &capture_frame);
+    sample_index += kSamplesPerChannel;
+    RTC_CHECK_EQ(AudioProcessing::kNoError,
+                 apm->ProcessReverseStream(&render_frame));
+    apm->set_stream_delay_ms(50);
+    RTC_CHECK_EQ(AudioProcessing::kNoError,
+                 apm->ProcessStream(&capture_frame));
+  });
+  EXPECT_EQ(capture_frame.samples_per_channel_, kSamplesPerChannel);
+}
+
+}  // namespace webrtc
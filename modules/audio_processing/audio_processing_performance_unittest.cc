@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "api/array_view.h"
+#include "api/audio/echo_canceller3_factory.h"
 #include "modules/audio_processing/test/test_utils.h"
 #include "rtc_base/atomic_ops.h"
 #include "rtc_base/event.h"
@@ -43,7 +44,9 @@ enum class SettingsType {
   kDefaultApmMobile,
   kAllSubmodulesTurnedOff,
   kDefaultApmDesktopWithoutDelayAgnostic,
-  kDefaultApmDesktopWithoutExtendedFilter
+  kDefaultApmDesktopWithoutExtendedFilter,
+  kDefaultApmDesktopWithAec3,
+  kDefaultApmDesktopWithTransientSuppression
 };
 
 // Variables related to the audio data and formats.
@@ -81,7 +84,9 @@ struct SimulationConfig {
     const SettingsType desktop_settings[] = {
         SettingsType::kDefaultApmDesktop, SettingsType::kAllSubmodulesTurnedOff,
         SettingsType::kDefaultApmDesktopWithoutDelayAgnostic,
-        SettingsType::kDefaultApmDesktopWithoutExtendedFilter};
+        SettingsType::kDefaultApmDesktopWithoutExtendedFilter,
+        SettingsType::kDefaultApmDesktopWithAec3,
+        SettingsType::kDefaultApmDesktopWithTransientSuppression};
 
     const int desktop_sample_rates[] = {8000, 16000, 32000, 48000};
 
@@ -123,6 +128,12 @@ struct SimulationConfig {
       case SettingsType::kDefaultApmDesktopWithoutExtendedFilter:
         description = "DefaultApmDesktopWithoutExtendedFilter";
         break;
+      case SettingsType::kDefaultApmDesktopWithAec3:
+        description = "DefaultApmDesktopWithAec3";
+        break;
+      case SettingsType::kDefaultApmDesktopWithTransientSuppression:
+        description = "DefaultApmDesktopWithTransientSuppression";
+        break;
     }
     return description;
   }
@@ -539,6 +550,26 @@ class CallSimulator : public ::testing::TestWithParam<SimulationConfig> {
         apm_->SetExtraOptions(config);
         break;
       }
+      case SettingsType::kDefaultApmDesktopWithAec3: {
+        apm_.reset(AudioProcessingBuilder()
+                       .SetEchoControlFactory(
+                           std::unique_ptr<EchoControlFactory>(
+                               new EchoCanceller3Factory()))
+                       .Create());
+        ASSERT_TRUE(!!apm_);
+        set_default_desktop_apm_runtime_settings(apm_.get());
+        break;
+      }
+      case SettingsType::kDefaultApmDesktopWithTransientSuppression: {
+        Config config;
+        add_default_desktop_config(&config);
+        config.Set<ExperimentalNs>(new ExperimentalNs(true));
+        apm_.reset(AudioProcessingBuilder().Create(config));
+        ASSERT_TRUE(!!apm_);
+        set_default_desktop_apm_runtime_settings(apm_.get());
+        apm_->SetExtraOptions(config);
+        break;
+      }
     }
 
     render_thread_state_.reset(new TimedThreadApiProcessor(
@@ -271,6 +271,9 @@ class AudioProcessing : public rtc::RefCountInterface {
       bool enabled = false;
       enum Level { kLow, kModerate, kHigh, kVeryHigh };
       Level level = kModerate;
+      // Uses the vectorized floating point core, see
+      // NoiseSuppression::set_implementation().
+      bool use_vectorized_core = false;
     } noise_suppression;
 
     // Enables reporting of |has_voice| in webrtc::AudioProcessingStats.
@@ -894,6 +897,16 @@ class NoiseSuppression {
   virtual int set_level(Level level) = 0;
   virtual Level level() const = 0;
 
+  // Selects the floating point suppressor core. The vectorized core batches
+  // the spectral updates and evaluates log() and exp() with SIMD
+  // approximations, so its output deviates slightly from the reference core.
+  // Only the reference core is supported in fixed point, for which
+  // |kUnsupportedFunctionError| is returned for |kVectorized|.
+  enum Implementation { kReference, kVectorized };
+
+  virtual int set_implementation(Implementation implementation) = 0;
+  virtual Implementation implementation() const = 0;
+
   // Returns the internally computed prior speech probability of current frame
   // averaged over output channels. This is not supported in fixed point, for
   // which |kUnsupportedFunctionError| is returned.
@@ -57,6 +57,8 @@ class MockNoiseSuppression : public NoiseSuppression {
   MOCK_CONST_METHOD0(is_enabled, bool());
   MOCK_METHOD1(set_level, int(Level level));
   MOCK_CONST_METHOD0(level, Level());
+  MOCK_METHOD1(set_implementation, int(Implementation implementation));
+  MOCK_CONST_METHOD0(implementation, Implementation());
   MOCK_CONST_METHOD0(speech_probability, float());
   MOCK_METHOD0(NoiseEstimate, std::vector<float>());
 };
@@ -68,6 +68,7 @@ void NoiseSuppressionImpl::Initialize(size_t channels, int sample_rate_hz) {
   }
   suppressors_.swap(new_suppressors);
   set_level(level_);
+  set_implementation(implementation_);
 }
 
 void NoiseSuppressionImpl::AnalyzeCaptureAudio(AudioBuffer* audio) {
@@ -153,6 +154,29 @@ NoiseSuppression::Level NoiseSuppressionImpl::level() const {
   return level_;
 }
 
+int NoiseSuppressionImpl::set_implementation(Implementation implementation) {
+  rtc::CritScope cs(crit_);
+#if defined(WEBRTC_NS_FLOAT)
+  implementation_ = implementation;
+  for (auto& suppressor : suppressors_) {
+    int error = WebRtcNs_set_vectorized(suppressor->state(),
+                                        implementation == kVectorized);
+    RTC_DCHECK_EQ(0, error);
+  }
+  return AudioProcessing::kNoError;
+#elif defined(WEBRTC_NS_FIXED)
+  if (implementation != kReference) {
+    return AudioProcessing::kUnsupportedFunctionError;
+  }
+  return AudioProcessing::kNoError;
+#endif
+}
+
+NoiseSuppression::Implementation NoiseSuppressionImpl::implementation() const {
+  rtc::CritScope cs(crit_);
+  return implementation_;
+}
+
 float NoiseSuppressionImpl::speech_probability() const {
   rtc::CritScope cs(crit_);
 #if defined(WEBRTC_NS_FLOAT)
@@ -37,6 +37,8 @@ class NoiseSuppressionImpl : public NoiseSuppression {
   bool is_enabled() const override;
   int set_level(Level level) override;
   Level level() const override;
+  int set_implementation(Implementation implementation) override;
+  Implementation implementation() const override;
   float speech_probability() const override;
   std::vector<float> NoiseEstimate() override;
   static size_t num_noise_bins();
@@ -46,6 +48,7 @@ class NoiseSuppressionImpl : public NoiseSuppression {
   rtc::CriticalSection* const crit_;
   bool enabled_ RTC_GUARDED_BY(crit_) = false;
   Level level_ RTC_GUARDED_BY(crit_) = kModerate;
+  Implementation implementation_ RTC_GUARDED_BY(crit_) = kReference;
   size_t channels_ RTC_GUARDED_BY(crit_) = 0;
   int sample_rate_hz_ RTC_GUARDED_BY(crit_) = 0;
   std::vector<std::unique_ptr<Suppressor>> suppressors_ RTC_GUARDED_BY(crit_);
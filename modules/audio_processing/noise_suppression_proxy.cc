@@ -61,6 +61,23 @@ NoiseSuppression::Level NoiseSuppressionProxy::level() const {
   return ns_->level();
 }
 
+int NoiseSuppressionProxy::set_implementation(Implementation implementation) {
+  AudioProcessing::Config config = apm_->GetConfig();
+  const bool use_vectorized_core = implementation == kVectorized;
+  if (config.noise_suppression.use_vectorized_core != use_vectorized_core) {
+    config.noise_suppression.use_vectorized_core = use_vectorized_core;
+    apm_->ApplyConfig(config);
+  }
+  return ns_->implementation() == implementation
+             ? AudioProcessing::kNoError
+             : AudioProcessing::kUnsupportedFunctionError;
+}
+
+NoiseSuppression::Implementation NoiseSuppressionProxy::implementation()
+    const {
+  return ns_->implementation();
+}
+
 float NoiseSuppressionProxy::speech_probability() const {
   return ns_->speech_probability();
 }
@@ -32,6 +32,8 @@ class NoiseSuppressionProxy : public NoiseSuppression {
   bool is_enabled() const override;
   int set_level(Level level) override;
   Level level() const override;
+  int set_implementation(Implementation implementation) override;
+  Implementation implementation() const override;
   float speech_probability() const override;
   std::vector<float> NoiseEstimate() override;
 
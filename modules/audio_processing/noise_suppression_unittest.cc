@@ -281,4 +281,25 @@ TEST(NoiseSuppresionBitExactnessTest, Mono16kHzVeryHigh) {
                       kOutputReference);
 }
 
+TEST(NoiseSuppressionImplementationTest, SelectsImplementation) {
+  rtc::CriticalSection crit_capture;
+  NoiseSuppressionImpl noise_suppressor(&crit_capture);
+  noise_suppressor.Initialize(1, AudioProcessing::kSampleRate16kHz);
+  noise_suppressor.Enable(true);
+  EXPECT_EQ(NoiseSuppression::kReference, noise_suppressor.implementation());
+
+#if defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
+  EXPECT_EQ(AudioProcessing::kNoError,
+            noise_suppressor.set_implementation(NoiseSuppression::kVectorized));
+  EXPECT_EQ(NoiseSuppression::kVectorized, noise_suppressor.implementation());
+  // The selection is kept when the suppressors are recreated.
+  noise_suppressor.Initialize(2, AudioProcessing::kSampleRate48kHz);
+  EXPECT_EQ(NoiseSuppression::kVectorized, noise_suppressor.implementation());
+#else
+  EXPECT_EQ(AudioProcessing::kUnsupportedFunctionError,
+            noise_suppressor.set_implementation(NoiseSuppression::kVectorized));
+  EXPECT_EQ(NoiseSuppression::kReference, noise_suppressor.implementation());
+#endif
+}
+
 }  // namespace webrtc
@@ -20,10 +20,14 @@
 NsHandle* WebRtcNs_Create() {
   NoiseSuppressionC* self = malloc(sizeof(NoiseSuppressionC));
   self->initFlag = 0;
+  self->fft = NULL;
   return (NsHandle*)self;
 }
 
 void WebRtcNs_Free(NsHandle* NS_inst) {
+  if (NS_inst) {
+    WebRtc_FreeRealFft(((NoiseSuppressionC*)NS_inst)->fft);
+  }
   free(NS_inst);
 }
 
@@ -35,6 +39,10 @@ int WebRtcNs_set_policy(NsHandle* NS_inst, int mode) {
   return WebRtcNs_set_policy_core((NoiseSuppressionC*)NS_inst, mode);
 }
 
+int WebRtcNs_set_vectorized(NsHandle* NS_inst, int enable) {
+  return WebRtcNs_set_vectorized_core((NoiseSuppressionC*)NS_inst, enable);
+}
+
 void WebRtcNs_Analyze(NsHandle* NS_inst, const float* spframe) {
   WebRtcNs_AnalyzeCore((NoiseSuppressionC*)NS_inst, spframe);
 }
@@ -65,6 +65,23 @@ int WebRtcNs_Init(NsHandle* NS_inst, uint32_t fs);
  */
 int WebRtcNs_set_policy(NsHandle* NS_inst, int mode);
 
+/*
+ * This selects the vectorized core, which evaluates log() and exp() with SIMD
+ * approximations. Its output matches the reference core within a small
+ * tolerance.
+ *
+ * Input:
+ *      - NS_inst       : Noise suppression instance.
+ *      - enable        : 0: Reference core, 1: Vectorized core
+ *
+ * Output:
+ *      - NS_inst       : Updated instance.
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int WebRtcNs_set_vectorized(NsHandle* NS_inst, int enable);
+
 /*
  * This functions estimates the background noise for the inserted speech frame.
  * The input and output signals should always be 10ms (80 or 160 samples).
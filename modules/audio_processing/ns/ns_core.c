@@ -14,10 +14,84 @@
 
 #include "rtc_base/checks.h"
 #include "common_audio/signal_processing/include/signal_processing_library.h"
-#include "common_audio/third_party/fft4g/fft4g.h"
+#include "common_audio/fft/real_fft_c_api.h"
 #include "modules/audio_processing/ns/noise_suppression.h"
 #include "modules/audio_processing/ns/ns_core.h"
 #include "modules/audio_processing/ns/windows_private.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+
+// Computes |y| = log(|x|).
+static void LogC(const float* x, size_t length, float* y) {
+  size_t i;
+  for (i = 0; i < length; i++) {
+    y[i] = (float)log(x[i]);
+  }
+}
+
+// Computes |y| = exp(|x|).
+static void ExpC(const float* x, size_t length, float* y) {
+  size_t i;
+  for (i = 0; i < length; i++) {
+    y[i] = (float)exp(x[i]);
+  }
+}
+
+// Updates the log quantile estimate |lquantile| and its density estimate
+// |density| with the log magnitude spectrum |lmagn|.
+static void UpdateQuantileC(const float* lmagn,
+                            size_t length,
+                            int counter,
+                            float* lquantile,
+                            float* density) {
+  size_t i;
+  float delta;
+
+  // newquantest(...)
+  for (i = 0; i < length; i++) {
+    // Compute delta.
+    if (density[i] > 1.0) {
+      delta = FACTOR * 1.f / density[i];
+    } else {
+      delta = FACTOR;
+    }
+
+    // Update log quantile estimate.
+    if (lmagn[i] > lquantile[i]) {
+      lquantile[i] += QUANTILE * delta / (float)(counter + 1);
+    } else {
+      lquantile[i] -= (1.f - QUANTILE) * delta / (float)(counter + 1);
+    }
+
+    // Update density estimate.
+    if (fabs(lmagn[i] - lquantile[i]) < WIDTH) {
+      density[i] =
+          ((float)counter * density[i] + 1.f / (2.f * WIDTH)) /
+          (float)(counter + 1);
+    }
+  }  // End loop over magnitude spectrum.
+}
+
+NsLog WebRtcNs_Log;
+NsExp WebRtcNs_Exp;
+NsUpdateQuantile WebRtcNs_UpdateQuantile;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Initialize function pointers for SSE2.
+static void WebRtcNs_InitSse2(void) {
+  WebRtcNs_Log = WebRtcNs_LogSse2;
+  WebRtcNs_Exp = WebRtcNs_ExpSse2;
+  WebRtcNs_UpdateQuantile = WebRtcNs_UpdateQuantileSse2;
+}
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+// Initialize function pointers for ARM Neon platform.
+static void WebRtcNs_InitNeon(void) {
+  WebRtcNs_Log = WebRtcNs_LogNeon;
+  WebRtcNs_Exp = WebRtcNs_ExpNeon;
+  WebRtcNs_UpdateQuantile = WebRtcNs_UpdateQuantileNeon;
+}
+#endif
 
 // Set Feature Extraction Parameters.
 static void set_feature_extraction_parameters(NoiseSuppressionC* self) {
@@ -97,10 +171,9 @@ int WebRtcNs_InitCore(NoiseSuppressionC* self, uint32_t fs) {
   }
   self->magnLen = self->anaLen / 2 + 1;  // Number of frequency bins.
 
-  // Initialize FFT work arrays.
-  self->ip[0] = 0;  // Setting this triggers initialization.
-  memset(self->dataBuf, 0, sizeof(float) * ANAL_BLOCKL_MAX);
-  WebRtc_rdft(self->anaLen, 1, self->dataBuf, self->ip, self->wfft);
+  // Initialize the FFT, whose length depends on the sample rate.
+  WebRtc_FreeRealFft(self->fft);
+  self->fft = WebRtc_CreateRealFft(self->anaLen);
 
   memset(self->analyzeBuf, 0, sizeof(float) * ANAL_BLOCKL_MAX);
   memset(self->dataBuf, 0, sizeof(float) * ANAL_BLOCKL_MAX);
@@ -210,6 +283,22 @@ int WebRtcNs_InitCore(NoiseSuppressionC* self, uint32_t fs) {
 
   // Default mode.
   WebRtcNs_set_policy_core(self, 0);
+  self->vectorized = 0;
+
+  // Initialize function pointers.
+  WebRtcNs_Log = LogC;
+  WebRtcNs_Exp = ExpC;
+  WebRtcNs_UpdateQuantile = UpdateQuantileC;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcNs_InitSse2();
+  }
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+  WebRtcNs_InitNeon();
+#endif
 
   self->initFlag = 1;
   return 0;
@@ -220,53 +309,29 @@ static void NoiseEstimation(NoiseSuppressionC* self,
                             float* magn,
                             float* noise) {
   size_t i, s, offset;
-  float lmagn[HALF_ANAL_BLOCKL], delta;
+  float lmagn[HALF_ANAL_BLOCKL];
+  const NsLog log_kernel = self->vectorized ? WebRtcNs_Log : LogC;
+  const NsExp exp_kernel = self->vectorized ? WebRtcNs_Exp : ExpC;
+  const NsUpdateQuantile update_quantile_kernel =
+      self->vectorized ? WebRtcNs_UpdateQuantile : UpdateQuantileC;
 
   if (self->updates < END_STARTUP_LONG) {
     self->updates++;
   }
 
-  for (i = 0; i < self->magnLen; i++) {
-    lmagn[i] = (float)log(magn[i]);
-  }
+  log_kernel(magn, self->magnLen, lmagn);
 
   // Loop over simultaneous estimates.
   for (s = 0; s < SIMULT; s++) {
     offset = s * self->magnLen;
 
-    // newquantest(...)
-    for (i = 0; i < self->magnLen; i++) {
-      // Compute delta.
-      if (self->density[offset + i] > 1.0) {
-        delta = FACTOR * 1.f / self->density[offset + i];
-      } else {
-        delta = FACTOR;
-      }
-
-      // Update log quantile estimate.
-      if (lmagn[i] > self->lquantile[offset + i]) {
-        self->lquantile[offset + i] +=
-            QUANTILE * delta / (float)(self->counter[s] + 1);
-      } else {
-        self->lquantile[offset + i] -=
-            (1.f - QUANTILE) * delta / (float)(self->counter[s] + 1);
-      }
-
-      // Update density estimate.
-      if (fabs(lmagn[i] - self->lquantile[offset + i]) < WIDTH) {
-        self->density[offset + i] =
-            ((float)self->counter[s] * self->density[offset + i] +
-             1.f / (2.f * WIDTH)) /
-            (float)(self->counter[s] + 1);
-      }
-    }  // End loop over magnitude spectrum.
+    update_quantile_kernel(lmagn, self->magnLen, self->counter[s],
+                           &self->lquantile[offset], &self->density[offset]);
 
     if (self->counter[s] >= END_STARTUP_LONG) {
       self->counter[s] = 0;
       if (self->updates >= END_STARTUP_LONG) {
-        for (i = 0; i < self->magnLen; i++) {
-          self->quantile[i] = (float)exp(self->lquantile[offset + i]);
-        }
+        exp_kernel(&self->lquantile[offset], self->magnLen, self->quantile);
       }
     }
 
@@ -276,9 +341,7 @@ static void NoiseEstimation(NoiseSuppressionC* self,
   // Sequentially update the noise during startup.
   if (self->updates < END_STARTUP_LONG) {
     // Use the last "s" to get noise during startup that differ from zero.
-    for (i = 0; i < self->magnLen; i++) {
-      self->quantile[i] = (float)exp(self->lquantile[offset + i]);
-    }
+    exp_kernel(&self->lquantile[offset], self->magnLen, self->quantile);
   }
 
   for (i = 0; i < self->magnLen; i++) {
@@ -527,6 +590,7 @@ static void ComputeSpectralFlatness(NoiseSuppressionC* self,
   size_t i;
   size_t shiftLP = 1;  // Option to remove first bin(s) from spectral measures.
   float avgSpectralFlatnessNum, avgSpectralFlatnessDen, spectralTmp;
+  float logMagn[HALF_ANAL_BLOCKL];
 
   // Compute spectral measures.
   // For flatness.
@@ -538,13 +602,19 @@ static void ComputeSpectralFlatness(NoiseSuppressionC* self,
   // Compute log of ratio of the geometric to arithmetic mean: check for log(0)
   // case.
   for (i = shiftLP; i < self->magnLen; i++) {
-    if (magnIn[i] > 0.0) {
-      avgSpectralFlatnessNum += (float)log(magnIn[i]);
-    } else {
+    if (magnIn[i] <= 0.0) {
       self->featureData[0] -= SPECT_FL_TAVG * self->featureData[0];
       return;
     }
   }
+  if (self->vectorized) {
+    WebRtcNs_Log(&magnIn[shiftLP], self->magnLen - shiftLP, logMagn);
+  } else {
+    LogC(&magnIn[shiftLP], self->magnLen - shiftLP, logMagn);
+  }
+  for (i = shiftLP; i < self->magnLen; i++) {
+    avgSpectralFlatnessNum += logMagn[i - shiftLP];
+  }
   // Normalize.
   avgSpectralFlatnessDen = avgSpectralFlatnessDen / self->magnLen;
   avgSpectralFlatnessNum = avgSpectralFlatnessNum / self->magnLen;
@@ -654,6 +724,10 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
   float weightIndPrior0, weightIndPrior1, weightIndPrior2;
   float threshPrior0, threshPrior1, threshPrior2;
   float widthPrior, widthPrior0, widthPrior1, widthPrior2;
+  float snrPriorTerm[HALF_ANAL_BLOCKL], logSnrPriorTerm[HALF_ANAL_BLOCKL];
+  float invLrts[HALF_ANAL_BLOCKL];
+  const NsLog log_kernel = self->vectorized ? WebRtcNs_Log : LogC;
+  const NsExp exp_kernel = self->vectorized ? WebRtcNs_Exp : ExpC;
 
   widthPrior0 = WIDTH_PR_MAP;
   // Width for pause region: lower range, so increase width in tanh map.
@@ -677,11 +751,15 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
   // This is the average over all frequencies of the smooth log LRT.
   logLrtTimeAvgKsum = 0.0;
   for (i = 0; i < self->magnLen; i++) {
-    tmpFloat1 = 1.f + 2.f * snrLocPrior[i];
+    snrPriorTerm[i] = 1.f + 2.f * snrLocPrior[i];
+  }
+  log_kernel(snrPriorTerm, self->magnLen, logSnrPriorTerm);
+  for (i = 0; i < self->magnLen; i++) {
+    tmpFloat1 = snrPriorTerm[i];
     tmpFloat2 = 2.f * snrLocPrior[i] / (tmpFloat1 + 0.0001f);
     besselTmp = (snrLocPost[i] + 1.f) * tmpFloat2;
     self->logLrtTimeAvg[i] +=
-        LRT_TAVG * (besselTmp - (float)log(tmpFloat1) - self->logLrtTimeAvg[i]);
+        LRT_TAVG * (besselTmp - logSnrPriorTerm[i] - self->logLrtTimeAvg[i]);
     logLrtTimeAvgKsum += self->logLrtTimeAvg[i];
   }
   logLrtTimeAvgKsum = (float)logLrtTimeAvgKsum / (self->magnLen);
@@ -745,8 +823,11 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
   // Final speech probability: combine prior model with LR factor:.
   gainPrior = (1.f - self->priorSpeechProb) / (self->priorSpeechProb + 0.0001f);
   for (i = 0; i < self->magnLen; i++) {
-    invLrt = (float)exp(-self->logLrtTimeAvg[i]);
-    invLrt = (float)gainPrior * invLrt;
+    invLrts[i] = -self->logLrtTimeAvg[i];
+  }
+  exp_kernel(invLrts, self->magnLen, invLrts);
+  for (i = 0; i < self->magnLen; i++) {
+    invLrt = (float)gainPrior * invLrts[i];
     probSpeechFinal[i] = 1.f / (1.f + invLrt);
   }
 }
@@ -897,7 +978,7 @@ static void FFT(NoiseSuppressionC* self,
 
   RTC_DCHECK_EQ(magnitude_length, time_data_length / 2 + 1);
 
-  WebRtc_rdft(time_data_length, 1, time_data, self->ip, self->wfft);
+  WebRtc_RealFftForward(self->fft, time_data);
 
   imag[0] = 0;
   real[0] = time_data[0];
@@ -939,7 +1020,7 @@ static void IFFT(NoiseSuppressionC* self,
     time_data[2 * i] = real[i];
     time_data[2 * i + 1] = imag[i];
   }
-  WebRtc_rdft(time_data_length, -1, time_data, self->ip, self->wfft);
+  WebRtc_RealFftInverse(self->fft, time_data);
 
   for (i = 0; i < time_data_length; ++i) {
     time_data[i] *= 2.f / time_data_length;  // FFT scaling.
@@ -1009,6 +1090,16 @@ static void ComputeDdBasedWienerFilter(const NoiseSuppressionC* self,
   }  // End of loop over frequencies.
 }
 
+// Selects between the reference and the vectorized core.
+// Returns 0 on success and -1 otherwise.
+int WebRtcNs_set_vectorized_core(NoiseSuppressionC* self, int enable) {
+  if (enable != 0 && enable != 1) {
+    return -1;
+  }
+  self->vectorized = enable;
+  return 0;
+}
+
 // Changes the aggressiveness of the noise suppression method.
 // |mode| = 0 is mild (6dB), |mode| = 1 is medium (10dB) and |mode| = 2 is
 // aggressive (15dB).
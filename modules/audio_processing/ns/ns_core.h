@@ -11,7 +11,12 @@
 #ifndef MODULES_AUDIO_PROCESSING_NS_NS_CORE_H_
 #define MODULES_AUDIO_PROCESSING_NS_NS_CORE_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common_audio/fft/real_fft_c_api.h"
 #include "modules/audio_processing/ns/defines.h"
+#include "rtc_base/system/arch.h"
 
 typedef struct NSParaExtract_ {
   // Bin size of histogram.
@@ -62,6 +67,8 @@ typedef struct NoiseSuppressionC_ {
   float syntBuf[ANAL_BLOCKL_MAX];
 
   int initFlag;
+  // Selects the vectorized core, see WebRtcNs_set_vectorized_core().
+  int vectorized;
   // Parameters for quantile noise estimation.
   float density[SIMULT * HALF_ANAL_BLOCKL];
   float lquantile[SIMULT * HALF_ANAL_BLOCKL];
@@ -73,9 +80,8 @@ typedef struct NoiseSuppressionC_ {
   float overdrive;
   float denoiseBound;
   int gainmap;
-  // FFT work arrays.
-  size_t ip[IP_LENGTH];
-  float wfft[W_LENGTH];
+  // FFT of |anaLen| values.
+  WebRtcRealFft* fft;
 
   // Parameters for new method: some not needed, will reduce/cleanup later.
   int32_t blockInd;        // Frame index counter.
@@ -150,6 +156,27 @@ int WebRtcNs_InitCore(NoiseSuppressionC* self, uint32_t fs);
  */
 int WebRtcNs_set_policy_core(NoiseSuppressionC* self, int mode);
 
+/****************************************************************************
+ * WebRtcNs_set_vectorized_core(...)
+ *
+ * This selects between the reference and the vectorized core. The vectorized
+ * core batches the spectral updates over all frequency bins and evaluates
+ * log() and exp() with the SIMD approximations below, so its output deviates
+ * slightly from the reference core. The two cores share their state, so the
+ * selection can be changed at any time.
+ *
+ * Input:
+ *      - self          : Noise suppression instance
+ *      - enable        : 0: Reference core, 1: Vectorized core
+ *
+ * Output:
+ *      - self          : Updated instance
+ *
+ * Return value         :  0 - Ok
+ *                        -1 - Error
+ */
+int WebRtcNs_set_vectorized_core(NoiseSuppressionC* self, int enable);
+
 /****************************************************************************
  * WebRtcNs_AnalyzeCore
  *
@@ -183,6 +210,52 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
                           size_t num_bands,
                           float* const* outFrame);
 
+/****************************************************************************
+ * Some function pointers, for the kernels of the vectorized core shared by
+ * SSE2, ARM NEON and generic C code.
+ */
+// Computes |y| = log(|x|) for |length| positive values.
+typedef void (*NsLog)(const float* x, size_t length, float* y);
+extern NsLog WebRtcNs_Log;
+
+// Computes |y| = exp(|x|) for |length| values.
+typedef void (*NsExp)(const float* x, size_t length, float* y);
+extern NsExp WebRtcNs_Exp;
+
+// Updates one of the SIMULT simultaneous log quantile estimates and its
+// density estimate with the log magnitude spectrum |lmagn|. |counter| is the
+// number of updates of the estimate so far.
+typedef void (*NsUpdateQuantile)(const float* lmagn,
+                                 size_t length,
+                                 int counter,
+                                 float* lquantile,
+                                 float* density);
+extern NsUpdateQuantile WebRtcNs_UpdateQuantile;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// For the above function pointers, functions for generic platforms are declared
+// and defined as static in file ns_core.c, while those for SSE2 are declared
+// below and defined in file ns_core_sse2.c.
+void WebRtcNs_LogSse2(const float* x, size_t length, float* y);
+void WebRtcNs_ExpSse2(const float* x, size_t length, float* y);
+void WebRtcNs_UpdateQuantileSse2(const float* lmagn,
+                                 size_t length,
+                                 int counter,
+                                 float* lquantile,
+                                 float* density);
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+// Defined in file ns_core_neon.c.
+void WebRtcNs_LogNeon(const float* x, size_t length, float* y);
+void WebRtcNs_ExpNeon(const float* x, size_t length, float* y);
+void WebRtcNs_UpdateQuantileNeon(const float* lmagn,
+                                 size_t length,
+                                 int counter,
+                                 float* lquantile,
+                                 float* density);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,200 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <arm_neon.h>
+#include <math.h>
+
+#include "modules/audio_processing/ns/defines.h"
+#include "modules/audio_processing/ns/ns_core.h"
+
+// Computes |a| / |b|. ARMv7 has no vector division, so the reciprocal of |b|
+// is refined with two Newton-Raphson iterations instead.
+static float32x4_t DivideNeon(float32x4_t a, float32x4_t b) {
+#if defined(WEBRTC_ARCH_ARM64)
+  return vdivq_f32(a, b);
+#else
+  float32x4_t x = vrecpeq_f32(b);
+  x = vmulq_f32(vrecpsq_f32(b, x), x);
+  x = vmulq_f32(vrecpsq_f32(b, x), x);
+  return vmulq_f32(a, x);
+#endif
+}
+
+// Returns |mask| ? |a| : |b|.
+static float32x4_t SelectNeon(uint32x4_t mask, float32x4_t a, float32x4_t b) {
+  return vbslq_f32(mask, a, b);
+}
+
+// Approximates log(x) for positive, normal x. See LogSse2() in
+// ns_core_sse2.c.
+static float32x4_t LogNeon(float32x4_t x) {
+  const float32x4_t kOne = vdupq_n_f32(1.f);
+  float32x4_t e, z, y;
+  uint32x4_t mask;
+
+  // Decompose x = m * 2^e, with the mantissa m in [0.5, 1).
+  e = vcvtq_f32_s32(vsubq_s32(
+      vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_f32(x), 23)),
+      vdupq_n_s32(126)));
+  x = vreinterpretq_f32_u32(
+      vorrq_u32(vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x007FFFFF)),
+                vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+
+  // Move m into [sqrt(0.5), sqrt(2)) and compute x = m - 1.
+  mask = vcltq_f32(x, vdupq_n_f32(0.707106781186547524f));
+  e = vsubq_f32(e, SelectNeon(mask, kOne, vdupq_n_f32(0.f)));
+  x = vaddq_f32(vsubq_f32(x, kOne), SelectNeon(mask, x, vdupq_n_f32(0.f)));
+
+  // log(1 + x) ~= x - x^2 / 2 + x^3 * P(x).
+  z = vmulq_f32(x, x);
+  y = vdupq_n_f32(7.0376836292e-2f);
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(-1.1514610310e-1f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(1.1676998740e-1f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(-1.2420140846e-1f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(1.4249322787e-1f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(-1.6668057665e-1f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(2.0000714765e-1f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(-2.4999993993e-1f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(3.3333331174e-1f));
+  y = vmulq_f32(vmulq_f32(y, x), z);
+
+  // Add e * log(2), with log(2) split in two parts for accuracy.
+  y = vaddq_f32(y, vmulq_f32(e, vdupq_n_f32(-2.12194440e-4f)));
+  y = vsubq_f32(y, vmulq_f32(z, vdupq_n_f32(0.5f)));
+  x = vaddq_f32(x, y);
+  return vaddq_f32(x, vmulq_f32(e, vdupq_n_f32(0.693359375f)));
+}
+
+// Approximates exp(x). See ExpSse2() in ns_core_sse2.c.
+static float32x4_t ExpNeon(float32x4_t x) {
+  const float32x4_t kOne = vdupq_n_f32(1.f);
+  float32x4_t fx, tmp, z, y;
+  int32x4_t n;
+
+  x = vminq_f32(x, vdupq_n_f32(88.3762626647949f));
+  x = vmaxq_f32(x, vdupq_n_f32(-87.3365447505531f));
+
+  // Decompose exp(x) = 2^n * exp(r), with n = floor(x / log(2) + 0.5).
+  fx = vaddq_f32(vmulq_f32(x, vdupq_n_f32(1.44269504088896341f)),
+                 vdupq_n_f32(0.5f));
+  tmp = vcvtq_f32_s32(vcvtq_s32_f32(fx));
+  fx = vsubq_f32(tmp, SelectNeon(vcgtq_f32(tmp, fx), kOne, vdupq_n_f32(0.f)));
+
+  // r = x - n * log(2), with log(2) split in two parts for accuracy.
+  x = vsubq_f32(x, vmulq_f32(fx, vdupq_n_f32(0.693359375f)));
+  x = vsubq_f32(x, vmulq_f32(fx, vdupq_n_f32(-2.12194440e-4f)));
+
+  // exp(r) ~= 1 + r + r^2 * P(r).
+  z = vmulq_f32(x, x);
+  y = vdupq_n_f32(1.9875691500e-4f);
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(1.3981999507e-3f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(8.3334519073e-3f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(4.1665795894e-2f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(1.6666665459e-1f));
+  y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(5.0000001201e-1f));
+  y = vaddq_f32(vaddq_f32(vmulq_f32(y, z), x), kOne);
+
+  // Scale by 2^n by building the float directly.
+  n = vaddq_s32(vcvtq_s32_f32(fx), vdupq_n_s32(0x7F));
+  return vmulq_f32(y, vreinterpretq_f32_s32(vshlq_n_s32(n, 23)));
+}
+
+void WebRtcNs_LogNeon(const float* x, size_t length, float* y) {
+  size_t i;
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    vst1q_f32(&y[i], LogNeon(vld1q_f32(&x[i])));
+  }
+  // Scalar code for the remaining items.
+  for (; i < length; ++i) {
+    y[i] = (float)log(x[i]);
+  }
+}
+
+void WebRtcNs_ExpNeon(const float* x, size_t length, float* y) {
+  size_t i;
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    vst1q_f32(&y[i], ExpNeon(vld1q_f32(&x[i])));
+  }
+  // Scalar code for the remaining items.
+  for (; i < length; ++i) {
+    y[i] = (float)exp(x[i]);
+  }
+}
+
+void WebRtcNs_UpdateQuantileNeon(const float* lmagn,
+                                 size_t length,
+                                 int counter,
+                                 float* lquantile,
+                                 float* density) {
+  const float kCounter = (float)counter;
+  const float kCounterPlusOne = (float)(counter + 1);
+  const float32x4_t kZero = vdupq_n_f32(0.f);
+  const float32x4_t kOne = vdupq_n_f32(1.f);
+  const float32x4_t kFactor = vdupq_n_f32(FACTOR);
+  const float32x4_t kQuantile = vdupq_n_f32(QUANTILE);
+  const float32x4_t kOneMinusQuantile = vdupq_n_f32(1.f - QUANTILE);
+  const float32x4_t kWidth = vdupq_n_f32(WIDTH);
+  const float32x4_t kHalfInvWidth = vdupq_n_f32(1.f / (2.f * WIDTH));
+  const float32x4_t vec_counter = vdupq_n_f32(kCounter);
+  const float32x4_t vec_counter_plus_one = vdupq_n_f32(kCounterPlusOne);
+  size_t i;
+
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    const float32x4_t vec_lmagn = vld1q_f32(&lmagn[i]);
+    float32x4_t vec_lquantile = vld1q_f32(&lquantile[i]);
+    float32x4_t vec_density = vld1q_f32(&density[i]);
+
+    // Compute delta.
+    const float32x4_t delta =
+        SelectNeon(vcgtq_f32(vec_density, kOne),
+                   DivideNeon(kFactor, vec_density), kFactor);
+
+    // Update log quantile estimate.
+    const uint32x4_t above = vcgtq_f32(vec_lmagn, vec_lquantile);
+    const float32x4_t step_up =
+        DivideNeon(vmulq_f32(kQuantile, delta), vec_counter_plus_one);
+    const float32x4_t step_down =
+        DivideNeon(vmulq_f32(kOneMinusQuantile, delta), vec_counter_plus_one);
+    vec_lquantile =
+        vaddq_f32(vec_lquantile, SelectNeon(above, step_up, kZero));
+    vec_lquantile =
+        vsubq_f32(vec_lquantile, SelectNeon(above, kZero, step_down));
+
+    // Update density estimate.
+    {
+      const uint32x4_t close =
+          vcltq_f32(vabsq_f32(vsubq_f32(vec_lmagn, vec_lquantile)), kWidth);
+      const float32x4_t new_density = DivideNeon(
+          vaddq_f32(vmulq_f32(vec_counter, vec_density), kHalfInvWidth),
+          vec_counter_plus_one);
+      vec_density = SelectNeon(close, new_density, vec_density);
+    }
+
+    vst1q_f32(&lquantile[i], vec_lquantile);
+    vst1q_f32(&density[i], vec_density);
+  }
+
+  // Scalar code for the remaining items.
+  for (; i < length; ++i) {
+    const float delta = density[i] > 1.f ? FACTOR / density[i] : FACTOR;
+    if (lmagn[i] > lquantile[i]) {
+      lquantile[i] += QUANTILE * delta / kCounterPlusOne;
+    } else {
+      lquantile[i] -= (1.f - QUANTILE) * delta / kCounterPlusOne;
+    }
+    if (fabsf(lmagn[i] - lquantile[i]) < WIDTH) {
+      density[i] =
+          (kCounter * density[i] + 1.f / (2.f * WIDTH)) / kCounterPlusOne;
+    }
+  }
+}
@@ -0,0 +1,185 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+#include <math.h>
+
+#include "modules/audio_processing/ns/defines.h"
+#include "modules/audio_processing/ns/ns_core.h"
+
+// Approximates log(x) for positive, normal x. This is the single precision
+// Cephes logf() algorithm, which has a maximum relative error of about
+// 2^-23 in the range used by the noise suppressor.
+static __m128 LogSse2(__m128 x) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  __m128 e, z, y, tmp, mask;
+
+  // Decompose x = m * 2^e, with the mantissa m in [0.5, 1).
+  e = _mm_cvtepi32_ps(_mm_sub_epi32(
+      _mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(126)));
+  x = _mm_or_ps(_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x007FFFFF))),
+                _mm_set1_ps(0.5f));
+
+  // Move m into [sqrt(0.5), sqrt(2)) and compute x = m - 1.
+  mask = _mm_cmplt_ps(x, _mm_set1_ps(0.707106781186547524f));
+  tmp = _mm_and_ps(x, mask);
+  x = _mm_sub_ps(x, kOne);
+  e = _mm_sub_ps(e, _mm_and_ps(kOne, mask));
+  x = _mm_add_ps(x, tmp);
+
+  // log(1 + x) ~= x - x^2 / 2 + x^3 * P(x).
+  z = _mm_mul_ps(x, x);
+  y = _mm_set1_ps(7.0376836292e-2f);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.1514610310e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.1676998740e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.2420140846e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.4249322787e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.6668057665e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(2.0000714765e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-2.4999993993e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(3.3333331174e-1f));
+  y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+
+  // Add e * log(2), with log(2) split in two parts for accuracy.
+  y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+  y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+  x = _mm_add_ps(x, y);
+  return _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+}
+
+// Approximates exp(x). This is the single precision Cephes expf() algorithm
+// with the input clamped to the range where the result is a normal float.
+static __m128 ExpSse2(__m128 x) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  __m128 fx, tmp, z, y;
+  __m128i n;
+
+  x = _mm_min_ps(x, _mm_set1_ps(88.3762626647949f));
+  x = _mm_max_ps(x, _mm_set1_ps(-87.3365447505531f));
+
+  // Decompose exp(x) = 2^n * exp(r), with n = floor(x / log(2) + 0.5).
+  fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)),
+                  _mm_set1_ps(0.5f));
+  tmp = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+  fx = _mm_sub_ps(tmp, _mm_and_ps(_mm_cmpgt_ps(tmp, fx), kOne));
+
+  // r = x - n * log(2), with log(2) split in two parts for accuracy.
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+  // exp(r) ~= 1 + r + r^2 * P(r).
+  z = _mm_mul_ps(x, x);
+  y = _mm_set1_ps(1.9875691500e-4f);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+  y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), kOne);
+
+  // Scale by 2^n by building the float directly.
+  n = _mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(0x7F));
+  return _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(n, 23)));
+}
+
+void WebRtcNs_LogSse2(const float* x, size_t length, float* y) {
+  size_t i;
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    _mm_storeu_ps(&y[i], LogSse2(_mm_loadu_ps(&x[i])));
+  }
+  // Scalar code for the remaining items.
+  for (; i < length; ++i) {
+    y[i] = (float)log(x[i]);
+  }
+}
+
+void WebRtcNs_ExpSse2(const float* x, size_t length, float* y) {
+  size_t i;
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    _mm_storeu_ps(&y[i], ExpSse2(_mm_loadu_ps(&x[i])));
+  }
+  // Scalar code for the remaining items.
+  for (; i < length; ++i) {
+    y[i] = (float)exp(x[i]);
+  }
+}
+
+// Computes the same quantities as the scalar version in ns_core.c, in the same
+// order, so the result is bit exact.
+void WebRtcNs_UpdateQuantileSse2(const float* lmagn,
+                                 size_t length,
+                                 int counter,
+                                 float* lquantile,
+                                 float* density) {
+  const float kCounter = (float)counter;
+  const float kCounterPlusOne = (float)(counter + 1);
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kFactor = _mm_set1_ps(FACTOR);
+  const __m128 kQuantile = _mm_set1_ps(QUANTILE);
+  const __m128 kOneMinusQuantile = _mm_set1_ps(1.f - QUANTILE);
+  const __m128 kWidth = _mm_set1_ps(WIDTH);
+  const __m128 kHalfInvWidth = _mm_set1_ps(1.f / (2.f * WIDTH));
+  const __m128 kAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+  const __m128 vec_counter = _mm_set1_ps(kCounter);
+  const __m128 vec_counter_plus_one = _mm_set1_ps(kCounterPlusOne);
+  size_t i;
+
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    const __m128 vec_lmagn = _mm_loadu_ps(&lmagn[i]);
+    __m128 vec_lquantile = _mm_loadu_ps(&lquantile[i]);
+    __m128 vec_density = _mm_loadu_ps(&density[i]);
+
+    // Compute delta.
+    const __m128 dense = _mm_cmpgt_ps(vec_density, kOne);
+    const __m128 delta =
+        _mm_or_ps(_mm_and_ps(dense, _mm_div_ps(kFactor, vec_density)),
+                  _mm_andnot_ps(dense, kFactor));
+
+    // Update log quantile estimate.
+    const __m128 above = _mm_cmpgt_ps(vec_lmagn, vec_lquantile);
+    const __m128 step_up =
+        _mm_div_ps(_mm_mul_ps(kQuantile, delta), vec_counter_plus_one);
+    const __m128 step_down =
+        _mm_div_ps(_mm_mul_ps(kOneMinusQuantile, delta), vec_counter_plus_one);
+    vec_lquantile = _mm_add_ps(vec_lquantile, _mm_and_ps(above, step_up));
+    vec_lquantile = _mm_sub_ps(vec_lquantile, _mm_andnot_ps(above, step_down));
+
+    // Update density estimate.
+    {
+      const __m128 close = _mm_cmplt_ps(
+          _mm_and_ps(_mm_sub_ps(vec_lmagn, vec_lquantile), kAbsMask), kWidth);
+      const __m128 new_density = _mm_div_ps(
+          _mm_add_ps(_mm_mul_ps(vec_counter, vec_density), kHalfInvWidth),
+          vec_counter_plus_one);
+      vec_density = _mm_or_ps(_mm_and_ps(close, new_density),
+                              _mm_andnot_ps(close, vec_density));
+    }
+
+    _mm_storeu_ps(&lquantile[i], vec_lquantile);
+    _mm_storeu_ps(&density[i], vec_density);
+  }
+
+  // Scalar code for the remaining items.
+  for (; i < length; ++i) {
+    const float delta = density[i] > 1.f ? FACTOR / density[i] : FACTOR;
+    if (lmagn[i] > lquantile[i]) {
+      lquantile[i] += QUANTILE * delta / kCounterPlusOne;
+    } else {
+      lquantile[i] -= (1.f - QUANTILE) * delta / kCounterPlusOne;
+    }
+    if (fabsf(lmagn[i] - lquantile[i]) < WIDTH) {
+      density[i] =
+          (kCounter * density[i] + 1.f / (2.f * WIDTH)) / kCounterPlusOne;
+    }
+  }
+}
@@ -0,0 +1,240 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/ns/ns_core.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "modules/audio_processing/ns/noise_suppression.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kNumFramesToProcess = 1000;
+
+// Owns a floating point noise suppressor.
+class NoiseSuppressor {
+ public:
+  NoiseSuppressor(int sample_rate_hz, int policy, bool vectorized)
+      : handle_(WebRtcNs_Create()) {
+    EXPECT_EQ(0, WebRtcNs_Init(handle_, sample_rate_hz));
+    EXPECT_EQ(0, WebRtcNs_set_policy(handle_, policy));
+    EXPECT_EQ(0, WebRtcNs_set_vectorized(handle_, vectorized ? 1 : 0));
+  }
+  ~NoiseSuppressor() { WebRtcNs_Free(handle_); }
+
+  NsHandle* handle() { return handle_; }
+
+ private:
+  NsHandle* const handle_;
+};
+
+// Generates 10 ms split band frames of noise with intermittent harmonic
+// bursts, which exercises both the noise and the speech paths of the
+// suppressor.
+class SignalGenerator {
+ public:
+  SignalGenerator(size_t num_bands, size_t frame_length)
+      : generator_(42),
+        noise_(0.f, 300.f),
+        bands_(num_bands, std::vector<float>(frame_length)) {
+    for (size_t i = 0; i < num_bands; ++i) {
+      band_pointers_.push_back(bands_[i].data());
+    }
+  }
+
+  const float* const* NextFrame() {
+    const bool burst = (frame_index_ / 50) % 3 == 1;
+    for (size_t b = 0; b < bands_.size(); ++b) {
+      for (size_t i = 0; i < bands_[b].size(); ++i) {
+        float sample = noise_(generator_);
+        if (burst && b == 0) {
+          const float t = static_cast<float>(sample_index_ + i);
+          sample += 4000.f * sinf(0.05f * t) + 2000.f * sinf(0.31f * t);
+        }
+        bands_[b][i] = sample;
+      }
+    }
+    sample_index_ += bands_[0].size();
+    ++frame_index_;
+    return band_pointers_.data();
+  }
+
+ private:
+  std::mt19937 generator_;
+  std::normal_distribution<float> noise_;
+  std::vector<std::vector<float>> bands_;
+  std::vector<const float*> band_pointers_;
+  size_t frame_index_ = 0;
+  size_t sample_index_ = 0;
+};
+
+size_t NumBands(int sample_rate_hz) {
+  return sample_rate_hz <= 16000 ? 1 : sample_rate_hz / 16000;
+}
+
+size_t FrameLength(int sample_rate_hz) {
+  return sample_rate_hz == 8000 ? 80 : 160;
+}
+
+// Runs the reference and the vectorized cores side by side on the same input
+// and verifies that their outputs and internal estimates stay close.
+void RunToleranceTest(int sample_rate_hz, int policy) {
+  const size_t num_bands = NumBands(sample_rate_hz);
+  const size_t frame_length = FrameLength(sample_rate_hz);
+  NoiseSuppressor reference(sample_rate_hz, policy, false);
+  NoiseSuppressor vectorized(sample_rate_hz, policy, true);
+  SignalGenerator signal(num_bands, frame_length);
+
+  std::vector<std::vector<float>> out_reference(
+      num_bands, std::vector<float>(frame_length));
+  std::vector<std::vector<float>> out_vectorized = out_reference;
+  std::vector<float*> out_reference_pointers;
+  std::vector<float*> out_vectorized_pointers;
+  for (size_t b = 0; b < num_bands; ++b) {
+    out_reference_pointers.push_back(out_reference[b].data());
+    out_vectorized_pointers.push_back(out_vectorized[b].data());
+  }
+
+  float max_output_error = 0.f;
+  for (size_t frame = 0; frame < kNumFramesToProcess; ++frame) {
+    const float* const* in = signal.NextFrame();
+    WebRtcNs_Analyze(reference.handle(), in[0]);
+    WebRtcNs_Analyze(vectorized.handle(), in[0]);
+    WebRtcNs_Process(reference.handle(), in, num_bands,
+                     out_reference_pointers.data());
+    WebRtcNs_Process(vectorized.handle(), in, num_bands,
+                     out_vectorized_pointers.data());
+
+    for (size_t b = 0; b < num_bands; ++b) {
+      for (size_t i = 0; i < frame_length; ++i) {
+        max_output_error =
+            std::max(max_output_error,
+                     fabsf(out_reference[b][i] - out_vectorized[b][i]));
+      }
+    }
+    ASSERT_NEAR(WebRtcNs_prior_speech_probability(reference.handle()),
+                WebRtcNs_prior_speech_probability(vectorized.handle()), 1e-3f)
+        << "frame " << frame;
+  }
+
+  // The output is in the 16 bit range, so this is below one LSB.
+  EXPECT_LT(max_output_error, 0.5f);
+
+  const float* noise_reference = WebRtcNs_noise_estimate(reference.handle());
+  const float* noise_vectorized = WebRtcNs_noise_estimate(vectorized.handle());
+  for (size_t i = 0; i < WebRtcNs_num_freq(); ++i) {
+    EXPECT_NEAR(noise_reference[i], noise_vectorized[i],
+                1e-3f * noise_reference[i]);
+  }
+}
+
+}  // namespace
+
+TEST(NsCoreTest, LogKernelIsAccurate) {
+  NoiseSuppressor ns(16000, 0, true);
+  std::vector<float> x;
+  for (float value = 1e-6f; value < 1e9f; value *= 1.0173f) {
+    x.push_back(value);
+  }
+  std::vector<float> y(x.size());
+  WebRtcNs_Log(x.data(), x.size(), y.data());
+  for (size_t i = 0; i < x.size(); ++i) {
+    const float expected = logf(x[i]);
+    EXPECT_NEAR(expected, y[i], 2e-7f * std::max(1.f, fabsf(expected)))
+        << x[i];
+  }
+}
+
+TEST(NsCoreTest, ExpKernelIsAccurate) {
+  NoiseSuppressor ns(16000, 0, true);
+  std::vector<float> x;
+  for (float value = -80.f; value < 80.f; value += 0.0371f) {
+    x.push_back(value);
+  }
+  std::vector<float> y(x.size());
+  WebRtcNs_Exp(x.data(), x.size(), y.data());
+  for (size_t i = 0; i < x.size(); ++i) {
+    const float expected = expf(x[i]);
+    EXPECT_NEAR(expected, y[i], 3e-7f * expected) << x[i];
+  }
+}
+
+TEST(NsCoreTest, VectorizedCoreIsCloseToReference8kHz) {
+  for (int policy = 0; policy < 4; ++policy) {
+    SCOPED_TRACE(policy);
+    RunToleranceTest(8000, policy);
+  }
+}
+
+TEST(NsCoreTest, VectorizedCoreIsCloseToReference16kHz) {
+  for (int policy = 0; policy < 4; ++policy) {
+    SCOPED_TRACE(policy);
+    RunToleranceTest(16000, policy);
+  }
+}
+
+TEST(NsCoreTest, VectorizedCoreIsCloseToReference32kHz) {
+  RunToleranceTest(32000, 2);
+}
+
+TEST(NsCoreTest, VectorizedCoreIsCloseToReference48kHz) {
+  RunToleranceTest(48000, 2);
+}
+
+TEST(NsCoreTest, RejectsInvalidCoreSelection) {
+  NoiseSuppressor ns(16000, 0, false);
+  EXPECT_EQ(-1, WebRtcNs_set_vectorized(ns.handle(), 2));
+  EXPECT_EQ(-1, WebRtcNs_set_vectorized(ns.handle(), -1));
+}
+
+// Measures the CPU time per 10 ms frame of the analysis and processing of the
+// two cores.
+TEST(NsCoreTest, DISABLED_Benchmark) {
+  for (int sample_rate_hz : {16000, 32000, 48000}) {
+    const size_t num_bands = NumBands(sample_rate_hz);
+    std::vector<std::vector<float>> out(num_bands, std::vector<float>(160));
+    std::vector<float*> out_pointers;
+    for (size_t b = 0; b < num_bands; ++b) {
+      out_pointers.push_back(out[b].data());
+    }
+
+    double reference_ns = 0.0;
+    for (bool vectorized : {false, true}) {
+      NoiseSuppressor ns(sample_rate_hz, 2, vectorized);
+      SignalGenerator signal(num_bands, 160);
+      int64_t elapsed_ns = 0;
+      constexpr size_t kNumFrames = 10000;
+      for (size_t frame = 0; frame < kNumFrames; ++frame) {
+        const float* const* in = signal.NextFrame();
+        const int64_t start = rtc::TimeNanos();
+        WebRtcNs_Analyze(ns.handle(), in[0]);
+        WebRtcNs_Process(ns.handle(), in, num_bands, out_pointers.data());
+        elapsed_ns += rtc::TimeNanos() - start;
+      }
+      const double ns_per_frame =
+          static_cast<double>(elapsed_ns) / kNumFrames;
+      if (!vectorized) {
+        reference_ns = ns_per_frame;
+      }
+      printf("%d Hz, %s core: %.0f ns per 10 ms frame (%.2fx)\n",
+             sample_rate_hz, vectorized ? "vectorized" : "reference",
+             ns_per_frame, reference_ns / ns_per_frame);
+    }
+  }
+}
+
+}  // namespace webrtc
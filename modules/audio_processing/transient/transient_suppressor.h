@@ -19,6 +19,7 @@
 
 namespace webrtc {
 
+class RealFft;
 class TransientDetector;
 
 // Detects transients in an audio stream and suppress them using a simple
@@ -84,9 +85,7 @@ class TransientSuppressor {
   // Output buffer where the restored samples are stored.
   std::unique_ptr<float[]> out_buffer_;
 
-  // Arrays for fft.
-  std::unique_ptr<size_t[]> ip_;
-  std::unique_ptr<float[]> wfft_;
+  std::unique_ptr<RealFft> fft_;
 
   std::unique_ptr<float[]> spectral_mean_;
 
@@ -14,7 +14,7 @@
 #include <stdio.h>
 #include <string.h>
 
-#include "common_audio/third_party/fft4g/fft4g.h"
+#include "common_audio/fft/real_fft.h"
 #include "modules/audio_processing/vad/pitch_internal.h"
 #include "modules/audio_processing/vad/pole_zero_filter.h"
 #include "modules/audio_processing/vad/vad_audio_proc_internal.h"
@@ -43,6 +43,7 @@ VadAudioProc::VadAudioProc()
       num_buffer_samples_(kNumPastSignalSamples),
       log_old_gain_(-2),
       old_lag_(50),  // Arbitrary but valid as pitch-lag (in samples).
+      fft_(new RealFft(kDftSize)),
       pitch_analysis_handle_(new PitchAnalysisStruct),
       pre_filter_handle_(new PreFiltBankstr),
       high_pass_filter_(PoleZeroFilter::Create(kCoeffNumerator,
@@ -56,10 +57,6 @@ VadAudioProc::VadAudioProc()
                 "correlation weight incorrect size");
 
   // TODO(turajs): Are we doing too much in the constructor?
-  float data[kDftSize];
-  // Make FFT to initialize.
-  ip_[0] = 0;
-  WebRtc_rdft(kDftSize, 1, data, ip_, w_fft_);
   // TODO(turajs): Need to initialize high-pass filter.
 
   // Initialize iSAC components.
@@ -191,7 +188,7 @@ void VadAudioProc::FindFirstSpectralPeaks(double* f_peak,
       data[n] = static_cast<float>(lpc[i * (kLpcOrder + 1) + n]);
     }
     // Transform to frequency domain.
-    WebRtc_rdft(kDftSize, 1, data, ip_, w_fft_);
+    fft_->Forward(data);
 
     size_t index_peak = 0;
     float prev_magn_sqr = data[0] * data[0];
@@ -20,6 +20,7 @@
 namespace webrtc {
 
 class PoleZeroFilter;
+class RealFft;
 
 class VadAudioProc {
  public:
@@ -69,13 +70,8 @@ class VadAudioProc {
   enum : size_t {
     kBufferLength = kNumPastSignalSamples + kNumSamplesToProcess
   };
-  enum : size_t { kIpLength = kDftSize >> 1 };
-  enum : size_t { kWLength = kDftSize >> 1 };
   enum : size_t { kLpcOrder = 16 };
 
-  size_t ip_[kIpLength];
-  float w_fft_[kWLength];
-
   // A buffer of 5 ms (past audio) + 30 ms (one iSAC frame ).
   float audio_buffer_[kBufferLength];
   size_t num_buffer_samples_;
@@ -83,6 +79,7 @@ class VadAudioProc {
   double log_old_gain_;
   double old_lag_;
 
+  const std::unique_ptr<RealFft> fft_;
   std::unique_ptr<PitchAnalysisStruct> pitch_analysis_handle_;
   std::unique_ptr<PreFiltBankstr> pre_filter_handle_;
   std::unique_ptr<PoleZeroFilter> high_pass_filter_;
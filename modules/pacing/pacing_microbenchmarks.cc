@@ -0,0 +1,46 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/round_robin_packet_queue.h"
+#include "test/gtest.h"
+#include "test/testsupport/microbenchmark.h"
+
+namespace webrtc {
+
+// Pushes and pops a packet on a queue that holds 50 packets of each of
+// 4 streams, like the pacer of a call with simulcast video and audio does.
+TEST(PacingMicrobenchmark, PacerPushPop) {
+  constexpr int kNumStreams = 4;
+  constexpr int kNumPacketsPerStream = 50;
+  RoundRobinPacketQueue queue(0);
+  uint64_t enqueue_order = 0;
+  int64_t now_ms = 0;
+  auto push = [&] {
+    const int stream = enqueue_order % kNumStreams;
+    queue.Push(RoundRobinPacketQueue::Packet(
+        stream == 0 ? RtpPacketSender::kHighPriority
+                    : RtpPacketSender::kNormalPriority,
+        1000 + stream, static_cast<uint16_t>(enqueue_order), now_ms, now_ms,
+        1200, false, enqueue_order));
+    ++enqueue_order;
+  };
+  for (int i = 0; i < kNumStreams * kNumPacketsPerStream; ++i)
+    push();
+
+  test::RunMicrobenchmark("PacerPushPop", [&] {
+    ++now_ms;
+    push();
+    queue.FinalizePop(queue.BeginPop());
+  });
+  EXPECT_EQ(queue.SizeInPackets(),
+            static_cast<size_t>(kNumStreams * kNumPacketsPerStream));
+}
+
+}  // namespace webrtc
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "modules/rtp_rtcp/source/rtp_format_vp8.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/checks.h"
+#include "test/gtest.h"
+#include "test/testsupport/microbenchmark.h"
+
+namespace webrtc {
+namespace {
+
+constexpr uint32_t kSsrc = 0x12345678;
+constexpr size_t kPayloadSize = 1100;
+
+RtpHeaderExtensionMap VideoExtensions() {
+  RtpHeaderExtensionMap extensions;
+  extensions.Register<TransmissionOffset>(1);
+  extensions.Register<AbsoluteSendTime>(2);
+  extensions.Register<TransportSequenceNumber>(3);
+  extensions.Register<VideoOrientation>(4);
+  return extensions;
+}
+
+void BuildVideoPacket(uint16_t sequence_number, RtpPacketToSend* packet) {
+  packet->SetPayloadType(96);
+  packet->SetSequenceNumber(sequence_number);
+  packet->SetTimestamp(sequence_number * 3000u);
+  packet->SetSsrc(kSsrc);
+  packet->SetExtension<TransmissionOffset>(0);
+  packet->SetExtension<AbsoluteSendTime>(sequence_number << 8);
+  packet->SetExtension<TransportSequenceNumber>(sequence_number);
+  packet->SetExtension<VideoOrientation>(0);
+  memset(packet->AllocatePayload(kPayloadSize), sequence_number & 0xff,
+         kPayloadSize);
+}
+
+}  // namespace
+
+TEST(RtpRtcpMicrobenchmark, RtpPacketSerialize) {
+  const RtpHeaderExtensionMap extensions = VideoExtensions();
+  RtpPacketToSend packet(&extensions);
+  uint16_t sequence_number = 0;
+  test::RunMicrobenchmark("RtpPacketSerialize", [&] {
+    packet.Clear();
+    BuildVideoPacket(sequence_number++, &packet);
+  });
+  EXPECT_EQ(packet.payload_size(), kPayloadSize);
+}
+
+TEST(RtpRtcpMicrobenchmark, RtpPacketParse) {
+  const RtpHeaderExtensionMap extensions = VideoExtensions();
+  RtpPacketToSend sent_packet(&extensions);
+  BuildVideoPacket(4711, &sent_packet);
+  RtpPacketReceived packet(&extensions);
+  uint16_t transport_sequence_number = 0;
+  test::RunMicrobenchmark("RtpPacketParse", [&] {
+    RTC_CHECK(packet.Parse(sent_packet.data(), sent_packet.size()));
+    packet.GetExtension<TransportSequenceNumber>(&transport_sequence_number);
+  });
+  EXPECT_EQ(transport_sequence_number, 4711);
+}
+
+// Protects a frame of 10 packets with 5 ULPFEC packets, like the video of
+// a call at 1 Mbps does.
+TEST(RtpRtcpMicrobenchmark, FecEncode) {
+  constexpr size_t kNumMediaPackets = 10;
+  constexpr uint8_t kProtectionFactor = 128;
+  const RtpHeaderExtensionMap extensions = VideoExtensions();
+  ForwardErrorCorrection::PacketList media_packets;
+  for (size_t i = 0; i < kNumMediaPackets; ++i) {
+    RtpPacketToSend rtp_packet(&extensions);
+    BuildVideoPacket(i, &rtp_packet);
+    auto media_packet = absl::make_unique<ForwardErrorCorrection::Packet>();
+    media_packet->length = rtp_packet.size();
+    memcpy(media_packet->data, rtp_packet.data(), rtp_packet.size());
+    media_packets.push_back(std::move(media_packet));
+  }
+  std::unique_ptr<ForwardErrorCorrection> fec =
+      ForwardErrorCorrection::CreateUlpfec(kSsrc);
+  std::list<ForwardErrorCorrection::Packet*> fec_packets;
+  test::RunMicrobenchmark("FecEncode", [&] {
+    fec_packets.clear();
+    RTC_CHECK_EQ(0, fec->EncodeFec(media_packets, kProtectionFactor, 0, false,
+                                   kFecMaskBursty, &fec_packets));
+  });
+  EXPECT_EQ(fec_packets.size(), 5u);
+}
+
+// Packetizes a VP8 key frame of 50 kB.
+TEST(RtpRtcpMicrobenchmark, Vp8Packetize) {
+  const std::vector<uint8_t> frame(50000, 0x55);
+  RTPVideoHeaderVP8 vp8_header;
+  vp8_header.InitRTPVideoHeaderVP8();
+  vp8_header.pictureId = 4711;
+  const RtpHeaderExtensionMap extensions = VideoExtensions();
+  RtpPacketToSend packet(&extensions);
+  size_t num_packets = 0;
+  test::RunMicrobenchmark("Vp8Packetize", [&] {
+    RtpPacketizerVp8 packetizer(frame, RtpPacketizer::PayloadSizeLimits(),
+                                vp8_header);
+    num_packets = 0;
+    while (packetizer.NextPacket(&packet))
+      ++num_packets;
+  });
+  EXPECT_EQ(num_packets, 42u);
+}
+
+}  // namespace webrtc
@@ -140,9 +140,10 @@ class Connection : public CandidatePairInterface,
   // Error if Send() returns < 0
   virtual int GetError() = 0;
 
-  sigslot::signal4<Connection*, const char*, size_t, int64_t> SignalReadPacket;
+  sigslot::single_threaded_signal<Connection*, const char*, size_t, int64_t>
+      SignalReadPacket;
 
-  sigslot::signal1<Connection*> SignalReadyToSend;
+  sigslot::single_threaded_signal<Connection*> SignalReadyToSend;
 
   // Called when a packet is received on this connection.
   void OnReadPacket(const char* data, size_t size, int64_t packet_time_us);
@@ -196,6 +196,12 @@ bool DtlsTransport::SetSslMaxProtocolVersion(rtc::SSLProtocolVersion version) {
   return true;
 }
 
+void DtlsTransport::SetSessionCache(
+    rtc::scoped_refptr<rtc::SSLSessionCache> session_cache) {
+  RTC_DCHECK(!dtls_);
+  session_cache_ = std::move(session_cache);
+}
+
 bool DtlsTransport::SetDtlsRole(rtc::SSLRole role) {
   if (dtls_) {
     RTC_DCHECK(dtls_role_);
@@ -341,6 +347,9 @@ bool DtlsTransport::SetupDtls() {
   dtls_->SetIdentity(local_certificate_->identity()->GetReference());
   dtls_->SetMode(rtc::SSL_MODE_DTLS);
   dtls_->SetMaxProtocolVersion(ssl_max_version_);
+  if (session_cache_) {
+    dtls_->SetSessionCache(session_cache_);
+  }
   dtls_->SetServerRole(*dtls_role_);
   dtls_->SignalEvent.connect(this, &DtlsTransport::OnDtlsEvent);
   dtls_->SignalSSLHandshakeError.connect(this,
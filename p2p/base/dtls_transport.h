@@ -142,6 +142,11 @@ class DtlsTransport : public DtlsTransportInternal {
 
   bool SetSslMaxProtocolVersion(rtc::SSLProtocolVersion version) override;
 
+  // Resumes DTLS sessions of |session_cache| with the same remote fingerprint
+  // and local certificate, see rtc::SSLStreamAdapter::SetSessionCache(). Must
+  // be called before the handshake is set up.
+  void SetSessionCache(rtc::scoped_refptr<rtc::SSLSessionCache> session_cache);
+
   // Find out which DTLS-SRTP cipher was negotiated
   bool GetSrtpCryptoSuite(int* cipher) override;
 
@@ -234,6 +239,7 @@ class DtlsTransport : public DtlsTransportInternal {
   absl::optional<rtc::SSLRole> dtls_role_;
   rtc::SSLProtocolVersion ssl_max_version_;
   webrtc::CryptoOptions crypto_options_;
+  rtc::scoped_refptr<rtc::SSLSessionCache> session_cache_;
   rtc::Buffer remote_fingerprint_value_;
   std::string remote_fingerprint_algorithm_;
 
@@ -25,6 +25,7 @@
 #include "rtc_base/ssl_adapter.h"
 #include "rtc_base/ssl_identity.h"
 #include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/time_utils.h"
 
 #define MAYBE_SKIP_TEST(feature)                                  \
   if (!(rtc::SSLStreamAdapter::feature())) {                      \
@@ -77,6 +78,8 @@ class DtlsTestClient : public sigslot::has_slots<> {
   }
   // Set up fake ICE transport and real DTLS transport under test.
   void SetupTransports(IceRole role, int async_delay_ms = 0) {
+    // Destroy the transports of a previous connection in order.
+    dtls_transport_.reset();
     fake_ice_transport_.reset(new FakeIceTransport("fake", 0));
     fake_ice_transport_->SetAsync(true);
     fake_ice_transport_->SetAsyncDelay(async_delay_ms);
@@ -550,6 +553,41 @@ TEST_F(DtlsTransportTest, TestCertificatesAfterConnect) {
             certificate1->GetSSLCertificate().ToPEMString());
 }
 
+// Test that reconnecting with the same certificates resumes the DTLS session,
+// with which the DTLS client is writable a round trip earlier.
+TEST_F(DtlsTransportTest, TestSessionResumption) {
+  constexpr int kOneWayDelayMs = 100;
+  PrepareDtls(rtc::KT_DEFAULT);
+  rtc::scoped_refptr<rtc::SSLSessionCache> session_cache =
+      rtc::SSLSessionCache::Create();
+  int64_t handshake_ms[2];
+  for (int64_t& elapsed_ms : handshake_ms) {
+    client1_.SetupTransports(ICEROLE_CONTROLLING, kOneWayDelayMs);
+    client2_.SetupTransports(ICEROLE_CONTROLLED, kOneWayDelayMs);
+    client1_.dtls_transport()->SetSessionCache(session_cache);
+    client2_.dtls_transport()->SetSessionCache(session_cache);
+    client1_.dtls_transport()->SetDtlsRole(rtc::SSL_SERVER);
+    client2_.dtls_transport()->SetDtlsRole(rtc::SSL_CLIENT);
+    SetRemoteFingerprintFromCert(client1_.dtls_transport(),
+                                 client2_.certificate());
+    SetRemoteFingerprintFromCert(client2_.dtls_transport(),
+                                 client1_.certificate());
+
+    const int64_t start_ms = rtc::TimeMillis();
+    ASSERT_TRUE(client1_.Connect(&client2_, false));
+    EXPECT_TRUE_SIMULATED_WAIT(client2_.dtls_transport()->writable(), kTimeout,
+                               fake_clock_);
+    elapsed_ms = rtc::TimeMillis() - start_ms;
+    EXPECT_TRUE_SIMULATED_WAIT(client1_.dtls_transport()->writable(), kTimeout,
+                               fake_clock_);
+  }
+  RTC_LOG(LS_INFO) << "Full handshake: " << handshake_ms[0]
+                   << " ms, resumed: " << handshake_ms[1] << " ms";
+  // The full handshake takes two round trips, the abbreviated one only one.
+  EXPECT_GE(handshake_ms[0], 4 * kOneWayDelayMs);
+  EXPECT_LT(handshake_ms[1], 3 * kOneWayDelayMs);
+}
+
 // Test that packets are retransmitted according to the expected schedule.
 // Each time a timeout occurs, the retransmission timer should be doubled up to
 // 60 seconds. The timer defaults to 1 second, but for WebRTC we should be
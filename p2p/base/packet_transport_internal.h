@@ -73,23 +73,24 @@ class RTC_EXPORT PacketTransportInternal : public sigslot::has_slots<> {
   //  writable, but temporarily not able to send packets. For example, the
   //  underlying transport's socket buffer may be full, as indicated by
   //  SendPacket's return code and/or GetError.
-  sigslot::signal1<PacketTransportInternal*> SignalReadyToSend;
+  sigslot::single_threaded_signal<PacketTransportInternal*> SignalReadyToSend;
 
   // Emitted when receiving state changes to true.
   sigslot::signal1<PacketTransportInternal*> SignalReceivingState;
 
   // Signalled each time a packet is received on this channel.
-  sigslot::signal5<PacketTransportInternal*,
-                   const char*,
-                   size_t,
-                   // TODO(bugs.webrtc.org/9584): Change to passing the int64_t
-                   // timestamp by value.
-                   const int64_t&,
-                   int>
+  sigslot::single_threaded_signal<PacketTransportInternal*,
+                                  const char*,
+                                  size_t,
+                                  // TODO(bugs.webrtc.org/9584): Change to
+                                  // passing the int64_t timestamp by value.
+                                  const int64_t&,
+                                  int>
       SignalReadPacket;
 
   // Signalled each time a packet is sent on this channel.
-  sigslot::signal2<PacketTransportInternal*, const rtc::SentPacket&>
+  sigslot::single_threaded_signal<PacketTransportInternal*,
+                                  const rtc::SentPacket&>
       SignalSentPacket;
 
   // Signalled when the current network route has changed.
@@ -13,6 +13,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <set>
@@ -113,14 +114,26 @@ const uint32_t DEF_ACK_DELAY = 100;  // 100 milliseconds
 
 const uint8_t FLAG_CTL = 0x02;
 const uint8_t FLAG_RST = 0x04;
+// The payload of a pure ACK holds SACK blocks instead of data.
+const uint8_t FLAG_SACK = 0x08;
 
 const uint8_t CTL_CONNECT = 0;
 
 // TCP options.
-const uint8_t TCP_OPT_EOL = 0;        // End of list.
-const uint8_t TCP_OPT_NOOP = 1;       // No-op.
-const uint8_t TCP_OPT_MSS = 2;        // Maximum segment size.
-const uint8_t TCP_OPT_WND_SCALE = 3;  // Window scale factor.
+const uint8_t TCP_OPT_EOL = 0;             // End of list.
+const uint8_t TCP_OPT_NOOP = 1;            // No-op.
+const uint8_t TCP_OPT_MSS = 2;             // Maximum segment size.
+const uint8_t TCP_OPT_WND_SCALE = 3;       // Window scale factor.
+const uint8_t TCP_OPT_SACK_PERMITTED = 4;  // Selective ACKs supported.
+
+// Each SACK block holds the left and right edges of a range of received data,
+// as in RFC 2018.
+const uint32_t SACK_BLOCK_SIZE = 8;
+const uint32_t MAX_SACK_BLOCKS = 4;
+
+// Multiplicative decrease factor and scaling constant of CUBIC (RFC 8312).
+const double CUBIC_BETA = 0.7;
+const double CUBIC_C = 0.4;
 
 const long DEFAULT_TIMEOUT =
     4000;  // If there are no pending clocks, wake up every 4 seconds
@@ -222,6 +235,7 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
   m_conv = conv;
   m_rcv_wnd = m_rbuf_len;
   m_rwnd_scale = m_swnd_scale = 0;
+  m_rlist_last = 0;
   m_snd_nxt = 0;
   m_snd_wnd = 1;
   m_snd_una = m_rcv_nxt = 0;
@@ -245,6 +259,13 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
   m_dup_acks = 0;
   m_recover = 0;
 
+  m_sack_enabled = false;
+  m_sack_high = m_sack_rexmit_nxt = 0;
+
+  m_cc = CC_NEW_RENO;
+  m_cubic_w_max = m_cubic_origin = m_cubic_epoch_start = 0;
+  m_cubic_k = m_cubic_reno_cwnd = 0;
+
   m_ts_recent = m_ts_lastack = 0;
 
   m_rx_rto = DEF_RTO;
@@ -253,6 +274,7 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
   m_use_nagling = true;
   m_ack_delay = DEF_ACK_DELAY;
   m_support_wnd_scale = true;
+  m_support_sack = true;
 }
 
 PseudoTcp::~PseudoTcp() {}
@@ -296,16 +318,17 @@ void PseudoTcp::NotifyClock(uint32_t now) {
                        << ") (dup_acks: " << static_cast<unsigned>(m_dup_acks)
                        << ")";
 #endif  // _DEBUGMSG
-      if (!transmit(m_slist.begin(), now)) {
+      if (!transmit(0, now)) {
         closedown(ECONNABORTED);
         return;
       }
+      // Retransmissions of the holes after it may have been lost as well.
+      m_sack_rexmit_nxt = m_slist.front().seq + m_slist.front().len;
 
-      uint32_t nInFlight = m_snd_nxt - m_snd_una;
-      m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
-      // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: " <<
-      // nInFlight << "  m_mss: " << m_mss;
+      onCongestionEvent();
       m_cwnd = m_mss;
+      // A timeout ends fast recovery.
+      m_dup_acks = 0;
 
       // Back off retransmit timer.  Note: the limit is lower when connecting.
       uint32_t rto_limit = (m_state < TCP_ESTABLISHED) ? DEF_RTO : MAX_RTO;
@@ -372,6 +395,8 @@ void PseudoTcp::GetOption(Option opt, int* value) {
     *value = m_sbuf_len;
   } else if (opt == OPT_RCVBUF) {
     *value = m_rbuf_len;
+  } else if (opt == OPT_CONGESTION_CONTROL) {
+    *value = m_cc;
   } else {
     RTC_NOTREACHED();
   }
@@ -387,6 +412,10 @@ void PseudoTcp::SetOption(Option opt, int value) {
   } else if (opt == OPT_RCVBUF) {
     RTC_DCHECK(m_state == TCP_LISTEN);
     resizeReceiveBuffer(value);
+  } else if (opt == OPT_CONGESTION_CONTROL) {
+    RTC_DCHECK(value == CC_NEW_RENO || value == CC_CUBIC);
+    m_cc = static_cast<CongestionControl>(value);
+    m_cubic_epoch_start = 0;
   } else {
     RTC_NOTREACHED();
   }
@@ -515,28 +544,34 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
 
   uint32_t now = Now();
 
-  std::unique_ptr<uint8_t[]> buffer(new uint8_t[MAX_PACKET]);
-  long_to_bytes(m_conv, buffer.get());
-  long_to_bytes(seq, buffer.get() + 4);
-  long_to_bytes(m_rcv_nxt, buffer.get() + 8);
-  buffer[12] = 0;
-  buffer[13] = flags;
-  short_to_bytes(static_cast<uint16_t>(m_rcv_wnd >> m_rwnd_scale),
-                 buffer.get() + 14);
-
-  // Timestamp computations
-  long_to_bytes(now, buffer.get() + 16);
-  long_to_bytes(m_ts_recent, buffer.get() + 20);
-  m_ts_lastack = m_rcv_nxt;
-
+  m_packet_buf.SetSize(HEADER_SIZE +
+                       std::max(len, MAX_SACK_BLOCKS * SACK_BLOCK_SIZE));
+  uint8_t* buffer = m_packet_buf.data();
+  uint32_t payload_len = len;
   if (len) {
     size_t bytes_read = 0;
     rtc::StreamResult result =
-        m_sbuf.ReadOffset(buffer.get() + HEADER_SIZE, len, offset, &bytes_read);
+        m_sbuf.ReadOffset(buffer + HEADER_SIZE, len, offset, &bytes_read);
     RTC_DCHECK(result == rtc::SR_SUCCESS);
     RTC_DCHECK(static_cast<uint32_t>(bytes_read) == len);
+  } else if (flags == 0 && m_sack_enabled && !m_rlist.empty()) {
+    // Tell the peer which data after the hole at |m_rcv_nxt| we have.
+    payload_len = writeSackBlocks(buffer + HEADER_SIZE);
+    flags |= FLAG_SACK;
   }
 
+  long_to_bytes(m_conv, buffer);
+  long_to_bytes(seq, buffer + 4);
+  long_to_bytes(m_rcv_nxt, buffer + 8);
+  buffer[12] = 0;
+  buffer[13] = flags;
+  short_to_bytes(static_cast<uint16_t>(m_rcv_wnd >> m_rwnd_scale), buffer + 14);
+
+  // Timestamp computations
+  long_to_bytes(now, buffer + 16);
+  long_to_bytes(m_ts_recent, buffer + 20);
+  m_ts_lastack = m_rcv_nxt;
+
 #if _DEBUGMSG >= _DBG_VERBOSE
   RTC_LOG(LS_INFO) << "<-- <CONV=" << m_conv
                    << "><FLG=" << static_cast<unsigned>(flags)
@@ -548,7 +583,7 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
 #endif  // _DEBUGMSG
 
   IPseudoTcpNotify::WriteResult wres = m_notify->TcpWritePacket(
-      this, reinterpret_cast<char*>(buffer.get()), len + HEADER_SIZE);
+      this, reinterpret_cast<char*>(buffer), payload_len + HEADER_SIZE);
   // Note: When len is 0, this is an ACK packet.  We don't read the return value
   // for those, and thus we won't retry.  So go ahead and treat the packet as a
   // success (basically simulate as if it were dropped), which will prevent our
@@ -698,6 +733,12 @@ bool PseudoTcp::process(Segment& seg) {
     }
   }
 
+  // SACK blocks are not data, treat the segment as a pure ACK from here on.
+  if (seg.flags & FLAG_SACK) {
+    applySackBlocks(seg.data, seg.len);
+    seg.len = 0;
+  }
+
   // Update timestamp
   if ((seg.seq <= m_ts_lastack) && (m_ts_lastack < seg.seq + seg.len)) {
     m_ts_recent = seg.tsval;
@@ -743,6 +784,7 @@ bool PseudoTcp::process(Segment& seg) {
     for (uint32_t nFree = nAcked; nFree > 0;) {
       RTC_DCHECK(!m_slist.empty());
       if (nFree < m_slist.front().len) {
+        m_slist.front().seq += nFree;
         m_slist.front().len -= nFree;
         nFree = 0;
       } else {
@@ -766,7 +808,16 @@ bool PseudoTcp::process(Segment& seg) {
 #if _DEBUGMSG >= _DBG_NORMAL
         RTC_LOG(LS_INFO) << "recovery retransmit";
 #endif  // _DEBUGMSG
-        if (!transmit(m_slist.begin(), now)) {
+        // With SACK, the new first segment may have been retransmitted in
+        // this recovery already, so retransmit the next hole instead.
+        size_t index = 0;
+        if (m_sack_enabled &&
+            static_cast<int32_t>(m_sack_rexmit_nxt - m_snd_una) > 0) {
+          index = findNextHole();
+        } else {
+          m_sack_rexmit_nxt = m_slist.front().seq + m_slist.front().len;
+        }
+        if (index < m_slist.size() && !transmit(index, now)) {
           closedown(ECONNABORTED);
           return false;
         }
@@ -778,7 +829,7 @@ bool PseudoTcp::process(Segment& seg) {
       if (m_cwnd < m_ssthresh) {
         m_cwnd += m_mss;
       } else {
-        m_cwnd += std::max<uint32_t>(1, m_mss * m_mss / m_cwnd);
+        increaseCongestionWindow(nAcked, now);
       }
     }
   } else if (seg.ack == m_snd_una) {
@@ -796,18 +847,29 @@ bool PseudoTcp::process(Segment& seg) {
         RTC_LOG(LS_INFO) << "enter recovery";
         RTC_LOG(LS_INFO) << "recovery retransmit";
 #endif  // _DEBUGMSG
-        if (!transmit(m_slist.begin(), now)) {
+        if (!transmit(0, now)) {
           closedown(ECONNABORTED);
           return false;
         }
         m_recover = m_snd_nxt;
-        uint32_t nInFlight = m_snd_nxt - m_snd_una;
-        m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
-        // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: "
-        // << nInFlight << "  m_mss: " << m_mss;
+        // Give the retransmission a full RTO to be acknowledged.
+        m_rto_base = now;
+        m_sack_rexmit_nxt = m_slist.front().seq + m_slist.front().len;
+        onCongestionEvent();
         m_cwnd = m_ssthresh + 3 * m_mss;
       } else if (m_dup_acks > 3) {
-        m_cwnd += m_mss;
+        // Each duplicate ACK means that a segment has left the network. If
+        // SACK tells that there are more holes, retransmit the next one in
+        // its place, otherwise allow sending new data.
+        size_t index = m_sack_enabled ? findNextHole() : m_slist.size();
+        if (index < m_slist.size()) {
+          if (!transmit(index, now)) {
+            closedown(ECONNABORTED);
+            return false;
+          }
+        } else {
+          m_cwnd += m_mss;
+        }
       }
     } else {
       m_dup_acks = 0;
@@ -945,14 +1007,29 @@ bool PseudoTcp::process(Segment& seg) {
         RTC_LOG(LS_INFO) << "Saving " << seg.len << " bytes (" << seg.seq
                          << " -> " << seg.seq + seg.len << ")";
 #endif  // _DEBUGMSG
-        RSegment rseg;
-        rseg.seq = seg.seq;
-        rseg.len = seg.len;
+        m_rlist_last = seg.seq;
+        uint32_t end = seg.seq + seg.len;
         RList::iterator it = m_rlist.begin();
-        while ((it != m_rlist.end()) && (it->seq < rseg.seq)) {
+        while ((it != m_rlist.end()) && (it->seq + it->len < seg.seq)) {
           ++it;
         }
-        m_rlist.insert(it, rseg);
+        if ((it == m_rlist.end()) || (it->seq > end)) {
+          RSegment rseg;
+          rseg.seq = seg.seq;
+          rseg.len = seg.len;
+          m_rlist.insert(it, rseg);
+        } else {
+          // Merge with the ranges that the segment overlaps or touches.
+          RList::iterator next = it + 1;
+          while ((next != m_rlist.end()) && (next->seq <= end)) {
+            end = std::max(end, next->seq + next->len);
+            ++next;
+          }
+          end = std::max(end, it->seq + it->len);
+          it->seq = std::min(it->seq, seg.seq);
+          it->len = end - it->seq;
+          m_rlist.erase(it + 1, next);
+        }
       }
     }
     if (bRecover) {
@@ -989,7 +1066,8 @@ bool PseudoTcp::process(Segment& seg) {
   return true;
 }
 
-bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
+bool PseudoTcp::transmit(size_t index, uint32_t now) {
+  SSegment* seg = &m_slist[index];
   if (seg->xmit >= ((m_state == TCP_ESTABLISHED) ? 15 : 30)) {
     RTC_LOG_F(LS_VERBOSE) << "too many retransmits";
     return false;
@@ -1041,8 +1119,8 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
     subseg.xmit = seg->xmit;
     seg->len = nTransmit;
 
-    SList::iterator next = seg;
-    m_slist.insert(++next, subseg);
+    m_slist.insert(m_slist.begin() + index + 1, subseg);
+    seg = &m_slist[index];
   }
 
   if (seg->xmit == 0) {
@@ -1062,6 +1140,7 @@ void PseudoTcp::attemptSend(SendFlags sflags) {
 
   if (rtc::TimeDiff32(now, m_lastsend) > static_cast<long>(m_rx_rto)) {
     m_cwnd = m_mss;
+    m_cubic_epoch_start = 0;
   }
 
 #if _DEBUGMSG
@@ -1127,22 +1206,20 @@ void PseudoTcp::attemptSend(SendFlags sflags) {
       return;
     }
 
-    // Find the next segment to transmit
-    SList::iterator it = m_slist.begin();
-    while (it->xmit > 0) {
-      ++it;
-      RTC_DCHECK(it != m_slist.end());
-    }
-    SList::iterator seg = it;
+    // Find the next segment to transmit, which starts at |m_snd_nxt|.
+    size_t index = findSegment(m_snd_nxt);
+    RTC_DCHECK(index < m_slist.size());
+    SSegment& seg = m_slist[index];
+    RTC_DCHECK(seg.xmit == 0);
 
     // If the segment is too large, break it into two
-    if (seg->len > nAvailable) {
-      SSegment subseg(seg->seq + nAvailable, seg->len - nAvailable, seg->bCtrl);
-      seg->len = nAvailable;
-      m_slist.insert(++it, subseg);
+    if (seg.len > nAvailable) {
+      SSegment subseg(seg.seq + nAvailable, seg.len - nAvailable, seg.bCtrl);
+      seg.len = nAvailable;
+      m_slist.insert(m_slist.begin() + index + 1, subseg);
     }
 
-    if (!transmit(seg, now)) {
+    if (!transmit(index, now)) {
       RTC_LOG_F(LS_VERBOSE) << "transmit failed";
       // TODO(?): consider closing socket
       return;
@@ -1188,6 +1265,10 @@ void PseudoTcp::disableWindowScale() {
   m_support_wnd_scale = false;
 }
 
+void PseudoTcp::disableSack() {
+  m_support_sack = false;
+}
+
 void PseudoTcp::queueConnectMessage() {
   rtc::ByteBufferWriter buf(rtc::ByteBuffer::ORDER_NETWORK);
 
@@ -1197,6 +1278,10 @@ void PseudoTcp::queueConnectMessage() {
     buf.WriteUInt8(1);
     buf.WriteUInt8(m_rwnd_scale);
   }
+  if (m_support_sack) {
+    buf.WriteUInt8(TCP_OPT_SACK_PERMITTED);
+    buf.WriteUInt8(0);
+  }
   m_snd_wnd = static_cast<uint32_t>(buf.Length());
   queue(buf.Data(), static_cast<uint32_t>(buf.Length()), true);
 }
@@ -1245,6 +1330,11 @@ void PseudoTcp::parseOptions(const char* data, uint32_t len) {
       m_swnd_scale = 0;
     }
   }
+
+  // SACK blocks are only sent to peers that know how to parse them.
+  m_sack_enabled =
+      m_support_sack && (options_specified.find(TCP_OPT_SACK_PERMITTED) !=
+                         options_specified.end());
 }
 
 void PseudoTcp::applyOption(char kind, const char* data, uint32_t len) {
@@ -1266,6 +1356,145 @@ void PseudoTcp::applyWindowScaleOption(uint8_t scale_factor) {
   m_swnd_scale = scale_factor;
 }
 
+uint32_t PseudoTcp::writeSackBlocks(uint8_t* buffer) const {
+  // The first block holds the most recently received segment, the others
+  // follow in sequence number order (RFC 2018, section 4).
+  size_t recent = 0;
+  for (size_t i = 0; i < m_rlist.size(); ++i) {
+    if ((m_rlist[i].seq <= m_rlist_last) &&
+        (m_rlist_last < m_rlist[i].seq + m_rlist[i].len)) {
+      recent = i;
+      break;
+    }
+  }
+
+  uint32_t len = 0;
+  for (size_t i = 0; (i < m_rlist.size()) &&
+                     (len < MAX_SACK_BLOCKS * SACK_BLOCK_SIZE);
+       ++i) {
+    const RSegment& rseg = m_rlist[i == 0 ? recent : (i <= recent ? i - 1 : i)];
+    long_to_bytes(rseg.seq, buffer + len);
+    long_to_bytes(rseg.seq + rseg.len, buffer + len + 4);
+    len += SACK_BLOCK_SIZE;
+  }
+  return len;
+}
+
+void PseudoTcp::applySackBlocks(const char* data, uint32_t len) {
+  for (uint32_t pos = 0; pos + SACK_BLOCK_SIZE <= len;
+       pos += SACK_BLOCK_SIZE) {
+    uint32_t left = bytes_to_long(data + pos);
+    uint32_t right = bytes_to_long(data + pos + 4);
+    // Ignore blocks that are not within the data in flight.
+    if ((left - m_snd_una >= right - m_snd_una) ||
+        (right - m_snd_una > m_snd_nxt - m_snd_una)) {
+      continue;
+    }
+    if (static_cast<int32_t>(right - m_sack_high) > 0) {
+      m_sack_high = right;
+    }
+    for (size_t index = findSegment(left); index < m_slist.size(); ++index) {
+      SSegment& seg = m_slist[index];
+      if (seg.seq + seg.len - m_snd_una > right - m_snd_una) {
+        break;
+      }
+      seg.bSacked = true;
+    }
+  }
+}
+
+size_t PseudoTcp::findNextHole() {
+  if (static_cast<int32_t>(m_sack_rexmit_nxt - m_snd_una) < 0) {
+    m_sack_rexmit_nxt = m_snd_una;
+  }
+  size_t index = findSegment(m_sack_rexmit_nxt);
+  for (; index < m_slist.size(); ++index) {
+    const SSegment& seg = m_slist[index];
+    // Data is only considered lost if later data has been received.
+    if ((seg.xmit == 0) ||
+        (static_cast<int32_t>(seg.seq + seg.len - m_sack_high) > 0)) {
+      break;
+    }
+    if (!seg.bSacked) {
+      m_sack_rexmit_nxt = seg.seq + seg.len;
+      return index;
+    }
+  }
+  // Don't scan the received segments again.
+  m_sack_rexmit_nxt = (index < m_slist.size()) ? m_slist[index].seq : m_snd_nxt;
+  return m_slist.size();
+}
+
+size_t PseudoTcp::findSegment(uint32_t seq) const {
+  // Compare offsets from |m_snd_una|, which are not affected by wrap around.
+  uint32_t offset = seq - m_snd_una;
+  return std::lower_bound(m_slist.begin(), m_slist.end(), offset,
+                          [this](const SSegment& seg, uint32_t value) {
+                            return seg.seq - m_snd_una < value;
+                          }) -
+         m_slist.begin();
+}
+
+void PseudoTcp::onCongestionEvent() {
+  uint32_t nInFlight = m_snd_nxt - m_snd_una;
+  if (m_cc == CC_CUBIC) {
+    // Fast convergence: leave room for new flows if the window has not grown
+    // back to where it was at the previous loss (RFC 8312, section 4.6).
+    if (m_cwnd < m_cubic_w_max) {
+      m_cubic_w_max = static_cast<uint32_t>(m_cwnd * (1 + CUBIC_BETA) / 2);
+    } else {
+      m_cubic_w_max = m_cwnd;
+    }
+    m_cubic_epoch_start = 0;
+    m_ssthresh =
+        std::max(static_cast<uint32_t>(nInFlight * CUBIC_BETA), 2 * m_mss);
+  } else {
+    m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
+  }
+  // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: "
+  // << nInFlight << "  m_mss: " << m_mss;
+}
+
+void PseudoTcp::increaseCongestionWindow(uint32_t nAcked, uint32_t now) {
+  if (m_cc != CC_CUBIC) {
+    m_cwnd += std::max<uint32_t>(1, m_mss * m_mss / m_cwnd);
+    return;
+  }
+
+  if (m_cubic_epoch_start == 0) {
+    m_cubic_epoch_start = now;
+    if (m_cwnd < m_cubic_w_max) {
+      m_cubic_k = std::cbrt((m_cubic_w_max - m_cwnd) / (CUBIC_C * m_mss));
+      m_cubic_origin = m_cubic_w_max;
+    } else {
+      m_cubic_k = 0;
+      m_cubic_origin = m_cwnd;
+    }
+    m_cubic_reno_cwnd = m_cwnd;
+  }
+
+  // The window that the cubic function reaches in one round trip.
+  double t = (rtc::TimeDiff32(now, m_cubic_epoch_start) + m_rx_srtt) / 1000.0 -
+             m_cubic_k;
+  double target = m_cubic_origin + CUBIC_C * t * t * t * m_mss;
+
+  // Never grow slower than Reno would with the same decrease factor, which
+  // adds 3 * (1 - beta) / (1 + beta) segments per round trip.
+  m_cubic_reno_cwnd += 3 * (1 - CUBIC_BETA) / (1 + CUBIC_BETA) * m_mss *
+                       nAcked / m_cubic_reno_cwnd;
+  target = std::max(target, m_cubic_reno_cwnd);
+
+  if (target > m_cwnd) {
+    // Approach the target over a round trip, by at most half a segment per
+    // segment acknowledged.
+    m_cwnd += std::max<uint32_t>(
+        1, static_cast<uint32_t>(
+               std::min((target - m_cwnd) * nAcked / m_cwnd, nAcked / 2.0)));
+  } else {
+    m_cwnd += std::max<uint32_t>(1, m_mss * nAcked / (100 * m_cwnd));
+  }
+}
+
 void PseudoTcp::resizeSendBuffer(uint32_t new_size) {
   m_sbuf_len = new_size;
   m_sbuf.SetCapacity(new_size);
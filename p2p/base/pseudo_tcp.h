@@ -13,8 +13,9 @@
 
 #include <stddef.h>
 #include <stdint.h>
-#include <list>
+#include <deque>
 
+#include "rtc_base/buffer.h"
 #include "rtc_base/memory/fifo_buffer.h"
 #include "rtc_base/system/rtc_export.h"
 
@@ -96,6 +97,12 @@ class RTC_EXPORT PseudoTcp {
     OPT_ACKDELAY,  // The Delayed ACK timeout (0 == off).
     OPT_RCVBUF,    // Set the receive buffer size, in bytes.
     OPT_SNDBUF,    // Set the send buffer size, in bytes.
+    // The CongestionControl algorithm to use.
+    OPT_CONGESTION_CONTROL,
+  };
+  enum CongestionControl {
+    CC_NEW_RENO,  // RFC 6582, the default.
+    CC_CUBIC,     // RFC 8312, grows the window faster on long fat networks.
   };
   void GetOption(Option opt, int* value);
   void SetOption(Option opt, int value);
@@ -128,13 +135,17 @@ class RTC_EXPORT PseudoTcp {
 
   struct SSegment {
     SSegment(uint32_t s, uint32_t l, bool c)
-        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c) {}
+        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c), bSacked(false) {}
     uint32_t seq, len;
     // uint32_t tstamp;
     uint8_t xmit;
     bool bCtrl;
+    // Whether the peer has selectively acknowledged this segment.
+    bool bSacked;
   };
-  typedef std::list<SSegment> SList;
+  // Segments are kept in sequence number order, which allows looking them up
+  // with a binary search.
+  typedef std::deque<SSegment> SList;
 
   struct RSegment {
     uint32_t seq, len;
@@ -163,7 +174,8 @@ class RTC_EXPORT PseudoTcp {
   bool clock_check(uint32_t now, long& nTimeout);
 
   bool process(Segment& seg);
-  bool transmit(const SList::iterator& seg, uint32_t now);
+  // Transmits the segment at |index| in |m_slist|.
+  bool transmit(size_t index, uint32_t now);
 
   void adjustMTU();
 
@@ -175,6 +187,10 @@ class RTC_EXPORT PseudoTcp {
   // support for testing backward compatibility.
   void disableWindowScale();
 
+  // This method is only used in tests, to disable selective acknowledgments
+  // for testing backward compatibility.
+  void disableSack();
+
  private:
   // Queue the connect message with TCP options.
   void queueConnectMessage();
@@ -188,6 +204,29 @@ class RTC_EXPORT PseudoTcp {
   // Apply window scale option.
   void applyWindowScaleOption(uint8_t scale_factor);
 
+  // Writes SACK blocks describing the out-of-order data in |m_rlist| to
+  // |buffer| and returns their size in bytes.
+  uint32_t writeSackBlocks(uint8_t* buffer) const;
+
+  // Marks the segments covered by the SACK blocks in |data| as received by
+  // the peer.
+  void applySackBlocks(const char* data, uint32_t len);
+
+  // Returns the index of the first segment in |m_slist| at or after
+  // |m_sack_rexmit_nxt| that the peer has not received although it has
+  // received later data, or |m_slist.size()| if there is none.
+  size_t findNextHole();
+
+  // Returns the index of the first segment in |m_slist| that starts at or
+  // after |seq|, or |m_slist.size()| if there is none.
+  size_t findSegment(uint32_t seq) const;
+
+  // Updates the slow start threshold after a loss.
+  void onCongestionEvent();
+
+  // Grows the congestion window in congestion avoidance.
+  void increaseCongestionWindow(uint32_t nAcked, uint32_t now);
+
   // Resize the send buffer with |new_size| in bytes.
   void resizeSendBuffer(uint32_t new_size);
 
@@ -205,9 +244,11 @@ class RTC_EXPORT PseudoTcp {
   bool m_bReadEnable, m_bWriteEnable, m_bOutgoing;
   uint32_t m_lasttraffic;
 
-  // Incoming data
-  typedef std::list<RSegment> RList;
+  // Incoming data. Out-of-order segments are coalesced into disjoint ranges.
+  typedef std::deque<RSegment> RList;
   RList m_rlist;
+  // Sequence number of the most recently received out-of-order segment.
+  uint32_t m_rlist_last;
   uint32_t m_rbuf_len, m_rcv_nxt, m_rcv_wnd, m_lastrecv;
   uint8_t m_rwnd_scale;  // Window scale factor.
   rtc::FifoBuffer m_rbuf;
@@ -218,6 +259,16 @@ class RTC_EXPORT PseudoTcp {
   uint8_t m_swnd_scale;  // Window scale factor.
   rtc::FifoBuffer m_sbuf;
 
+  // Reused for building outgoing packets.
+  rtc::Buffer m_packet_buf;
+
+  // Selective acknowledgments (RFC 2018), enabled if both sides support them.
+  bool m_sack_enabled;
+  // End of the highest range the peer has selectively acknowledged, and the
+  // sequence number up to which holes below it have been retransmitted in the
+  // current recovery.
+  uint32_t m_sack_high, m_sack_rexmit_nxt;
+
   // Maximum segment size, estimated protocol level, largest segment sent
   uint32_t m_mss, m_msslevel, m_largest, m_mtu_advise;
   // Retransmit timer
@@ -231,10 +282,18 @@ class RTC_EXPORT PseudoTcp {
 
   // Congestion avoidance, Fast retransmit/recovery, Delayed ACKs
   uint32_t m_ssthresh, m_cwnd;
-  uint8_t m_dup_acks;
+  uint32_t m_dup_acks;
   uint32_t m_recover;
   uint32_t m_t_ack;
 
+  // CUBIC state: window before the last reduction, window at the plateau of
+  // the cubic function, the time the current epoch started (0 if none), the
+  // time it takes to reach the plateau in seconds, and the window of an
+  // emulated Reno flow.
+  CongestionControl m_cc;
+  uint32_t m_cubic_w_max, m_cubic_origin, m_cubic_epoch_start;
+  double m_cubic_k, m_cubic_reno_cwnd;
+
   // Configuration options
   bool m_use_nagling;
   uint32_t m_ack_delay;
@@ -242,6 +301,9 @@ class RTC_EXPORT PseudoTcp {
   // This is used by unit tests to test backward compatibility of
   // PseudoTcp implementations that don't support window scaling.
   bool m_support_wnd_scale;
+
+  // Whether to offer selective acknowledgments to the peer.
+  bool m_support_sack;
 };
 
 }  // namespace cricket
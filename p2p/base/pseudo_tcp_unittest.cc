@@ -11,10 +11,14 @@
 #include <string.h>
 #include <algorithm>
 #include <cstddef>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "api/units/time_delta.h"
 #include "p2p/base/pseudo_tcp.h"
+#include "rtc_base/fake_clock.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/helpers.h"
 #include "rtc_base/location.h"
@@ -22,6 +26,7 @@
 #include "rtc_base/memory_stream.h"
 #include "rtc_base/message_handler.h"
 #include "rtc_base/message_queue.h"
+#include "rtc_base/random.h"
 #include "rtc_base/thread.h"
 #include "rtc_base/time_utils.h"
 #include "test/gtest.h"
@@ -40,6 +45,8 @@ class PseudoTcpForTest : public cricket::PseudoTcp {
   bool isReceiveBufferFull() const { return PseudoTcp::isReceiveBufferFull(); }
 
   void disableWindowScale() { PseudoTcp::disableWindowScale(); }
+
+  void disableSack() { PseudoTcp::disableSack(); }
 };
 
 class PseudoTcpTestBase : public ::testing::Test,
@@ -100,6 +107,12 @@ class PseudoTcpTestBase : public ::testing::Test,
   }
   void DisableRemoteWindowScale() { remote_.disableWindowScale(); }
   void DisableLocalWindowScale() { local_.disableWindowScale(); }
+  void DisableRemoteSack() { remote_.disableSack(); }
+  void DisableLocalSack() { local_.disableSack(); }
+  void SetOptCongestionControl(PseudoTcp::CongestionControl cc) {
+    local_.SetOption(PseudoTcp::OPT_CONGESTION_CONTROL, cc);
+    remote_.SetOption(PseudoTcp::OPT_CONGESTION_CONTROL, cc);
+  }
 
  protected:
   int Connect() {
@@ -631,6 +644,26 @@ TEST_F(PseudoTcpTest, TestSendWithLoss) {
   TestTransfer(100000);  // less data so test runs faster
 }
 
+// Test sending data with packet loss to a peer that doesn't support selective
+// acknowledgments.
+TEST_F(PseudoTcpTest, TestSendWithLossRemoteNoSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetLoss(10);
+  DisableRemoteSack();
+  TestTransfer(100000);
+}
+
+// Test sending data with packet loss from a peer that doesn't support
+// selective acknowledgments.
+TEST_F(PseudoTcpTest, TestSendWithLossLocalNoSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetLoss(10);
+  DisableLocalSack();
+  TestTransfer(100000);
+}
+
 // Test sending data with a 50 ms RTT and 10% packet loss. Transmission should
 // take much longer due to send back-off and slower detection of loss.
 TEST_F(PseudoTcpTest, TestSendWithDelayAndLoss) {
@@ -682,6 +715,16 @@ TEST_F(PseudoTcpTest, TestSendWithLossAndOptAckDelayOff) {
   TestTransfer(100000);
 }
 
+// Test sending data with 50ms delay and 10% packet loss using CUBIC.
+TEST_F(PseudoTcpTest, TestSendWithDelayAndLossUsingCubic) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetDelay(50);
+  SetLoss(10);
+  SetOptCongestionControl(PseudoTcp::CC_CUBIC);
+  TestTransfer(100000);  // less data so test runs faster
+}
+
 // Test sending data with 50ms delay and Nagling disabled.
 TEST_F(PseudoTcpTest, TestSendWithDelayAndOptNaglingOff) {
   SetLocalMtu(1500);
@@ -878,3 +921,194 @@ TEST_F(PseudoTcpTest, TestSendWithMismatchedMtus) {
   TestTransfer(1000000);
 }
 */
+
+// Transfers data in simulated time over a link with a bottleneck rate, a
+// fixed round-trip time and random loss, to measure the goodput that
+// PseudoTcp achieves on long fat networks.
+class PseudoTcpLinkSimulation : public cricket::IPseudoTcpNotify {
+ public:
+  struct Link {
+    int rtt_ms;
+    double loss_percent;
+    int rate_kbps;
+  };
+
+  PseudoTcpLinkSimulation(const Link& link, int buffer_size)
+      : link_(link), random_(4711), sender_(this, 1), receiver_(this, 1) {
+    // PseudoTcp treats a time of 0 as unset.
+    clock_.AdvanceTime(webrtc::TimeDelta::seconds(1));
+    for (PseudoTcpForTest* tcp : {&sender_, &receiver_}) {
+      tcp->NotifyMTU(1280);
+      tcp->SetOption(PseudoTcp::OPT_SNDBUF, buffer_size);
+      tcp->SetOption(PseudoTcp::OPT_RCVBUF, buffer_size);
+    }
+  }
+
+  PseudoTcpForTest& sender() { return sender_; }
+  PseudoTcpForTest& receiver() { return receiver_; }
+
+  // Returns the goodput in kbps, or 0 if the transfer did not complete within
+  // |max_duration_ms| of simulated time.
+  int Run(size_t transfer_size, int64_t max_duration_ms) {
+    transfer_size_ = transfer_size;
+    const int64_t start_us = rtc::TimeMicros();
+    sender_.Connect();
+    while (bytes_received_ < transfer_size_) {
+      if (sender_.State() == PseudoTcp::TCP_CLOSED) {
+        return 0;
+      }
+      int64_t next_us = std::min(next_clock_us_[0], next_clock_us_[1]);
+      if (!packets_.empty()) {
+        next_us = std::min(next_us, packets_.begin()->first);
+      }
+      if (next_us - start_us > max_duration_ms * 1000) {
+        return 0;
+      }
+      if (next_us > rtc::TimeMicros()) {
+        clock_.AdvanceTime(
+            webrtc::TimeDelta::us(next_us - rtc::TimeMicros()));
+      }
+      while (!packets_.empty() && packets_.begin()->first <= next_us) {
+        Packet packet = std::move(packets_.begin()->second);
+        packets_.erase(packets_.begin());
+        packet.destination->NotifyPacket(packet.data.data(),
+                                         packet.data.size());
+      }
+      for (int i = 0; i < 2; ++i) {
+        if (next_clock_us_[i] <= next_us) {
+          endpoint(i).NotifyClock(PseudoTcp::Now());
+        }
+      }
+      UpdateClocks();
+    }
+    return static_cast<int>(transfer_size_ * 8 * 1000 /
+                            (rtc::TimeMicros() - start_us));
+  }
+
+ private:
+  struct Packet {
+    PseudoTcp* destination;
+    std::string data;
+  };
+
+  PseudoTcpForTest& endpoint(int index) {
+    return index == 0 ? sender_ : receiver_;
+  }
+
+  void UpdateClocks() {
+    for (int i = 0; i < 2; ++i) {
+      long timeout = 0;
+      endpoint(i).GetNextClock(PseudoTcp::Now(), timeout);
+      next_clock_us_[i] =
+          rtc::TimeMicros() + std::max<long>(timeout, 1) * 1000;
+    }
+  }
+
+  void WriteData() {
+    static const char kData[kBlockSize] = {};
+    while (bytes_sent_ < transfer_size_) {
+      int sent = sender_.Send(
+          kData, std::min<size_t>(kBlockSize, transfer_size_ - bytes_sent_));
+      if (sent <= 0) {
+        break;
+      }
+      bytes_sent_ += sent;
+    }
+  }
+
+  void OnTcpOpen(PseudoTcp* tcp) override {
+    if (tcp == &sender_) {
+      WriteData();
+    }
+  }
+  void OnTcpReadable(PseudoTcp* tcp) override {
+    char buffer[kBlockSize];
+    int received;
+    while ((received = receiver_.Recv(buffer, sizeof(buffer))) > 0) {
+      bytes_received_ += received;
+    }
+  }
+  void OnTcpWriteable(PseudoTcp* tcp) override { WriteData(); }
+  void OnTcpClosed(PseudoTcp* tcp, uint32_t error) override {}
+  WriteResult TcpWritePacket(PseudoTcp* tcp,
+                             const char* buffer,
+                             size_t len) override {
+    if (random_.Rand<double>() * 100 < link_.loss_percent) {
+      return WR_SUCCESS;
+    }
+    // Packets queue up in front of the bottleneck, one queue per direction,
+    // which holds up to a round trip worth of data.
+    const int direction = tcp == &sender_ ? 0 : 1;
+    if (link_free_us_[direction] - rtc::TimeMicros() > link_.rtt_ms * 1000) {
+      return WR_SUCCESS;
+    }
+    link_free_us_[direction] =
+        std::max(link_free_us_[direction], rtc::TimeMicros()) +
+        static_cast<int64_t>(len) * 8 * 1000 / link_.rate_kbps;
+    packets_.emplace(link_free_us_[direction] + link_.rtt_ms * 1000 / 2,
+                     Packet{direction == 0 ? static_cast<PseudoTcp*>(&receiver_)
+                                           : &sender_,
+                            std::string(buffer, len)});
+    return WR_SUCCESS;
+  }
+
+  const Link link_;
+  rtc::ScopedBaseFakeClock clock_;
+  webrtc::Random random_;
+  PseudoTcpForTest sender_;
+  PseudoTcpForTest receiver_;
+  std::multimap<int64_t, Packet> packets_;
+  int64_t link_free_us_[2] = {0, 0};
+  int64_t next_clock_us_[2] = {0, 0};
+  size_t transfer_size_ = 0;
+  size_t bytes_sent_ = 0;
+  size_t bytes_received_ = 0;
+};
+
+// Slow start overflows the bottleneck queue, which drops many segments of the
+// same window. SACK allows retransmitting all of them within a round trip.
+TEST(PseudoTcpLinkSimulationTest, SackRecoversFromBurstLoss) {
+  constexpr PseudoTcpLinkSimulation::Link kLink = {100, 0.0, 20000};
+  constexpr int kBufferSize = 1024 * 1024;
+  constexpr size_t kTransferSize = 2 * 1024 * 1024;
+  int goodput_kbps[2];
+  for (bool sack : {false, true}) {
+    PseudoTcpLinkSimulation simulation(kLink, kBufferSize);
+    if (!sack) {
+      simulation.sender().disableSack();
+    }
+    goodput_kbps[sack] = simulation.Run(kTransferSize, 60000);
+  }
+  EXPECT_GT(goodput_kbps[false], 0);
+  EXPECT_GT(goodput_kbps[true], 2 * goodput_kbps[false]);
+}
+
+// Prints the goodput of bulk transfers over a 20 Mbps link with different
+// round-trip times and random loss rates, with NewReno, NewReno with SACK and
+// CUBIC with SACK.
+TEST(PseudoTcpLinkSimulationTest, DISABLED_Throughput) {
+  constexpr int kRateKbps = 20000;
+  constexpr int kBufferSize = 2 * 1024 * 1024;
+  constexpr size_t kTransferSize = 10 * 1024 * 1024;
+  for (int rtt_ms : {50, 100, 200}) {
+    for (double loss_percent : {0.0, 0.1, 1.0, 3.0}) {
+      int goodput_kbps[3];
+      for (int variant = 0; variant < 3; ++variant) {
+        PseudoTcpLinkSimulation simulation({rtt_ms, loss_percent, kRateKbps},
+                                           kBufferSize);
+        if (variant == 0) {
+          simulation.sender().disableSack();
+        } else if (variant == 2) {
+          simulation.sender().SetOption(PseudoTcp::OPT_CONGESTION_CONTROL,
+                                        PseudoTcp::CC_CUBIC);
+        }
+        goodput_kbps[variant] = simulation.Run(kTransferSize, 600000);
+      }
+      printf(
+          "RTT %3d ms, loss %.1f%%: NewReno %5d kbps, SACK %5d kbps, "
+          "SACK+CUBIC %5d kbps\n",
+          rtt_ms, loss_percent, goodput_kbps[0], goodput_kbps[1],
+          goodput_kbps[2]);
+    }
+  }
+}
@@ -13,6 +13,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "media/sctp/sctp_transport_internal.h"
@@ -28,6 +29,24 @@ namespace webrtc {
 static size_t kMaxQueuedReceivedDataBytes = 16 * 1024 * 1024;
 static size_t kMaxQueuedSendDataBytes = 16 * 1024 * 1024;
 
+// A batch holds consecutive messages of the same type, and no more than the
+// SCTP send buffer can take, as the transport would reject the rest anyway.
+// Adds the payload of |buffer| to the batch if it fits.
+static bool AddToSendBatch(const DataBuffer& buffer,
+                           bool binary,
+                           size_t* batch_bytes,
+                           std::vector<rtc::CopyOnWriteBuffer>* payloads) {
+  if (buffer.binary != binary ||
+      (!payloads->empty() &&
+       *batch_bytes + buffer.size() >
+           static_cast<size_t>(cricket::kSctpSendBufferSize))) {
+    return false;
+  }
+  payloads->push_back(buffer.data);
+  *batch_bytes += buffer.size();
+  return true;
+}
+
 InternalDataChannelInit::InternalDataChannelInit(const DataChannelInit& base)
     : DataChannelInit(base), open_handshake_role(kOpener) {
   // If the channel is externally negotiated, do not send the OPEN message.
@@ -89,6 +108,20 @@ bool SctpSidAllocator::IsSidAvailable(int sid) const {
   return used_sids_.find(sid) == used_sids_.end();
 }
 
+size_t DataChannelProviderInterface::SendDataBatch(
+    const cricket::SendDataParams& params,
+    rtc::ArrayView<const rtc::CopyOnWriteBuffer> payloads,
+    cricket::SendDataResult* result) {
+  size_t num_sent = 0;
+  for (const rtc::CopyOnWriteBuffer& payload : payloads) {
+    if (!SendData(params, payload, result)) {
+      break;
+    }
+    ++num_sent;
+  }
+  return num_sent;
+}
+
 bool DataChannel::PacketQueue::Empty() const {
   return packets_.empty();
 }
@@ -285,6 +318,77 @@ bool DataChannel::Send(const DataBuffer& buffer) {
   return true;
 }
 
+bool DataChannel::SendBatch(rtc::ArrayView<const DataBuffer> buffers) {
+  if (!IsSctpLike(data_channel_type_)) {
+    return DataChannelInterface::SendBatch(buffers);
+  }
+
+  for (const DataBuffer& buffer : buffers) {
+    buffered_amount_ += buffer.size();
+  }
+  if (state_ != kOpen) {
+    return false;
+  }
+
+  // Empty buffers aren't sent, like with Send().
+  std::vector<const DataBuffer*> pending;
+  pending.reserve(buffers.size());
+  for (const DataBuffer& buffer : buffers) {
+    if (buffer.size() > 0) {
+      pending.push_back(&buffer);
+    }
+  }
+
+  // If the queue is non-empty, we're waiting for SignalReadyToSend and all
+  // buffers are queued after the ones that are already queued. Otherwise they
+  // are sent directly while the transport takes them, and only the rest is
+  // queued, which shares the payloads and doesn't copy any data.
+  size_t num_sent = 0;
+  bool blocked = !queued_send_data_.Empty();
+  cricket::SendDataResult send_result = cricket::SDR_SUCCESS;
+  while (!blocked && num_sent < pending.size()) {
+    const bool binary = pending[num_sent]->binary;
+    std::vector<rtc::CopyOnWriteBuffer> payloads;
+    size_t batch_bytes = 0;
+    for (size_t i = num_sent; i < pending.size(); ++i) {
+      if (!AddToSendBatch(*pending[i], binary, &batch_bytes, &payloads)) {
+        break;
+      }
+    }
+    const size_t num_batch_sent = provider_->SendDataBatch(
+        GetDataSendParams(binary), payloads, &send_result);
+    num_sent += num_batch_sent;
+    blocked = num_batch_sent < payloads.size();
+  }
+
+  bool failed = blocked && send_result != cricket::SDR_SUCCESS &&
+                send_result != cricket::SDR_BLOCK;
+  if (failed) {
+    RTC_LOG(LS_ERROR)
+        << "Closing the DataChannel due to a failure to send data, "
+           "send_result = "
+        << send_result;
+  } else {
+    for (size_t i = num_sent; i < pending.size(); ++i) {
+      if (!QueueSendDataMessage(*pending[i])) {
+        RTC_LOG(LS_ERROR) << "Closing the DataChannel due to a failure to "
+                             "queue additional data.";
+        failed = true;
+        break;
+      }
+    }
+  }
+  // The rest is queued before notifying the observer, which may send more
+  // data.
+  for (size_t i = 0; i < num_sent; ++i) {
+    OnDataMessageSent(pending[i]->size());
+  }
+  if (failed) {
+    CloseAbruptly();
+  }
+  return true;
+}
+
 void DataChannel::SetReceiveSsrc(uint32_t receive_ssrc) {
   RTC_DCHECK(data_channel_type_ == cricket::DCT_RTP);
 
@@ -577,17 +681,49 @@ void DataChannel::SendQueuedDataMessages() {
   RTC_DCHECK(state_ == kOpen || state_ == kClosing);
 
   while (!queued_send_data_.Empty()) {
-    std::unique_ptr<DataBuffer> buffer = queued_send_data_.PopFront();
-    if (!SendDataMessage(*buffer, false)) {
-      // Return the message to the front of the queue if sending is aborted.
-      queued_send_data_.PushFront(std::move(buffer));
+    if (!SendQueuedDataBatch()) {
       break;
     }
   }
 }
 
-bool DataChannel::SendDataMessage(const DataBuffer& buffer,
-                                  bool queue_if_blocked) {
+bool DataChannel::SendQueuedDataBatch() {
+  const bool binary = queued_send_data_.Peek(0).binary;
+  std::vector<rtc::CopyOnWriteBuffer> payloads;
+  size_t batch_bytes = 0;
+  for (size_t i = 0; i < queued_send_data_.Size(); ++i) {
+    if (!AddToSendBatch(queued_send_data_.Peek(i), binary, &batch_bytes,
+                        &payloads)) {
+      break;
+    }
+  }
+
+  cricket::SendDataResult send_result = cricket::SDR_SUCCESS;
+  const size_t num_sent = provider_->SendDataBatch(GetDataSendParams(binary),
+                                                   payloads, &send_result);
+  // Remove the sent messages before notifying the observer, which may send
+  // more data.
+  for (size_t i = 0; i < num_sent; ++i) {
+    queued_send_data_.PopFront();
+  }
+  for (size_t i = 0; i < num_sent; ++i) {
+    OnDataMessageSent(payloads[i].size());
+  }
+  if (num_sent == payloads.size()) {
+    return true;
+  }
+
+  if (send_result != cricket::SDR_BLOCK) {
+    RTC_LOG(LS_ERROR)
+        << "Closing the DataChannel due to a failure to send data, "
+           "send_result = "
+        << send_result;
+    CloseAbruptly();
+  }
+  return false;
+}
+
+cricket::SendDataParams DataChannel::GetDataSendParams(bool binary) const {
   cricket::SendDataParams send_params;
 
   if (IsSctpLike(data_channel_type_)) {
@@ -608,20 +744,18 @@ bool DataChannel::SendDataMessage(const DataBuffer& buffer,
   } else {
     send_params.ssrc = send_ssrc_;
   }
-  send_params.type = buffer.binary ? cricket::DMT_BINARY : cricket::DMT_TEXT;
+  send_params.type = binary ? cricket::DMT_BINARY : cricket::DMT_TEXT;
+  return send_params;
+}
 
+bool DataChannel::SendDataMessage(const DataBuffer& buffer,
+                                  bool queue_if_blocked) {
   cricket::SendDataResult send_result = cricket::SDR_SUCCESS;
-  bool success = provider_->SendData(send_params, buffer.data, &send_result);
+  bool success = provider_->SendData(GetDataSendParams(buffer.binary),
+                                     buffer.data, &send_result);
 
   if (success) {
-    ++messages_sent_;
-    bytes_sent_ += buffer.size();
-
-    RTC_DCHECK(buffered_amount_ >= buffer.size());
-    buffered_amount_ -= buffer.size();
-    if (observer_ && buffer.size() > 0) {
-      observer_->OnBufferedAmountChange(buffer.size());
-    }
+    OnDataMessageSent(buffer.size());
     return true;
   }
 
@@ -644,6 +778,17 @@ bool DataChannel::SendDataMessage(const DataBuffer& buffer,
   return false;
 }
 
+void DataChannel::OnDataMessageSent(size_t size) {
+  ++messages_sent_;
+  bytes_sent_ += size;
+
+  RTC_DCHECK(buffered_amount_ >= size);
+  buffered_amount_ -= size;
+  if (observer_ && size > 0) {
+    observer_->OnBufferedAmountChange(size);
+  }
+}
+
 bool DataChannel::QueueSendDataMessage(const DataBuffer& buffer) {
   size_t start_buffered_amount = queued_send_data_.byte_count();
   if (start_buffered_amount + buffer.size() > kMaxQueuedSendDataBytes) {
@@ -16,6 +16,7 @@
 #include <set>
 #include <string>
 
+#include "api/array_view.h"
 #include "api/data_channel_interface.h"
 #include "api/proxy.h"
 #include "api/scoped_refptr.h"
@@ -37,6 +38,15 @@ class DataChannelProviderInterface {
   virtual bool SendData(const cricket::SendDataParams& params,
                         const rtc::CopyOnWriteBuffer& payload,
                         cricket::SendDataResult* result) = 0;
+  // Sends |payloads| with the same |params|, in order, and stops at the first
+  // one that can't be sent. Returns the number of payloads that were sent;
+  // |result| tells why the next one wasn't. Providers that have to switch
+  // threads to reach the transport should override this to do it once for
+  // the whole batch.
+  virtual size_t SendDataBatch(
+      const cricket::SendDataParams& params,
+      rtc::ArrayView<const rtc::CopyOnWriteBuffer> payloads,
+      cricket::SendDataResult* result);
   // Connects to the transport signals.
   virtual bool ConnectDataChannel(DataChannel* data_channel) = 0;
   // Disconnects from the transport signals.
@@ -150,6 +160,9 @@ class DataChannel : public DataChannelInterface, public sigslot::has_slots<> {
   virtual uint32_t messages_received() const { return messages_received_; }
   virtual uint64_t bytes_received() const { return bytes_received_; }
   virtual bool Send(const DataBuffer& buffer);
+  // Hands |buffers| to the provider in batches while it takes them, and queues
+  // the rest like Send() does.
+  virtual bool SendBatch(rtc::ArrayView<const DataBuffer> buffers);
 
   // Close immediately, ignoring any queued data or closing procedure.
   // This is called for RTP data channels when SDP indicates a channel should
@@ -228,7 +241,9 @@ class DataChannel : public DataChannelInterface, public sigslot::has_slots<> {
     size_t byte_count() const { return byte_count_; }
 
     bool Empty() const;
+    size_t Size() const { return packets_.size(); }
 
+    const DataBuffer& Peek(size_t index) const { return *packets_[index]; }
     std::unique_ptr<DataBuffer> PopFront();
 
     void PushFront(std::unique_ptr<DataBuffer> packet);
@@ -260,7 +275,12 @@ class DataChannel : public DataChannelInterface, public sigslot::has_slots<> {
   void DeliverQueuedReceivedData();
 
   void SendQueuedDataMessages();
+  // Sends a batch of messages from the front of the queue. Returns false if
+  // not all of them could be sent.
+  bool SendQueuedDataBatch();
+  cricket::SendDataParams GetDataSendParams(bool binary) const;
   bool SendDataMessage(const DataBuffer& buffer, bool queue_if_blocked);
+  void OnDataMessageSent(size_t size);
   bool QueueSendDataMessage(const DataBuffer& buffer);
 
   void SendQueuedControlMessages();
@@ -320,6 +340,7 @@ PROXY_CONSTMETHOD0(uint64_t, bytes_received)
 PROXY_CONSTMETHOD0(uint64_t, buffered_amount)
 PROXY_METHOD0(void, Close)
 PROXY_METHOD1(bool, Send, const DataBuffer&)
+PROXY_METHOD1(bool, SendBatch, rtc::ArrayView<const DataBuffer>)
 END_PROXY_MAP()
 
 }  // namespace webrtc
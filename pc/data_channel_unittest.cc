@@ -17,6 +17,8 @@
 #include "pc/test/fake_data_channel_provider.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/numerics/safe_conversions.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
 #include "test/gtest.h"
 
 using webrtc::DataChannel;
@@ -271,6 +273,76 @@ TEST_F(SctpDataChannelTest, VerifyMessagesAndBytesSent) {
   EXPECT_EQ(bytes_sent, webrtc_data_channel_->bytes_sent());
 }
 
+// Tests that SendBatch() sends all buffers and updates the buffered amount
+// like Send() does.
+TEST_F(SctpDataChannelTest, SendBatch) {
+  AddObserver();
+  SetChannelReady();
+  std::vector<webrtc::DataBuffer> buffers(5, webrtc::DataBuffer("abcd"));
+  const int batch_count = provider_->send_data_batch_count();
+
+  EXPECT_TRUE(webrtc_data_channel_->SendBatch(buffers));
+  EXPECT_EQ(batch_count + 1, provider_->send_data_batch_count());
+  EXPECT_EQ(0U, webrtc_data_channel_->buffered_amount());
+  EXPECT_EQ(5U, webrtc_data_channel_->messages_sent());
+  EXPECT_EQ(20U, webrtc_data_channel_->bytes_sent());
+  EXPECT_EQ(5U, observer_->on_buffered_amount_change_count());
+}
+
+// Tests that the buffers passed to SendBatch() are queued while the channel is
+// blocked.
+TEST_F(SctpDataChannelTest, SendBatchWhenBlocked) {
+  AddObserver();
+  SetChannelReady();
+  std::vector<webrtc::DataBuffer> buffers(3, webrtc::DataBuffer("abcd"));
+  provider_->set_send_blocked(true);
+
+  EXPECT_TRUE(webrtc_data_channel_->SendBatch(buffers));
+  EXPECT_EQ(12U, webrtc_data_channel_->buffered_amount());
+  EXPECT_EQ(0U, webrtc_data_channel_->messages_sent());
+  EXPECT_EQ(0U, observer_->on_buffered_amount_change_count());
+
+  provider_->set_send_blocked(false);
+  EXPECT_EQ(0U, webrtc_data_channel_->buffered_amount());
+  EXPECT_EQ(3U, webrtc_data_channel_->messages_sent());
+  EXPECT_EQ(3U, observer_->on_buffered_amount_change_count());
+}
+
+// Tests that a batch larger than the send queue is sent while the channel isn't
+// blocked.
+TEST_F(SctpDataChannelTest, SendBatchLargerThanSendQueue) {
+  SetChannelReady();
+  // The buffers share a 1 MB payload.
+  rtc::CopyOnWriteBuffer payload(1024 * 1024);
+  memset(payload.data(), 0, payload.size());
+  std::vector<webrtc::DataBuffer> buffers(17, webrtc::DataBuffer(payload, true));
+
+  EXPECT_TRUE(webrtc_data_channel_->SendBatch(buffers));
+  EXPECT_EQ(webrtc::DataChannelInterface::kOpen, webrtc_data_channel_->state());
+  EXPECT_EQ(0U, webrtc_data_channel_->buffered_amount());
+  EXPECT_EQ(17U, webrtc_data_channel_->messages_sent());
+}
+
+// Tests that queued messages are handed to the provider in batches of the same
+// message type when the channel is unblocked.
+TEST_F(SctpDataChannelTest, QueuedDataSentInBatches) {
+  SetChannelReady();
+  provider_->set_send_blocked(true);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(webrtc_data_channel_->Send(webrtc::DataBuffer("text")));
+  }
+  rtc::CopyOnWriteBuffer payload(4);
+  memset(payload.data(), 0, payload.size());
+  EXPECT_TRUE(webrtc_data_channel_->Send(webrtc::DataBuffer(payload, true)));
+  const int batch_count = provider_->send_data_batch_count();
+
+  provider_->set_send_blocked(false);
+  EXPECT_EQ(batch_count + 2, provider_->send_data_batch_count());
+  EXPECT_EQ(0U, webrtc_data_channel_->buffered_amount());
+  EXPECT_EQ(11U, webrtc_data_channel_->messages_sent());
+  EXPECT_EQ(cricket::DMT_BINARY, provider_->last_send_data_params().type);
+}
+
 // Tests that the queued control message is sent when channel is ready.
 TEST_F(SctpDataChannelTest, OpenMessageSent) {
   // Initially the id is unassigned.
@@ -613,6 +685,114 @@ TEST_F(SctpDataChannelTest, TransportDestroyedWhileDataBuffered) {
                  webrtc_data_channel_->state(), kDefaultTimeout);
 }
 
+// Passes every send through a network thread, like PeerConnection does, to a
+// link that accepts a window of data before it blocks.
+class LinkSimulatingProvider : public FakeDataChannelProvider {
+ public:
+  static constexpr size_t kWindowBytes = 256 * 1024;
+
+  LinkSimulatingProvider() : network_thread_(rtc::Thread::Create()) {
+    network_thread_->Start();
+  }
+
+  bool SendData(const cricket::SendDataParams& params,
+                const rtc::CopyOnWriteBuffer& payload,
+                cricket::SendDataResult* result) override {
+    ++num_thread_hops_;
+    return network_thread_->Invoke<bool>(
+        RTC_FROM_HERE, [&] { return SendOnNetworkThread(payload, result); });
+  }
+
+  size_t SendDataBatch(const cricket::SendDataParams& params,
+                       rtc::ArrayView<const rtc::CopyOnWriteBuffer> payloads,
+                       cricket::SendDataResult* result) override {
+    ++num_thread_hops_;
+    return network_thread_->Invoke<size_t>(RTC_FROM_HERE, [&] {
+      size_t num_sent = 0;
+      for (const rtc::CopyOnWriteBuffer& payload : payloads) {
+        if (!SendOnNetworkThread(payload, result)) {
+          break;
+        }
+        ++num_sent;
+      }
+      return num_sent;
+    });
+  }
+
+  // Delivers the data in flight, which unblocks the data channels.
+  void DeliverWindow() {
+    bytes_in_flight_ = 0;
+    set_send_blocked(false);
+  }
+
+  int num_thread_hops() const { return num_thread_hops_; }
+
+ private:
+  bool SendOnNetworkThread(const rtc::CopyOnWriteBuffer& payload,
+                           cricket::SendDataResult* result) {
+    if (bytes_in_flight_ + payload.size() > kWindowBytes) {
+      *result = cricket::SDR_BLOCK;
+      return false;
+    }
+    bytes_in_flight_ += payload.size();
+    return true;
+  }
+
+  const std::unique_ptr<rtc::Thread> network_thread_;
+  size_t bytes_in_flight_ = 0;
+  int num_thread_hops_ = 0;
+};
+
+constexpr size_t LinkSimulatingProvider::kWindowBytes;
+
+// Measures the throughput of a bulk transfer that keeps the buffered amount
+// below the window of the link, with Send() and with SendBatch().
+TEST(SctpDataChannelBenchmark, DISABLED_Throughput) {
+  constexpr size_t kTransferBytes = 64 * 1024 * 1024;
+
+  for (size_t message_size : {1024, 16 * 1024}) {
+    for (size_t batch_size : {1, 64}) {
+      LinkSimulatingProvider provider;
+      provider.set_transport_available(true);
+      rtc::scoped_refptr<DataChannel> data_channel =
+          DataChannel::Create(&provider, cricket::DCT_SCTP, "bulk",
+                              webrtc::InternalDataChannelInit());
+      data_channel->OnTransportChannelCreated();
+      data_channel->SetSctpSid(0);
+      provider.set_ready_to_send(true);
+      ASSERT_EQ(webrtc::DataChannelInterface::kOpen, data_channel->state());
+
+      rtc::CopyOnWriteBuffer payload(message_size);
+      memset(payload.data(), 0, payload.size());
+      const std::vector<webrtc::DataBuffer> batch(
+          batch_size, webrtc::DataBuffer(payload, true));
+
+      const int64_t start_us = rtc::TimeMicros();
+      for (size_t sent = 0; sent < kTransferBytes;
+           sent += batch_size * message_size) {
+        while (data_channel->buffered_amount() >=
+               LinkSimulatingProvider::kWindowBytes) {
+          provider.DeliverWindow();
+        }
+        if (batch_size == 1) {
+          data_channel->Send(batch[0]);
+        } else {
+          data_channel->SendBatch(batch);
+        }
+      }
+      while (data_channel->buffered_amount() > 0) {
+        provider.DeliverWindow();
+      }
+      const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+      printf("%5d byte messages, batches of %2d: %6.0f MB/s, %d thread hops\n",
+             static_cast<int>(message_size), static_cast<int>(batch_size),
+             static_cast<double>(kTransferBytes) / elapsed_us,
+             provider.num_thread_hops());
+      data_channel->CloseAbruptly();
+    }
+  }
+}
+
 class SctpSidAllocatorTest : public ::testing::Test {
  protected:
   SctpSidAllocator allocator_;
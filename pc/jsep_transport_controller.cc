@@ -498,8 +498,10 @@ JsepTransportController::CreateDtlsTransport(
     dtls = config_.external_transport_factory->CreateDtlsTransport(
         ice, config_.crypto_options);
   } else {
-    dtls = absl::make_unique<cricket::DtlsTransport>(
+    auto dtls_transport = absl::make_unique<cricket::DtlsTransport>(
         ice, config_.crypto_options, config_.event_log);
+    dtls_transport->SetSessionCache(config_.dtls_session_cache);
+    dtls = std::move(dtls_transport);
   }
 
   RTC_DCHECK(dtls);
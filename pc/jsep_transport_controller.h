@@ -36,6 +36,7 @@
 #include "rtc_base/async_invoker.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/ref_counted_object.h"
+#include "rtc_base/ssl_stream_adapter.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 
 namespace rtc {
@@ -80,6 +81,9 @@ class JsepTransportController : public sigslot::has_slots<> {
     bool enable_external_auth = false;
     // Used to inject the ICE/DTLS transports created externally.
     cricket::TransportFactoryInterface* external_transport_factory = nullptr;
+    // If set, the DTLS transports resume the sessions of earlier connections
+    // between the same certificates from this cache.
+    rtc::scoped_refptr<rtc::SSLSessionCache> dtls_session_cache;
     Observer* transport_observer = nullptr;
     bool active_reset_srtp_params = false;
     RtcEventLog* event_log = nullptr;
@@ -0,0 +1,189 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "api/jsep_session_description.h"
+#include "pc/session_description.h"
+#include "pc/srtp_session.h"
+#include "pc/webrtc_sdp.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ssl_stream_adapter.h"
+#include "test/gtest.h"
+#include "test/testsupport/microbenchmark.h"
+
+namespace webrtc {
+namespace {
+
+// An offer of audio and video like the ones of Chrome.
+const char kOffer[] =
+    "v=0\r\n"
+    "o=- 5140125312316573427 2 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "a=msid-semantic: WMS stream\r\n"
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111 103 104 9 0 8 106 105 13 110 112 113 "
+    "126\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=candidate:1467250027 1 udp 2122260223 192.168.0.196 46243 typ host "
+    "generation 0\r\n"
+    "a=candidate:3350409123 1 udp 1686052607 203.0.113.7 46243 typ srflx "
+    "raddr 192.168.0.196 rport 46243 generation 0\r\n"
+    "a=ice-ufrag:7sFv\r\n"
+    "a=ice-pwd:dOTZKZNVlO9RSGsEGM63JXT2\r\n"
+    "a=ice-options:trickle\r\n"
+    "a=fingerprint:sha-256 "
+    "7B:8B:F0:65:5F:78:E2:51:3B:AC:6F:F3:3F:46:1B:35:DC:B8:5F:64:1A:24:C2:43:"
+    "F0:A1:58:D0:A1:2C:19:08\r\n"
+    "a=setup:actpass\r\n"
+    "a=mid:0\r\n"
+    "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+    "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "a=extmap:3 http://www.ietf.org/id/"
+    "draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=extmap:4 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+    "a=sendrecv\r\n"
+    "a=msid:stream audio\r\n"
+    "a=rtcp-mux\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=rtcp-fb:111 transport-cc\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:103 ISAC/16000\r\n"
+    "a=rtpmap:104 ISAC/32000\r\n"
+    "a=rtpmap:9 G722/8000\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=rtpmap:8 PCMA/8000\r\n"
+    "a=rtpmap:106 CN/32000\r\n"
+    "a=rtpmap:105 CN/16000\r\n"
+    "a=rtpmap:13 CN/8000\r\n"
+    "a=rtpmap:110 telephone-event/48000\r\n"
+    "a=rtpmap:112 telephone-event/32000\r\n"
+    "a=rtpmap:113 telephone-event/16000\r\n"
+    "a=rtpmap:126 telephone-event/8000\r\n"
+    "a=ssrc:1649781353 cname:kqAsL4tDlQ6ycq5A\r\n"
+    "a=ssrc:1649781353 msid:stream audio\r\n"
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101 102 122 127 121\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=ice-ufrag:7sFv\r\n"
+    "a=ice-pwd:dOTZKZNVlO9RSGsEGM63JXT2\r\n"
+    "a=ice-options:trickle\r\n"
+    "a=fingerprint:sha-256 "
+    "7B:8B:F0:65:5F:78:E2:51:3B:AC:6F:F3:3F:46:1B:35:DC:B8:5F:64:1A:24:C2:43:"
+    "F0:A1:58:D0:A1:2C:19:08\r\n"
+    "a=setup:actpass\r\n"
+    "a=mid:1\r\n"
+    "a=extmap:14 urn:ietf:params:rtp-hdrext:toffset\r\n"
+    "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "a=extmap:13 urn:3gpp:video-orientation\r\n"
+    "a=extmap:3 http://www.ietf.org/id/"
+    "draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=extmap:12 http://www.webrtc.org/experiments/rtp-hdrext/playout-delay\r\n"
+    "a=extmap:4 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+    "a=sendrecv\r\n"
+    "a=msid:stream video\r\n"
+    "a=rtcp-mux\r\n"
+    "a=rtcp-rsize\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtcp-fb:96 goog-remb\r\n"
+    "a=rtcp-fb:96 transport-cc\r\n"
+    "a=rtcp-fb:96 ccm fir\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=rtcp-fb:96 nack pli\r\n"
+    "a=rtpmap:97 rtx/90000\r\n"
+    "a=fmtp:97 apt=96\r\n"
+    "a=rtpmap:98 VP9/90000\r\n"
+    "a=rtcp-fb:98 goog-remb\r\n"
+    "a=rtcp-fb:98 transport-cc\r\n"
+    "a=rtcp-fb:98 ccm fir\r\n"
+    "a=rtcp-fb:98 nack\r\n"
+    "a=rtcp-fb:98 nack pli\r\n"
+    "a=fmtp:98 profile-id=0\r\n"
+    "a=rtpmap:99 rtx/90000\r\n"
+    "a=fmtp:99 apt=98\r\n"
+    "a=rtpmap:100 H264/90000\r\n"
+    "a=rtcp-fb:100 goog-remb\r\n"
+    "a=rtcp-fb:100 transport-cc\r\n"
+    "a=rtcp-fb:100 ccm fir\r\n"
+    "a=rtcp-fb:100 nack\r\n"
+    "a=rtcp-fb:100 nack pli\r\n"
+    "a=fmtp:100 level-asymmetry-allowed=1;packetization-mode=1;"
+    "profile-level-id=42e01f\r\n"
+    "a=rtpmap:101 rtx/90000\r\n"
+    "a=fmtp:101 apt=100\r\n"
+    "a=rtpmap:102 red/90000\r\n"
+    "a=rtpmap:122 rtx/90000\r\n"
+    "a=fmtp:122 apt=102\r\n"
+    "a=rtpmap:127 ulpfec/90000\r\n"
+    "a=rtpmap:121 flexfec-03/90000\r\n"
+    "a=ssrc-group:FID 2231627014 632943048\r\n"
+    "a=ssrc:2231627014 cname:kqAsL4tDlQ6ycq5A\r\n"
+    "a=ssrc:2231627014 msid:stream video\r\n"
+    "a=ssrc:632943048 cname:kqAsL4tDlQ6ycq5A\r\n"
+    "a=ssrc:632943048 msid:stream video\r\n";
+
+// Protects video packets of 1100 bytes of payload with |crypto_suite|.
+void RunSrtpProtectBenchmark(const std::string& name, int crypto_suite) {
+  constexpr size_t kHeaderSize = 12;
+  constexpr size_t kPayloadSize = 1100;
+  int key_length;
+  int salt_length;
+  ASSERT_TRUE(
+      rtc::GetSrtpKeyAndSaltLengths(crypto_suite, &key_length, &salt_length));
+  std::vector<uint8_t> key(key_length + salt_length, 0x5a);
+  cricket::SrtpSession session;
+  ASSERT_TRUE(session.SetSend(crypto_suite, key.data(), key.size(),
+                              std::vector<int>()));
+
+  // Leaves room for the authentication tag.
+  std::vector<uint8_t> packet(kHeaderSize + kPayloadSize + 32);
+  uint16_t sequence_number = 0;
+  int protected_size = 0;
+  test::RunMicrobenchmark(name, [&] {
+    // The packet is encrypted in place, so it is written again.
+    packet[0] = 0x80;
+    packet[1] = 96;
+    rtc::SetBE16(&packet[2], ++sequence_number);
+    rtc::SetBE32(&packet[4], sequence_number * 3000u);
+    rtc::SetBE32(&packet[8], 0x12345678);
+    memset(&packet[kHeaderSize], 0x55, kPayloadSize);
+    RTC_CHECK(session.ProtectRtp(packet.data(), kHeaderSize + kPayloadSize,
+                                 packet.size(), &protected_size));
+  });
+  EXPECT_GT(protected_size, static_cast<int>(kHeaderSize + kPayloadSize));
+}
+
+}  // namespace
+
+TEST(PcMicrobenchmark, SrtpProtectAesCm) {
+  RunSrtpProtectBenchmark("SrtpProtectAesCm", rtc::SRTP_AES128_CM_SHA1_80);
+}
+
+TEST(PcMicrobenchmark, SrtpProtectAesGcm) {
+  RunSrtpProtectBenchmark("SrtpProtectAesGcm", rtc::SRTP_AEAD_AES_128_GCM);
+}
+
+TEST(PcMicrobenchmark, SdpParse) {
+  const std::string offer = kOffer;
+  size_t num_contents = 0;
+  test::RunMicrobenchmark("SdpParse", [&] {
+    JsepSessionDescription description(SdpType::kOffer);
+    SdpParseError error;
+    RTC_CHECK(SdpDeserialize(offer, &description, &error)) << error.line;
+    num_contents = description.description()->contents().size();
+  });
+  EXPECT_EQ(num_contents, 2u);
+}
+
+}  // namespace webrtc
@@ -1022,6 +1022,9 @@ bool PeerConnection::Initialize(
                               : options.crypto_options;
   config.transport_observer = this;
   config.event_log = event_log_ptr_;
+  if (config.crypto_options.dtls.enable_session_resumption) {
+    config.dtls_session_cache = factory_->dtls_session_cache();
+  }
 #if defined(ENABLE_EXTERNAL_AUTH)
   config.enable_external_auth = true;
 #endif
@@ -5830,6 +5833,29 @@ bool PeerConnection::SendData(const cricket::SendDataParams& params,
                         cricket_sctp_transport(), params, payload, result));
 }
 
+size_t PeerConnection::SendDataBatch(
+    const cricket::SendDataParams& params,
+    rtc::ArrayView<const rtc::CopyOnWriteBuffer> payloads,
+    cricket::SendDataResult* result) {
+  RTC_DCHECK_RUN_ON(signaling_thread());
+  if (media_transport_ || rtp_data_channel_ || !sctp_transport_) {
+    return DataChannelProviderInterface::SendDataBatch(params, payloads,
+                                                       result);
+  }
+  // Switch to the network thread once for the whole batch.
+  cricket::SctpTransportInternal* transport = cricket_sctp_transport();
+  return network_thread()->Invoke<size_t>(RTC_FROM_HERE, [&] {
+    size_t num_sent = 0;
+    for (const rtc::CopyOnWriteBuffer& payload : payloads) {
+      if (!transport->SendData(params, payload, result)) {
+        break;
+      }
+      ++num_sent;
+    }
+    return num_sent;
+  });
+}
+
 bool PeerConnection::ConnectDataChannel(DataChannel* webrtc_data_channel) {
   RTC_DCHECK_RUN_ON(signaling_thread());
   if (!rtp_data_channel_ && !sctp_transport_ && !media_transport_) {
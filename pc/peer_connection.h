@@ -839,6 +839,9 @@ class PeerConnection : public PeerConnectionInternal,
   bool SendData(const cricket::SendDataParams& params,
                 const rtc::CopyOnWriteBuffer& payload,
                 cricket::SendDataResult* result) override;
+  size_t SendDataBatch(const cricket::SendDataParams& params,
+                       rtc::ArrayView<const rtc::CopyOnWriteBuffer> payloads,
+                       cricket::SendDataResult* result) override;
   bool ConnectDataChannel(DataChannel* webrtc_data_channel) override;
   void DisconnectDataChannel(DataChannel* webrtc_data_channel) override;
   void AddSctpDataStream(int sid) override;
@@ -154,6 +154,23 @@ SdpContentPredicate HaveSdesGcmCryptos(size_t num_crypto_suites) {
   };
 }
 
+SdpContentPredicate HaveSdesCipherSuites(
+    const std::vector<std::string>& cipher_suites) {
+  return [cipher_suites](const cricket::ContentInfo* content,
+                         const cricket::TransportInfo* transport) {
+    const auto& cryptos = content->media_description()->cryptos();
+    if (cryptos.size() != cipher_suites.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < cryptos.size(); ++i) {
+      if (cryptos[i].cipher_suite != cipher_suites[i]) {
+        return false;
+      }
+    }
+    return true;
+  };
+}
+
 class PeerConnectionCryptoTest
     : public PeerConnectionCryptoBaseTest,
       public ::testing::WithParamInterface<SdpSemantics> {
@@ -239,6 +256,23 @@ TEST_P(PeerConnectionCryptoTest, CorrectCryptoInAnswerWhenDtlsDisabled) {
                              answer->description()));
 }
 
+// The default factory options enable the GCM cipher suites, so an SDES offer
+// made with them lists the GCM cryptos ahead of AES_CM_128_HMAC_SHA1_80.
+TEST_P(PeerConnectionCryptoTest, DefaultSdesOfferCryptos) {
+  RTCConfiguration config;
+  config.enable_dtls_srtp.emplace(false);
+  auto caller = CreatePeerConnectionWithAudioVideo(config);
+
+  auto offer = caller->CreateOffer();
+  ASSERT_TRUE(offer);
+
+  ASSERT_FALSE(offer->description()->contents().empty());
+  EXPECT_TRUE(SdpContentsAll(
+      HaveSdesCipherSuites({"AEAD_AES_256_GCM", "AEAD_AES_128_GCM",
+                            "AES_CM_128_HMAC_SHA1_80"}),
+      offer->description()));
+}
+
 // When encryption is disabled, the SDP offer/answer should have neither a DTLS
 // fingerprint nor any SDES crypto options.
 TEST_P(PeerConnectionCryptoTest, CorrectCryptoInOfferWhenEncryptionDisabled) {
@@ -77,7 +77,8 @@ PeerConnectionFactory::PeerConnectionFactory(
       injected_network_controller_factory_(
           std::move(dependencies.network_controller_factory)),
       media_transport_factory_(
-          std::move(dependencies.media_transport_factory)) {
+          std::move(dependencies.media_transport_factory)),
+      crypto_worker_pool_(std::move(dependencies.crypto_worker_pool)) {
   if (!network_thread_) {
     owned_network_thread_ = rtc::Thread::CreateWithSocketServer();
     owned_network_thread_->SetName("pc_network_thread", nullptr);
@@ -252,9 +253,15 @@ PeerConnectionFactory::CreatePeerConnection(
 
   // Set internal defaults if optional dependencies are not set.
   if (!dependencies.cert_generator) {
-    dependencies.cert_generator =
-        absl::make_unique<rtc::RTCCertificateGenerator>(signaling_thread_,
-                                                        network_thread_);
+    if (crypto_worker_pool_) {
+      dependencies.cert_generator =
+          absl::make_unique<rtc::RTCCertificateGenerator>(signaling_thread_,
+                                                          crypto_worker_pool_);
+    } else {
+      dependencies.cert_generator =
+          absl::make_unique<rtc::RTCCertificateGenerator>(signaling_thread_,
+                                                          network_thread_);
+    }
   }
   if (!dependencies.allocator) {
     network_thread_->Invoke<void>(RTC_FROM_HERE, [this, &configuration,
@@ -293,6 +300,15 @@ PeerConnectionFactory::CreatePeerConnection(
   return PeerConnectionProxy::Create(signaling_thread(), pc);
 }
 
+rtc::scoped_refptr<rtc::SSLSessionCache>
+PeerConnectionFactory::dtls_session_cache() {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  if (!dtls_session_cache_) {
+    dtls_session_cache_ = rtc::SSLSessionCache::Create();
+  }
+  return dtls_session_cache_;
+}
+
 rtc::scoped_refptr<MediaStreamInterface>
 PeerConnectionFactory::CreateLocalMediaStream(const std::string& stream_id) {
   RTC_DCHECK(signaling_thread_->IsCurrent());
@@ -21,7 +21,9 @@
 #include "api/scoped_refptr.h"
 #include "media/sctp/sctp_transport_internal.h"
 #include "pc/channel_manager.h"
+#include "rtc_base/crypto_worker_pool.h"
 #include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/ssl_stream_adapter.h"
 #include "rtc_base/thread.h"
 
 namespace rtc {
@@ -92,6 +94,12 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
     return media_transport_factory_.get();
   }
 
+  // The DTLS sessions of the PeerConnections that enable
+  // CryptoOptions::Dtls::enable_session_resumption, which are resumed when a
+  // PeerConnection connects the same certificates again. Created on first use,
+  // on the signaling thread.
+  rtc::scoped_refptr<rtc::SSLSessionCache> dtls_session_cache();
+
  protected:
   // This structure allows simple management of all new dependencies being added
   // to the PeerConnectionFactory.
@@ -128,6 +136,9 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
   std::unique_ptr<NetworkControllerFactoryInterface>
       injected_network_controller_factory_;
   std::unique_ptr<MediaTransportFactory> media_transport_factory_;
+  // Set by PeerConnectionFactoryDependencies::crypto_worker_pool.
+  const rtc::scoped_refptr<rtc::CryptoWorkerPool> crypto_worker_pool_;
+  rtc::scoped_refptr<rtc::SSLSessionCache> dtls_session_cache_;
 };
 
 }  // namespace webrtc
@@ -104,8 +104,8 @@ static const char kDataChannelLabel[] = "data_channel";
 
 // SRTP cipher name negotiated by the tests. This must be updated if the
 // default changes.
-static const int kDefaultSrtpCryptoSuite = rtc::SRTP_AES128_CM_SHA1_80;
-static const int kDefaultSrtpCryptoSuiteGcm = rtc::SRTP_AEAD_AES_256_GCM;
+static const int kDefaultSrtpCryptoSuite = rtc::SRTP_AEAD_AES_256_GCM;
+static const int kDefaultSrtpCryptoSuiteNonGcm = rtc::SRTP_AES128_CM_SHA1_80;
 
 static const SocketAddress kDefaultLocalAddress("192.168.1.1", 0);
 
@@ -3017,11 +3017,14 @@ TEST_P(PeerConnectionIntegrationTest, CallerDtls10ToCalleeDtls12) {
 
 // The three tests below verify that "enable_aes128_sha1_32_crypto_cipher"
 // works as expected; the cipher should only be used if enabled by both sides.
+// GCM is disabled, since it would be preferred otherwise.
 TEST_P(PeerConnectionIntegrationTest,
        Aes128Sha1_32_CipherNotUsedWhenOnlyCallerSupported) {
   PeerConnectionFactory::Options caller_options;
+  caller_options.crypto_options = CryptoOptions::NoGcm();
   caller_options.crypto_options.srtp.enable_aes128_sha1_32_crypto_cipher = true;
   PeerConnectionFactory::Options callee_options;
+  callee_options.crypto_options = CryptoOptions::NoGcm();
   callee_options.crypto_options.srtp.enable_aes128_sha1_32_crypto_cipher =
       false;
   int expected_cipher_suite = rtc::SRTP_AES128_CM_SHA1_80;
@@ -3032,9 +3035,11 @@ TEST_P(PeerConnectionIntegrationTest,
 TEST_P(PeerConnectionIntegrationTest,
        Aes128Sha1_32_CipherNotUsedWhenOnlyCalleeSupported) {
   PeerConnectionFactory::Options caller_options;
+  caller_options.crypto_options = CryptoOptions::NoGcm();
   caller_options.crypto_options.srtp.enable_aes128_sha1_32_crypto_cipher =
       false;
   PeerConnectionFactory::Options callee_options;
+  callee_options.crypto_options = CryptoOptions::NoGcm();
   callee_options.crypto_options.srtp.enable_aes128_sha1_32_crypto_cipher = true;
   int expected_cipher_suite = rtc::SRTP_AES128_CM_SHA1_80;
   TestNegotiatedCipherSuite(caller_options, callee_options,
@@ -3043,8 +3048,10 @@ TEST_P(PeerConnectionIntegrationTest,
 
 TEST_P(PeerConnectionIntegrationTest, Aes128Sha1_32_CipherUsedWhenSupported) {
   PeerConnectionFactory::Options caller_options;
+  caller_options.crypto_options = CryptoOptions::NoGcm();
   caller_options.crypto_options.srtp.enable_aes128_sha1_32_crypto_cipher = true;
   PeerConnectionFactory::Options callee_options;
+  callee_options.crypto_options = CryptoOptions::NoGcm();
   callee_options.crypto_options.srtp.enable_aes128_sha1_32_crypto_cipher = true;
   int expected_cipher_suite = rtc::SRTP_AES128_CM_SHA1_32;
   TestNegotiatedCipherSuite(caller_options, callee_options,
@@ -3055,7 +3062,7 @@ TEST_P(PeerConnectionIntegrationTest, Aes128Sha1_32_CipherUsedWhenSupported) {
 TEST_P(PeerConnectionIntegrationTest, NonGcmCipherUsedWhenGcmNotSupported) {
   bool local_gcm_enabled = false;
   bool remote_gcm_enabled = false;
-  int expected_cipher_suite = kDefaultSrtpCryptoSuite;
+  int expected_cipher_suite = kDefaultSrtpCryptoSuiteNonGcm;
   TestGcmNegotiationUsesCipherSuite(local_gcm_enabled, remote_gcm_enabled,
                                     expected_cipher_suite);
 }
@@ -3064,7 +3071,7 @@ TEST_P(PeerConnectionIntegrationTest, NonGcmCipherUsedWhenGcmNotSupported) {
 TEST_P(PeerConnectionIntegrationTest, GcmCipherUsedWhenGcmSupported) {
   bool local_gcm_enabled = true;
   bool remote_gcm_enabled = true;
-  int expected_cipher_suite = kDefaultSrtpCryptoSuiteGcm;
+  int expected_cipher_suite = kDefaultSrtpCryptoSuite;
   TestGcmNegotiationUsesCipherSuite(local_gcm_enabled, remote_gcm_enabled,
                                     expected_cipher_suite);
 }
@@ -3074,7 +3081,7 @@ TEST_P(PeerConnectionIntegrationTest,
        NonGcmCipherUsedWhenOnlyCallerSupportsGcm) {
   bool local_gcm_enabled = true;
   bool remote_gcm_enabled = false;
-  int expected_cipher_suite = kDefaultSrtpCryptoSuite;
+  int expected_cipher_suite = kDefaultSrtpCryptoSuiteNonGcm;
   TestGcmNegotiationUsesCipherSuite(local_gcm_enabled, remote_gcm_enabled,
                                     expected_cipher_suite);
 }
@@ -3084,7 +3091,7 @@ TEST_P(PeerConnectionIntegrationTest,
        NonGcmCipherUsedWhenOnlyCalleeSupportsGcm) {
   bool local_gcm_enabled = false;
   bool remote_gcm_enabled = true;
-  int expected_cipher_suite = kDefaultSrtpCryptoSuite;
+  int expected_cipher_suite = kDefaultSrtpCryptoSuiteNonGcm;
   TestGcmNegotiationUsesCipherSuite(local_gcm_enabled, remote_gcm_enabled,
                                     expected_cipher_suite);
 }
@@ -10,13 +10,16 @@
 
 #include "pc/srtp_session.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <string>
+#include <vector>
 
 #include "media/base/fake_rtp.h"
 #include "pc/test/srtp_test_util.h"
 #include "rtc_base/byte_order.h"
 #include "rtc_base/ssl_stream_adapter.h"  // For rtc::SRTP_*
+#include "rtc_base/time_utils.h"
 #include "system_wrappers/include/metrics.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
@@ -70,8 +73,9 @@ class SrtpSessionTest : public ::testing::Test {
   }
   cricket::SrtpSession s1_;
   cricket::SrtpSession s2_;
-  char rtp_packet_[sizeof(kPcmuFrame) + 10];
-  char rtcp_packet_[sizeof(kRtcpReport) + 4 + 10];
+  // Large enough for the 16 byte authentication tag of the GCM suites.
+  char rtp_packet_[sizeof(kPcmuFrame) + 16];
+  char rtcp_packet_[sizeof(kRtcpReport) + 4 + 16];
   int rtp_len_;
   int rtcp_len_;
 };
@@ -128,6 +132,30 @@ TEST_F(SrtpSessionTest, TestProtect_AES_CM_128_HMAC_SHA1_32) {
   TestUnprotectRtcp(CS_AES_CM_128_HMAC_SHA1_32);
 }
 
+// Test that we can encrypt and decrypt RTP/RTCP using AEAD_AES_128_GCM.
+TEST_F(SrtpSessionTest, TestProtect_AEAD_AES_128_GCM) {
+  EXPECT_TRUE(s1_.SetSend(SRTP_AEAD_AES_128_GCM, kTestKeyGcm128_1,
+                          kTestKeyGcm128Len, kEncryptedHeaderExtensionIds));
+  EXPECT_TRUE(s2_.SetRecv(SRTP_AEAD_AES_128_GCM, kTestKeyGcm128_1,
+                          kTestKeyGcm128Len, kEncryptedHeaderExtensionIds));
+  TestProtectRtp(CS_AEAD_AES_128_GCM);
+  TestProtectRtcp(CS_AEAD_AES_128_GCM);
+  TestUnprotectRtp(CS_AEAD_AES_128_GCM);
+  TestUnprotectRtcp(CS_AEAD_AES_128_GCM);
+}
+
+// Test that we can encrypt and decrypt RTP/RTCP using AEAD_AES_256_GCM.
+TEST_F(SrtpSessionTest, TestProtect_AEAD_AES_256_GCM) {
+  EXPECT_TRUE(s1_.SetSend(SRTP_AEAD_AES_256_GCM, kTestKeyGcm256_1,
+                          kTestKeyGcm256Len, kEncryptedHeaderExtensionIds));
+  EXPECT_TRUE(s2_.SetRecv(SRTP_AEAD_AES_256_GCM, kTestKeyGcm256_1,
+                          kTestKeyGcm256Len, kEncryptedHeaderExtensionIds));
+  TestProtectRtp(CS_AEAD_AES_256_GCM);
+  TestProtectRtcp(CS_AEAD_AES_256_GCM);
+  TestUnprotectRtp(CS_AEAD_AES_256_GCM);
+  TestUnprotectRtcp(CS_AEAD_AES_256_GCM);
+}
+
 TEST_F(SrtpSessionTest, TestGetSendStreamPacketIndex) {
   EXPECT_TRUE(s1_.SetSend(SRTP_AES128_CM_SHA1_32, kTestKey1, kTestKeyLen,
                           kEncryptedHeaderExtensionIds));
@@ -246,4 +274,73 @@ TEST_F(SrtpSessionTest, TestReplay) {
       s1_.ProtectRtp(rtp_packet_, rtp_len_, sizeof(rtp_packet_), &out_len));
 }
 
+// Reports how many RTP packets one core protects and unprotects per second
+// with each crypto suite, for the typical sizes of audio and video packets.
+TEST_F(SrtpSessionTest, DISABLED_ProtectRtpBenchmark) {
+  constexpr int kNumBatches = 100;
+  constexpr int kBatchSize = 1000;
+  constexpr int kRtpHeaderLen = 12;
+  constexpr int kMaxTagLen = 16;
+  struct Suite {
+    const char* name;
+    int crypto_suite;
+    const uint8_t* key;
+    int key_len;
+  };
+  const Suite kSuites[] = {
+      {CS_AES_CM_128_HMAC_SHA1_80, SRTP_AES128_CM_SHA1_80, kTestKey1,
+       kTestKeyLen},
+      {CS_AES_CM_128_HMAC_SHA1_32, SRTP_AES128_CM_SHA1_32, kTestKey1,
+       kTestKeyLen},
+      {CS_AEAD_AES_128_GCM, SRTP_AEAD_AES_128_GCM, kTestKeyGcm128_1,
+       kTestKeyGcm128Len},
+      {CS_AEAD_AES_256_GCM, SRTP_AEAD_AES_256_GCM, kTestKeyGcm256_1,
+       kTestKeyGcm256Len},
+  };
+
+  for (const Suite& suite : kSuites) {
+    // Opus at 32 kbps, and a full video packet.
+    for (int payload_len : {80, 1200}) {
+      cricket::SrtpSession sender;
+      cricket::SrtpSession receiver;
+      ASSERT_TRUE(sender.SetSend(suite.crypto_suite, suite.key, suite.key_len,
+                                 kEncryptedHeaderExtensionIds));
+      ASSERT_TRUE(receiver.SetRecv(suite.crypto_suite, suite.key,
+                                   suite.key_len,
+                                   kEncryptedHeaderExtensionIds));
+      const int rtp_len = kRtpHeaderLen + payload_len;
+      const int max_len = rtp_len + kMaxTagLen;
+      std::vector<char> packets(kBatchSize * max_len);
+      std::vector<int> lengths(kBatchSize);
+      int64_t protect_us = 0;
+      int64_t unprotect_us = 0;
+      uint16_t seq_num = 0;
+      for (int batch = 0; batch < kNumBatches; ++batch) {
+        for (int i = 0; i < kBatchSize; ++i) {
+          char* packet = &packets[i * max_len];
+          memcpy(packet, kPcmuFrame, kRtpHeaderLen);
+          SetBE16(packet + 2, seq_num++);
+          memset(packet + kRtpHeaderLen, i, payload_len);
+        }
+        int64_t start_us = TimeMicros();
+        for (int i = 0; i < kBatchSize; ++i) {
+          ASSERT_TRUE(sender.ProtectRtp(&packets[i * max_len], rtp_len,
+                                        max_len, &lengths[i]));
+        }
+        protect_us += TimeMicros() - start_us;
+        start_us = TimeMicros();
+        for (int i = 0; i < kBatchSize; ++i) {
+          ASSERT_TRUE(receiver.UnprotectRtp(&packets[i * max_len], lengths[i],
+                                            &lengths[i]));
+        }
+        unprotect_us += TimeMicros() - start_us;
+      }
+      constexpr double kNumPackets = kNumBatches * kBatchSize;
+      printf("%s, %d bytes: protect %.0f packets/s, unprotect %.0f packets/s\n",
+             suite.name, rtp_len, kNumPackets * 1e6 / protect_us,
+             kNumPackets * 1e6 / unprotect_us);
+    }
+  }
+}
+
 }  // namespace rtc
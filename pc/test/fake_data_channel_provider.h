@@ -44,6 +44,14 @@ class FakeDataChannelProvider : public webrtc::DataChannelProviderInterface {
     return true;
   }
 
+  size_t SendDataBatch(const cricket::SendDataParams& params,
+                       rtc::ArrayView<const rtc::CopyOnWriteBuffer> payloads,
+                       cricket::SendDataResult* result) override {
+    ++send_data_batch_count_;
+    return DataChannelProviderInterface::SendDataBatch(params, payloads,
+                                                       result);
+  }
+
   bool ConnectDataChannel(webrtc::DataChannel* data_channel) override {
     RTC_CHECK(connected_channels_.find(data_channel) ==
               connected_channels_.end());
@@ -130,6 +138,8 @@ class FakeDataChannelProvider : public webrtc::DataChannelProviderInterface {
     return last_send_data_params_;
   }
 
+  int send_data_batch_count() const { return send_data_batch_count_; }
+
   bool IsConnected(webrtc::DataChannel* data_channel) const {
     return connected_channels_.find(data_channel) != connected_channels_.end();
   }
@@ -148,6 +158,7 @@ class FakeDataChannelProvider : public webrtc::DataChannelProviderInterface {
   bool transport_available_;
   bool ready_to_send_;
   bool transport_error_;
+  int send_data_batch_count_ = 0;
   std::set<webrtc::DataChannel*> connected_channels_;
   std::set<uint32_t> send_ssrcs_;
   std::set<uint32_t> recv_ssrcs_;
@@ -97,20 +97,21 @@ class AsyncPacketSocket : public sigslot::has_slots<> {
 
   // Emitted each time a packet is read. Used only for UDP and
   // connected TCP sockets.
-  sigslot::signal5<AsyncPacketSocket*,
-                   const char*,
-                   size_t,
-                   const SocketAddress&,
-                   // TODO(bugs.webrtc.org/9584): Change to passing the int64_t
-                   // timestamp by value.
-                   const int64_t&>
+  sigslot::single_threaded_signal<AsyncPacketSocket*,
+                                  const char*,
+                                  size_t,
+                                  const SocketAddress&,
+                                  // TODO(bugs.webrtc.org/9584): Change to
+                                  // passing the int64_t timestamp by value.
+                                  const int64_t&>
       SignalReadPacket;
 
   // Emitted each time a packet is sent.
-  sigslot::signal2<AsyncPacketSocket*, const SentPacket&> SignalSentPacket;
+  sigslot::single_threaded_signal<AsyncPacketSocket*, const SentPacket&>
+      SignalSentPacket;
 
   // Emitted when the socket is currently able to send.
-  sigslot::signal1<AsyncPacketSocket*> SignalReadyToSend;
+  sigslot::single_threaded_signal<AsyncPacketSocket*> SignalReadyToSend;
 
   // Emitted after address for the socket is allocated, i.e. binding
   // is finished. State of the socket is changed from BINDING to BOUND
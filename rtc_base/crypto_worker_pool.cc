@@ -0,0 +1,171 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/crypto_worker_pool.h"
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/ref_counted_object.h"
+
+namespace rtc {
+
+namespace {
+
+bool SameKeyParams(const KeyParams& a, const KeyParams& b) {
+  if (a.type() != b.type()) {
+    return false;
+  }
+  if (a.type() == KT_RSA) {
+    return a.rsa_params().mod_size == b.rsa_params().mod_size &&
+           a.rsa_params().pub_exp == b.rsa_params().pub_exp;
+  }
+  return a.ec_curve() == b.ec_curve();
+}
+
+void PostResult(Thread* reply_thread,
+                const scoped_refptr<RTCCertificateGeneratorCallback>& callback,
+                const scoped_refptr<RTCCertificate>& certificate) {
+  reply_thread->PostTask(RTC_FROM_HERE, [callback, certificate] {
+    if (certificate) {
+      callback->OnSuccess(certificate);
+    } else {
+      callback->OnFailure();
+    }
+  });
+}
+
+}  // namespace
+
+// static
+scoped_refptr<CryptoWorkerPool> CryptoWorkerPool::Create(const Config& config) {
+  return new RefCountedObject<CryptoWorkerPool>(config);
+}
+
+CryptoWorkerPool::CryptoWorkerPool(const Config& config)
+    : certificate_cache_size_(config.certificate_cache_size) {
+  RTC_DCHECK_GT(config.num_worker_threads, 0);
+  for (int i = 0; i < config.num_worker_threads; ++i) {
+    std::unique_ptr<Thread> worker = Thread::Create();
+    worker->SetName("CryptoWorker", this);
+    RTC_CHECK(worker->Start());
+    workers_.push_back(std::move(worker));
+  }
+
+  CritScope cs(&crit_);
+  if (certificate_cache_size_ == 0) {
+    return;
+  }
+  for (const KeyParams& key_params : config.cached_key_params) {
+    RTC_DCHECK(key_params.IsValid());
+    cache_.emplace_back();
+    cache_.back().key_params = key_params;
+  }
+  // Only fill the cache once all entries exist, since the refills refer to
+  // them.
+  for (CachedCertificates& cached : cache_) {
+    MaybeStartRefill(&cached);
+  }
+}
+
+CryptoWorkerPool::~CryptoWorkerPool() {
+  for (const std::unique_ptr<Thread>& worker : workers_) {
+    RTC_DCHECK(!worker->IsCurrent());
+    worker->Stop();
+  }
+}
+
+void CryptoWorkerPool::GenerateCertificateAsync(
+    const KeyParams& key_params,
+    const absl::optional<uint64_t>& expires_ms,
+    Thread* reply_thread,
+    const scoped_refptr<RTCCertificateGeneratorCallback>& callback) {
+  RTC_DCHECK(reply_thread);
+  RTC_DCHECK(callback);
+
+  if (!expires_ms) {
+    scoped_refptr<RTCCertificate> certificate;
+    {
+      CritScope cs(&crit_);
+      CachedCertificates* cached = FindCachedCertificates(key_params);
+      if (cached) {
+        if (cached->certificates.empty()) {
+          ++stats_.certificate_cache_misses;
+        } else {
+          ++stats_.certificate_cache_hits;
+          certificate = std::move(cached->certificates.back());
+          cached->certificates.pop_back();
+        }
+        MaybeStartRefill(cached);
+      }
+    }
+    if (certificate) {
+      PostResult(reply_thread, callback, certificate);
+      return;
+    }
+  }
+
+  const KeyParams params = key_params;
+  const absl::optional<uint64_t> expires = expires_ms;
+  PostTask(RTC_FROM_HERE, [params, expires, reply_thread, callback] {
+    PostResult(reply_thread, callback,
+               RTCCertificateGenerator::GenerateCertificate(params, expires));
+  });
+}
+
+CryptoWorkerPool::Stats CryptoWorkerPool::GetStats() const {
+  CritScope cs(&crit_);
+  return stats_;
+}
+
+Thread* CryptoWorkerPool::NextWorker() {
+  return workers_[next_worker_++ % workers_.size()].get();
+}
+
+CryptoWorkerPool::CachedCertificates* CryptoWorkerPool::FindCachedCertificates(
+    const KeyParams& key_params) {
+  for (CachedCertificates& cached : cache_) {
+    if (SameKeyParams(cached.key_params, key_params)) {
+      return &cached;
+    }
+  }
+  return nullptr;
+}
+
+void CryptoWorkerPool::MaybeStartRefill(CachedCertificates* cached) {
+  if (cached->refilling ||
+      cached->certificates.size() >= certificate_cache_size_) {
+    return;
+  }
+  cached->refilling = true;
+  // The workers are stopped before |this| is destroyed.
+  const KeyParams key_params = cached->key_params;
+  PostTask(RTC_FROM_HERE, [this, key_params] { Refill(key_params); });
+}
+
+void CryptoWorkerPool::Refill(const KeyParams& key_params) {
+  // Generates one certificate at a time, so that requests that missed the
+  // cache don't wait for the whole refill.
+  scoped_refptr<RTCCertificate> certificate =
+      RTCCertificateGenerator::GenerateCertificate(key_params, absl::nullopt);
+
+  CritScope cs(&crit_);
+  CachedCertificates* cached = FindCachedCertificates(key_params);
+  RTC_DCHECK(cached);
+  cached->refilling = false;
+  if (!certificate) {
+    RTC_LOG(LS_ERROR) << "Failed to generate a certificate for the cache.";
+    return;
+  }
+  cached->certificates.push_back(std::move(certificate));
+  ++stats_.pregenerated_certificates;
+  MaybeStartRefill(cached);
+}
+
+}  // namespace rtc
@@ -0,0 +1,124 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_CRYPTO_WORKER_POOL_H_
+#define RTC_BASE_CRYPTO_WORKER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/scoped_refptr.h"
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/location.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/rtc_certificate.h"
+#include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/ssl_identity.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// A pool of threads for the expensive public key operations of call setup,
+// such as generating certificates. When hundreds of calls are set up at once,
+// running these on the signaling and network threads would stall the other
+// calls on those threads.
+//
+// The pool also keeps a few certificates of each of
+// |Config::cached_key_params| generated ahead of time. A request for one of
+// them with the default expiration is served from this cache, which is then
+// refilled in the background.
+//
+// All methods are thread safe. The pool is reference counted so that it can be
+// shared by the certificate generators of a PeerConnectionFactory (see
+// PeerConnectionFactoryDependencies::crypto_worker_pool); it must not be
+// released last on a worker thread.
+class CryptoWorkerPool : public RefCountInterface {
+ public:
+  struct Config {
+    int num_worker_threads = 2;
+    // Key types of which certificates are generated ahead of time.
+    std::vector<KeyParams> cached_key_params = {KeyParams()};
+    // Number of certificates kept for each of |cached_key_params|. 0 disables
+    // the cache.
+    size_t certificate_cache_size = 4;
+  };
+
+  struct Stats {
+    int64_t certificate_cache_hits = 0;
+    int64_t certificate_cache_misses = 0;
+    // Certificates generated for the cache.
+    int64_t pregenerated_certificates = 0;
+  };
+
+  static scoped_refptr<CryptoWorkerPool> Create(const Config& config);
+
+  // Like RTCCertificateGenerator::GenerateCertificateAsync(), but the
+  // |callback| is invoked on |reply_thread|, which may be any thread. If the
+  // cache has a matching certificate, it is posted to |reply_thread| right
+  // away.
+  void GenerateCertificateAsync(
+      const KeyParams& key_params,
+      const absl::optional<uint64_t>& expires_ms,
+      Thread* reply_thread,
+      const scoped_refptr<RTCCertificateGeneratorCallback>& callback);
+
+  // Runs |task| on one of the worker threads, like Thread::PostTask(). The
+  // task must not hold the last reference to the pool.
+  template <class FunctorT>
+  void PostTask(const Location& posted_from, FunctorT&& task) {
+    NextWorker()->PostTask(posted_from, std::forward<FunctorT>(task));
+  }
+
+  Stats GetStats() const;
+
+ protected:
+  explicit CryptoWorkerPool(const Config& config);
+  // Waits for the running tasks. Tasks that haven't started are dropped.
+  ~CryptoWorkerPool() override;
+
+ private:
+  struct CachedCertificates {
+    KeyParams key_params;
+    std::vector<scoped_refptr<RTCCertificate>> certificates;
+    // Set while a worker is generating certificates for the cache.
+    bool refilling = false;
+  };
+
+  Thread* NextWorker();
+  CachedCertificates* FindCachedCertificates(const KeyParams& key_params)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void MaybeStartRefill(CachedCertificates* cached)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Runs on a worker thread. Adds a certificate to the cache of |key_params|
+  // and starts the next refill if it isn't full yet.
+  void Refill(const KeyParams& key_params);
+
+  const size_t certificate_cache_size_;
+  std::vector<std::unique_ptr<Thread>> workers_;
+  std::atomic<size_t> next_worker_{0};
+
+  CriticalSection crit_;
+  std::vector<CachedCertificates> cache_ RTC_GUARDED_BY(crit_);
+  Stats stats_ RTC_GUARDED_BY(crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(CryptoWorkerPool);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_CRYPTO_WORKER_POOL_H_
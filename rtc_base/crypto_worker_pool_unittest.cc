@@ -0,0 +1,220 @@
+/*
+ *  Copyright 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/crypto_worker_pool.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+constexpr int kTimeoutMs = 10000;
+
+class Callback : public RTCCertificateGeneratorCallback {
+ public:
+  void OnSuccess(const scoped_refptr<RTCCertificate>& certificate) override {
+    OnDone();
+    certificate_ = certificate;
+  }
+  void OnFailure() override { OnDone(); }
+
+  bool done() const { return done_; }
+  Thread* thread() const { return thread_; }
+  const scoped_refptr<RTCCertificate>& certificate() const {
+    return certificate_;
+  }
+
+ private:
+  void OnDone() {
+    EXPECT_FALSE(done_);
+    done_ = true;
+    thread_ = Thread::Current();
+  }
+
+  bool done_ = false;
+  Thread* thread_ = nullptr;
+  scoped_refptr<RTCCertificate> certificate_;
+};
+
+scoped_refptr<Callback> CreateCallback() {
+  return new RefCountedObject<Callback>();
+}
+
+CryptoWorkerPool::Config ConfigWithCacheSize(size_t cache_size) {
+  CryptoWorkerPool::Config config;
+  config.cached_key_params = {KeyParams::ECDSA()};
+  config.certificate_cache_size = cache_size;
+  return config;
+}
+
+}  // namespace
+
+TEST(CryptoWorkerPoolTest, ServesCertificatesFromCache) {
+  scoped_refptr<CryptoWorkerPool> pool =
+      CryptoWorkerPool::Create(ConfigWithCacheSize(2));
+  EXPECT_EQ_WAIT(2, pool->GetStats().pregenerated_certificates, kTimeoutMs);
+
+  scoped_refptr<Callback> callback = CreateCallback();
+  pool->GenerateCertificateAsync(KeyParams::ECDSA(), absl::nullopt,
+                                 Thread::Current(), callback);
+  // Even a cached certificate is delivered asynchronously.
+  EXPECT_FALSE(callback->done());
+  EXPECT_TRUE_WAIT(callback->done(), kTimeoutMs);
+  EXPECT_TRUE(callback->certificate());
+  EXPECT_EQ(Thread::Current(), callback->thread());
+  EXPECT_EQ(1, pool->GetStats().certificate_cache_hits);
+  EXPECT_EQ(0, pool->GetStats().certificate_cache_misses);
+
+  // The taken certificate is replaced in the background.
+  EXPECT_EQ_WAIT(3, pool->GetStats().pregenerated_certificates, kTimeoutMs);
+}
+
+TEST(CryptoWorkerPoolTest, GeneratesOnWorkerWhenCacheIsEmpty) {
+  scoped_refptr<CryptoWorkerPool> pool =
+      CryptoWorkerPool::Create(ConfigWithCacheSize(1));
+  EXPECT_EQ_WAIT(1, pool->GetStats().pregenerated_certificates, kTimeoutMs);
+
+  std::vector<scoped_refptr<Callback>> callbacks;
+  for (int i = 0; i < 2; ++i) {
+    callbacks.push_back(CreateCallback());
+    pool->GenerateCertificateAsync(KeyParams::ECDSA(), absl::nullopt,
+                                   Thread::Current(), callbacks.back());
+  }
+  // Key types that aren't cached are always generated.
+  callbacks.push_back(CreateCallback());
+  pool->GenerateCertificateAsync(KeyParams::RSA(1024), absl::nullopt,
+                                 Thread::Current(), callbacks.back());
+
+  for (const scoped_refptr<Callback>& callback : callbacks) {
+    EXPECT_TRUE_WAIT(callback->done(), kTimeoutMs);
+    EXPECT_TRUE(callback->certificate());
+    EXPECT_EQ(Thread::Current(), callback->thread());
+  }
+  EXPECT_NE(callbacks[0]->certificate(), callbacks[1]->certificate());
+  EXPECT_EQ(1, pool->GetStats().certificate_cache_hits);
+  EXPECT_EQ(1, pool->GetStats().certificate_cache_misses);
+}
+
+TEST(CryptoWorkerPoolTest, GeneratesCertificatesWithExpiration) {
+  scoped_refptr<CryptoWorkerPool> pool =
+      CryptoWorkerPool::Create(ConfigWithCacheSize(1));
+  EXPECT_EQ_WAIT(1, pool->GetStats().pregenerated_certificates, kTimeoutMs);
+
+  constexpr uint64_t kExpiresMs = 60000;
+  scoped_refptr<Callback> callback = CreateCallback();
+  pool->GenerateCertificateAsync(KeyParams::ECDSA(), kExpiresMs,
+                                 Thread::Current(), callback);
+  EXPECT_TRUE_WAIT(callback->done(), kTimeoutMs);
+  ASSERT_TRUE(callback->certificate());
+  EXPECT_LE(callback->certificate()->Expires(), TimeUTCMillis() + kExpiresMs);
+  EXPECT_EQ(0, pool->GetStats().certificate_cache_hits);
+}
+
+TEST(CryptoWorkerPoolTest, ReportsFailure) {
+  scoped_refptr<CryptoWorkerPool> pool =
+      CryptoWorkerPool::Create(ConfigWithCacheSize(0));
+  scoped_refptr<Callback> callback = CreateCallback();
+  pool->GenerateCertificateAsync(KeyParams::RSA(0, 0), absl::nullopt,
+                                 Thread::Current(), callback);
+  EXPECT_TRUE_WAIT(callback->done(), kTimeoutMs);
+  EXPECT_FALSE(callback->certificate());
+}
+
+TEST(CryptoWorkerPoolTest, CertificateGeneratorUsesPool) {
+  scoped_refptr<CryptoWorkerPool> pool =
+      CryptoWorkerPool::Create(ConfigWithCacheSize(1));
+  EXPECT_EQ_WAIT(1, pool->GetStats().pregenerated_certificates, kTimeoutMs);
+
+  RTCCertificateGenerator generator(Thread::Current(), pool);
+  scoped_refptr<Callback> callback = CreateCallback();
+  generator.GenerateCertificateAsync(KeyParams::ECDSA(), absl::nullopt,
+                                     callback);
+  EXPECT_TRUE_WAIT(callback->done(), kTimeoutMs);
+  EXPECT_TRUE(callback->certificate());
+  EXPECT_EQ(1, pool->GetStats().certificate_cache_hits);
+}
+
+// Generates a burst of certificates, as when many calls are set up at once,
+// and reports how long the network thread is blocked meanwhile. Without a
+// pool, RTCCertificateGenerator generates on the network thread.
+TEST(CryptoWorkerPoolTest, DISABLED_Benchmark) {
+  constexpr int kNumCertificates = 50;
+  std::unique_ptr<Thread> network_thread = Thread::Create();
+  ASSERT_TRUE(network_thread->Start());
+
+  for (const KeyParams& key_params : {KeyParams::ECDSA(), KeyParams::RSA()}) {
+    for (int mode = 0; mode < 3; ++mode) {
+      std::unique_ptr<RTCCertificateGenerator> generator;
+      scoped_refptr<CryptoWorkerPool> pool;
+      const char* name;
+      if (mode == 0) {
+        generator.reset(new RTCCertificateGenerator(Thread::Current(),
+                                                    network_thread.get()));
+        name = "Network thread";
+      } else {
+        CryptoWorkerPool::Config config;
+        config.cached_key_params = {key_params};
+        config.certificate_cache_size = mode == 1 ? 0 : kNumCertificates / 2;
+        pool = CryptoWorkerPool::Create(config);
+        EXPECT_EQ_WAIT(static_cast<int64_t>(config.certificate_cache_size),
+                       pool->GetStats().pregenerated_certificates, 60000);
+        generator.reset(new RTCCertificateGenerator(Thread::Current(), pool));
+        name = mode == 1 ? "Pool" : "Pool with cache";
+      }
+
+      std::vector<scoped_refptr<Callback>> callbacks;
+      const int64_t start_us = TimeMicros();
+      for (int i = 0; i < kNumCertificates; ++i) {
+        callbacks.push_back(CreateCallback());
+        generator->GenerateCertificateAsync(key_params, absl::nullopt,
+                                            callbacks.back());
+      }
+      // Probes the network thread every millisecond until all certificates
+      // are delivered.
+      std::atomic<int64_t> max_stall_us(0);
+      auto all_done = [&callbacks] {
+        return std::all_of(
+            callbacks.begin(), callbacks.end(),
+            [](const scoped_refptr<Callback>& c) { return c->done(); });
+      };
+      while (!all_done()) {
+        const int64_t posted_us = TimeMicros();
+        network_thread->PostTask(RTC_FROM_HERE, [&max_stall_us, posted_us] {
+          const int64_t stall_us = TimeMicros() - posted_us;
+          if (stall_us > max_stall_us) {
+            max_stall_us = stall_us;
+          }
+        });
+        Thread::Current()->ProcessMessages(1);
+      }
+      const int64_t elapsed_us = TimeMicros() - start_us;
+      // Let the last probes run before they go out of scope.
+      network_thread->Invoke<void>(RTC_FROM_HERE, [] {});
+      printf("%s, %s: %.0f certificates/s, network thread blocked %.1f ms\n",
+             key_params.type() == KT_RSA ? "RSA" : "ECDSA", name,
+             kNumCertificates * 1e6 / elapsed_us, max_stall_us / 1000.0);
+    }
+  }
+}
+
+}  // namespace rtc
@@ -0,0 +1,381 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/linux_network_monitor.h"
+
+#include <errno.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace rtc {
+
+namespace {
+
+// Large enough for the messages of a dump, which the kernel fills up to a page
+// or more.
+const size_t kBufferSize = 32 * 1024;
+
+AdapterType AdapterTypeFromHardwareType(unsigned short type) {
+  switch (type) {
+    case ARPHRD_LOOPBACK:
+      return ADAPTER_TYPE_LOOPBACK;
+    // Tunnels without a link layer, such as the tun interfaces of VPN
+    // clients.
+    case ARPHRD_NONE:
+    case ARPHRD_TUNNEL:
+    case ARPHRD_TUNNEL6:
+      return ADAPTER_TYPE_VPN;
+    default:
+      return ADAPTER_TYPE_UNKNOWN;
+  }
+}
+
+}  // namespace
+
+bool LinuxNetworkMonitor::Interface::IsUsable() const {
+  return (flags & IFF_RUNNING) && !addresses.empty();
+}
+
+LinuxNetworkMonitor::LinuxNetworkMonitor() : buffer_(new char[kBufferSize]) {}
+
+LinuxNetworkMonitor::~LinuxNetworkMonitor() {
+  Stop();
+}
+
+void LinuxNetworkMonitor::Start() {
+  if (thread_) {
+    return;
+  }
+  netlink_fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (netlink_fd_ < 0) {
+    RTC_LOG_ERR(LS_ERROR) << "Failed to create a netlink socket";
+    return;
+  }
+  sockaddr_nl address;
+  memset(&address, 0, sizeof(address));
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+  if (bind(netlink_fd_, reinterpret_cast<sockaddr*>(&address),
+           sizeof(address)) != 0) {
+    RTC_LOG_ERR(LS_ERROR) << "Failed to bind the netlink socket";
+    close(netlink_fd_);
+    netlink_fd_ = -1;
+    return;
+  }
+  stop_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (stop_fd_ < 0) {
+    RTC_LOG_ERR(LS_ERROR) << "Failed to create an eventfd";
+    close(netlink_fd_);
+    netlink_fd_ = -1;
+    return;
+  }
+  thread_.reset(new PlatformThread(&LinuxNetworkMonitor::ThreadMain, this,
+                                   "NetworkMonitor"));
+  thread_->Start();
+}
+
+void LinuxNetworkMonitor::Stop() {
+  if (!thread_) {
+    return;
+  }
+  const uint64_t value = 1;
+  if (write(stop_fd_, &value, sizeof(value)) != sizeof(value)) {
+    RTC_LOG_ERR(LS_ERROR) << "Failed to stop the network monitor thread";
+  }
+  thread_->Stop();
+  thread_.reset();
+  close(stop_fd_);
+  stop_fd_ = -1;
+  close(netlink_fd_);
+  netlink_fd_ = -1;
+
+  CritScope cs(&crit_);
+  interfaces_.clear();
+  adapter_types_.clear();
+}
+
+bool LinuxNetworkMonitor::ReportsAllNetworkChanges() const {
+  CritScope cs(&crit_);
+  return listening_;
+}
+
+AdapterType LinuxNetworkMonitor::GetAdapterType(
+    const std::string& interface_name) {
+  CritScope cs(&crit_);
+  auto it = adapter_types_.find(interface_name);
+  return it == adapter_types_.end() ? ADAPTER_TYPE_UNKNOWN : it->second;
+}
+
+bool LinuxNetworkMonitor::ProcessNetlinkMessages(const void* data,
+                                                 size_t size) {
+  bool changed = false;
+  for (const nlmsghdr* message = static_cast<const nlmsghdr*>(data);
+       NLMSG_OK(message, size); message = NLMSG_NEXT(message, size)) {
+    switch (message->nlmsg_type) {
+      case NLMSG_DONE:
+        dump_done_ = true;
+        break;
+      case NLMSG_ERROR:
+        // Only requests are answered with errors, so this ends a dump.
+        RTC_LOG(LS_WARNING) << "Netlink request failed";
+        dump_done_ = true;
+        break;
+      case RTM_NEWLINK:
+      case RTM_DELLINK:
+        if (ProcessLinkMessage(message)) {
+          changed = true;
+        }
+        break;
+      case RTM_NEWADDR:
+      case RTM_DELADDR:
+        if (ProcessAddressMessage(message)) {
+          changed = true;
+        }
+        break;
+    }
+  }
+  return changed;
+}
+
+// static
+void LinuxNetworkMonitor::ThreadMain(void* monitor) {
+  static_cast<LinuxNetworkMonitor*>(monitor)->Run();
+}
+
+void LinuxNetworkMonitor::Run() {
+  while (Synchronize()) {
+    {
+      CritScope cs(&crit_);
+      listening_ = true;
+    }
+    // The networks may have changed before the socket was subscribed, or
+    // while messages were lost.
+    OnNetworksChanged();
+    bool changed;
+    while (Receive(&changed)) {
+      if (changed) {
+        OnNetworksChanged();
+      }
+    }
+    if (!overflowed_) {
+      break;
+    }
+    RTC_LOG(LS_WARNING) << "Netlink messages were lost, listing the "
+                           "interfaces again";
+  }
+  // Stopped, or the socket failed, in which case BasicNetworkManager goes back
+  // to polling the interfaces.
+  CritScope cs(&crit_);
+  listening_ = false;
+}
+
+bool LinuxNetworkMonitor::Synchronize() {
+  // The socket is subscribed to the changes before the dumps, so that none are
+  // missed in between.
+  do {
+    overflowed_ = false;
+    {
+      CritScope cs(&crit_);
+      interfaces_.clear();
+      adapter_types_.clear();
+    }
+    if (Dump(RTM_GETLINK) && Dump(RTM_GETADDR)) {
+      return true;
+    }
+  } while (overflowed_);
+  return false;
+}
+
+bool LinuxNetworkMonitor::Dump(int type) {
+  struct {
+    nlmsghdr header;
+    rtgenmsg message;
+  } request;
+  memset(&request, 0, sizeof(request));
+  request.header.nlmsg_len = NLMSG_LENGTH(sizeof(rtgenmsg));
+  request.header.nlmsg_type = type;
+  request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  request.header.nlmsg_seq = ++sequence_number_;
+  request.message.rtgen_family = AF_UNSPEC;
+  if (send(netlink_fd_, &request, request.header.nlmsg_len, 0) < 0) {
+    RTC_LOG_ERR(LS_ERROR) << "Failed to send a netlink request";
+    return false;
+  }
+  dump_done_ = false;
+  bool changed;
+  while (!dump_done_) {
+    if (!Receive(&changed)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LinuxNetworkMonitor::Receive(bool* changed) {
+  *changed = false;
+  pollfd fds[] = {{netlink_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+  if (poll(fds, 2, -1) < 0) {
+    if (errno == EINTR) {
+      return true;
+    }
+    RTC_LOG_ERR(LS_ERROR) << "Failed to poll the netlink socket";
+    return false;
+  }
+  if (fds[1].revents) {
+    return false;
+  }
+  // Processes all the available messages before signaling, so that a burst of
+  // changes is reported once.
+  while (true) {
+    ssize_t size = recv(netlink_fd_, buffer_.get(), kBufferSize, MSG_DONTWAIT);
+    if (size > 0) {
+      if (ProcessNetlinkMessages(buffer_.get(), size)) {
+        *changed = true;
+      }
+      continue;
+    }
+    if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    }
+    if (size < 0 && errno == EINTR) {
+      continue;
+    }
+    if (size < 0 && errno == ENOBUFS) {
+      overflowed_ = true;
+    } else {
+      RTC_LOG_ERR(LS_ERROR) << "Failed to read from the netlink socket";
+    }
+    return false;
+  }
+}
+
+bool LinuxNetworkMonitor::ProcessLinkMessage(const nlmsghdr* message) {
+  if (message->nlmsg_len < NLMSG_LENGTH(sizeof(ifinfomsg))) {
+    return false;
+  }
+  const ifinfomsg* link_message =
+      static_cast<const ifinfomsg*>(NLMSG_DATA(message));
+  std::string name;
+  ssize_t payload_len = IFLA_PAYLOAD(message);
+  for (const rtattr* rta = IFLA_RTA(link_message); RTA_OK(rta, payload_len);
+       rta = RTA_NEXT(rta, payload_len)) {
+    if (rta->rta_type == IFLA_IFNAME) {
+      const char* data = static_cast<const char*>(RTA_DATA(rta));
+      name.assign(data, strnlen(data, RTA_PAYLOAD(rta)));
+    }
+  }
+
+  CritScope cs(&crit_);
+  auto it = interfaces_.find(link_message->ifi_index);
+  if (message->nlmsg_type == RTM_DELLINK) {
+    if (it == interfaces_.end()) {
+      return false;
+    }
+    const bool was_usable = it->second.IsUsable();
+    adapter_types_.erase(it->second.name);
+    interfaces_.erase(it);
+    return was_usable;
+  }
+
+  // Most link messages, such as the ones of traffic statistics or of wireless
+  // events, don't change the flags or the name.
+  Interface& interface = interfaces_[link_message->ifi_index];
+  const bool was_usable = interface.IsUsable();
+  bool renamed = false;
+  if (!name.empty() && name != interface.name) {
+    adapter_types_.erase(interface.name);
+    interface.name = name;
+    renamed = true;
+  }
+  interface.flags = link_message->ifi_flags;
+  interface.type = link_message->ifi_type;
+  if (!interface.name.empty()) {
+    adapter_types_[interface.name] = AdapterTypeFromHardwareType(interface.type);
+  }
+  const bool usable = interface.IsUsable();
+  return usable != was_usable || (usable && renamed);
+}
+
+bool LinuxNetworkMonitor::ProcessAddressMessage(const nlmsghdr* message) {
+  if (message->nlmsg_len < NLMSG_LENGTH(sizeof(ifaddrmsg))) {
+    return false;
+  }
+  const ifaddrmsg* address_message =
+      static_cast<const ifaddrmsg*>(NLMSG_DATA(message));
+  IPAddress ip;
+  // IFA_FLAGS holds all of the flags, while ifa_flags only has room for the
+  // first 8.
+  uint32_t flags = address_message->ifa_flags;
+  ssize_t payload_len = IFA_PAYLOAD(message);
+  for (const rtattr* rta = IFA_RTA(address_message); RTA_OK(rta, payload_len);
+       rta = RTA_NEXT(rta, payload_len)) {
+    // Like getifaddrs(), prefers the local address of point to point
+    // interfaces to their peer address.
+    if (address_message->ifa_family == AF_INET &&
+        RTA_PAYLOAD(rta) >= sizeof(in_addr) &&
+        (rta->rta_type == IFA_LOCAL ||
+         (rta->rta_type == IFA_ADDRESS && ip.IsNil()))) {
+      in_addr address;
+      memcpy(&address, RTA_DATA(rta), sizeof(address));
+      ip = IPAddress(address);
+    } else if (address_message->ifa_family == AF_INET6 &&
+               RTA_PAYLOAD(rta) >= sizeof(in6_addr) &&
+               rta->rta_type == IFA_ADDRESS) {
+      in6_addr address;
+      memcpy(&address, RTA_DATA(rta), sizeof(address));
+      ip = IPAddress(address);
+    } else if (rta->rta_type == IFA_FLAGS &&
+               RTA_PAYLOAD(rta) >= sizeof(flags)) {
+      memcpy(&flags, RTA_DATA(rta), sizeof(flags));
+    }
+  }
+  if (ip.IsNil()) {
+    return false;
+  }
+
+  // The same address is announced again whenever its flags or lifetimes
+  // change. Only the deprecated and temporary flags change the networks, as
+  // BasicNetworkManager skips deprecated IPv6 addresses and prefers the
+  // temporary ones.
+  const std::pair<IPAddress, int> address(ip, address_message->ifa_prefixlen);
+  flags &= IFA_F_DEPRECATED | IFA_F_TEMPORARY;
+  CritScope cs(&crit_);
+  if (message->nlmsg_type == RTM_DELADDR) {
+    auto it = interfaces_.find(address_message->ifa_index);
+    return it != interfaces_.end() && it->second.addresses.erase(address) &&
+           (it->second.flags & IFF_RUNNING);
+  }
+  // The address may be announced before its interface.
+  Interface& interface = interfaces_[address_message->ifa_index];
+  auto result = interface.addresses.insert(std::make_pair(address, flags));
+  bool changed = result.second;
+  if (!changed && result.first->second != flags) {
+    result.first->second = flags;
+    changed = true;
+  }
+  return changed && (interface.flags & IFF_RUNNING);
+}
+
+NetworkMonitorInterface* LinuxNetworkMonitorFactory::CreateNetworkMonitor() {
+  return new LinuxNetworkMonitor();
+}
+
+}  // namespace rtc
@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_LINUX_NETWORK_MONITOR_H_
+#define RTC_BASE_LINUX_NETWORK_MONITOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/network_monitor.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/thread_annotations.h"
+
+struct nlmsghdr;
+
+namespace rtc {
+
+// Network monitor for Linux that listens to the interface and address changes
+// of the kernel on a netlink socket, on a thread of its own. It keeps a table
+// of the interfaces that it updates with each message, and only signals the
+// changes that can affect the networks of BasicNetworkManager: addresses added
+// to, removed from or deprecated on a running interface, and interfaces with
+// addresses going up or down. This filters out the bulk of the netlink traffic on hosts with
+// many virtual interfaces, such as the veth pairs of containers, and the
+// periodic IPv6 address lifetime updates.
+//
+// While the thread listens to the socket, all changes are reported, and
+// BasicNetworkManager stops polling the interfaces (see
+// ReportsAllNetworkChanges()). If the socket can't be opened or fails, it
+// polls them again.
+class LinuxNetworkMonitor : public NetworkMonitorBase {
+ public:
+  LinuxNetworkMonitor();
+  ~LinuxNetworkMonitor() override;
+
+  void Start() override;
+  void Stop() override;
+
+  AdapterType GetAdapterType(const std::string& interface_name) override;
+  bool ReportsAllNetworkChanges() const override;
+
+  // Updates the table of interfaces with the netlink messages in |data|, and
+  // returns true if that changed a network. Public for testing.
+  bool ProcessNetlinkMessages(const void* data, size_t size);
+
+ private:
+  struct Interface {
+    std::string name;
+    unsigned int flags = 0;
+    // ARPHRD_* hardware type.
+    unsigned short type = 0;
+    // IFA_F_DEPRECATED and IFA_F_TEMPORARY flags of the addresses, by address
+    // and prefix length.
+    std::map<std::pair<IPAddress, int>, uint32_t> addresses;
+
+    // True if BasicNetworkManager makes networks of the interface.
+    bool IsUsable() const;
+  };
+
+  static void ThreadMain(void* monitor);
+  void Run();
+  // Lists the interfaces and their addresses again. Returns false if the
+  // monitor is stopped or the socket fails.
+  bool Synchronize();
+  // Requests the list of interfaces or addresses of the kernel, and processes
+  // the messages up to the end of the list.
+  bool Dump(int type);
+  // Waits for messages, and processes all that are available. Sets |*changed|
+  // if they changed a network. Returns false if the monitor is stopped, the
+  // socket fails or messages were lost.
+  bool Receive(bool* changed);
+  // Returns true if |message| changed a network.
+  bool ProcessLinkMessage(const nlmsghdr* message);
+  bool ProcessAddressMessage(const nlmsghdr* message);
+
+  int netlink_fd_ = -1;
+  // Written by Stop() to wake the thread up.
+  int stop_fd_ = -1;
+  std::unique_ptr<PlatformThread> thread_;
+  std::unique_ptr<char[]> buffer_;
+  uint32_t sequence_number_ = 0;
+  // Set when the end of a dump is processed.
+  bool dump_done_ = false;
+  // Set when the socket buffer overflowed, and messages were lost.
+  bool overflowed_ = false;
+
+  CriticalSection crit_;
+  // By interface index.
+  std::map<int, Interface> interfaces_ RTC_GUARDED_BY(crit_);
+  std::map<std::string, AdapterType> adapter_types_ RTC_GUARDED_BY(crit_);
+  // True from the first listing of the interfaces until the thread stops.
+  bool listening_ RTC_GUARDED_BY(crit_) = false;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(LinuxNetworkMonitor);
+};
+
+class LinuxNetworkMonitorFactory : public NetworkMonitorFactory {
+ public:
+  NetworkMonitorInterface* CreateNetworkMonitor() override;
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_LINUX_NETWORK_MONITOR_H_
@@ -0,0 +1,294 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/linux_network_monitor.h"
+
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+constexpr int kTimeoutMs = 5000;
+constexpr unsigned int kUp = IFF_UP | IFF_RUNNING;
+
+// Builds netlink messages like the ones of the kernel.
+class NetlinkMessages {
+ public:
+  void AddLink(int type,
+               int index,
+               const char* name,
+               unsigned int flags,
+               unsigned short hardware_type = ARPHRD_ETHER) {
+    const size_t name_size = strlen(name) + 1;
+    nlmsghdr* header = Append(
+        type, NLMSG_ALIGN(sizeof(ifinfomsg)) + RTA_LENGTH(name_size));
+    ifinfomsg* link_message = static_cast<ifinfomsg*>(NLMSG_DATA(header));
+    link_message->ifi_index = index;
+    link_message->ifi_flags = flags;
+    link_message->ifi_type = hardware_type;
+    rtattr* rta = IFLA_RTA(link_message);
+    rta->rta_type = IFLA_IFNAME;
+    rta->rta_len = RTA_LENGTH(name_size);
+    memcpy(RTA_DATA(rta), name, name_size);
+  }
+
+  void AddAddress(int type,
+                  int index,
+                  const char* ip_string,
+                  int prefix,
+                  uint32_t flags = 0) {
+    IPAddress ip;
+    RTC_CHECK(IPFromString(ip_string, &ip));
+    const size_t ip_size =
+        ip.family() == AF_INET ? sizeof(in_addr) : sizeof(in6_addr);
+    nlmsghdr* header =
+        Append(type, NLMSG_ALIGN(sizeof(ifaddrmsg)) +
+                         RTA_SPACE(sizeof(flags)) + RTA_LENGTH(ip_size));
+    ifaddrmsg* address_message = static_cast<ifaddrmsg*>(NLMSG_DATA(header));
+    address_message->ifa_family = ip.family();
+    address_message->ifa_prefixlen = prefix;
+    address_message->ifa_flags = static_cast<unsigned char>(flags);
+    address_message->ifa_index = index;
+    // Like the kernel, sends all of the flags in IFA_FLAGS too.
+    rtattr* rta = IFA_RTA(address_message);
+    rta->rta_type = IFA_FLAGS;
+    rta->rta_len = RTA_LENGTH(sizeof(flags));
+    memcpy(RTA_DATA(rta), &flags, sizeof(flags));
+    rta = reinterpret_cast<rtattr*>(reinterpret_cast<char*>(rta) +
+                                    RTA_SPACE(sizeof(flags)));
+    rta->rta_type = IFA_ADDRESS;
+    rta->rta_len = RTA_LENGTH(ip_size);
+    if (ip.family() == AF_INET) {
+      const in_addr address = ip.ipv4_address();
+      memcpy(RTA_DATA(rta), &address, ip_size);
+    } else {
+      const in6_addr address = ip.ipv6_address();
+      memcpy(RTA_DATA(rta), &address, ip_size);
+    }
+  }
+
+  // Returns true if the messages changed a network, and clears them.
+  bool ProcessIn(LinuxNetworkMonitor* monitor) {
+    bool changed =
+        monitor->ProcessNetlinkMessages(buffer_.data(), buffer_.size());
+    buffer_.clear();
+    return changed;
+  }
+
+ private:
+  nlmsghdr* Append(int type, size_t payload_size) {
+    const size_t offset = buffer_.size();
+    buffer_.resize(offset + NLMSG_SPACE(payload_size));
+    nlmsghdr* header = reinterpret_cast<nlmsghdr*>(&buffer_[offset]);
+    header->nlmsg_len = NLMSG_LENGTH(payload_size);
+    header->nlmsg_type = type;
+    return header;
+  }
+
+  std::vector<char> buffer_;
+};
+
+class Listener : public sigslot::has_slots<> {
+ public:
+  void OnNetworksChanged() { ++num_changes_; }
+  int num_changes() const { return num_changes_; }
+
+ private:
+  int num_changes_ = 0;
+};
+
+}  // namespace
+
+TEST(LinuxNetworkMonitorTest, ReportsAddressChangesOfRunningInterfaces) {
+  LinuxNetworkMonitor monitor;
+  NetlinkMessages messages;
+  messages.AddLink(RTM_NEWLINK, 2, "eth0", kUp);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+
+  messages.AddAddress(RTM_NEWADDR, 2, "192.168.1.2", 24);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+  messages.AddAddress(RTM_NEWADDR, 2, "2001:db8::2", 64);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+  // Like the updates of the lifetimes of IPv6 addresses.
+  messages.AddAddress(RTM_NEWADDR, 2, "2001:db8::2", 64);
+  messages.AddAddress(RTM_NEWADDR, 2, "2001:db8::2", 64);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+
+  messages.AddAddress(RTM_DELADDR, 2, "192.168.1.2", 24);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+  messages.AddAddress(RTM_DELADDR, 2, "192.168.1.2", 24);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+}
+
+TEST(LinuxNetworkMonitorTest, ReportsDeprecatedAndTemporaryFlagChanges) {
+  LinuxNetworkMonitor monitor;
+  NetlinkMessages messages;
+  messages.AddLink(RTM_NEWLINK, 2, "eth0", kUp);
+  messages.AddAddress(RTM_NEWADDR, 2, "2001:db8::3", 64, IFA_F_TEMPORARY);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+  // Only the lifetimes change, and the other flags are ignored.
+  messages.AddAddress(RTM_NEWADDR, 2, "2001:db8::3", 64,
+                      IFA_F_TEMPORARY | IFA_F_NOPREFIXROUTE);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+
+  // The preferred lifetime of the address ran out.
+  messages.AddAddress(RTM_NEWADDR, 2, "2001:db8::3", 64,
+                      IFA_F_TEMPORARY | IFA_F_DEPRECATED);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+  messages.AddAddress(RTM_NEWADDR, 2, "2001:db8::3", 64,
+                      IFA_F_TEMPORARY | IFA_F_DEPRECATED);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+  messages.AddAddress(RTM_NEWADDR, 2, "2001:db8::3", 64, IFA_F_DEPRECATED);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+}
+
+TEST(LinuxNetworkMonitorTest, IgnoresAddressChangesOfDownInterfaces) {
+  LinuxNetworkMonitor monitor;
+  NetlinkMessages messages;
+  messages.AddLink(RTM_NEWLINK, 2, "eth0", IFF_UP);
+  messages.AddAddress(RTM_NEWADDR, 2, "192.168.1.2", 24);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+  messages.AddAddress(RTM_DELADDR, 2, "192.168.1.2", 24);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+}
+
+TEST(LinuxNetworkMonitorTest, IgnoresInterfacesWithoutAddresses) {
+  LinuxNetworkMonitor monitor;
+  NetlinkMessages messages;
+  // Like the host side of the veth pair of a container.
+  messages.AddLink(RTM_NEWLINK, 7, "veth1234", 0);
+  messages.AddLink(RTM_NEWLINK, 7, "veth1234", kUp);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+  messages.AddLink(RTM_DELLINK, 7, "veth1234", 0);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+}
+
+TEST(LinuxNetworkMonitorTest, ReportsInterfacesWithAddressesGoingUpAndDown) {
+  LinuxNetworkMonitor monitor;
+  NetlinkMessages messages;
+  // The address may be announced before its interface.
+  messages.AddAddress(RTM_NEWADDR, 3, "10.0.0.1", 8);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+  messages.AddLink(RTM_NEWLINK, 3, "wlan0", kUp);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+  // Like traffic statistics.
+  messages.AddLink(RTM_NEWLINK, 3, "wlan0", kUp);
+  EXPECT_FALSE(messages.ProcessIn(&monitor));
+
+  messages.AddLink(RTM_NEWLINK, 3, "wlan0", IFF_UP);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+  messages.AddLink(RTM_NEWLINK, 3, "wlan0", kUp);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+  messages.AddLink(RTM_NEWLINK, 3, "wlan1", kUp);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+  messages.AddLink(RTM_DELLINK, 3, "wlan1", 0);
+  EXPECT_TRUE(messages.ProcessIn(&monitor));
+}
+
+TEST(LinuxNetworkMonitorTest, GetsAdapterTypeFromHardwareType) {
+  LinuxNetworkMonitor monitor;
+  NetlinkMessages messages;
+  messages.AddLink(RTM_NEWLINK, 1, "lo", kUp | IFF_LOOPBACK, ARPHRD_LOOPBACK);
+  messages.AddLink(RTM_NEWLINK, 2, "eth0", kUp, ARPHRD_ETHER);
+  messages.AddLink(RTM_NEWLINK, 3, "wg0", kUp, ARPHRD_NONE);
+  messages.ProcessIn(&monitor);
+  EXPECT_EQ(ADAPTER_TYPE_LOOPBACK, monitor.GetAdapterType("lo"));
+  // Left to the name matching rules of BasicNetworkManager.
+  EXPECT_EQ(ADAPTER_TYPE_UNKNOWN, monitor.GetAdapterType("eth0"));
+  EXPECT_EQ(ADAPTER_TYPE_VPN, monitor.GetAdapterType("wg0"));
+
+  messages.AddLink(RTM_NEWLINK, 3, "vpn0", kUp, ARPHRD_NONE);
+  messages.ProcessIn(&monitor);
+  EXPECT_EQ(ADAPTER_TYPE_UNKNOWN, monitor.GetAdapterType("wg0"));
+  EXPECT_EQ(ADAPTER_TYPE_VPN, monitor.GetAdapterType("vpn0"));
+  messages.AddLink(RTM_DELLINK, 3, "vpn0", 0, ARPHRD_NONE);
+  messages.ProcessIn(&monitor);
+  EXPECT_EQ(ADAPTER_TYPE_UNKNOWN, monitor.GetAdapterType("vpn0"));
+}
+
+TEST(LinuxNetworkMonitorTest, ListsInterfacesOfTheHost) {
+  Listener listener;
+  LinuxNetworkMonitor monitor;
+  monitor.SignalNetworksChanged.connect(&listener,
+                                        &Listener::OnNetworksChanged);
+  EXPECT_FALSE(monitor.ReportsAllNetworkChanges());
+  monitor.Start();
+  // The networks are reported once they are listed.
+  EXPECT_TRUE_WAIT(listener.num_changes() > 0, kTimeoutMs);
+  EXPECT_TRUE(monitor.ReportsAllNetworkChanges());
+  EXPECT_EQ(ADAPTER_TYPE_LOOPBACK, monitor.GetAdapterType("lo"));
+  monitor.Stop();
+  EXPECT_FALSE(monitor.ReportsAllNetworkChanges());
+  EXPECT_EQ(ADAPTER_TYPE_UNKNOWN, monitor.GetAdapterType("lo"));
+}
+
+// Reports how long it takes to process the netlink messages of a host with 500
+// interfaces, when they are listed and when their addresses are announced
+// again.
+TEST(LinuxNetworkMonitorTest, DISABLED_Benchmark) {
+  constexpr int kNumInterfaces = 500;
+  constexpr int kNumRounds = 100;
+  LinuxNetworkMonitor monitor;
+  NetlinkMessages messages;
+  int64_t list_us = 0;
+  int64_t update_us = 0;
+  int num_changes = 0;
+  for (int round = 0; round < kNumRounds; ++round) {
+    for (int i = 0; i < kNumInterfaces; ++i) {
+      char name[IFNAMSIZ];
+      snprintf(name, sizeof(name), "veth%d", i);
+      messages.AddLink(RTM_NEWLINK, i + 1, name, kUp);
+    }
+    for (int i = 0; i < kNumInterfaces; ++i) {
+      char ip[32];
+      snprintf(ip, sizeof(ip), "10.%d.%d.1", i / 256, i % 256);
+      messages.AddAddress(RTM_NEWADDR, i + 1, ip, 24);
+    }
+    int64_t start_us = TimeMicros();
+    messages.ProcessIn(&monitor);
+    list_us += TimeMicros() - start_us;
+
+    for (int i = 0; i < kNumInterfaces; ++i) {
+      char ip[32];
+      snprintf(ip, sizeof(ip), "10.%d.%d.1", i / 256, i % 256);
+      messages.AddAddress(RTM_NEWADDR, i + 1, ip, 24);
+    }
+    start_us = TimeMicros();
+    if (messages.ProcessIn(&monitor)) {
+      ++num_changes;
+    }
+    update_us += TimeMicros() - start_us;
+
+    for (int i = 0; i < kNumInterfaces; ++i) {
+      messages.AddLink(RTM_DELLINK, i + 1, "", 0);
+    }
+    messages.ProcessIn(&monitor);
+  }
+  printf("%d interfaces: listed in %.0f us, %.2f us per repeated address, "
+         "%d changes reported\n",
+         kNumInterfaces, static_cast<double>(list_us) / kNumRounds,
+         static_cast<double>(update_us) / kNumRounds / kNumInterfaces,
+         num_changes);
+}
+
+}  // namespace rtc
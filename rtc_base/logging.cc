@@ -27,16 +27,25 @@
 static const int kMaxLogLineSize = 1024 - 60;
 #endif  // WEBRTC_MAC && !defined(WEBRTC_IOS) || WEBRTC_ANDROID
 
+#if defined(WEBRTC_POSIX)
+#include <pthread.h>
+#endif
+
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 #include <algorithm>
+#include <atomic>
 #include <cstdarg>
+#include <memory>
 #include <vector>
 
 #include "rtc_base/checks.h"
 #include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/platform_thread.h"
 #include "rtc_base/platform_thread_types.h"
 #include "rtc_base/string_encode.h"
 #include "rtc_base/string_utils.h"
@@ -67,6 +76,15 @@ const char* FilenameFromPath(const char* file) {
 
 // Global lock for log subsystem, only needed to serialize access to streams_.
 CriticalSection g_log_crit;
+
+// Returns the time to be logged for a message that is created now.
+int64_t LogTimeMillis() {
+  // Make sure that the logging start time isn't later than the message.
+  LogMessage::LogStartTime();
+  // Use SystemTimeMillis so that even if tests use fake clocks, the timestamp
+  // in log messages represents the real system time.
+  return SystemTimeMillis();
+}
 }  // namespace
 
 // Inefficient default implementation, override is recommended.
@@ -104,11 +122,24 @@ LogMessage::LogMessage(const char* file,
                        LoggingSeverity sev,
                        LogErrorContext err_ctx,
                        int err)
+    : LogMessage(file,
+                 line,
+                 sev,
+                 err_ctx,
+                 err,
+                 timestamp_ ? LogTimeMillis() : 0,
+                 thread_ ? CurrentThreadId() : 0) {}
+
+LogMessage::LogMessage(const char* file,
+                       int line,
+                       LoggingSeverity sev,
+                       LogErrorContext err_ctx,
+                       int err,
+                       int64_t log_time_ms,
+                       PlatformThreadId thread_id)
     : severity_(sev) {
   if (timestamp_) {
-    // Use SystemTimeMillis so that even if tests use fake clocks, the timestamp
-    // in log messages represents the real system time.
-    int64_t time = TimeDiff(SystemTimeMillis(), LogStartTime());
+    int64_t time = TimeDiff(log_time_ms, LogStartTime());
     // Also ensure WallClockStartTime is initialized, so that it matches
     // LogStartTime.
     WallClockStartTime();
@@ -118,8 +149,7 @@ LogMessage::LogMessage(const char* file,
   }
 
   if (thread_) {
-    PlatformThreadId id = CurrentThreadId();
-    print_stream_ << "[" << id << "] ";
+    print_stream_ << "[" << thread_id << "] ";
   }
 
   if (file != nullptr) {
@@ -436,17 +466,9 @@ void LogMessage::OutputToDebug(const std::string& str,
 
 // static
 bool LogMessage::IsNoop(LoggingSeverity severity) {
-  if (severity >= g_dbg_sev || severity >= g_min_sev)
-    return false;
-
-  // TODO(tommi): We're grabbing this lock for every LogMessage instance that
-  // is going to be logged. This introduces unnecessary synchronization for
-  // a feature that's mostly used for testing.
-  CritScope cs(&g_log_crit);
-  if (streams_.size() > 0)
-    return false;
-
-  return true;
+  // |g_min_sev| is the lowest severity of the debug output and all streams, so
+  // there is no need to look at the streams under the lock.
+  return severity < g_dbg_sev && severity < g_min_sev;
 }
 
 void LogMessage::FinishPrintStream() {
@@ -457,6 +479,501 @@ void LogMessage::FinishPrintStream() {
 
 namespace webrtc_logging_impl {
 
+namespace {
+
+// Size of the message buffer of each thread. Must be a power of two.
+constexpr size_t kThreadBufferSize = 64 * 1024;
+// Longest time that a message waits for the background thread, unless the
+// buffer of its thread fills up faster.
+constexpr int kMaxWriteDelayMs = 10;
+
+std::atomic<bool> g_async_logging(false);
+
+// A captured message starts with this header, which is followed by the tag, if
+// any, and the arguments. Every argument is a LogArgType followed by the value.
+// All kinds of strings are stored as kCharP followed by the length and the
+// characters.
+struct RecordHeader {
+  uint32_t size;
+  // Length of the tag, or -1 if there is none.
+  int32_t tag_size;
+  LogMetadataErr meta;
+  int64_t log_time_ms;
+};
+
+}  // namespace
+
+// The messages of one thread, in a ring buffer of bytes. The thread itself is
+// the only producer and the background thread the only consumer, so the two
+// positions are all the synchronization needed. The positions count bytes
+// since the start and wrap around at the end of size_t.
+class ThreadLogBuffer {
+ public:
+  explicit ThreadLogBuffer(PlatformThreadId thread_id)
+      : thread_id(thread_id), data_(new char[kThreadBufferSize]) {}
+
+  void CopyIn(size_t pos, const void* data, size_t size) {
+    const size_t offset = pos & (kThreadBufferSize - 1);
+    const size_t first = std::min(size, kThreadBufferSize - offset);
+    memcpy(&data_[offset], data, first);
+    memcpy(&data_[0], static_cast<const char*>(data) + first, size - first);
+  }
+
+  void CopyOut(size_t pos, void* data, size_t size) const {
+    const size_t offset = pos & (kThreadBufferSize - 1);
+    const size_t first = std::min(size, kThreadBufferSize - offset);
+    memcpy(data, &data_[offset], first);
+    memcpy(static_cast<char*>(data) + first, &data_[0], size - first);
+  }
+
+  const PlatformThreadId thread_id;
+  // Set by the producer while it checks whether async logging is on and
+  // writes a message.
+  std::atomic<bool> in_use{false};
+  // Set when the thread has exited. The consumer then deletes the buffer once
+  // it is empty.
+  std::atomic<bool> orphaned{false};
+  std::atomic<uint32_t> num_dropped{0};
+  std::atomic<size_t> write_pos{0};
+  std::atomic<size_t> read_pos{0};
+  // Only accessed by the producer.
+  bool is_writer_thread = false;
+
+ private:
+  const std::unique_ptr<char[]> data_;
+};
+
+namespace {
+
+// Serializes one message into a ThreadLogBuffer. Nothing is visible to the
+// consumer until Commit().
+class RecordWriter {
+ public:
+  explicit RecordWriter(ThreadLogBuffer* buffer)
+      : buffer_(buffer),
+        start_(buffer->write_pos.load(std::memory_order_relaxed)),
+        read_pos_(buffer->read_pos.load(std::memory_order_acquire)),
+        pos_(start_ + sizeof(RecordHeader)) {}
+
+  void Write(const void* data, size_t size) {
+    // Once the buffer is full, only the size is counted.
+    if (!full_ && pos_ + size - read_pos_ <= kThreadBufferSize) {
+      buffer_->CopyIn(pos_, data, size);
+    } else {
+      full_ = true;
+    }
+    pos_ += size;
+  }
+
+  template <typename T>
+  void WriteValue(T value) {
+    Write(&value, sizeof(value));
+  }
+
+  template <typename T>
+  void WriteArg(LogArgType type, T value) {
+    WriteValue(type);
+    WriteValue(value);
+  }
+
+  void WriteString(absl::string_view str) {
+    WriteValue(LogArgType::kCharP);
+    WriteValue(static_cast<uint32_t>(str.size()));
+    Write(str.data(), str.size());
+  }
+
+  size_t size() const { return pos_ - start_; }
+  bool full() const { return full_; }
+
+  // Returns the number of bytes in the buffer after the commit.
+  size_t Commit(RecordHeader header) {
+    RTC_DCHECK(!full_);
+    header.size = static_cast<uint32_t>(size());
+    buffer_->CopyIn(start_, &header, sizeof(header));
+    buffer_->write_pos.store(pos_, std::memory_order_release);
+    return pos_ - read_pos_;
+  }
+
+ private:
+  ThreadLogBuffer* const buffer_;
+  const size_t start_;
+  const size_t read_pos_;
+  size_t pos_;
+  bool full_ = false;
+};
+
+class RecordReader {
+ public:
+  RecordReader(const ThreadLogBuffer* buffer, size_t pos)
+      : buffer_(buffer), pos_(pos) {}
+
+  template <typename T>
+  T ReadValue() {
+    T value;
+    buffer_->CopyOut(pos_, &value, sizeof(value));
+    pos_ += sizeof(value);
+    return value;
+  }
+
+  void ReadString(size_t size, std::string* str) {
+    str->resize(size);
+    if (size > 0) {
+      buffer_->CopyOut(pos_, &(*str)[0], size);
+    }
+    pos_ += size;
+  }
+
+ private:
+  const ThreadLogBuffer* const buffer_;
+  size_t pos_;
+};
+
+}  // namespace
+
+// Owns the buffers of all threads that have logged while async logging was on,
+// and the background thread that writes their messages. Created on first use
+// and never deleted.
+class AsyncLogWriter {
+ public:
+  static AsyncLogWriter* Instance() {
+    static AsyncLogWriter* const instance = new AsyncLogWriter();
+    return instance;
+  }
+
+  void Start();
+  void Stop();
+  void Flush();
+
+  // Captures a message in the buffer of the current thread. Returns false if
+  // the message has to be written synchronously instead, because async logging
+  // was stopped or the message is too large for the buffer.
+  bool Capture(const LogMetadataErr& meta,
+               const char* tag,
+               const LogArgType* fmt,
+               va_list* args);
+
+ private:
+  AsyncLogWriter();
+
+  static void ThreadFunc(void* context);
+#if defined(WEBRTC_WIN)
+  static void NTAPI OnThreadExit(void* buffer);
+#else
+  static void OnThreadExit(void* buffer);
+#endif
+
+  void Run();
+  ThreadLogBuffer* CurrentThreadBuffer();
+  void DrainAll();
+  void Drain(ThreadLogBuffer* buffer);
+
+  // Serializes Start(), Stop() and Flush().
+  CriticalSection control_crit_;
+  std::unique_ptr<PlatformThread> thread_ RTC_GUARDED_BY(control_crit_);
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> flush_requested_{false};
+  Event wake_up_;
+  Event flushed_;
+
+#if defined(WEBRTC_WIN)
+  const DWORD buffer_key_;
+#else
+  pthread_key_t buffer_key_;
+#endif
+  CriticalSection buffers_crit_;
+  std::vector<ThreadLogBuffer*> buffers_ RTC_GUARDED_BY(buffers_crit_);
+
+  // Only used on the background thread.
+  std::string tag_;
+  std::string string_arg_;
+};
+
+AsyncLogWriter::AsyncLogWriter()
+#if defined(WEBRTC_WIN)
+    : buffer_key_(FlsAlloc(&OnThreadExit)) {
+  RTC_CHECK_NE(buffer_key_, FLS_OUT_OF_INDEXES);
+}
+#else
+{
+  RTC_CHECK_EQ(0, pthread_key_create(&buffer_key_, &OnThreadExit));
+}
+#endif
+
+void AsyncLogWriter::Start() {
+  CritScope cs(&control_crit_);
+  if (thread_) {
+    return;
+  }
+  LogMessage::LogStartTime();
+  stop_ = false;
+  g_async_logging = true;
+  thread_.reset(new PlatformThread(&ThreadFunc, this, "AsyncLogWriter"));
+  thread_->Start();
+}
+
+void AsyncLogWriter::Stop() {
+  CritScope cs(&control_crit_);
+  if (!thread_) {
+    return;
+  }
+  g_async_logging = false;
+  {
+    // Wait for the threads that are capturing a message, so that the last
+    // drain includes it. Threads that start capturing after this point see
+    // that async logging is off.
+    CritScope buffers_cs(&buffers_crit_);
+    Event poll;
+    for (ThreadLogBuffer* buffer : buffers_) {
+      while (buffer->in_use) {
+        poll.Wait(1);
+      }
+    }
+  }
+  stop_ = true;
+  wake_up_.Set();
+  thread_->Stop();
+  thread_.reset();
+}
+
+void AsyncLogWriter::Flush() {
+  CritScope cs(&control_crit_);
+  if (!thread_) {
+    return;
+  }
+  flush_requested_ = true;
+  wake_up_.Set();
+  flushed_.Wait(Event::kForever);
+}
+
+bool AsyncLogWriter::Capture(const LogMetadataErr& meta,
+                             const char* tag,
+                             const LogArgType* fmt,
+                             va_list* args) {
+  ThreadLogBuffer* buffer = CurrentThreadBuffer();
+  // Pairs with Stop(), which turns async logging off before it checks
+  // |in_use|.
+  buffer->in_use = true;
+  if (!g_async_logging) {
+    buffer->in_use.store(false, std::memory_order_release);
+    return false;
+  }
+
+  RecordWriter writer(buffer);
+  const absl::string_view tag_str(tag ? tag : "");
+  writer.Write(tag_str.data(), tag_str.size());
+  for (; *fmt != LogArgType::kEnd; ++fmt) {
+    switch (*fmt) {
+      case LogArgType::kInt:
+        writer.WriteArg(*fmt, va_arg(*args, int));
+        break;
+      case LogArgType::kLong:
+        writer.WriteArg(*fmt, va_arg(*args, long));
+        break;
+      case LogArgType::kLongLong:
+        writer.WriteArg(*fmt, va_arg(*args, long long));
+        break;
+      case LogArgType::kUInt:
+        writer.WriteArg(*fmt, va_arg(*args, unsigned));
+        break;
+      case LogArgType::kULong:
+        writer.WriteArg(*fmt, va_arg(*args, unsigned long));
+        break;
+      case LogArgType::kULongLong:
+        writer.WriteArg(*fmt, va_arg(*args, unsigned long long));
+        break;
+      case LogArgType::kDouble:
+        writer.WriteArg(*fmt, va_arg(*args, double));
+        break;
+      case LogArgType::kLongDouble:
+        writer.WriteArg(*fmt, va_arg(*args, long double));
+        break;
+      case LogArgType::kCharP: {
+        const char* s = va_arg(*args, const char*);
+        writer.WriteString(s ? s : "(null)");
+        break;
+      }
+      case LogArgType::kStdString:
+        writer.WriteString(*va_arg(*args, const std::string*));
+        break;
+      case LogArgType::kStringView:
+        writer.WriteString(*va_arg(*args, const absl::string_view*));
+        break;
+      case LogArgType::kVoidP:
+        writer.WriteArg(*fmt, reinterpret_cast<uintptr_t>(
+                                  va_arg(*args, const void*)));
+        break;
+      default:
+        RTC_NOTREACHED();
+        buffer->in_use.store(false, std::memory_order_release);
+        return true;
+    }
+  }
+  writer.WriteValue(LogArgType::kEnd);
+
+  if (writer.size() > kThreadBufferSize) {
+    buffer->in_use.store(false, std::memory_order_release);
+    // Write the earlier messages of this thread first. The background thread
+    // writes its own large messages right away, as it can't wait for itself.
+    if (!buffer->is_writer_thread) {
+      Flush();
+    }
+    return false;
+  }
+  if (writer.full()) {
+    buffer->num_dropped.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    RecordHeader header;
+    header.tag_size = tag ? static_cast<int32_t>(tag_str.size()) : -1;
+    header.meta = meta;
+    header.log_time_ms = LogMessage::timestamp_ ? LogTimeMillis() : 0;
+    const size_t used = writer.Commit(header);
+    // Don't wait for the timer if the buffer is filling up.
+    if (used >= kThreadBufferSize / 2 &&
+        used - writer.size() < kThreadBufferSize / 2) {
+      wake_up_.Set();
+    }
+  }
+  buffer->in_use.store(false, std::memory_order_release);
+  return true;
+}
+
+void AsyncLogWriter::ThreadFunc(void* context) {
+  static_cast<AsyncLogWriter*>(context)->Run();
+}
+
+#if defined(WEBRTC_WIN)
+void NTAPI AsyncLogWriter::OnThreadExit(void* buffer) {
+#else
+void AsyncLogWriter::OnThreadExit(void* buffer) {
+#endif
+  static_cast<ThreadLogBuffer*>(buffer)->orphaned.store(
+      true, std::memory_order_release);
+}
+
+void AsyncLogWriter::Run() {
+  CurrentThreadBuffer()->is_writer_thread = true;
+  while (true) {
+    wake_up_.Wait(kMaxWriteDelayMs);
+    const bool stop = stop_;
+    const bool flush = flush_requested_.exchange(false);
+    DrainAll();
+    if (flush) {
+      flushed_.Set();
+    }
+    if (stop) {
+      return;
+    }
+  }
+}
+
+ThreadLogBuffer* AsyncLogWriter::CurrentThreadBuffer() {
+#if defined(WEBRTC_WIN)
+  ThreadLogBuffer* buffer =
+      static_cast<ThreadLogBuffer*>(FlsGetValue(buffer_key_));
+#else
+  ThreadLogBuffer* buffer =
+      static_cast<ThreadLogBuffer*>(pthread_getspecific(buffer_key_));
+#endif
+  if (buffer) {
+    return buffer;
+  }
+  buffer = new ThreadLogBuffer(CurrentThreadId());
+#if defined(WEBRTC_WIN)
+  FlsSetValue(buffer_key_, buffer);
+#else
+  pthread_setspecific(buffer_key_, buffer);
+#endif
+  CritScope cs(&buffers_crit_);
+  buffers_.push_back(buffer);
+  return buffer;
+}
+
+void AsyncLogWriter::DrainAll() {
+  CritScope cs(&buffers_crit_);
+  // Writing a message may add the buffer of this thread, if a stream logs.
+  for (size_t i = 0; i < buffers_.size();) {
+    ThreadLogBuffer* buffer = buffers_[i];
+    const bool orphaned = buffer->orphaned.load(std::memory_order_acquire);
+    Drain(buffer);
+    if (orphaned) {
+      delete buffer;
+      buffers_[i] = buffers_.back();
+      buffers_.pop_back();
+    } else {
+      ++i;
+    }
+  }
+}
+
+void AsyncLogWriter::Drain(ThreadLogBuffer* buffer) {
+  const uint32_t num_dropped =
+      buffer->num_dropped.exchange(0, std::memory_order_relaxed);
+  size_t pos = buffer->read_pos.load(std::memory_order_relaxed);
+  const size_t end = buffer->write_pos.load(std::memory_order_acquire);
+  while (pos != end) {
+    RecordReader reader(buffer, pos);
+    const RecordHeader header = reader.ReadValue<RecordHeader>();
+    const LogMetadata& meta = header.meta.meta;
+    LogMessage log_message(meta.File(), meta.Line(), meta.Severity(),
+                           header.meta.err_ctx, header.meta.err,
+                           header.log_time_ms, buffer->thread_id);
+    if (header.tag_size >= 0) {
+      reader.ReadString(header.tag_size, &tag_);
+      log_message.AddTag(tag_.c_str());
+    }
+    for (LogArgType type = reader.ReadValue<LogArgType>();
+         type != LogArgType::kEnd; type = reader.ReadValue<LogArgType>()) {
+      switch (type) {
+        case LogArgType::kInt:
+          log_message.stream() << reader.ReadValue<int>();
+          break;
+        case LogArgType::kLong:
+          log_message.stream() << reader.ReadValue<long>();
+          break;
+        case LogArgType::kLongLong:
+          log_message.stream() << reader.ReadValue<long long>();
+          break;
+        case LogArgType::kUInt:
+          log_message.stream() << reader.ReadValue<unsigned>();
+          break;
+        case LogArgType::kULong:
+          log_message.stream() << reader.ReadValue<unsigned long>();
+          break;
+        case LogArgType::kULongLong:
+          log_message.stream() << reader.ReadValue<unsigned long long>();
+          break;
+        case LogArgType::kDouble:
+          log_message.stream() << reader.ReadValue<double>();
+          break;
+        case LogArgType::kLongDouble:
+          log_message.stream() << reader.ReadValue<long double>();
+          break;
+        case LogArgType::kCharP:
+          reader.ReadString(reader.ReadValue<uint32_t>(), &string_arg_);
+          log_message.stream() << string_arg_;
+          break;
+        case LogArgType::kVoidP:
+          log_message.stream() << rtc::ToHex(reader.ReadValue<uintptr_t>());
+          break;
+        default:
+          RTC_NOTREACHED();
+          break;
+      }
+    }
+    pos += header.size;
+    // Hand the space back right away, the message is complete.
+    buffer->read_pos.store(pos, std::memory_order_release);
+  }
+  if (num_dropped > 0) {
+    LogMessage log_message(__FILE__, __LINE__, LS_WARNING, ERRCTX_NONE, 0,
+                           LogMessage::timestamp_ ? LogTimeMillis() : 0,
+                           buffer->thread_id);
+    log_message.stream() << "Dropped " << num_dropped
+                         << " log messages of a thread that logged faster "
+                            "than they could be written.";
+  }
+}
+
 void Log(const LogArgType* fmt, ...) {
   va_list args;
   va_start(args, fmt);
@@ -492,6 +1009,19 @@ void Log(const LogArgType* fmt, ...) {
     return;
   }
 
+  if (g_async_logging.load(std::memory_order_relaxed)) {
+    // Keep the arguments in case the message has to be written synchronously.
+    va_list args_copy;
+    va_copy(args_copy, args);
+    const bool captured =
+        AsyncLogWriter::Instance()->Capture(meta, tag, fmt + 1, &args_copy);
+    va_end(args_copy);
+    if (captured) {
+      va_end(args);
+      return;
+    }
+  }
+
   LogMessage log_message(meta.meta.File(), meta.meta.Line(),
                          meta.meta.Severity(), meta.err_ctx, meta.err);
   if (tag) {
@@ -550,4 +1080,17 @@ void Log(const LogArgType* fmt, ...) {
 }
 
 }  // namespace webrtc_logging_impl
+
+void LogMessage::StartAsyncLogging() {
+  webrtc_logging_impl::AsyncLogWriter::Instance()->Start();
+}
+
+void LogMessage::StopAsyncLogging() {
+  webrtc_logging_impl::AsyncLogWriter::Instance()->Stop();
+}
+
+void LogMessage::FlushAsyncLogging() {
+  webrtc_logging_impl::AsyncLogWriter::Instance()->Flush();
+}
+
 }  // namespace rtc
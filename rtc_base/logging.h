@@ -55,6 +55,7 @@
 #include "absl/strings/string_view.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/deprecation.h"
+#include "rtc_base/platform_thread_types.h"
 #include "rtc_base/strings/string_builder.h"
 #include "rtc_base/system/inline.h"
 
@@ -291,6 +292,8 @@ ToStringVal MakeVal(const T& x) {
 
 void Log(const LogArgType* fmt, ...);
 
+class AsyncLogWriter;
+
 // Ephemeral type that represents the result of the logging << operator.
 template <typename... Ts>
 class LogStreamer;
@@ -462,11 +465,37 @@ class LogMessage {
   // LogMessage.
   static bool IsNoop(LoggingSeverity severity);
 
+  // Asynchronous logging. While it is on, the logging macros only copy their
+  // arguments to a buffer owned by the calling thread, without taking any
+  // locks, and a background thread formats the messages and writes them to
+  // the debug output and the streams. Messages logged by one thread are
+  // written in order, but messages of different threads may be reordered
+  // within a few milliseconds. If a thread logs faster than the background
+  // thread can write, its messages are dropped and a warning is written
+  // instead. Start and stop must be called on the same thread.
+  static void StartAsyncLogging();
+  // Writes all pending messages and stops the background thread.
+  static void StopAsyncLogging();
+  // Blocks until all messages logged before the call have been written.
+  static void FlushAsyncLogging();
+
  private:
   friend class LogMessageForTesting;
+  friend class webrtc_logging_impl::AsyncLogWriter;
   typedef std::pair<LogSink*, LoggingSeverity> StreamAndSeverity;
   typedef std::list<StreamAndSeverity> StreamList;
 
+  // Used for messages that were captured earlier and are formatted on the
+  // background thread. |log_time_ms| and |thread_id| are only used if
+  // timestamps and thread ids are logged.
+  LogMessage(const char* file,
+             int line,
+             LoggingSeverity sev,
+             LogErrorContext err_ctx,
+             int err,
+             int64_t log_time_ms,
+             PlatformThreadId thread_id);
+
   // Updates min_sev_ appropriately when debug sinks change.
   static void UpdateMinLogSeverity();
 
@@ -12,9 +12,12 @@
 
 #include <string.h>
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include "rtc_base/arraysize.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/event.h"
 #include "rtc_base/platform_thread.h"
 #include "rtc_base/stream.h"
@@ -382,4 +385,236 @@ TEST(LogTest, EnumsAreSupported) {
   stream.Close();
 }
 
+// Collects the messages, which may be written by the background thread of
+// async logging.
+class MessageCollector : public LogSink {
+ public:
+  void OnLogMessage(const std::string& message) override {
+    CritScope cs(&crit_);
+    messages_.push_back(message);
+  }
+
+  std::vector<std::string> messages() const {
+    CritScope cs(&crit_);
+    return messages_;
+  }
+
+ private:
+  CriticalSection crit_;
+  std::vector<std::string> messages_ RTC_GUARDED_BY(crit_);
+};
+
+void LogAllTypes(int index) {
+  const std::string s = "std::string";
+  const char* null_string = nullptr;
+  RTC_LOG(LS_INFO) << index << "|" << 2l << "|" << 3ll << "|" << 4u << "|"
+                   << 5ul << "|" << 6ull << "|" << 7.5 << "|" << 8.25L << "|"
+                   << s << "|" << absl::string_view("view") << "|"
+                   << reinterpret_cast<void*>(0xabcd) << "|" << null_string;
+}
+
+TEST(LogTest, AsyncLoggingFormatsLikeSyncLogging) {
+  MessageCollector sync_sink;
+  LogMessage::AddLogToStream(&sync_sink, LS_INFO);
+  LogAllTypes(1);
+  RTC_LOG_ERRNO_EX(LS_WARNING, EINVAL) << "errno";
+  LogMessage::RemoveLogToStream(&sync_sink);
+
+  MessageCollector async_sink;
+  LogMessage::AddLogToStream(&async_sink, LS_INFO);
+  LogMessage::StartAsyncLogging();
+  LogAllTypes(1);
+  RTC_LOG_ERRNO_EX(LS_WARNING, EINVAL) << "errno";
+  LogMessage::FlushAsyncLogging();
+  LogMessage::StopAsyncLogging();
+  LogMessage::RemoveLogToStream(&async_sink);
+
+  // The messages come from different lines.
+  const std::vector<std::string> sync_messages = sync_sink.messages();
+  const std::vector<std::string> async_messages = async_sink.messages();
+  ASSERT_EQ(2u, sync_messages.size());
+  ASSERT_EQ(2u, async_messages.size());
+  for (size_t i = 0; i < sync_messages.size(); ++i) {
+    const std::string& sync_message = sync_messages[i];
+    const std::string& async_message = async_messages[i];
+    EXPECT_EQ(sync_message.substr(sync_message.find("): ")),
+              async_message.substr(async_message.find("): ")));
+  }
+  EXPECT_NE(std::string::npos,
+            async_messages[0].find("1|2|3|4|5|6|7.5|8.25|std::string|view|"
+                                   "abcd|(null)\n"));
+}
+
+TEST(LogTest, AsyncLoggingKeepsOrderOfEachThread) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumMessages = 2000;
+  MessageCollector sink;
+  LogMessage::AddLogToStream(&sink, LS_INFO);
+  LogMessage::StartAsyncLogging();
+
+  struct Context {
+    int thread_index;
+    Event go;
+  };
+  std::vector<std::unique_ptr<Context>> contexts;
+  std::vector<std::unique_ptr<PlatformThread>> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    contexts.emplace_back(new Context());
+    contexts.back()->thread_index = t;
+    threads.emplace_back(new PlatformThread(
+        [](void* context) {
+          Context* c = static_cast<Context*>(context);
+          c->go.Wait(Event::kForever);
+          for (int i = 0; i < kNumMessages; ++i) {
+            RTC_LOG(LS_INFO) << "thread " << c->thread_index << " message "
+                             << i;
+            // Let the background thread keep up.
+            if (i % 100 == 0) {
+              LogMessage::FlushAsyncLogging();
+            }
+          }
+        },
+        contexts.back().get(), "LogThread"));
+    threads.back()->Start();
+  }
+  for (auto& context : contexts) {
+    context->go.Set();
+  }
+  for (auto& thread : threads) {
+    thread->Stop();
+  }
+  LogMessage::StopAsyncLogging();
+  LogMessage::RemoveLogToStream(&sink);
+
+  std::vector<int> next_message(kNumThreads, 0);
+  for (const std::string& message : sink.messages()) {
+    int thread_index, index;
+    ASSERT_EQ(2, sscanf(message.c_str() + message.find("): ") + 3,
+                        "thread %d message %d", &thread_index, &index))
+        << message;
+    EXPECT_EQ(next_message[thread_index]++, index);
+  }
+  for (int count : next_message) {
+    EXPECT_EQ(kNumMessages, count);
+  }
+}
+
+TEST(LogTest, AsyncLoggingDropsMessagesWhenBufferIsFull) {
+  // Blocks the background thread in the first message.
+  class BlockingSink : public LogSink {
+   public:
+    void OnLogMessage(const std::string& message) override {
+      if (num_messages_++ == 0) {
+        blocked_.Set();
+        unblock_.Wait(Event::kForever);
+      }
+      messages_ += message;
+    }
+
+    Event blocked_;
+    Event unblock_;
+    int num_messages_ = 0;
+    std::string messages_;
+  } sink;
+  LogMessage::AddLogToStream(&sink, LS_INFO);
+  LogMessage::StartAsyncLogging();
+
+  RTC_LOG(LS_INFO) << "first";
+  ASSERT_TRUE(sink.blocked_.Wait(1000));
+  const std::string message(100, 'X');
+  for (int i = 0; i < 2000; ++i) {
+    RTC_LOG(LS_INFO) << message;
+  }
+  sink.unblock_.Set();
+  LogMessage::StopAsyncLogging();
+  LogMessage::RemoveLogToStream(&sink);
+
+  // The first message and the warning are written as well.
+  const int num_written = sink.num_messages_ - 2;
+  EXPECT_GT(num_written, 0);
+  EXPECT_LT(num_written, 2000);
+  const std::string warning =
+      "Dropped " + std::to_string(2000 - num_written) + " log messages";
+  EXPECT_NE(std::string::npos, sink.messages_.find(warning));
+}
+
+TEST(LogTest, AsyncLoggingWritesLargeMessagesInOrder) {
+  MessageCollector sink;
+  LogMessage::AddLogToStream(&sink, LS_INFO);
+  LogMessage::StartAsyncLogging();
+  const std::string large_message(100000, 'X');
+  RTC_LOG(LS_INFO) << "before";
+  RTC_LOG(LS_INFO) << large_message;
+  RTC_LOG(LS_INFO) << "after";
+  LogMessage::StopAsyncLogging();
+  LogMessage::RemoveLogToStream(&sink);
+
+  const std::vector<std::string> messages = sink.messages();
+  ASSERT_EQ(3u, messages.size());
+  EXPECT_NE(std::string::npos, messages[0].find("before"));
+  EXPECT_NE(std::string::npos, messages[1].find(large_message));
+  EXPECT_NE(std::string::npos, messages[2].find("after"));
+}
+
+// Measures the time RTC_LOG takes on the logging threads, with synchronous and
+// asynchronous logging.
+TEST(LogTest, DISABLED_PerfWithThreads) {
+  constexpr int kNumMessages = 20000;
+  constexpr int kBatchSize = 200;
+  class NullSink : public LogSink {
+    void OnLogMessage(const std::string& message) override {}
+  } sink;
+  const LoggingSeverity debug_severity = LogMessage::GetLogToDebug();
+  LogMessage::LogToDebug(LS_NONE);
+  LogMessage::AddLogToStream(&sink, LS_INFO);
+
+  struct Context {
+    int64_t elapsed_us = 0;
+  };
+  for (bool async : {false, true}) {
+    if (async) {
+      LogMessage::StartAsyncLogging();
+    }
+    for (int num_threads : {1, 2, 4, 8, 16}) {
+      std::vector<Context> contexts(num_threads);
+      std::vector<std::unique_ptr<PlatformThread>> threads;
+      for (Context& context : contexts) {
+        threads.emplace_back(new PlatformThread(
+            [](void* context) {
+              int64_t elapsed_us = 0;
+              for (int i = 0; i < kNumMessages; i += kBatchSize) {
+                const int64_t start_us = TimeMicros();
+                for (int j = i; j < i + kBatchSize; ++j) {
+                  RTC_LOG(LS_INFO) << "Message " << j << " of "
+                                   << kNumMessages
+                                   << ", which is a typical log line.";
+                }
+                elapsed_us += TimeMicros() - start_us;
+                // Stay below the rate at which messages are dropped.
+                LogMessage::FlushAsyncLogging();
+              }
+              static_cast<Context*>(context)->elapsed_us = elapsed_us;
+            },
+            &context, "LogThread"));
+      }
+      for (auto& thread : threads) {
+        thread->Start();
+      }
+      int64_t total_us = 0;
+      for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->Stop();
+        total_us += contexts[i].elapsed_us;
+      }
+      printf("%s, %2d threads: %.0f ns per message\n",
+             async ? "Async" : "Sync", num_threads,
+             1000.0 * total_us / (num_threads * kNumMessages));
+    }
+    if (async) {
+      LogMessage::StopAsyncLogging();
+    }
+  }
+  LogMessage::RemoveLogToStream(&sink);
+  LogMessage::LogToDebug(debug_severity);
+}
+
 }  // namespace rtc
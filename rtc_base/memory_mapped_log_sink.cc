@@ -0,0 +1,460 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/memory_mapped_log_sink.h"
+
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#include "rtc_base/string_utils.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // WEBRTC_WIN
+
+#include <string.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/file_rotating_stream.h"
+
+// Note: We use fprintf for logging in this sink to avoid infinite loops when
+// logging.
+
+namespace rtc {
+
+namespace {
+
+// Longest time a message waits for the next file, if the background thread
+// can't keep up. Messages are dropped after that.
+constexpr int kMaxRotationWaitMs = 100;
+
+// Writing to the files must not page fault, so the pages are touched in
+// advance with this stride.
+constexpr size_t kPageSize = 4096;
+
+#if defined(WEBRTC_WIN)
+const char kPathDelimiter[] = "\\";
+
+bool DeleteFile(const std::string& file) {
+  return ::DeleteFileW(ToUtf16(file).c_str()) != 0;
+}
+
+bool MoveFile(const std::string& old_file, const std::string& new_file) {
+  return ::MoveFileExW(ToUtf16(old_file).c_str(), ToUtf16(new_file).c_str(),
+                       MOVEFILE_REPLACE_EXISTING) != 0;
+}
+#else
+const char kPathDelimiter[] = "/";
+
+bool DeleteFile(const std::string& file) {
+  return ::unlink(file.c_str()) == 0;
+}
+
+bool MoveFile(const std::string& old_file, const std::string& new_file) {
+  return ::rename(old_file.c_str(), new_file.c_str()) == 0;
+}
+
+// Allocates the disk space of the first |size| bytes of the file. Only
+// extending the file with ftruncate() would leave it sparse, and writing to a
+// mapped page that can't be allocated then raises SIGBUS, e.g. once the disk
+// is full.
+bool AllocateFile(int fd, size_t size) {
+#if defined(WEBRTC_MAC)
+  fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0,
+                    static_cast<off_t>(size), 0};
+  if (::fcntl(fd, F_PREALLOCATE, &store) == -1) {
+    store.fst_flags = F_ALLOCATEALL;
+    if (::fcntl(fd, F_PREALLOCATE, &store) == -1) {
+      return false;
+    }
+  }
+  return ::ftruncate(fd, size) == 0;
+#else
+  int error;
+  do {
+    error = ::posix_fallocate(fd, 0, size);
+  } while (error == EINTR);
+  return error == 0;
+#endif
+}
+#endif  // WEBRTC_WIN
+
+std::string AddTrailingPathDelimiterIfNeeded(const std::string& directory) {
+  if (!directory.empty() && directory.back() == kPathDelimiter[0]) {
+    return directory;
+  }
+  return directory + kPathDelimiter;
+}
+
+}  // namespace
+
+// A file of a fixed size that is mapped for writing.
+class MemoryMappedRotatingLogSink::MappedFile {
+ public:
+  // Creates |path| with |size| bytes and maps it. Returns null and deletes the
+  // file if its space can't be allocated.
+  static std::unique_ptr<MappedFile> Create(const std::string& path,
+                                            size_t size);
+  ~MappedFile();
+
+  char* data() { return data_; }
+
+  // Unmaps the file and trims it to |size| bytes.
+  void Close(size_t size);
+
+ private:
+  MappedFile() = default;
+
+#if defined(WEBRTC_WIN)
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+  char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+std::unique_ptr<MemoryMappedRotatingLogSink::MappedFile>
+MemoryMappedRotatingLogSink::MappedFile::Create(const std::string& path,
+                                                size_t size) {
+  std::unique_ptr<MappedFile> file(new MappedFile());
+  file->size_ = size;
+#if defined(WEBRTC_WIN)
+  // Sharing deletion allows renaming the file while it is open.
+  file->file_ = ::CreateFileW(ToUtf16(path).c_str(),
+                              GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file->file_ == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+  // Creating the mapping extends the file, which isn't sparse, so this fails
+  // if the disk is full.
+  const uint64_t size64 = size;
+  file->mapping_ = ::CreateFileMappingW(
+      file->file_, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+      static_cast<DWORD>(size64), nullptr);
+  if (!file->mapping_) {
+    return nullptr;
+  }
+  void* data = ::MapViewOfFile(file->mapping_, FILE_MAP_WRITE, 0, 0, size);
+  if (!data) {
+    return nullptr;
+  }
+#else
+  file->fd_ =
+      ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (file->fd_ < 0) {
+    return nullptr;
+  }
+  if (!AllocateFile(file->fd_, size)) {
+    DeleteFile(path);
+    return nullptr;
+  }
+  void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      file->fd_, 0);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+#endif
+  file->data_ = static_cast<char*>(data);
+  volatile char* pages = file->data_;
+  for (size_t i = 0; i < size; i += kPageSize) {
+    pages[i] = 0;
+  }
+  return file;
+}
+
+MemoryMappedRotatingLogSink::MappedFile::~MappedFile() {
+#if defined(WEBRTC_WIN)
+  if (data_) {
+    ::UnmapViewOfFile(data_);
+  }
+  if (mapping_) {
+    ::CloseHandle(mapping_);
+  }
+  if (file_ != INVALID_HANDLE_VALUE) {
+    ::CloseHandle(file_);
+  }
+#else
+  if (data_) {
+    ::munmap(data_, size_);
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+#endif
+}
+
+void MemoryMappedRotatingLogSink::MappedFile::Close(size_t size) {
+  RTC_DCHECK_LE(size, size_);
+#if defined(WEBRTC_WIN)
+  ::UnmapViewOfFile(data_);
+  ::CloseHandle(mapping_);
+  mapping_ = nullptr;
+  LARGE_INTEGER end;
+  end.QuadPart = size;
+  if (!::SetFilePointerEx(file_, end, nullptr, FILE_BEGIN) ||
+      !::SetEndOfFile(file_)) {
+    std::fprintf(stderr, "Failed to trim log file.\n");
+  }
+  ::CloseHandle(file_);
+  file_ = INVALID_HANDLE_VALUE;
+#else
+  ::munmap(data_, size_);
+  if (::ftruncate(fd_, size) != 0) {
+    std::fprintf(stderr, "Failed to trim log file.\n");
+  }
+  ::close(fd_);
+  fd_ = -1;
+#endif
+  data_ = nullptr;
+}
+
+constexpr uint8_t MemoryMappedRotatingLogSink::kFrameMagic;
+
+MemoryMappedRotatingLogSink::MemoryMappedRotatingLogSink(
+    const std::string& log_dir_path,
+    const std::string& log_prefix,
+    size_t max_log_size,
+    size_t num_log_files,
+    Format format)
+    : dir_path_(AddTrailingPathDelimiterIfNeeded(log_dir_path)),
+      file_prefix_(log_prefix),
+      max_log_size_(max_log_size),
+      format_(format),
+      next_file_name_(dir_path_ + "." + log_prefix + "_next"),
+      thread_(&ThreadFunc, this, "MappedLogSink") {
+  RTC_DCHECK_GE(max_log_size, sizeof(FrameHeader));
+  RTC_DCHECK_GT(num_log_files, 1);
+  // Same names as FileRotatingStream.
+  const int max_digits = std::snprintf(nullptr, 0, "%zu", num_log_files - 1);
+  for (size_t i = 0; i < num_log_files; ++i) {
+    char file_postfix[32];
+    std::snprintf(file_postfix, sizeof(file_postfix), "_%0*zu", max_digits, i);
+    file_names_.push_back(dir_path_ + file_prefix_ + file_postfix);
+  }
+}
+
+MemoryMappedRotatingLogSink::~MemoryMappedRotatingLogSink() {
+  {
+    CritScope cs(&crit_);
+    stop_ = true;
+  }
+  wake_up_.Set();
+  // Finishes the renaming of the files that were rotated out.
+  thread_.Stop();
+  if (current_) {
+    current_->Close(current_size_);
+  }
+  CritScope cs(&crit_);
+  if (next_) {
+    next_->Close(0);
+    DeleteFile(next_file_name_);
+  }
+}
+
+bool MemoryMappedRotatingLogSink::Init() {
+  RTC_DCHECK(!current_);
+  for (const std::string& file_name : file_names_) {
+    DeleteFile(file_name);
+  }
+  DeleteFile(next_file_name_);
+  current_ = MappedFile::Create(file_names_[0], max_log_size_);
+  if (!current_) {
+    std::fprintf(stderr, "Failed to create: %s\n", file_names_[0].c_str());
+    return false;
+  }
+  thread_.Start();
+  return true;
+}
+
+void MemoryMappedRotatingLogSink::OnLogMessage(const std::string& message) {
+  Write(LS_NONE, nullptr, 0, message);
+}
+
+void MemoryMappedRotatingLogSink::OnLogMessage(const std::string& message,
+                                               LoggingSeverity severity) {
+  Write(severity, nullptr, 0, message);
+}
+
+void MemoryMappedRotatingLogSink::OnLogMessage(const std::string& message,
+                                               LoggingSeverity severity,
+                                               const char* tag) {
+  Write(severity, tag, strlen(tag), message);
+}
+
+std::string MemoryMappedRotatingLogSink::GetFilePath(size_t index) const {
+  RTC_DCHECK_LT(index, file_names_.size());
+  return file_names_[index];
+}
+
+std::vector<MemoryMappedRotatingLogSink::FramedMessage>
+MemoryMappedRotatingLogSink::ReadFramedLog(const std::string& log_dir_path,
+                                           const std::string& log_prefix) {
+  FileRotatingStreamReader reader(log_dir_path, log_prefix);
+  std::vector<char> data(reader.GetSize());
+  data.resize(reader.ReadAll(data.data(), data.size()));
+
+  std::vector<FramedMessage> messages;
+  size_t pos = 0;
+  while (pos + sizeof(FrameHeader) <= data.size()) {
+    // Skip the padding at the end of a file that wasn't trimmed.
+    if (data[pos] == 0) {
+      ++pos;
+      continue;
+    }
+    FrameHeader header;
+    memcpy(&header, &data[pos], sizeof(header));
+    pos += sizeof(header);
+    if (header.magic != kFrameMagic || header.severity > LS_NONE ||
+        header.tag_size + header.message_size > data.size() - pos) {
+      std::fprintf(stderr, "Corrupt log frame.\n");
+      break;
+    }
+    FramedMessage message;
+    message.severity = static_cast<LoggingSeverity>(header.severity);
+    message.tag.assign(&data[pos], header.tag_size);
+    pos += header.tag_size;
+    message.message.assign(&data[pos], header.message_size);
+    pos += header.message_size;
+    messages.push_back(std::move(message));
+  }
+  return messages;
+}
+
+void MemoryMappedRotatingLogSink::Write(LoggingSeverity severity,
+                                        const char* tag,
+                                        size_t tag_size,
+                                        const std::string& message) {
+  if (!current_) {
+    std::fprintf(stderr, "Init() must be called before adding this sink.\n");
+    return;
+  }
+  // The text format separates the tag with ": ".
+  size_t header_size = 0;
+  if (format_ == Format::kFramed) {
+    header_size = sizeof(FrameHeader);
+    tag_size = std::min<size_t>(tag_size, UINT16_MAX);
+  } else if (tag) {
+    header_size = 2;
+  }
+  tag_size = std::min(tag_size, max_log_size_ - header_size);
+  const size_t message_size =
+      std::min(message.size(), max_log_size_ - header_size - tag_size);
+  const size_t size = header_size + tag_size + message_size;
+  if (current_size_ + size > max_log_size_ && !Rotate()) {
+    return;
+  }
+
+  char* dest = current_->data() + current_size_;
+  if (format_ == Format::kFramed) {
+    FrameHeader header;
+    header.magic = kFrameMagic;
+    header.severity = static_cast<uint8_t>(severity);
+    header.tag_size = static_cast<uint16_t>(tag_size);
+    header.message_size = static_cast<uint32_t>(message_size);
+    memcpy(dest, &header, sizeof(header));
+    // |tag| is null for untagged messages.
+    if (tag_size) {
+      memcpy(dest + header_size, tag, tag_size);
+    }
+  } else if (tag) {
+    memcpy(dest, tag, tag_size);
+    memcpy(dest + tag_size, ": ", 2);
+  }
+  memcpy(dest + header_size + tag_size, message.data(), message_size);
+  current_size_ += size;
+}
+
+bool MemoryMappedRotatingLogSink::Rotate() {
+  // The next file is usually ready long before it's needed.
+  if (!next_ready_.Wait(rotation_behind_ ? 0 : kMaxRotationWaitMs)) {
+    if (!rotation_behind_) {
+      std::fprintf(stderr, "Log file rotation is behind, dropping messages.\n");
+      rotation_behind_ = true;
+    }
+    return false;
+  }
+  rotation_behind_ = false;
+  {
+    CritScope cs(&crit_);
+    RTC_DCHECK(next_);
+    retired_.push_back({std::move(current_), current_size_});
+    current_ = std::move(next_);
+  }
+  current_size_ = 0;
+  wake_up_.Set();
+  return true;
+}
+
+void MemoryMappedRotatingLogSink::ThreadFunc(void* context) {
+  static_cast<MemoryMappedRotatingLogSink*>(context)->Run();
+}
+
+void MemoryMappedRotatingLogSink::Run() {
+  while (true) {
+    std::vector<RetiredFile> retired;
+    bool stop;
+    bool has_next;
+    {
+      CritScope cs(&crit_);
+      retired.swap(retired_);
+      stop = stop_;
+      has_next = next_ != nullptr;
+    }
+    for (RetiredFile& file : retired) {
+      file.file->Close(file.size);
+      ShiftFiles();
+    }
+    if (stop) {
+      return;
+    }
+    if (!has_next) {
+      std::unique_ptr<MappedFile> next =
+          MappedFile::Create(next_file_name_, max_log_size_);
+      if (next) {
+        {
+          CritScope cs(&crit_);
+          next_ = std::move(next);
+        }
+        next_ready_.Set();
+      } else {
+        std::fprintf(stderr, "Failed to create: %s\n",
+                     next_file_name_.c_str());
+        // Try again later.
+        wake_up_.Wait(kMaxRotationWaitMs);
+        continue;
+      }
+    }
+    wake_up_.Wait(Event::kForever);
+  }
+}
+
+void MemoryMappedRotatingLogSink::ShiftFiles() {
+  // The oldest file doesn't exist until all files have been used.
+  DeleteFile(file_names_.back());
+  for (size_t i = file_names_.size() - 1; i > 0; --i) {
+    MoveFile(file_names_[i - 1], file_names_[i]);
+  }
+  if (!MoveFile(next_file_name_, file_names_[0])) {
+    std::fprintf(stderr, "Failed to move: %s to %s\n", next_file_name_.c_str(),
+                 file_names_[0].c_str());
+  }
+}
+
+}  // namespace rtc
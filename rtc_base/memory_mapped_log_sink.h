@@ -0,0 +1,151 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_MEMORY_MAPPED_LOG_SINK_H_
+#define RTC_BASE_MEMORY_MAPPED_LOG_SINK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// Log sink that writes to memory mapped files, which are rotated like the files
+// of FileRotatingLogSink and can be read with FileRotatingStreamReader.
+//
+// Logging a message is a copy into the mapping of the current file, without
+// any system calls. A background thread creates, allocates and maps the next
+// file ahead of time, and once the current file is full, the sink just
+// switches to it. A file whose disk space cannot be allocated is not used.
+// Renaming the files, trimming the full file to the written size and deleting
+// the oldest file is also left to the background thread. A message never
+// spans two files; one that is larger than a file is truncated.
+//
+// Since the data is in the page cache as soon as it is written, the logs
+// survive a crash of the process. The files are then padded with zeros up to
+// the file size.
+//
+// The OnLogMessage() calls must not be concurrent, which the LogMessage
+// ensures. Init() must be called before adding this sink.
+class MemoryMappedRotatingLogSink : public LogSink {
+ public:
+  enum class Format {
+    // The messages as text, with the tag prepended, like FileRotatingLogSink.
+    kText,
+    // Each message is a FrameHeader followed by the tag and the message, in
+    // host byte order. See ReadFramedLog().
+    kFramed,
+  };
+
+  struct FrameHeader {
+    uint8_t magic;
+    uint8_t severity;
+    uint16_t tag_size;
+    uint32_t message_size;
+  };
+  static constexpr uint8_t kFrameMagic = 0xA5;
+
+  struct FramedMessage {
+    LoggingSeverity severity;
+    std::string tag;
+    std::string message;
+  };
+
+  // |num_log_files| must be greater than 1 and |max_log_size| must be at least
+  // the size of a FrameHeader.
+  MemoryMappedRotatingLogSink(const std::string& log_dir_path,
+                              const std::string& log_prefix,
+                              size_t max_log_size,
+                              size_t num_log_files,
+                              Format format = Format::kText);
+  // Trims the current file to the written size.
+  ~MemoryMappedRotatingLogSink() override;
+
+  // Deletes the files of an earlier sink with the same prefix and number of
+  // files, and creates the first log file.
+  bool Init();
+
+  void OnLogMessage(const std::string& message) override;
+  void OnLogMessage(const std::string& message,
+                    LoggingSeverity severity) override;
+  void OnLogMessage(const std::string& message,
+                    LoggingSeverity severity,
+                    const char* tag) override;
+
+  // Returns the path of the i-th newest file, like
+  // FileRotatingStream::GetFilePath().
+  std::string GetFilePath(size_t index) const;
+
+  // Returns the messages of a log written with Format::kFramed, oldest first.
+  static std::vector<FramedMessage> ReadFramedLog(
+      const std::string& log_dir_path,
+      const std::string& log_prefix);
+
+ private:
+  class MappedFile;
+
+  struct RetiredFile {
+    std::unique_ptr<MappedFile> file;
+    size_t size;
+  };
+
+  void Write(LoggingSeverity severity,
+             const char* tag,
+             size_t tag_size,
+             const std::string& message);
+  // Switches to the file prepared by the background thread. Returns false if
+  // it isn't ready in time.
+  bool Rotate();
+
+  static void ThreadFunc(void* context);
+  void Run();
+  // Renames the files so that the current file is the 0th one.
+  void ShiftFiles();
+
+  const std::string dir_path_;
+  const std::string file_prefix_;
+  const size_t max_log_size_;
+  const Format format_;
+  std::vector<std::string> file_names_;
+  // The next file is created under this name and renamed when it is used.
+  const std::string next_file_name_;
+
+  // Only used by the writer.
+  std::unique_ptr<MappedFile> current_;
+  size_t current_size_ = 0;
+  // Set when the next file wasn't ready in time, so that the following
+  // messages are dropped without waiting until it is.
+  bool rotation_behind_ = false;
+
+  CriticalSection crit_;
+  std::unique_ptr<MappedFile> next_ RTC_GUARDED_BY(crit_);
+  std::vector<RetiredFile> retired_ RTC_GUARDED_BY(crit_);
+  bool stop_ RTC_GUARDED_BY(crit_) = false;
+  // Set by the background thread when |next_| is ready.
+  Event next_ready_;
+  Event wake_up_;
+  PlatformThread thread_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(MemoryMappedRotatingLogSink);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_MEMORY_MAPPED_LOG_SINK_H_
@@ -0,0 +1,216 @@
+/*
+ *  Copyright 2019 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/memory_mapped_log_sink.h"
+
+#include <stdio.h>
+
+#if defined(WEBRTC_POSIX)
+#include <signal.h>
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rtc_base/file_rotating_stream.h"
+#include "rtc_base/log_sinks.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/file_utils.h"
+
+namespace rtc {
+namespace {
+
+using Format = MemoryMappedRotatingLogSink::Format;
+
+const char kFilePrefix[] = "MemoryMappedRotatingLogSinkTest";
+
+std::string NumberedMessage(int index) {
+  char message[32];
+  snprintf(message, sizeof(message), "message %03d\n", index);
+  return message;
+}
+
+class MemoryMappedRotatingLogSinkTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_path_ = webrtc::test::OutputPath() +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    ASSERT_TRUE(webrtc::test::CreateDir(dir_path_));
+  }
+
+  void TearDown() override {
+    sink_.reset();
+    for (const std::string& file_path : file_paths_) {
+      // Not all files are expected to exist.
+      webrtc::test::RemoveFile(file_path);
+    }
+    EXPECT_TRUE(webrtc::test::RemoveDir(dir_path_));
+  }
+
+  void CreateSink(size_t max_log_size, size_t num_log_files, Format format) {
+    sink_.reset(new MemoryMappedRotatingLogSink(
+        dir_path_, kFilePrefix, max_log_size, num_log_files, format));
+    ASSERT_TRUE(sink_->Init());
+    for (size_t i = 0; i < num_log_files; ++i) {
+      file_paths_.push_back(sink_->GetFilePath(i));
+    }
+  }
+
+  // Destroys the sink, which trims the current file, and reads the log.
+  std::string CloseAndReadAll() {
+    sink_.reset();
+    FileRotatingStreamReader reader(dir_path_, kFilePrefix);
+    std::string log(reader.GetSize(), '\0');
+    log.resize(reader.ReadAll(&log[0], log.size()));
+    return log;
+  }
+
+  std::string dir_path_;
+  std::vector<std::string> file_paths_;
+  std::unique_ptr<MemoryMappedRotatingLogSink> sink_;
+};
+
+}  // namespace
+
+TEST_F(MemoryMappedRotatingLogSinkTest, WritesTextLikeFileRotatingLogSink) {
+  CreateSink(1000, 2, Format::kText);
+  sink_->OnLogMessage("first\n");
+  sink_->OnLogMessage("second\n", LS_WARNING);
+  sink_->OnLogMessage("third\n", LS_INFO, "tag");
+  EXPECT_EQ("first\nsecond\ntag: third\n", CloseAndReadAll());
+}
+
+TEST_F(MemoryMappedRotatingLogSinkTest, KeepsNewestFiles) {
+  constexpr int kNumMessages = 100;
+  // Eight 12 byte messages fit in a file.
+  CreateSink(100, 3, Format::kText);
+  for (int i = 0; i < kNumMessages; ++i) {
+    sink_->OnLogMessage(NumberedMessage(i));
+  }
+  const std::string log = CloseAndReadAll();
+
+  // Two full files and the current one, with the 4 messages since the last
+  // rotation.
+  std::string expected_log;
+  for (int i = kNumMessages - 2 * 8 - 4; i < kNumMessages; ++i) {
+    expected_log += NumberedMessage(i);
+  }
+  EXPECT_EQ(expected_log, log);
+  for (const std::string& file_path : file_paths_) {
+    EXPECT_TRUE(webrtc::test::FileExists(file_path));
+  }
+}
+
+TEST_F(MemoryMappedRotatingLogSinkTest, WritesFramedMessages) {
+  constexpr int kNumMessages = 50;
+  CreateSink(200, 4, Format::kFramed);
+  for (int i = 0; i < kNumMessages; ++i) {
+    if (i % 2 == 0) {
+      sink_->OnLogMessage(NumberedMessage(i), LS_WARNING, "tag");
+    } else {
+      sink_->OnLogMessage(NumberedMessage(i), LS_ERROR);
+    }
+  }
+  sink_.reset();
+
+  const std::vector<MemoryMappedRotatingLogSink::FramedMessage> messages =
+      MemoryMappedRotatingLogSink::ReadFramedLog(dir_path_, kFilePrefix);
+  // At least eight frames of 23 or 20 bytes fit in a file, and three of the
+  // four files are full.
+  ASSERT_GE(messages.size(), 3u * 8);
+  const int first = kNumMessages - static_cast<int>(messages.size());
+  for (size_t i = 0; i < messages.size(); ++i) {
+    const int index = first + static_cast<int>(i);
+    EXPECT_EQ(NumberedMessage(index), messages[i].message);
+    EXPECT_EQ(index % 2 == 0 ? LS_WARNING : LS_ERROR, messages[i].severity);
+    EXPECT_EQ(index % 2 == 0 ? "tag" : "", messages[i].tag);
+  }
+}
+
+TEST_F(MemoryMappedRotatingLogSinkTest, TruncatesMessagesLargerThanFile) {
+  CreateSink(10, 2, Format::kText);
+  sink_->OnLogMessage("0123456789abcdef");
+  EXPECT_EQ("0123456789", CloseAndReadAll());
+}
+
+#if defined(WEBRTC_POSIX)
+// The space of the files is allocated up front, so that writing to the mapping
+// can't fail later. Lowering the file size limit fails the allocation like a
+// full disk.
+TEST_F(MemoryMappedRotatingLogSinkTest, InitFailsIfFileCantBeAllocated) {
+  MemoryMappedRotatingLogSink sink(dir_path_, kFilePrefix, 64 * 1024, 2,
+                                   Format::kText);
+  struct rlimit limit;
+  ASSERT_EQ(0, getrlimit(RLIMIT_FSIZE, &limit));
+  struct rlimit low_limit = limit;
+  low_limit.rlim_cur = 1024;
+  // Exceeding the limit raises SIGXFSZ, which terminates the process by
+  // default.
+  struct sigaction ignore = {};
+  ignore.sa_handler = SIG_IGN;
+  struct sigaction old_action;
+  ASSERT_EQ(0, sigaction(SIGXFSZ, &ignore, &old_action));
+  ASSERT_EQ(0, setrlimit(RLIMIT_FSIZE, &low_limit));
+  const bool initialized = sink.Init();
+  setrlimit(RLIMIT_FSIZE, &limit);
+  sigaction(SIGXFSZ, &old_action, nullptr);
+
+  EXPECT_FALSE(initialized);
+  EXPECT_FALSE(webrtc::test::FileExists(sink.GetFilePath(0)));
+}
+#endif  // defined(WEBRTC_POSIX)
+
+// Compares the throughput and the worst case time of a write of the memory
+// mapped sink with FileRotatingLogSink.
+TEST_F(MemoryMappedRotatingLogSinkTest, DISABLED_Benchmark) {
+  constexpr size_t kMaxLogSize = 4 * 1024 * 1024;
+  constexpr size_t kNumLogFiles = 4;
+  constexpr size_t kTotalSize = 256 * 1024 * 1024;
+  const std::string message(120, 'X');
+
+  for (int type = 0; type < 3; ++type) {
+    std::unique_ptr<LogSink> sink;
+    const char* name;
+    if (type == 0) {
+      FileRotatingLogSink* file_sink = new FileRotatingLogSink(
+          dir_path_, kFilePrefix, kMaxLogSize, kNumLogFiles);
+      ASSERT_TRUE(file_sink->Init());
+      sink.reset(file_sink);
+      name = "FileRotatingLogSink";
+    } else {
+      CreateSink(kMaxLogSize, kNumLogFiles,
+                 type == 1 ? Format::kText : Format::kFramed);
+      sink = std::move(sink_);
+      name = type == 1 ? "Memory mapped, text" : "Memory mapped, framed";
+    }
+
+    std::vector<int64_t> write_ns;
+    write_ns.reserve(kTotalSize / message.size() + 1);
+    const int64_t start_ns = TimeNanos();
+    for (size_t written = 0; written < kTotalSize; written += message.size()) {
+      const int64_t write_start_ns = TimeNanos();
+      sink->OnLogMessage(message, LS_INFO);
+      write_ns.push_back(TimeNanos() - write_start_ns);
+    }
+    const int64_t elapsed_ns = TimeNanos() - start_ns;
+    sink.reset();
+    std::sort(write_ns.begin(), write_ns.end());
+    printf("%s: %.0f MB/s, 99.99th percentile %.1f us, max %.1f us\n", name,
+           1000.0 * kTotalSize / elapsed_ns,
+           write_ns[write_ns.size() * 9999 / 10000] / 1000.0,
+           write_ns.back() / 1000.0);
+  }
+}
+
+}  // namespace rtc
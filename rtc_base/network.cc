@@ -397,12 +397,13 @@ void NetworkManagerBase::MergeNetworkList(const NetworkList& new_networks,
   // and re-sort it.
   if (*changed) {
     networks_ = merged_list;
-    // Reset the active states of all networks.
+    // Reset the active states of all networks. Only the networks in the newly
+    // generated |networks_| are active.
     for (const auto& kv : networks_map_) {
-      Network* network = kv.second;
-      // If |network| is in the newly generated |networks_|, it is active.
-      bool found = absl::c_linear_search(networks_, network);
-      network->set_active(found);
+      kv.second->set_active(false);
+    }
+    for (Network* network : networks_) {
+      network->set_active(true);
     }
     absl::c_sort(networks_, SortNetworks);
     // Now network interfaces are sorted, we should set the preference value
@@ -946,7 +947,13 @@ void BasicNetworkManager::UpdateNetworksOnce() {
 }
 
 void BasicNetworkManager::UpdateNetworksContinually() {
-  UpdateNetworksOnce();
+  // While the monitor reports every change, the networks are only updated when
+  // it does. The timer keeps running, so that polling resumes if the monitor
+  // fails.
+  if (!sent_first_update_ || !network_monitor_ ||
+      !network_monitor_->ReportsAllNetworkChanges()) {
+    UpdateNetworksOnce();
+  }
   thread_->PostDelayed(RTC_FROM_HERE, kNetworksUpdateIntervalMs, this,
                        kUpdateNetworksMessage);
 }
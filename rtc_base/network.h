@@ -276,7 +276,8 @@ class BasicNetworkManager : public NetworkManagerBase,
   // Called when it receives updates from the network monitor.
   void OnNetworksChanged();
 
-  // Updates the networks and reschedules the next update.
+  // Updates the networks, unless the network monitor reports all changes, and
+  // reschedules the next update.
   void UpdateNetworksContinually();
   // Only updates the networks; does not reschedule the next update.
   void UpdateNetworksOnce();
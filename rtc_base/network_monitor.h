@@ -75,6 +75,11 @@ class NetworkMonitorInterface {
   virtual AdapterType GetAdapterType(const std::string& interface_name) = 0;
   virtual AdapterType GetVpnUnderlyingAdapterType(
       const std::string& interface_name) = 0;
+
+  // Returns true if OnNetworksChanged() is currently called for every change
+  // of the network interfaces and their addresses, so that they don't need to
+  // be polled. May change at any time, e.g. when the monitor fails.
+  virtual bool ReportsAllNetworkChanges() const { return false; }
 };
 
 class NetworkMonitorBase : public NetworkMonitorInterface,
@@ -10,6 +10,7 @@
 
 #include "rtc_base/network.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include <memory>
@@ -18,6 +19,7 @@
 #include "rtc_base/checks.h"
 #include "rtc_base/net_helpers.h"
 #include "rtc_base/network_monitor.h"
+#include "rtc_base/time_utils.h"
 #if defined(WEBRTC_POSIX)
 #include <net/if.h>
 #include <sys/types.h>
@@ -43,6 +45,12 @@ class FakeNetworkMonitor : public NetworkMonitorBase {
   void Start() override { started_ = true; }
   void Stop() override { started_ = false; }
   bool started() { return started_; }
+  void set_reports_all_network_changes(bool value) {
+    reports_all_network_changes_ = value;
+  }
+  bool ReportsAllNetworkChanges() const override {
+    return reports_all_network_changes_;
+  }
   AdapterType GetAdapterType(const std::string& if_name) override {
     // Note that the name matching rules are different from the
     // GetAdapterTypeFromName in NetworkManager.
@@ -57,6 +65,7 @@ class FakeNetworkMonitor : public NetworkMonitorBase {
 
  private:
   bool started_ = false;
+  bool reports_all_network_changes_ = false;
 };
 
 class FakeNetworkMonitorFactory : public NetworkMonitorFactory {
@@ -113,6 +122,9 @@ class NetworkTest : public ::testing::Test, public sigslot::has_slots<> {
     return static_cast<FakeNetworkMonitor*>(
         network_manager.network_monitor_.get());
   }
+  void UpdateNetworksContinually(BasicNetworkManager& network_manager) {
+    network_manager.UpdateNetworksContinually();
+  }
   void ClearNetworks(BasicNetworkManager& network_manager) {
     for (const auto& kv : network_manager.networks_map_) {
       delete kv.second;
@@ -906,6 +918,35 @@ TEST_F(NetworkTest, TestGetAdapterTypeFromNameMatching) {
   ReleaseIfAddrs(addr_list);
 #endif
 }
+
+// Reports how long a poll of the interfaces blocks the network thread on a
+// host with 500 interfaces, such as the veth interfaces of containers. A
+// network monitor that reports all changes avoids the polls.
+TEST_F(NetworkTest, DISABLED_PollManyInterfacesBenchmark) {
+  constexpr int kNumInterfaces = 500;
+  constexpr int kNumPolls = 100;
+  char names[kNumInterfaces][IFNAMSIZ];
+  ifaddrs* addr_list = nullptr;
+  for (int i = 0; i < kNumInterfaces; ++i) {
+    snprintf(names[i], IFNAMSIZ, "veth%d", i);
+    char ip[32];
+    snprintf(ip, sizeof(ip), "10.%d.%d.1", i / 256, i % 256);
+    addr_list = AddIpv4Address(addr_list, names[i], ip, "255.255.255.0");
+  }
+
+  BasicNetworkManager manager;
+  const int64_t start_us = TimeMicros();
+  for (int i = 0; i < kNumPolls; ++i) {
+    NetworkManager::NetworkList list;
+    CallConvertIfAddrs(manager, addr_list, false, &list);
+    bool changed;
+    MergeNetworkList(manager, list, &changed);
+  }
+  printf("%d interfaces: %.2f ms per poll\n", kNumInterfaces,
+         (TimeMicros() - start_us) / 1000.0 / kNumPolls);
+  ClearNetworks(manager);
+  ReleaseIfAddrs(addr_list);
+}
 #endif  // defined(WEBRTC_POSIX)
 
 #if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
@@ -1099,6 +1140,39 @@ TEST_F(NetworkTest, TestNetworkMonitoring) {
   NetworkMonitorFactory::ReleaseFactory(factory);
 }
 
+TEST_F(NetworkTest, PollsOnlyWhileNetworkMonitorDoesNotReportAllChanges) {
+  BasicNetworkManager manager;
+  manager.SignalNetworksChanged.connect(static_cast<NetworkTest*>(this),
+                                        &NetworkTest::OnNetworksChanged);
+  FakeNetworkMonitorFactory* factory = new FakeNetworkMonitorFactory();
+  NetworkMonitorFactory::SetFactory(factory);
+  manager.StartUpdating();
+  FakeNetworkMonitor* network_monitor = GetNetworkMonitor(manager);
+  network_monitor->set_reports_all_network_changes(true);
+  EXPECT_TRUE_WAIT(callback_called_, 1000);
+  callback_called_ = false;
+
+  // The poll doesn't list the interfaces, but the next one is scheduled.
+  ClearNetworks(manager);
+  UpdateNetworksContinually(manager);
+  EXPECT_FALSE(callback_called_);
+  EXPECT_FALSE(Thread::Current()->empty());
+
+  // Changes are reported by the monitor.
+  network_monitor->OnNetworksChanged();
+  EXPECT_TRUE_WAIT(callback_called_, 1000);
+  callback_called_ = false;
+
+  // Polling resumes when the monitor fails.
+  network_monitor->set_reports_all_network_changes(false);
+  ClearNetworks(manager);
+  UpdateNetworksContinually(manager);
+  EXPECT_TRUE(callback_called_);
+
+  manager.StopUpdating();
+  NetworkMonitorFactory::ReleaseFactory(factory);
+}
+
 // Fails on Android: https://bugs.chromium.org/p/webrtc/issues/detail?id=4364.
 #if defined(WEBRTC_ANDROID)
 #define MAYBE_DefaultLocalAddress DISABLED_DefaultLocalAddress
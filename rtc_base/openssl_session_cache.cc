@@ -9,8 +9,15 @@
  */
 
 #include "rtc_base/openssl_session_cache.h"
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <string.h>
+
 #include "rtc_base/checks.h"
 #include "rtc_base/openssl.h"
+#include "rtc_base/time_utils.h"
 
 namespace rtc {
 
@@ -49,4 +56,136 @@ SSLMode OpenSSLSessionCache::GetSSLMode() const {
   return ssl_mode_;
 }
 
+// The session ID context of the server contexts. OpenSSL doesn't resume
+// sessions without one when the peer certificate is verified.
+static const unsigned char kDtlsSessionIdContext[] = "WebRTC DTLS";
+
+OpenSSLDtlsSessionCache::OpenSSLDtlsSessionCache(size_t max_sessions)
+    : max_sessions_(max_sessions),
+      current_ticket_key_(CreateTicketKey(TimeMillis())) {
+  RTC_DCHECK_GT(max_sessions, 0);
+}
+
+OpenSSLDtlsSessionCache::~OpenSSLDtlsSessionCache() {
+  for (const auto& it : sessions_) {
+    SSL_SESSION_free(it.second);
+  }
+}
+
+size_t OpenSSLDtlsSessionCache::GetSize() const {
+  CritScope cs(&crit_);
+  return sessions_.size();
+}
+
+bool OpenSSLDtlsSessionCache::ConfigureContext(SSL_CTX* ssl_ctx) const {
+  // Tickets can't be resumed for longer than their key is accepted.
+  SSL_CTX_set_timeout(ssl_ctx, 2 * kTicketKeyRotationIntervalMs /
+                                   kNumMillisecsPerSec);
+  return SSL_CTX_set_session_id_context(ssl_ctx, kDtlsSessionIdContext,
+                                        sizeof(kDtlsSessionIdContext)) == 1;
+}
+
+int OpenSSLDtlsSessionCache::SetUpTicketCipher(uint8_t* key_name,
+                                               uint8_t* iv,
+                                               EVP_CIPHER_CTX* cipher_ctx,
+                                               HMAC_CTX* hmac_ctx,
+                                               bool encrypt) {
+  const int64_t now_ms = TimeMillis();
+  TicketKey key;
+  bool renew = false;
+  {
+    CritScope cs(&crit_);
+    MaybeRotateTicketKeys(now_ms);
+    if (encrypt) {
+      key = current_ticket_key_;
+    } else if (memcmp(key_name, current_ticket_key_.name,
+                      sizeof(key.name)) == 0) {
+      key = current_ticket_key_;
+    } else if (previous_ticket_key_ &&
+               memcmp(key_name, previous_ticket_key_->name,
+                      sizeof(key.name)) == 0 &&
+               now_ms - previous_ticket_key_->created_ms <
+                   2 * kTicketKeyRotationIntervalMs) {
+      key = *previous_ticket_key_;
+      renew = true;
+    } else {
+      return 0;
+    }
+  }
+
+  const EVP_CIPHER* cipher = EVP_aes_128_cbc();
+  if (encrypt) {
+    memcpy(key_name, key.name, sizeof(key.name));
+    if (RAND_bytes(iv, EVP_CIPHER_iv_length(cipher)) != 1 ||
+        EVP_EncryptInit_ex(cipher_ctx, cipher, nullptr, key.aes_key, iv) !=
+            1) {
+      return -1;
+    }
+  } else if (EVP_DecryptInit_ex(cipher_ctx, cipher, nullptr, key.aes_key,
+                                iv) != 1) {
+    return -1;
+  }
+  if (HMAC_Init_ex(hmac_ctx, key.hmac_key, sizeof(key.hmac_key), EVP_sha256(),
+                   nullptr) != 1) {
+    return -1;
+  }
+  return renew ? 2 : 1;
+}
+
+// static
+OpenSSLDtlsSessionCache::TicketKey OpenSSLDtlsSessionCache::CreateTicketKey(
+    int64_t now_ms) {
+  TicketKey key;
+  RTC_CHECK(RAND_bytes(key.name, sizeof(key.name)));
+  RTC_CHECK(RAND_bytes(key.hmac_key, sizeof(key.hmac_key)));
+  RTC_CHECK(RAND_bytes(key.aes_key, sizeof(key.aes_key)));
+  key.created_ms = now_ms;
+  return key;
+}
+
+void OpenSSLDtlsSessionCache::MaybeRotateTicketKeys(int64_t now_ms) {
+  const int64_t age_ms = now_ms - current_ticket_key_.created_ms;
+  if (age_ms < kTicketKeyRotationIntervalMs) {
+    return;
+  }
+  // After a long pause, the tickets of the current key have expired too.
+  if (age_ms < 2 * kTicketKeyRotationIntervalMs) {
+    previous_ticket_key_ = current_ticket_key_;
+  } else {
+    previous_ticket_key_.reset();
+  }
+  current_ticket_key_ = CreateTicketKey(now_ms);
+}
+
+SSL_SESSION* OpenSSLDtlsSessionCache::LookupSession(
+    const std::string& key) const {
+  CritScope cs(&crit_);
+  auto it = sessions_.find(key);
+  if (it == sessions_.end()) {
+    return nullptr;
+  }
+  SSL_SESSION_up_ref(it->second);
+  return it->second;
+}
+
+void OpenSSLDtlsSessionCache::AddSession(const std::string& key,
+                                         SSL_SESSION* session) {
+  SSL_SESSION_up_ref(session);
+  CritScope cs(&crit_);
+  auto it = sessions_.find(key);
+  if (it != sessions_.end()) {
+    SSL_SESSION_free(it->second);
+    it->second = session;
+    return;
+  }
+  if (sessions_.size() == max_sessions_) {
+    auto oldest = sessions_.find(keys_.front());
+    SSL_SESSION_free(oldest->second);
+    sessions_.erase(oldest);
+    keys_.pop_front();
+  }
+  sessions_[key] = session;
+  keys_.push_back(key);
+}
+
 }  // namespace rtc
@@ -12,11 +12,17 @@
 #define RTC_BASE_OPENSSL_SESSION_CACHE_H_
 
 #include <openssl/ossl_typ.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
 #include <map>
 #include <string>
 
+#include "absl/types/optional.h"
 #include "rtc_base/constructor_magic.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/thread_annotations.h"
 
 #ifndef OPENSSL_IS_BORINGSSL
 typedef struct ssl_session_st SSL_SESSION;
@@ -62,6 +68,65 @@ class OpenSSLSessionCache final {
   RTC_DISALLOW_COPY_AND_ASSIGN(OpenSSLSessionCache);
 };
 
+// The SSLSessionCache of OpenSSLStreamAdapter. Unlike OpenSSLSessionCache, it
+// is shared by adapters that each have their own SSL_CTX, so it only supports
+// resumption with session tickets: the server contexts encrypt the tickets with
+// the rotating ticket keys of the cache, and the client sessions are kept by a
+// key that identifies both certificates of the connection.
+class OpenSSLDtlsSessionCache : public SSLSessionCache {
+ public:
+  explicit OpenSSLDtlsSessionCache(size_t max_sessions);
+  ~OpenSSLDtlsSessionCache() override;
+
+  size_t GetSize() const override;
+
+  // Makes |ssl_ctx| resume sessions and expire their tickets with the ticket
+  // keys. The tickets themselves are set up by SetUpTicketCipher(), from the
+  // ticket key callback of |ssl_ctx|. Returns false on failure.
+  bool ConfigureContext(SSL_CTX* ssl_ctx) const;
+  // Implements the ticket key callback of SSL_CTX_set_tlsext_ticket_key_cb().
+  // A ticket is issued with the current ticket key, and accepted while its key
+  // is at most two rotation intervals old. Returns 1 on success, 2 if the
+  // ticket of an older key should be renewed, 0 if its key is unknown or
+  // expired, and -1 on failure.
+  int SetUpTicketCipher(uint8_t* key_name,
+                        uint8_t* iv,
+                        EVP_CIPHER_CTX* cipher_ctx,
+                        HMAC_CTX* hmac_ctx,
+                        bool encrypt);
+  // Looks up a session by key. The returned SSL_SESSION is up_refed, and must
+  // be freed by the caller.
+  SSL_SESSION* LookupSession(const std::string& key) const;
+  // Adds a session to the cache, and up_refs it. Any existing session with the
+  // same key is replaced.
+  void AddSession(const std::string& key, SSL_SESSION* session);
+
+ private:
+  struct TicketKey {
+    uint8_t name[16];
+    uint8_t hmac_key[32];
+    uint8_t aes_key[16];
+    int64_t created_ms;
+  };
+
+  static TicketKey CreateTicketKey(int64_t now_ms);
+  // Replaces the current ticket key once it is a rotation interval old.
+  void MaybeRotateTicketKeys(int64_t now_ms)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  const size_t max_sessions_;
+
+  CriticalSection crit_;
+  TicketKey current_ticket_key_ RTC_GUARDED_BY(crit_);
+  // The key that was current before, whose tickets are still accepted.
+  absl::optional<TicketKey> previous_ticket_key_ RTC_GUARDED_BY(crit_);
+  std::map<std::string, SSL_SESSION*> sessions_ RTC_GUARDED_BY(crit_);
+  // Keys of |sessions_|, oldest first.
+  std::deque<std::string> keys_ RTC_GUARDED_BY(crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(OpenSSLDtlsSessionCache);
+};
+
 }  // namespace rtc
 
 #endif  // RTC_BASE_OPENSSL_SESSION_CACHE_H_
@@ -333,6 +333,7 @@ bool OpenSSLStreamAdapter::SetPeerCertificateDigest(
   }
 
   if (state_ == SSL_CONNECTED) {
+    MaybeAddSessionToCache();
     // Post the event asynchronously to unwind the stack. The caller
     // of ContinueSSL may be the same object listening for these
     // events and may not be prepared for reentrancy.
@@ -399,6 +400,10 @@ int OpenSSLStreamAdapter::GetSslVersion() const {
   return -1;
 }
 
+bool OpenSSLStreamAdapter::IsSessionResumed() const {
+  return state_ == SSL_CONNECTED && SSL_session_reused(ssl_);
+}
+
 // Key Extractor interface
 bool OpenSSLStreamAdapter::ExportKeyingMaterial(const std::string& label,
                                                 const uint8_t* context,
@@ -505,6 +510,12 @@ void OpenSSLStreamAdapter::SetInitialRetransmissionTimeout(int timeout_ms) {
   dtls_handshake_timeout_ms_ = timeout_ms;
 }
 
+void OpenSSLStreamAdapter::SetSessionCache(
+    const scoped_refptr<SSLSessionCache>& session_cache) {
+  RTC_DCHECK(ssl_ctx_ == nullptr);
+  session_cache_ = static_cast<OpenSSLDtlsSessionCache*>(session_cache.get());
+}
+
 //
 // StreamInterface Implementation
 //
@@ -812,6 +823,15 @@ int OpenSSLStreamAdapter::BeginSSL() {
   SSL_set_mode(ssl_, SSL_MODE_ENABLE_PARTIAL_WRITE |
                          SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 
+  if (session_cache_ && ssl_mode_ == SSL_MODE_DTLS && role_ == SSL_CLIENT) {
+    SSL_SESSION* session = session_cache_->LookupSession(GetSessionCacheKey());
+    if (session) {
+      RTC_LOG(LS_INFO) << "Offering to resume a cached session.";
+      SSL_set_session(ssl_, session);
+      SSL_SESSION_free(session);
+    }
+  }
+
   // Do the connect
   return ContinueSSL();
 }
@@ -829,11 +849,15 @@ int OpenSSLStreamAdapter::ContinueSSL() {
   switch (ssl_error) {
     case SSL_ERROR_NONE:
       RTC_LOG(LS_VERBOSE) << " -- success";
+      if (SSL_session_reused(ssl_) && !SetPeerCertificateFromSession()) {
+        return -1;
+      }
       // By this point, OpenSSL should have given us a certificate, or errored
       // out if one was missing.
       RTC_DCHECK(peer_cert_chain_ || !GetClientAuthEnabled());
 
       state_ = SSL_CONNECTED;
+      MaybeAddSessionToCache();
       if (!WaitingToVerifyPeerCertificate()) {
         // We have everything we need to start the connection, so signal
         // SE_OPEN. If we need a client certificate fingerprint and don't have
@@ -1016,6 +1040,14 @@ SSL_CTX* OpenSSLStreamAdapter::SetupSSLContext() {
     }
   }
 
+  if (session_cache_ && ssl_mode_ == SSL_MODE_DTLS) {
+    if (!session_cache_->ConfigureContext(ctx)) {
+      SSL_CTX_free(ctx);
+      return nullptr;
+    }
+    SSL_CTX_set_tlsext_ticket_key_cb(ctx, SSLTicketKeyCallback);
+  }
+
   return ctx;
 }
 
@@ -1093,6 +1125,66 @@ int OpenSSLStreamAdapter::SSLVerifyCallback(X509_STORE_CTX* store, void* arg) {
   return 1;
 }
 
+// static
+int OpenSSLStreamAdapter::SSLTicketKeyCallback(SSL* ssl,
+                                               uint8_t* key_name,
+                                               uint8_t* iv,
+                                               EVP_CIPHER_CTX* cipher_ctx,
+                                               HMAC_CTX* hmac_ctx,
+                                               int encrypt) {
+  OpenSSLStreamAdapter* stream =
+      reinterpret_cast<OpenSSLStreamAdapter*>(SSL_get_app_data(ssl));
+  return stream->session_cache_->SetUpTicketCipher(key_name, iv, cipher_ctx,
+                                                   hmac_ctx, encrypt != 0);
+}
+
+std::string OpenSSLStreamAdapter::GetSessionCacheKey() const {
+  if (!identity_ || !HasPeerCertificateDigest()) {
+    return std::string();
+  }
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  size_t digest_length;
+  if (!identity_->certificate().ComputeDigest(DIGEST_SHA_256, digest,
+                                              sizeof(digest), &digest_length)) {
+    return std::string();
+  }
+  std::string key(reinterpret_cast<const char*>(digest), digest_length);
+  key += peer_certificate_digest_algorithm_;
+  key.append(peer_certificate_digest_value_.data<char>(),
+             peer_certificate_digest_value_.size());
+  return key;
+}
+
+bool OpenSSLStreamAdapter::SetPeerCertificateFromSession() {
+  X509* cert = SSL_get_peer_certificate(ssl_);
+  if (!cert) {
+    RTC_LOG(LS_WARNING) << "Resumed a session without a peer certificate.";
+    return role_ == SSL_SERVER && !GetClientAuthEnabled();
+  }
+  peer_cert_chain_.reset(
+      new SSLCertChain(absl::make_unique<OpenSSLCertificate>(cert)));
+  X509_free(cert);
+
+  if (!HasPeerCertificateDigest()) {
+    RTC_LOG(LS_INFO) << "Waiting to verify certificate until digest is known.";
+    return true;
+  }
+  return VerifyPeerCertificate();
+}
+
+void OpenSSLStreamAdapter::MaybeAddSessionToCache() {
+  if (!session_cache_ || ssl_mode_ != SSL_MODE_DTLS || role_ != SSL_CLIENT ||
+      !peer_certificate_verified_) {
+    return;
+  }
+  // Each adapter has its own SSL_CTX, so only sessions with a ticket can be
+  // resumed by another one.
+  SSL_SESSION* session = SSL_get_session(ssl_);
+  if (session && SSL_SESSION_has_ticket(session)) {
+    session_cache_->AddSession(GetSessionCacheKey(), session);
+  }
+}
+
 bool OpenSSLStreamAdapter::IsBoringSsl() {
 #ifdef OPENSSL_IS_BORINGSSL
   return true;
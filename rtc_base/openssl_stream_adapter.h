@@ -19,9 +19,11 @@
 #include <string>
 #include <vector>
 
+#include "api/scoped_refptr.h"
 #include "rtc_base/buffer.h"
 #include "rtc_base/message_queue.h"
 #include "rtc_base/openssl_identity.h"
+#include "rtc_base/openssl_session_cache.h"
 #include "rtc_base/ssl_identity.h"
 #include "rtc_base/ssl_stream_adapter.h"
 #include "rtc_base/stream.h"
@@ -79,6 +81,9 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   void SetMode(SSLMode mode) override;
   void SetMaxProtocolVersion(SSLProtocolVersion version) override;
   void SetInitialRetransmissionTimeout(int timeout_ms) override;
+  // |session_cache| must have been created with SSLSessionCache::Create().
+  void SetSessionCache(
+      const scoped_refptr<SSLSessionCache>& session_cache) override;
 
   StreamResult Read(void* data,
                     size_t data_len,
@@ -97,6 +102,7 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   bool GetSslCipherSuite(int* cipher) override;
 
   int GetSslVersion() const override;
+  bool IsSessionResumed() const override;
 
   // Key Extractor interface
   bool ExportKeyingMaterial(const std::string& label,
@@ -174,6 +180,25 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   // SSL certificate verification callback. See
   // SSL_CTX_set_cert_verify_callback.
   static int SSLVerifyCallback(X509_STORE_CTX* store, void* arg);
+  // Sets up the encryption of the session tickets with the keys of
+  // |session_cache_|, see SSL_CTX_set_tlsext_ticket_key_cb.
+  static int SSLTicketKeyCallback(SSL* ssl,
+                                  uint8_t* key_name,
+                                  uint8_t* iv,
+                                  EVP_CIPHER_CTX* cipher_ctx,
+                                  HMAC_CTX* hmac_ctx,
+                                  int encrypt);
+
+  // Returns the key of the sessions between our certificate and the peer
+  // certificate in |session_cache_|, or an empty string if either isn't known.
+  std::string GetSessionCacheKey() const;
+  // Records the peer certificate of a resumed session, for which the
+  // verification callback isn't called, and verifies it if the digest is
+  // known. Returns false if the verification fails.
+  bool SetPeerCertificateFromSession();
+  // Adds the session to |session_cache_| in the client role, once the peer
+  // certificate is verified.
+  void MaybeAddSessionToCache();
 
   bool WaitingToVerifyPeerCertificate() const {
     return GetClientAuthEnabled() && !peer_certificate_verified_;
@@ -217,6 +242,8 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   // A 50-ms initial timeout ensures rapid setup on fast connections, but may
   // be too aggressive for low bandwidth links.
   int dtls_handshake_timeout_ms_ = 50;
+
+  scoped_refptr<OpenSSLDtlsSessionCache> session_cache_;
 };
 
 /////////////////////////////////////////////////////////////////////////////
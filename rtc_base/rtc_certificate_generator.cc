@@ -16,6 +16,7 @@
 #include <utility>
 
 #include "rtc_base/checks.h"
+#include "rtc_base/crypto_worker_pool.h"
 #include "rtc_base/location.h"
 #include "rtc_base/message_handler.h"
 #include "rtc_base/message_queue.h"
@@ -140,6 +141,18 @@ RTCCertificateGenerator::RTCCertificateGenerator(Thread* signaling_thread,
   RTC_DCHECK(worker_thread_);
 }
 
+RTCCertificateGenerator::RTCCertificateGenerator(
+    Thread* signaling_thread,
+    scoped_refptr<CryptoWorkerPool> crypto_worker_pool)
+    : signaling_thread_(signaling_thread),
+      worker_thread_(nullptr),
+      crypto_worker_pool_(std::move(crypto_worker_pool)) {
+  RTC_DCHECK(signaling_thread_);
+  RTC_DCHECK(crypto_worker_pool_);
+}
+
+RTCCertificateGenerator::~RTCCertificateGenerator() = default;
+
 void RTCCertificateGenerator::GenerateCertificateAsync(
     const KeyParams& key_params,
     const absl::optional<uint64_t>& expires_ms,
@@ -147,6 +160,12 @@ void RTCCertificateGenerator::GenerateCertificateAsync(
   RTC_DCHECK(signaling_thread_->IsCurrent());
   RTC_DCHECK(callback);
 
+  if (crypto_worker_pool_) {
+    crypto_worker_pool_->GenerateCertificateAsync(key_params, expires_ms,
+                                                  signaling_thread_, callback);
+    return;
+  }
+
   // Create a new |RTCCertificateGenerationTask| for this generation request. It
   // is reference counted and referenced by the message data, ensuring it lives
   // until the task has completed (independent of |RTCCertificateGenerator|).
@@ -22,6 +22,8 @@
 
 namespace rtc {
 
+class CryptoWorkerPool;
+
 // See |RTCCertificateGeneratorInterface::GenerateCertificateAsync|.
 class RTCCertificateGeneratorCallback : public RefCountInterface {
  public:
@@ -52,7 +54,8 @@ class RTCCertificateGeneratorInterface {
 // Standard implementation of |RTCCertificateGeneratorInterface|.
 // The static function |GenerateCertificate| generates a certificate on the
 // current thread. The |RTCCertificateGenerator| instance generates certificates
-// asynchronously on the worker thread with |GenerateCertificateAsync|.
+// asynchronously on the worker thread with |GenerateCertificateAsync|, or on a
+// |CryptoWorkerPool|, which may have them generated already.
 class RTCCertificateGenerator : public RTCCertificateGeneratorInterface {
  public:
   // Generates a certificate on the current thread. Returns null on failure.
@@ -65,7 +68,9 @@ class RTCCertificateGenerator : public RTCCertificateGeneratorInterface {
       const absl::optional<uint64_t>& expires_ms);
 
   RTCCertificateGenerator(Thread* signaling_thread, Thread* worker_thread);
-  ~RTCCertificateGenerator() override {}
+  RTCCertificateGenerator(Thread* signaling_thread,
+                          scoped_refptr<CryptoWorkerPool> crypto_worker_pool);
+  ~RTCCertificateGenerator() override;
 
   // |RTCCertificateGeneratorInterface| overrides.
   // If |expires_ms| is specified, the certificate will expire in approximately
@@ -80,6 +85,7 @@ class RTCCertificateGenerator : public RTCCertificateGeneratorInterface {
  private:
   Thread* const signaling_thread_;
   Thread* const worker_thread_;
+  const scoped_refptr<CryptoWorkerPool> crypto_worker_pool_;
 };
 
 }  // namespace rtc
@@ -10,7 +10,13 @@
 
 #include "rtc_base/third_party/sigslot/sigslot.h"
 
+#include <stdio.h>
+
+#include <memory>
+#include <vector>
+
 #include "rtc_base/sigslot_repeater.h"
+#include "rtc_base/time_utils.h"
 #include "test/gtest.h"
 
 // This function, when passed a has_slots or signalx, will break the build if
@@ -382,3 +388,193 @@ TEST(SigslotRepeaterTest, StopsRepeatingSignalsAfterStopCalled) {
   signal();
   EXPECT_EQ(1, receiver.signal_count());
 }
+
+// Counts the calls from a single_threaded_signal<int> and can disconnect
+// others when called.
+class SingleThreadedReceiver : public sigslot::has_slots<> {
+ public:
+  SingleThreadedReceiver() = default;
+  SingleThreadedReceiver(const SingleThreadedReceiver&) = default;
+
+  void Connect(sigslot::single_threaded_signal<int>* signal) {
+    signal_ = signal;
+    signal->connect(this, &SingleThreadedReceiver::OnSignal);
+  }
+  void DisconnectWhenCalled(SingleThreadedReceiver* receiver) {
+    to_disconnect_ = receiver;
+  }
+  void DisconnectAllWhenCalled() { disconnect_all_ = true; }
+
+  void OnSignal(int value) {
+    ++signal_count_;
+    sum_ += value;
+    if (to_disconnect_) {
+      signal_->disconnect(to_disconnect_);
+    }
+    if (disconnect_all_) {
+      signal_->disconnect_all();
+    }
+  }
+
+  int signal_count() const { return signal_count_; }
+  int sum() const { return sum_; }
+
+ private:
+  sigslot::single_threaded_signal<int>* signal_ = nullptr;
+  SingleThreadedReceiver* to_disconnect_ = nullptr;
+  bool disconnect_all_ = false;
+  int signal_count_ = 0;
+  int sum_ = 0;
+};
+
+TEST(SigslotSingleThreadedSignalTest, CallsSlotsInOrderOfConnecting) {
+  sigslot::single_threaded_signal<int> signal;
+  EXPECT_TRUE(signal.is_empty());
+  // More receivers than fit inline.
+  SingleThreadedReceiver receivers[4];
+  for (SingleThreadedReceiver& receiver : receivers) {
+    receiver.Connect(&signal);
+  }
+  EXPECT_FALSE(signal.is_empty());
+  signal(3);
+  signal(4);
+  for (const SingleThreadedReceiver& receiver : receivers) {
+    EXPECT_EQ(2, receiver.signal_count());
+    EXPECT_EQ(7, receiver.sum());
+  }
+  signal.disconnect(&receivers[1]);
+  signal(1);
+  EXPECT_EQ(3, receivers[0].signal_count());
+  EXPECT_EQ(2, receivers[1].signal_count());
+  EXPECT_EQ(3, receivers[3].signal_count());
+}
+
+TEST(SigslotSingleThreadedSignalTest, DestroyingSlotDisconnects) {
+  sigslot::single_threaded_signal<int> signal;
+  SingleThreadedReceiver receiver1;
+  {
+    SingleThreadedReceiver receiver2;
+    receiver2.Connect(&signal);
+    receiver1.Connect(&signal);
+  }
+  signal(1);
+  EXPECT_EQ(1, receiver1.signal_count());
+}
+
+TEST(SigslotSingleThreadedSignalTest, DestroyingSignalDisconnects) {
+  SingleThreadedReceiver receiver;
+  {
+    sigslot::single_threaded_signal<int> signal;
+    receiver.Connect(&signal);
+    signal(1);
+  }
+  // The receiver would access the destroyed signal if it was still connected.
+  EXPECT_EQ(1, receiver.signal_count());
+}
+
+TEST(SigslotSingleThreadedSignalTest, CopiesConnections) {
+  sigslot::single_threaded_signal<int> signal;
+  SingleThreadedReceiver receiver;
+  receiver.Connect(&signal);
+  sigslot::single_threaded_signal<int> copied_signal(signal);
+  SingleThreadedReceiver copied_receiver(receiver);
+  signal(1);
+  copied_signal(1);
+  EXPECT_EQ(2, receiver.signal_count());
+  EXPECT_EQ(2, copied_receiver.signal_count());
+}
+
+TEST(SigslotSingleThreadedSignalTest, DisconnectWhileFiring) {
+  sigslot::single_threaded_signal<int> signal;
+  SingleThreadedReceiver receivers[5];
+  for (SingleThreadedReceiver& receiver : receivers) {
+    receiver.Connect(&signal);
+  }
+  // An earlier and a later slot are disconnected by the third one.
+  receivers[2].DisconnectWhenCalled(&receivers[0]);
+  signal(1);
+  receivers[2].DisconnectWhenCalled(&receivers[3]);
+  signal(1);
+  EXPECT_EQ(1, receivers[0].signal_count());
+  EXPECT_EQ(2, receivers[1].signal_count());
+  EXPECT_EQ(2, receivers[2].signal_count());
+  EXPECT_EQ(1, receivers[3].signal_count());
+  EXPECT_EQ(2, receivers[4].signal_count());
+}
+
+TEST(SigslotSingleThreadedSignalTest, DisconnectAllWhileFiring) {
+  sigslot::single_threaded_signal<int> signal;
+  SingleThreadedReceiver receivers[3];
+  for (SingleThreadedReceiver& receiver : receivers) {
+    receiver.Connect(&signal);
+  }
+  receivers[1].DisconnectAllWhenCalled();
+  signal(1);
+  EXPECT_TRUE(signal.is_empty());
+  EXPECT_EQ(1, receivers[0].signal_count());
+  EXPECT_EQ(1, receivers[1].signal_count());
+  EXPECT_EQ(0, receivers[2].signal_count());
+}
+
+// Receives packets like the slots of a socket's SignalReadPacket.
+class PacketReceiver : public sigslot::has_slots<> {
+ public:
+  void OnPacket(void* socket,
+                const char* data,
+                size_t size,
+                const int64_t& packet_time_us) {
+    bytes_ += size;
+  }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  size_t bytes_ = 0;
+};
+
+// Emits packets to |num_signals| signals in turn, like the signals of the
+// sockets of many connections, and prints the time per packet.
+template <typename Signal>
+void EmitPackets(const char* name, int num_signals, int num_slots) {
+  constexpr int kNumPackets = 10000000;
+  std::vector<std::unique_ptr<Signal>> signals;
+  std::vector<std::unique_ptr<PacketReceiver>> receivers;
+  for (int i = 0; i < num_signals; ++i) {
+    signals.emplace_back(new Signal());
+  }
+  for (int i = 0; i < num_signals * num_slots; ++i) {
+    receivers.emplace_back(new PacketReceiver());
+    signals[i % num_signals]->connect(receivers.back().get(),
+                                      &PacketReceiver::OnPacket);
+  }
+  // Visit the signals in an order unrelated to their addresses.
+  std::vector<Signal*> order;
+  for (int i = 0; i < num_signals; ++i) {
+    order.push_back(signals[(i * 7919) % num_signals].get());
+  }
+
+  const char packet[100] = {0};
+  const int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumPackets; ++i) {
+    (*order[i % num_signals])(nullptr, packet, sizeof(packet), start_us);
+  }
+  const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+  size_t bytes = 0;
+  for (const auto& receiver : receivers) {
+    bytes += receiver->bytes();
+  }
+  EXPECT_EQ(sizeof(packet) * kNumPackets * num_slots, bytes);
+  printf("%s, %d signal(s), %d slot(s): %.2f ns per packet\n", name,
+         num_signals, num_slots, 1000.0 * elapsed_us / kNumPackets);
+}
+
+TEST(SigslotSingleThreadedSignalTest, DISABLED_EmitPerformance) {
+  for (int num_signals : {1, 10000}) {
+    for (int num_slots : {1, 2}) {
+      EmitPackets<sigslot::signal<void*, const char*, size_t, const int64_t&>>(
+          "signal", num_signals, num_slots);
+      EmitPackets<sigslot::single_threaded_signal<void*, const char*, size_t,
+                                                  const int64_t&>>(
+          "single_threaded_signal", num_signals, num_slots);
+    }
+  }
+}
@@ -46,6 +46,7 @@ class SocketAddress {
 
   // Creates a copy of the given address.
   SocketAddress(const SocketAddress& addr);
+  SocketAddress(SocketAddress&& addr) = default;
 
   // Resets to the nil address.
   void Clear();
@@ -58,6 +59,7 @@ class SocketAddress {
 
   // Replaces our address with the given one.
   SocketAddress& operator=(const SocketAddress& addr);
+  SocketAddress& operator=(SocketAddress&& addr) = default;
 
   // Changes the IP of this address to the given one, and clears the hostname
   // IP is given as an integer in host byte order. V4 only, to be deprecated..
@@ -10,7 +10,9 @@
 
 #include "rtc_base/ssl_stream_adapter.h"
 
+#include "rtc_base/openssl_session_cache.h"
 #include "rtc_base/openssl_stream_adapter.h"
+#include "rtc_base/ref_counted_object.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -89,6 +91,13 @@ bool IsGcmCryptoSuiteName(const std::string& crypto_suite) {
           crypto_suite == CS_AEAD_AES_128_GCM);
 }
 
+constexpr int64_t SSLSessionCache::kTicketKeyRotationIntervalMs;
+
+// static
+scoped_refptr<SSLSessionCache> SSLSessionCache::Create(size_t max_sessions) {
+  return new RefCountedObject<OpenSSLDtlsSessionCache>(max_sessions);
+}
+
 SSLStreamAdapter* SSLStreamAdapter::Create(StreamInterface* stream) {
   return new OpenSSLStreamAdapter(stream);
 }
@@ -102,6 +111,10 @@ bool SSLStreamAdapter::GetSslCipherSuite(int* cipher_suite) {
   return false;
 }
 
+bool SSLStreamAdapter::IsSessionResumed() const {
+  return false;
+}
+
 bool SSLStreamAdapter::ExportKeyingMaterial(const std::string& label,
                                             const uint8_t* context,
                                             size_t context_len,
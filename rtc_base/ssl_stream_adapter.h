@@ -17,6 +17,8 @@
 #include <string>
 #include <vector>
 
+#include "api/scoped_refptr.h"
+#include "rtc_base/ref_count.h"
 #include "rtc_base/ssl_certificate.h"
 #include "rtc_base/ssl_identity.h"
 #include "rtc_base/stream.h"
@@ -110,6 +112,28 @@ enum { SSE_MSG_TRUNC = 0xff0001 };
 // Used to send back UMA histogram value. Logged when Dtls handshake fails.
 enum class SSLHandshakeError { UNKNOWN, INCOMPATIBLE_CIPHERSUITE, MAX_VALUE };
 
+// Keeps the DTLS sessions of SSLStreamAdapters, so that a later handshake
+// between the same certificates can resume a session with an abbreviated
+// handshake, which saves a round trip and the public key operations. Sessions
+// are resumed with session tickets; the cache holds the tickets of the client
+// role and the ticket keys of the server role. Thread safe, so that it can be
+// shared by the transports of a PeerConnectionFactory.
+class SSLSessionCache : public RefCountInterface {
+ public:
+  // The ticket keys are replaced after this interval, and the tickets of a key
+  // are accepted for two intervals.
+  static constexpr int64_t kTicketKeyRotationIntervalMs = 60 * 60 * 1000;
+
+  // Keeps up to |max_sessions|, dropping the oldest when full.
+  static scoped_refptr<SSLSessionCache> Create(size_t max_sessions = 100);
+
+  // Returns the number of cached sessions.
+  virtual size_t GetSize() const = 0;
+
+ protected:
+  ~SSLSessionCache() override = default;
+};
+
 class SSLStreamAdapter : public StreamAdapterInterface {
  public:
   // Instantiate an SSLStreamAdapter wrapping the given stream,
@@ -147,6 +171,14 @@ class SSLStreamAdapter : public StreamAdapterInterface {
   // This should only be called before StartSSL().
   virtual void SetInitialRetransmissionTimeout(int timeout_ms) = 0;
 
+  // Resumes a session of |session_cache| in the client role, if it has one
+  // with the same local certificate and peer certificate digest, and makes
+  // sessions resumable in the server role. The peer certificate is still
+  // verified against the digest on resumption. Only supported in DTLS mode.
+  // This should only be called before StartSSL().
+  virtual void SetSessionCache(
+      const scoped_refptr<SSLSessionCache>& session_cache) {}
+
   // StartSSL starts negotiation with a peer, whose certificate is verified
   // using the certificate digest. Generally, SetIdentity() and possibly
   // SetServerRole() should have been called before this.
@@ -189,6 +221,9 @@ class SSLStreamAdapter : public StreamAdapterInterface {
 
   virtual int GetSslVersion() const = 0;
 
+  // Returns true if the connection resumed a previous session.
+  virtual bool IsSessionResumed() const;
+
   // Key Exporter interface from RFC 5705
   // Arguments are:
   // label               -- the exporter label.
@@ -15,6 +15,7 @@
 
 #include "rtc_base/buffer_queue.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/fake_clock.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/helpers.h"
 #include "rtc_base/memory/fifo_buffer.h"
@@ -372,6 +373,32 @@ class SSLStreamAdapterTestBase : public ::testing::Test,
     server_ssl_->SetIdentity(server_identity_);
   }
 
+  // Replaces the streams and adapters with new ones that use the same
+  // identities, e.g. to repeat the handshake.
+  void RecreateAdapters() {
+    rtc::SSLIdentity* client_identity = client_identity_->GetReference();
+    rtc::SSLIdentity* server_identity = server_identity_->GetReference();
+    CreateStreams();
+
+    client_ssl_.reset(rtc::SSLStreamAdapter::Create(client_stream_));
+    server_ssl_.reset(rtc::SSLStreamAdapter::Create(server_stream_));
+
+    client_ssl_->SignalEvent.connect(this, &SSLStreamAdapterTestBase::OnEvent);
+    server_ssl_->SignalEvent.connect(this, &SSLStreamAdapterTestBase::OnEvent);
+
+    client_identity_ = client_identity;
+    server_identity_ = server_identity;
+    client_ssl_->SetIdentity(client_identity_);
+    server_ssl_->SetIdentity(server_identity_);
+    identities_set_ = false;
+  }
+
+  void SetSessionCache(
+      const rtc::scoped_refptr<rtc::SSLSessionCache>& session_cache) {
+    client_ssl_->SetSessionCache(session_cache);
+    server_ssl_->SetSessionCache(session_cache);
+  }
+
   virtual void OnEvent(rtc::StreamInterface* stream, int sig, int err) {
     RTC_LOG(LS_VERBOSE) << "SSLStreamAdapterTestBase::OnEvent sig=" << sig;
 
@@ -837,9 +864,9 @@ class SSLStreamAdapterTestDTLS
     for (;;) {
       r = stream->Read(buffer, 2000, &bread, &err2);
 
-      if (r == rtc::SR_ERROR) {
+      if (r == rtc::SR_ERROR || r == rtc::SR_EOS) {
         // Unfortunately, errors are the way that the stream adapter
-        // signals close right now
+        // signals close right now. An alert of the peer ends the stream.
         stream->Close();
         return;
       }
@@ -92,14 +92,21 @@
 // to connect or disconnect to signalx concurrently or data race may occur.
 // If signalx is single threaded the user must ensure that disconnect, connect
 // or signal is not happening concurrently or data race may occur.
+//
+// single_threaded_signal is a signal for the per packet paths. It connects to
+// the same has_slots as signalx, but keeps its connections in a vector with
+// inline storage instead of a std::list, and has no thread policy at all.
 
 #ifndef RTC_BASE_THIRD_PARTY_SIGSLOT_SIGSLOT_H_
 #define RTC_BASE_THIRD_PARTY_SIGSLOT_SIGSLOT_H_
 
+#include <algorithm>
 #include <cstring>
 #include <list>
 #include <set>
 
+#include "absl/container/inlined_vector.h"
+
 // On our copy of sigslot.h, we set single threading as default.
 #define SIGSLOT_DEFAULT_MT_POLICY single_threaded
 
@@ -317,6 +324,18 @@ class _opaque_connection {
     return res;
   }
 
+  // Returns a connection without destination that does nothing when emitted.
+  template <typename... Args>
+  _opaque_connection disconnected() const {
+    _opaque_connection res = *this;
+    res.pdest = nullptr;
+    typedef void (*em_t)(const _opaque_connection* self, Args...);
+    union_caster<em_t, emit_t> caster;
+    caster.from = &_opaque_connection::null_emitter<Args...>;
+    res.pemit = caster.to;
+    return res;
+  }
+
   // Just calls the stored "emitter" function pointer stored at construction
   // time.
   template <typename... Args>
@@ -335,6 +354,9 @@ class _opaque_connection {
     std::memcpy(&pm, self->pmethod, sizeof(pm_t));
     (static_cast<DestT*>(self->pdest)->*(pm))(args...);
   }
+
+  template <typename... Args>
+  static void null_emitter(const _opaque_connection* self, Args... args) {}
 };
 
 template <class mt_policy>
@@ -564,6 +586,149 @@ class signal_with_thread_policy : public _signal_base<mt_policy> {
   void operator()(Args... args) { emit(args...); }
 };
 
+// A signal that is only ever connected, disconnected and emitted on one
+// thread, like the signals of sockets and transports that fire for every
+// packet. The connections are contiguous and the first two are stored inline,
+// so emitting doesn't chase list nodes, and there's no lock_block to go
+// through. Slots may still connect and disconnect while the signal is firing.
+template <typename... Args>
+class single_threaded_signal : public _signal_base_interface {
+ private:
+  typedef absl::InlinedVector<_opaque_connection, 2> connections_list;
+
+ public:
+  single_threaded_signal()
+      : _signal_base_interface(&single_threaded_signal::do_slot_disconnect,
+                               &single_threaded_signal::do_slot_duplicate) {}
+
+  single_threaded_signal(const single_threaded_signal& o)
+      : _signal_base_interface(&single_threaded_signal::do_slot_disconnect,
+                               &single_threaded_signal::do_slot_duplicate) {
+    for (const auto& connection : o.m_connected_slots) {
+      if (connection.getdest()) {
+        connection.getdest()->signal_connect(this);
+        m_connected_slots.push_back(connection);
+      }
+    }
+  }
+
+  ~single_threaded_signal() { disconnect_all(); }
+
+  template <class desttype>
+  void connect(desttype* pclass, void (desttype::*pmemfun)(Args...)) {
+    m_connected_slots.push_back(_opaque_connection(pclass, pmemfun));
+    pclass->signal_connect(static_cast<_signal_base_interface*>(this));
+  }
+
+  bool is_empty() const {
+    for (const auto& connection : m_connected_slots) {
+      if (connection.getdest())
+        return false;
+    }
+    return true;
+  }
+
+  void disconnect_all() {
+    for (size_t i = m_connected_slots.size(); i > 0; --i) {
+      has_slots_interface* pdest = m_connected_slots[i - 1].getdest();
+      if (pdest) {
+        erase(i - 1);
+        pdest->signal_disconnect(static_cast<_signal_base_interface*>(this));
+      }
+    }
+  }
+
+#if !defined(NDEBUG)
+  bool connected(has_slots_interface* pclass) const {
+    for (const auto& connection : m_connected_slots) {
+      if (connection.getdest() == pclass)
+        return true;
+    }
+    return false;
+  }
+#endif
+
+  void disconnect(has_slots_interface* pclass) {
+    for (size_t i = 0; i < m_connected_slots.size(); ++i) {
+      if (m_connected_slots[i].getdest() == pclass) {
+        erase(i);
+        pclass->signal_disconnect(static_cast<_signal_base_interface*>(this));
+        return;
+      }
+    }
+  }
+
+  void emit(Args... args) {
+    // Slots that are connected while firing are called as well. The
+    // connection may move when that happens, but isn't accessed after its
+    // slot is called.
+    const bool nested = m_firing;
+    m_firing = true;
+    for (size_t i = 0; i < m_connected_slots.size(); ++i) {
+      m_connected_slots[i].template emit<Args...>(args...);
+    }
+    if (!nested) {
+      m_firing = false;
+      if (m_erased_while_firing) {
+        m_connected_slots.erase(
+            std::remove_if(m_connected_slots.begin(), m_connected_slots.end(),
+                           [](const _opaque_connection& connection) {
+                             return connection.getdest() == nullptr;
+                           }),
+            m_connected_slots.end());
+        m_erased_while_firing = false;
+      }
+    }
+  }
+
+  void operator()(Args... args) { emit(args...); }
+
+ private:
+  single_threaded_signal& operator=(single_threaded_signal const& that);
+
+  // While the signal is firing, the connection is only cleared, to keep the
+  // indices of the loop in emit() valid.
+  void erase(size_t index) {
+    if (m_firing) {
+      m_connected_slots[index] =
+          m_connected_slots[index].template disconnected<Args...>();
+      m_erased_while_firing = true;
+    } else {
+      m_connected_slots.erase(m_connected_slots.begin() + index);
+    }
+  }
+
+  static void do_slot_disconnect(_signal_base_interface* p,
+                                 has_slots_interface* pslot) {
+    single_threaded_signal* const self =
+        static_cast<single_threaded_signal*>(p);
+    for (size_t i = self->m_connected_slots.size(); i > 0; --i) {
+      if (self->m_connected_slots[i - 1].getdest() == pslot) {
+        self->erase(i - 1);
+      }
+    }
+  }
+
+  static void do_slot_duplicate(_signal_base_interface* p,
+                                const has_slots_interface* oldtarget,
+                                has_slots_interface* newtarget) {
+    single_threaded_signal* const self =
+        static_cast<single_threaded_signal*>(p);
+    const size_t size = self->m_connected_slots.size();
+    for (size_t i = 0; i < size; ++i) {
+      if (self->m_connected_slots[i].getdest() == oldtarget) {
+        self->m_connected_slots.push_back(
+            self->m_connected_slots[i].duplicate(newtarget));
+      }
+    }
+  }
+
+  // Ahead of the connections, to share their cache line.
+  bool m_firing = false;
+  bool m_erased_while_firing = false;
+  connections_list m_connected_slots;
+};
+
 // Alias with default thread policy. Needed because both default arguments
 // and variadic template arguments must go at the end of the list, so we
 // can't have both at once.
@@ -37,6 +37,15 @@ static inline void __cpuid(int cpu_info[4], int info_type) {
         "=d"(cpu_info[3])
       : "a"(info_type));
 }
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
+  __asm__ volatile(
+      "mov %%ebx, %%edi\n"
+      "cpuid\n"
+      "xchg %%edi, %%ebx\n"
+      : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]),
+        "=d"(cpu_info[3])
+      : "a"(info_type), "c"(sub_type));
+}
 #else
 static inline void __cpuid(int cpu_info[4], int info_type) {
   __asm__ volatile("cpuid\n"
@@ -44,10 +53,38 @@ static inline void __cpuid(int cpu_info[4], int info_type) {
                      "=d"(cpu_info[3])
                    : "a"(info_type));
 }
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
+  __asm__ volatile("cpuid\n"
+                   : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]),
+                     "=d"(cpu_info[3])
+                   : "a"(info_type), "c"(sub_type));
+}
 #endif
 #endif  // _MSC_VER
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(WEBRTC_ENABLE_AVX2)
+// Reads the extended control register |xcr| (requires OSXSAVE).
+static uint64_t xgetbv(uint32_t xcr) {
+#if defined(_MSC_VER)
+  return _xgetbv(xcr);
+#else
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(xcr));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif  // _MSC_VER
+}
+
+// Returns true if the CPU supports AVX and the OS saves the YMM registers on
+// context switches.
+static bool IsAvxEnabledByOs(const int cpu_info[4]) {
+  return (cpu_info[2] & 0x10000000) != 0 /* AVX */ &&
+         (cpu_info[2] & 0x04000000) != 0 /* XSAVE */ &&
+         (cpu_info[2] & 0x08000000) != 0 /* OSXSAVE */ &&
+         (xgetbv(0) & 0x00000006) == 6 /* XMM and YMM state enabled */;
+}
+#endif  // WEBRTC_ARCH_X86_FAMILY && WEBRTC_ENABLE_AVX2
+
 #if defined(WEBRTC_ARCH_X86_FAMILY)
 // Actual feature detection for x86.
 static int GetCPUInfo(CPUFeature feature) {
@@ -59,6 +96,23 @@ static int GetCPUInfo(CPUFeature feature) {
   if (feature == kSSE3) {
     return 0 != (cpu_info[2] & 0x00000001);
   }
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (feature == kAVX2 || feature == kFMA3) {
+    if (!IsAvxEnabledByOs(cpu_info)) {
+      return 0;
+    }
+    if (feature == kFMA3) {
+      return 0 != (cpu_info[2] & 0x00001000);
+    }
+    int cpu_info7[4];
+    __cpuid(cpu_info7, 0);
+    if (cpu_info7[0] < 7) {
+      return 0;
+    }
+    __cpuidex(cpu_info7, 7, 0);
+    return 0 != (cpu_info7[1] & 0x00000020);
+  }
+#endif  // WEBRTC_ENABLE_AVX2
   return 0;
 }
 #else
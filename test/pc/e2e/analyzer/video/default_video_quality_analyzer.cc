@@ -14,7 +14,9 @@
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "api/scoped_refptr.h"
 #include "api/units/time_delta.h"
+#include "api/video/i420_buffer.h"
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "rtc_base/logging.h"
 #include "test/testsupport/perf_test.h"
@@ -62,8 +64,13 @@ double RateCounter::GetEventsPerSecond() const {
          (event_last_time_ - event_first_time_).us() * kMicrosPerSecond;
 }
 
-DefaultVideoQualityAnalyzer::DefaultVideoQualityAnalyzer()
-    : clock_(Clock::GetRealTimeClock()) {}
+DefaultVideoQualityAnalyzer::DefaultVideoQualityAnalyzer(
+    int max_frames_in_flight_per_stream_count)
+    : clock_(Clock::GetRealTimeClock()),
+      max_frames_in_flight_per_stream_count_(
+          max_frames_in_flight_per_stream_count) {
+  RTC_CHECK_GT(max_frames_in_flight_per_stream_count, 0);
+}
 DefaultVideoQualityAnalyzer::~DefaultVideoQualityAnalyzer() {
   Stop();
 }
@@ -116,24 +123,28 @@ uint16_t DefaultVideoQualityAnalyzer::OnFrameCaptured(
     frame_counters_.captured++;
     stream_frame_counters_[stream_label].captured++;
 
-    StreamState* state = &stream_states_[stream_label];
-    state->frame_ids.push_back(frame_id);
     // Update frames in flight info.
-    auto it = captured_frames_in_flight_.find(frame_id);
-    if (it != captured_frames_in_flight_.end()) {
+    auto stats_it = frame_stats_.find(frame_id);
+    if (stats_it != frame_stats_.end()) {
       // We overflow uint16_t and hit previous frame id and this frame is still
-      // in flight. It means that this stream wasn't rendered for long time and
-      // we need to process existing frame as dropped.
-      auto stats_it = frame_stats_.find(frame_id);
-      RTC_DCHECK(stats_it != frame_stats_.end());
-
-      RTC_DCHECK(frame_id == state->frame_ids.front());
-      state->frame_ids.pop_front();
+      // in flight. It means that the stream of that frame wasn't rendered for
+      // long time and we need to process existing frame as dropped.
+      const std::string& dropped_stream_label = stats_it->second.stream_label;
+      StreamState* dropped_state = &stream_states_[dropped_stream_label];
+      RTC_DCHECK(frame_id == dropped_state->frame_ids.front());
+      dropped_state->frame_ids.pop_front();
       frame_counters_.dropped++;
-      stream_frame_counters_[stream_label].dropped++;
-      AddComparison(it->second, absl::nullopt, true, stats_it->second);
+      stream_frame_counters_[dropped_stream_label].dropped++;
+
+      absl::optional<VideoFrame> dropped_frame = absl::nullopt;
+      auto it = captured_frames_in_flight_.find(frame_id);
+      if (it != captured_frames_in_flight_.end()) {
+        dropped_frame = std::move(it->second);
+        captured_frames_in_flight_.erase(it);
+      }
+      AddComparison(std::move(dropped_frame), absl::nullopt, true,
+                    stats_it->second);
 
-      captured_frames_in_flight_.erase(it);
       frame_stats_.erase(stats_it);
     }
     captured_frames_in_flight_.insert(
@@ -142,6 +153,17 @@ uint16_t DefaultVideoQualityAnalyzer::OnFrameCaptured(
     captured_frames_in_flight_.at(frame_id).set_id(frame_id);
     frame_stats_.insert(std::pair<uint16_t, FrameStats>(
         frame_id, FrameStats(stream_label, /*captured_time=*/Now())));
+
+    StreamState* state = &stream_states_[stream_label];
+    state->frame_ids.push_back(frame_id);
+    // Release the video frame of the oldest frame, that still has it, if the
+    // stream has too many frames in flight. It's the most likely one to be
+    // dropped and for dropped frames the video frame isn't used anyway.
+    if (state->frame_ids.size() > max_frames_in_flight_per_stream_count_) {
+      captured_frames_in_flight_.erase(
+          state->frame_ids[state->frame_ids.size() -
+                           max_frames_in_flight_per_stream_count_ - 1]);
+    }
   }
   return frame_id;
 }
@@ -216,10 +238,14 @@ void DefaultVideoQualityAnalyzer::OnFrameRendered(
   frame_stats->rendered_frame_width = frame.width();
   frame_stats->rendered_frame_height = frame.height();
 
-  // Find corresponding captured frame.
+  // Find corresponding captured frame. It can be already released, if there
+  // were too many frames in flight in this stream.
+  absl::optional<VideoFrame> captured_frame = absl::nullopt;
   auto frame_it = captured_frames_in_flight_.find(frame.id());
-  RTC_DCHECK(frame_it != captured_frames_in_flight_.end());
-  const VideoFrame& captured_frame = frame_it->second;
+  if (frame_it != captured_frames_in_flight_.end()) {
+    captured_frame = std::move(frame_it->second);
+    captured_frames_in_flight_.erase(frame_it);
+  }
 
   // After we received frame here we need to check if there are any dropped
   // frames between this one and last one, that was rendered for this video
@@ -234,7 +260,8 @@ void DefaultVideoQualityAnalyzer::OnFrameRendered(
     state->frame_ids.pop_front();
     // Frame with id |dropped_frame_id| was dropped. We need:
     // 1. Update global and stream frame counters
-    // 2. Extract corresponding frame from |captured_frames_in_flight_|
+    // 2. Extract corresponding frame from |captured_frames_in_flight_| if it
+    //    wasn't released yet
     // 3. Extract corresponding frame stats from |frame_stats_|
     // 4. Send extracted frame to comparison with dropped=true
     // 5. Cleanup dropped frame
@@ -243,14 +270,17 @@ void DefaultVideoQualityAnalyzer::OnFrameRendered(
 
     auto dropped_frame_stats_it = frame_stats_.find(dropped_frame_id);
     RTC_DCHECK(dropped_frame_stats_it != frame_stats_.end());
+    absl::optional<VideoFrame> dropped_frame = absl::nullopt;
     auto dropped_frame_it = captured_frames_in_flight_.find(dropped_frame_id);
-    RTC_CHECK(dropped_frame_it != captured_frames_in_flight_.end());
+    if (dropped_frame_it != captured_frames_in_flight_.end()) {
+      dropped_frame = std::move(dropped_frame_it->second);
+      captured_frames_in_flight_.erase(dropped_frame_it);
+    }
 
-    AddComparison(dropped_frame_it->second, absl::nullopt, true,
+    AddComparison(std::move(dropped_frame), absl::nullopt, true,
                   dropped_frame_stats_it->second);
 
     frame_stats_.erase(dropped_frame_stats_it);
-    captured_frames_in_flight_.erase(dropped_frame_it);
   }
   RTC_DCHECK(!state->frame_ids.empty());
   state->frame_ids.pop_front();
@@ -262,12 +292,16 @@ void DefaultVideoQualityAnalyzer::OnFrameRendered(
   state->last_rendered_frame_time = frame_stats->rendered_time;
   {
     rtc::CritScope cr(&comparison_lock_);
-    stream_stats_[stream_label].skipped_between_rendered.AddSample(
-        dropped_count);
+    StreamStats* stream_stats = &stream_stats_[stream_label];
+    stream_stats->skipped_between_rendered.AddSample(dropped_count);
+    stream_stats->rendered_frame_rate.AddEvent(frame_stats->rendered_time);
+  }
+  if (captured_frame) {
+    AddComparison(std::move(captured_frame), frame, false, *frame_stats);
+  } else {
+    AddComparison(absl::nullopt, absl::nullopt, false, *frame_stats);
   }
-  AddComparison(captured_frame, frame, false, *frame_stats);
 
-  captured_frames_in_flight_.erase(frame_it);
   frame_stats_.erase(stats_it);
 }
 
@@ -424,6 +458,9 @@ void DefaultVideoQualityAnalyzer::AddComparison(
     FrameStats frame_stats) {
   rtc::CritScope crit(&comparison_lock_);
   analyzer_stats_.comparisons_queue_size.AddSample(comparisons_.size());
+  if (!captured) {
+    analyzer_stats_.memory_overloaded_comparisons_done++;
+  }
   // If there too many computations waiting in the queue, we won't provide
   // frames itself to make future computations lighter.
   if (comparisons_.size() >= kMaxActiveComparisons) {
@@ -446,7 +483,7 @@ void DefaultVideoQualityAnalyzer::ProcessComparisons() {
     {
       rtc::CritScope crit(&comparison_lock_);
       if (!comparisons_.empty()) {
-        comparison = comparisons_.front();
+        comparison = std::move(comparisons_.front());
         comparisons_.pop_front();
         if (!comparisons_.empty()) {
           comparison_available_event_.Set();
@@ -479,8 +516,20 @@ void DefaultVideoQualityAnalyzer::ProcessComparison(
   double psnr = -1.0;
   double ssim = -1.0;
   if (comparison.captured && !comparison.dropped) {
-    psnr = I420PSNR(&*comparison.captured, &*comparison.rendered);
-    ssim = I420SSIM(&*comparison.captured, &*comparison.rendered);
+    // Convert and scale the frames once for both metrics.
+    rtc::scoped_refptr<I420BufferInterface> reference_buffer =
+        comparison.captured->video_frame_buffer()->ToI420();
+    rtc::scoped_refptr<I420BufferInterface> test_buffer =
+        comparison.rendered->video_frame_buffer()->ToI420();
+    if (test_buffer->width() != reference_buffer->width() ||
+        test_buffer->height() != reference_buffer->height()) {
+      rtc::scoped_refptr<I420Buffer> scaled_buffer = I420Buffer::Create(
+          reference_buffer->width(), reference_buffer->height());
+      scaled_buffer->ScaleFrom(*test_buffer);
+      test_buffer = scaled_buffer;
+    }
+    psnr = I420PSNR(*reference_buffer, *test_buffer);
+    ssim = I420SSIM(*reference_buffer, *test_buffer);
   }
 
   const FrameStats& frame_stats = comparison.frame_stats;
@@ -573,6 +622,8 @@ void DefaultVideoQualityAnalyzer::ReportResults() {
   RTC_LOG(INFO) << "comparisons_done=" << analyzer_stats_.comparisons_done;
   RTC_LOG(INFO) << "overloaded_comparisons_done="
                 << analyzer_stats_.overloaded_comparisons_done;
+  RTC_LOG(INFO) << "memory_overloaded_comparisons_done="
+                << analyzer_stats_.memory_overloaded_comparisons_done;
 }
 
 void DefaultVideoQualityAnalyzer::ReportVideoBweResults(
@@ -606,6 +657,11 @@ void DefaultVideoQualityAnalyzer::ReportResults(
                         ? 0
                         : stats.encode_frame_rate.GetEventsPerSecond(),
                     "fps", /*important=*/false);
+  test::PrintResult("rendered_frame_rate", "", test_case_name,
+                    stats.rendered_frame_rate.IsEmpty()
+                        ? 0
+                        : stats.rendered_frame_rate.GetEventsPerSecond(),
+                    "fps", /*important=*/false);
   ReportResult("encode_time", test_case_name, stats.encode_time_ms, "ms");
   ReportResult("time_between_freezes", test_case_name,
                stats.time_between_freezes_ms, "ms");
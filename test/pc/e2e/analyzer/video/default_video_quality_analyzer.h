@@ -32,6 +32,11 @@
 namespace webrtc {
 namespace webrtc_pc_e2e {
 
+// Amount of captured frames per stream, for which analyzer keeps the video
+// frame itself to compare it with rendered one. 270 frames is 9 seconds of
+// 30 fps video.
+constexpr int kDefaultMaxFramesInFlightPerStream = 270;
+
 class RateCounter {
  public:
   void AddEvent(Timestamp event_time);
@@ -79,6 +84,7 @@ struct StreamStats {
   // Time between frames out from renderer.
   SamplesStatsCounter time_between_rendered_frames_ms;
   RateCounter encode_frame_rate;
+  RateCounter rendered_frame_rate;
   SamplesStatsCounter encode_time_ms;
   SamplesStatsCounter decode_time_ms;
   // Max frames skipped between two nearest.
@@ -110,6 +116,11 @@ struct AnalyzerStats {
   // comparison doesn't include metrics, that require heavy computations like
   // SSIM and PSNR.
   int64_t overloaded_comparisons_done = 0;
+  // Amount of overloaded comparisons, for which captured frame was released
+  // before the frame was rendered or dropped, because there were too many
+  // frames in flight in the stream. They are included in
+  // |overloaded_comparisons_done|.
+  int64_t memory_overloaded_comparisons_done = 0;
 };
 
 struct VideoBweStats {
@@ -122,7 +133,12 @@ struct VideoBweStats {
 
 class DefaultVideoQualityAnalyzer : public VideoQualityAnalyzerInterface {
  public:
-  DefaultVideoQualityAnalyzer();
+  // Keeps video frames only for |max_frames_in_flight_per_stream_count| last
+  // captured frames of each stream. For older frames in flight only metrics,
+  // that don't require video frames, are computed.
+  explicit DefaultVideoQualityAnalyzer(
+      int max_frames_in_flight_per_stream_count =
+          kDefaultMaxFramesInFlightPerStream);
   ~DefaultVideoQualityAnalyzer() override;
 
   void Start(std::string test_case_name, int max_threads_count) override;
@@ -186,8 +202,9 @@ class DefaultVideoQualityAnalyzer : public VideoQualityAnalyzerInterface {
   //      presented and |dropped| is false, either |rendered| is omitted and
   //      |dropped| is true.
   //   2. Overloaded - in this case both |captured| and |rendered| are omitted
-  //      because there were too many comparisons in the queue. |dropped| can be
-  //      true or false showing was frame dropped or not.
+  //      because there were too many comparisons in the queue or too many
+  //      frames in flight in the stream. |dropped| can be true or false showing
+  //      was frame dropped or not.
   struct FrameComparison {
     FrameComparison(absl::optional<VideoFrame> captured,
                     absl::optional<VideoFrame> rendered,
@@ -257,6 +274,7 @@ class DefaultVideoQualityAnalyzer : public VideoQualityAnalyzerInterface {
   Timestamp Now();
 
   webrtc::Clock* const clock_;
+  const size_t max_frames_in_flight_per_stream_count_;
   std::atomic<uint16_t> next_frame_id_{0};
 
   std::string test_label_;
@@ -265,7 +283,8 @@ class DefaultVideoQualityAnalyzer : public VideoQualityAnalyzerInterface {
   State state_ RTC_GUARDED_BY(lock_) = State::kNew;
   Timestamp start_time_ RTC_GUARDED_BY(lock_) = Timestamp::MinusInfinity();
   // Frames that were captured by all streams and still aren't rendered by any
-  // stream or deemed dropped.
+  // stream or deemed dropped. Contains at most
+  // |max_frames_in_flight_per_stream_count_| last captured frames per stream.
   std::map<uint16_t, VideoFrame> captured_frames_in_flight_
       RTC_GUARDED_BY(lock_);
   // Global frames count for all video streams.
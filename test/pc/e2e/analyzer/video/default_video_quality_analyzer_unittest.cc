@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/pc/e2e/analyzer/video/default_video_quality_analyzer.h"
+
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "api/video/encoded_image.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/video_frame.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace webrtc_pc_e2e {
+namespace {
+
+constexpr int kMaxFramesInFlightPerStream = 5;
+constexpr int kFramesCount = 10;
+constexpr char kStreamLabel[] = "video-stream";
+
+VideoFrame CreateFrame() {
+  rtc::scoped_refptr<I420Buffer> buffer = I420Buffer::Create(320, 240);
+  I420Buffer::SetBlack(buffer.get());
+  return VideoFrame::Builder()
+      .set_video_frame_buffer(buffer)
+      .set_timestamp_us(0)
+      .build();
+}
+
+// Passes the frame through all analyzer stages before rendering.
+void PassThroughPipeline(DefaultVideoQualityAnalyzer* analyzer,
+                         const VideoFrame& frame) {
+  analyzer->OnFramePreEncode(frame);
+  analyzer->OnFrameEncoded(frame.id(), EncodedImage());
+  analyzer->OnFrameReceived(frame.id(), EncodedImage());
+  analyzer->OnFrameDecoded(frame, /*decode_time_ms=*/absl::nullopt,
+                           /*qp=*/absl::nullopt);
+}
+
+std::vector<VideoFrame> CaptureFrames(DefaultVideoQualityAnalyzer* analyzer) {
+  std::vector<VideoFrame> frames;
+  for (int i = 0; i < kFramesCount; ++i) {
+    VideoFrame frame = CreateFrame();
+    frame.set_id(analyzer->OnFrameCaptured(kStreamLabel, frame));
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+}  // namespace
+
+TEST(DefaultVideoQualityAnalyzerTest,
+     FramesOverMaxInFlightAreComparedWithoutVideoFrames) {
+  DefaultVideoQualityAnalyzer analyzer(kMaxFramesInFlightPerStream);
+  analyzer.Start("test_case", /*max_threads_count=*/1);
+
+  std::vector<VideoFrame> frames = CaptureFrames(&analyzer);
+  for (const VideoFrame& frame : frames) {
+    PassThroughPipeline(&analyzer, frame);
+    analyzer.OnFrameRendered(frame);
+  }
+  analyzer.Stop();
+
+  AnalyzerStats analyzer_stats = analyzer.GetAnalyzerStats();
+  EXPECT_EQ(analyzer_stats.comparisons_done, kFramesCount);
+  EXPECT_EQ(analyzer_stats.memory_overloaded_comparisons_done,
+            kFramesCount - kMaxFramesInFlightPerStream);
+  EXPECT_GE(analyzer_stats.overloaded_comparisons_done,
+            kFramesCount - kMaxFramesInFlightPerStream);
+
+  FrameCounters frame_counters = analyzer.GetGlobalCounters();
+  EXPECT_EQ(frame_counters.captured, kFramesCount);
+  EXPECT_EQ(frame_counters.rendered, kFramesCount);
+  EXPECT_EQ(frame_counters.dropped, 0);
+
+  StreamStats stats = analyzer.GetStats().at(kStreamLabel);
+  EXPECT_EQ(static_cast<int64_t>(stats.psnr.GetSamples().size()),
+            kFramesCount - analyzer_stats.overloaded_comparisons_done);
+  EXPECT_FALSE(stats.rendered_frame_rate.IsEmpty());
+}
+
+TEST(DefaultVideoQualityAnalyzerTest,
+     FramesDroppedOverMaxInFlightAreComparedWithoutVideoFrames) {
+  DefaultVideoQualityAnalyzer analyzer(kMaxFramesInFlightPerStream);
+  analyzer.Start("test_case", /*max_threads_count=*/1);
+
+  std::vector<VideoFrame> frames = CaptureFrames(&analyzer);
+  PassThroughPipeline(&analyzer, frames.back());
+  analyzer.OnFrameRendered(frames.back());
+  analyzer.Stop();
+
+  AnalyzerStats analyzer_stats = analyzer.GetAnalyzerStats();
+  EXPECT_EQ(analyzer_stats.comparisons_done, kFramesCount);
+  EXPECT_EQ(analyzer_stats.memory_overloaded_comparisons_done,
+            kFramesCount - kMaxFramesInFlightPerStream);
+
+  FrameCounters frame_counters = analyzer.GetGlobalCounters();
+  EXPECT_EQ(frame_counters.captured, kFramesCount);
+  EXPECT_EQ(frame_counters.rendered, 1);
+  EXPECT_EQ(frame_counters.dropped, kFramesCount - 1);
+}
+
+}  // namespace webrtc_pc_e2e
+}  // namespace webrtc
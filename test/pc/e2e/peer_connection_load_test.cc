@@ -0,0 +1,683 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Sets up many calls between two PeerConnectionFactories in one process, over
+// an emulated network, to find out how the native stack scales with the number
+// of connections. The calls are ramped up at a fixed rate, with fake video
+// codecs, and then kept running for a while. Reports the setup latency of the
+// calls, the memory per call, the packet rate and the CPU usage of each kind
+// of thread.
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/call/call_factory_interface.h"
+#include "api/jsep.h"
+#include "api/peer_connection_interface.h"
+#include "api/rtc_event_log/rtc_event_log_factory.h"
+#include "api/scoped_refptr.h"
+#include "api/task_queue/default_task_queue_factory.h"
+#include "api/test/create_network_emulation_manager.h"
+#include "api/test/network_emulation_manager.h"
+#include "call/simulated_network.h"
+#include "media/engine/fake_video_codec_factory.h"
+#include "media/engine/webrtc_media_engine.h"
+#include "media/engine/webrtc_media_engine_defaults.h"
+#include "modules/audio_device/include/test_audio_device.h"
+#include "p2p/client/basic_port_allocator.h"
+#include "pc/test/frame_generator_capturer_video_track_source.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/crypto_worker_pool.h"
+#include "rtc_base/event.h"
+#include "rtc_base/flags.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/numerics/samples_stats_counter.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/sleep.h"
+
+WEBRTC_DEFINE_int(num_connections, 100, "Number of calls to set up.");
+WEBRTC_DEFINE_int(ramp_up_rate, 20, "Calls started per second.");
+WEBRTC_DEFINE_int(setup_timeout_s,
+                  30,
+                  "Time to wait for the calls to connect after the last one "
+                  "is started, in seconds.");
+WEBRTC_DEFINE_int(duration_s,
+                  10,
+                  "Time to keep the calls running once they are set up, in "
+                  "seconds.");
+WEBRTC_DEFINE_bool(audio, true, "Send audio in both directions.");
+WEBRTC_DEFINE_bool(video, true, "Send video in both directions.");
+WEBRTC_DEFINE_int(width, 320, "Width of the fake video.");
+WEBRTC_DEFINE_int(height, 180, "Height of the fake video.");
+WEBRTC_DEFINE_int(fps, 15, "Frame rate of the fake video.");
+WEBRTC_DEFINE_bool(crypto_worker_pool,
+                   true,
+                   "Generate the DTLS certificates on a CryptoWorkerPool "
+                   "instead of the network thread.");
+WEBRTC_DEFINE_bool(help, false, "Print this message.");
+
+namespace webrtc {
+namespace webrtc_pc_e2e {
+namespace {
+
+constexpr int16_t kAudioMaxAmplitude = 32000;
+constexpr int kSamplingFrequencyInHz = 48000;
+
+// Counters of the calls, updated on the signaling threads.
+class LoadTestStats {
+ public:
+  void OnConnected(int64_t setup_time_us) {
+    rtc::CritScope cs(&crit_);
+    ++num_connected_;
+    setup_latency_ms_.AddSample(setup_time_us / 1000.0);
+  }
+  void OnFailed() {
+    rtc::CritScope cs(&crit_);
+    ++num_failed_;
+  }
+
+  int num_connected() const {
+    rtc::CritScope cs(&crit_);
+    return num_connected_;
+  }
+  int num_failed() const {
+    rtc::CritScope cs(&crit_);
+    return num_failed_;
+  }
+  SamplesStatsCounter setup_latency_ms() const {
+    rtc::CritScope cs(&crit_);
+    return setup_latency_ms_;
+  }
+
+ private:
+  rtc::CriticalSection crit_;
+  int num_connected_ RTC_GUARDED_BY(crit_) = 0;
+  int num_failed_ RTC_GUARDED_BY(crit_) = 0;
+  SamplesStatsCounter setup_latency_ms_ RTC_GUARDED_BY(crit_);
+};
+
+class CreateDescriptionObserver : public CreateSessionDescriptionObserver {
+ public:
+  // |callback| is called with null on failure.
+  explicit CreateDescriptionObserver(
+      std::function<void(SessionDescriptionInterface*)> callback)
+      : callback_(std::move(callback)) {}
+
+  void OnSuccess(SessionDescriptionInterface* desc) override {
+    callback_(desc);
+  }
+  void OnFailure(RTCError error) override {
+    RTC_LOG(LS_ERROR) << "Failed to create a description: "
+                      << error.message();
+    callback_(nullptr);
+  }
+
+ private:
+  const std::function<void(SessionDescriptionInterface*)> callback_;
+};
+
+// The failures show up as calls that don't connect.
+class SetDescriptionObserver : public SetSessionDescriptionObserver {
+ public:
+  void OnSuccess() override {}
+  void OnFailure(RTCError error) override {
+    RTC_LOG(LS_ERROR) << "Failed to set a description: " << error.message();
+  }
+};
+
+// The PeerConnectionFactory of one side of the calls, with its threads and
+// media sources, which all its calls share.
+struct LoadTestSide {
+  LoadTestSide(const std::string& name,
+               EmulatedNetworkManagerInterface* network)
+      : network(network),
+        signaling_thread(rtc::Thread::Create()),
+        worker_thread(rtc::Thread::Create()) {
+    signaling_thread->SetName(name + "Signaling", nullptr);
+    RTC_CHECK(signaling_thread->Start());
+    worker_thread->SetName(name + "Worker", nullptr);
+    RTC_CHECK(worker_thread->Start());
+
+    std::unique_ptr<TaskQueueFactory> task_queue_factory =
+        CreateDefaultTaskQueueFactory();
+    cricket::MediaEngineDependencies media_deps;
+    media_deps.task_queue_factory = task_queue_factory.get();
+    media_deps.adm = TestAudioDeviceModule::Create(
+        task_queue_factory.get(),
+        TestAudioDeviceModule::CreatePulsedNoiseCapturer(
+            kAudioMaxAmplitude, kSamplingFrequencyInHz),
+        TestAudioDeviceModule::CreateDiscardRenderer(kSamplingFrequencyInHz),
+        /*speed=*/1.f);
+    media_deps.video_encoder_factory =
+        absl::make_unique<FakeVideoEncoderFactory>();
+    media_deps.video_decoder_factory =
+        absl::make_unique<FakeVideoDecoderFactory>();
+    SetMediaEngineDefaults(&media_deps);
+
+    PeerConnectionFactoryDependencies pcf_deps;
+    pcf_deps.network_thread = network->network_thread();
+    pcf_deps.worker_thread = worker_thread.get();
+    pcf_deps.signaling_thread = signaling_thread.get();
+    pcf_deps.media_engine = cricket::CreateMediaEngine(std::move(media_deps));
+    pcf_deps.call_factory = CreateCallFactory();
+    pcf_deps.event_log_factory =
+        absl::make_unique<RtcEventLogFactory>(task_queue_factory.get());
+    pcf_deps.task_queue_factory = std::move(task_queue_factory);
+    if (FLAG_crypto_worker_pool) {
+      pcf_deps.crypto_worker_pool =
+          rtc::CryptoWorkerPool::Create(rtc::CryptoWorkerPool::Config());
+    }
+    factory = CreateModularPeerConnectionFactory(std::move(pcf_deps));
+    RTC_CHECK(factory);
+
+    if (FLAG_audio) {
+      audio_track = factory->CreateAudioTrack(
+          "audio", factory->CreateAudioSource(cricket::AudioOptions()));
+    }
+    if (FLAG_video) {
+      FrameGeneratorCapturerVideoTrackSource::Config config;
+      config.width = FLAG_width;
+      config.height = FLAG_height;
+      config.frames_per_second = FLAG_fps;
+      video_source =
+          new rtc::RefCountedObject<FrameGeneratorCapturerVideoTrackSource>(
+              config, Clock::GetRealTimeClock(), /*is_screencast=*/false);
+      video_source->Start();
+      video_track = factory->CreateVideoTrack("video", video_source);
+    }
+  }
+
+  ~LoadTestSide() {
+    audio_track = nullptr;
+    video_track = nullptr;
+    if (video_source) {
+      video_source->Stop();
+      video_source = nullptr;
+    }
+    factory = nullptr;
+  }
+
+  EmulatedNetworkManagerInterface* const network;
+  std::unique_ptr<rtc::Thread> signaling_thread;
+  std::unique_ptr<rtc::Thread> worker_thread;
+  rtc::scoped_refptr<PeerConnectionFactoryInterface> factory;
+  rtc::scoped_refptr<AudioTrackInterface> audio_track;
+  rtc::scoped_refptr<FrameGeneratorCapturerVideoTrackSource> video_source;
+  rtc::scoped_refptr<VideoTrackInterface> video_track;
+};
+
+class LoadTestCall;
+
+// One end of a call. Trickles its candidates to the other end.
+class LoadTestPeer : public PeerConnectionObserver {
+ public:
+  LoadTestPeer(LoadTestSide* side, LoadTestCall* call, bool is_caller);
+
+  PeerConnectionInterface* pc() const { return pc_.get(); }
+  rtc::Thread* signaling_thread() const {
+    return side_->signaling_thread.get();
+  }
+  void set_remote(LoadTestPeer* remote) { remote_ = remote; }
+  void Close() { pc_->Close(); }
+
+  // PeerConnectionObserver implementation.
+  void OnSignalingChange(PeerConnectionInterface::SignalingState) override {}
+  void OnDataChannel(rtc::scoped_refptr<DataChannelInterface>) override {}
+  void OnRenegotiationNeeded() override {}
+  void OnIceConnectionChange(
+      PeerConnectionInterface::IceConnectionState) override {}
+  void OnConnectionChange(
+      PeerConnectionInterface::PeerConnectionState new_state) override;
+  void OnIceGatheringChange(
+      PeerConnectionInterface::IceGatheringState) override {}
+  void OnIceCandidate(const IceCandidateInterface* candidate) override;
+
+ private:
+  LoadTestSide* const side_;
+  LoadTestCall* const call_;
+  const bool is_caller_;
+  LoadTestPeer* remote_ = nullptr;
+  rtc::scoped_refptr<PeerConnectionInterface> pc_;
+};
+
+// A call between the two sides, which negotiates itself through the signaling
+// threads once started.
+class LoadTestCall {
+ public:
+  LoadTestCall(LoadTestSide* caller_side,
+               LoadTestSide* callee_side,
+               LoadTestStats* stats)
+      : stats_(stats),
+        caller_(caller_side, this, /*is_caller=*/true),
+        callee_(callee_side, this, /*is_caller=*/false) {
+    caller_.set_remote(&callee_);
+    callee_.set_remote(&caller_);
+  }
+
+  void Start() {
+    start_us_ = rtc::TimeMicros();
+    caller_.pc()->CreateOffer(
+        new rtc::RefCountedObject<CreateDescriptionObserver>(
+            [this](SessionDescriptionInterface* offer) {
+              OnOfferCreated(offer);
+            }),
+        PeerConnectionInterface::RTCOfferAnswerOptions());
+  }
+
+  // Closing doesn't cancel the tasks of the call that are already posted, so
+  // the signaling threads must be flushed before the call is destroyed.
+  void Close() {
+    caller_.Close();
+    callee_.Close();
+  }
+
+  void OnConnected() {
+    if (!done_.exchange(true)) {
+      stats_->OnConnected(rtc::TimeMicros() - start_us_);
+    }
+  }
+  void OnFailed() {
+    if (!done_.exchange(true)) {
+      stats_->OnFailed();
+    }
+  }
+
+ private:
+  // On the signaling thread of the caller.
+  void OnOfferCreated(SessionDescriptionInterface* offer) {
+    if (!offer) {
+      OnFailed();
+      return;
+    }
+    std::string sdp;
+    offer->ToString(&sdp);
+    caller_.pc()->SetLocalDescription(
+        new rtc::RefCountedObject<SetDescriptionObserver>(), offer);
+    // Posted before the candidates of the caller, which therefore always
+    // follow the offer.
+    callee_.signaling_thread()->PostTask(
+        RTC_FROM_HERE, [this, sdp] { OnOfferReceived(sdp); });
+  }
+
+  // On the signaling thread of the callee.
+  void OnOfferReceived(const std::string& sdp) {
+    callee_.pc()->SetRemoteDescription(
+        new rtc::RefCountedObject<SetDescriptionObserver>(),
+        CreateSessionDescription(SdpType::kOffer, sdp).release());
+    callee_.pc()->CreateAnswer(
+        new rtc::RefCountedObject<CreateDescriptionObserver>(
+            [this](SessionDescriptionInterface* answer) {
+              OnAnswerCreated(answer);
+            }),
+        PeerConnectionInterface::RTCOfferAnswerOptions());
+  }
+
+  // On the signaling thread of the callee.
+  void OnAnswerCreated(SessionDescriptionInterface* answer) {
+    if (!answer) {
+      OnFailed();
+      return;
+    }
+    std::string sdp;
+    answer->ToString(&sdp);
+    callee_.pc()->SetLocalDescription(
+        new rtc::RefCountedObject<SetDescriptionObserver>(), answer);
+    caller_.signaling_thread()->PostTask(RTC_FROM_HERE, [this, sdp] {
+      caller_.pc()->SetRemoteDescription(
+          new rtc::RefCountedObject<SetDescriptionObserver>(),
+          CreateSessionDescription(SdpType::kAnswer, sdp).release());
+    });
+  }
+
+  LoadTestStats* const stats_;
+  // Written before the offer is created, and read on the signaling thread of
+  // the caller once connected.
+  int64_t start_us_ = 0;
+  std::atomic<bool> done_{false};
+  LoadTestPeer caller_;
+  LoadTestPeer callee_;
+};
+
+LoadTestPeer::LoadTestPeer(LoadTestSide* side,
+                           LoadTestCall* call,
+                           bool is_caller)
+    : side_(side), call_(call), is_caller_(is_caller) {
+  PeerConnectionInterface::RTCConfiguration config;
+  config.sdp_semantics = SdpSemantics::kUnifiedPlan;
+  config.bundle_policy = PeerConnectionInterface::kBundlePolicyMaxBundle;
+  config.rtcp_mux_policy = PeerConnectionInterface::kRtcpMuxPolicyRequire;
+
+  PeerConnectionDependencies deps(this);
+  auto port_allocator = absl::make_unique<cricket::BasicPortAllocator>(
+      side->network->network_manager());
+  // The emulated network only carries UDP.
+  port_allocator->set_flags(port_allocator->flags() |
+                            cricket::PORTALLOCATOR_DISABLE_TCP);
+  deps.allocator = std::move(port_allocator);
+  pc_ = side->factory->CreatePeerConnection(config, std::move(deps));
+  RTC_CHECK(pc_);
+
+  if (side->audio_track) {
+    RTC_CHECK(pc_->AddTrack(side->audio_track, {"stream"}).ok());
+  }
+  if (side->video_track) {
+    RTC_CHECK(pc_->AddTrack(side->video_track, {"stream"}).ok());
+  }
+}
+
+void LoadTestPeer::OnConnectionChange(
+    PeerConnectionInterface::PeerConnectionState new_state) {
+  if (!is_caller_) {
+    return;
+  }
+  if (new_state == PeerConnectionInterface::PeerConnectionState::kConnected) {
+    call_->OnConnected();
+  } else if (new_state ==
+             PeerConnectionInterface::PeerConnectionState::kFailed) {
+    call_->OnFailed();
+  }
+}
+
+void LoadTestPeer::OnIceCandidate(const IceCandidateInterface* candidate) {
+  std::string sdp;
+  RTC_CHECK(candidate->ToString(&sdp));
+  const std::string sdp_mid = candidate->sdp_mid();
+  const int sdp_mline_index = candidate->sdp_mline_index();
+  LoadTestPeer* remote = remote_;
+  remote->signaling_thread()->PostTask(
+      RTC_FROM_HERE, [remote, sdp_mid, sdp_mline_index, sdp] {
+        std::unique_ptr<IceCandidateInterface> candidate(
+            CreateIceCandidate(sdp_mid, sdp_mline_index, sdp, nullptr));
+        if (!candidate || !remote->pc()->AddIceCandidate(candidate.get())) {
+          RTC_LOG(LS_WARNING) << "Failed to add a candidate";
+        }
+      });
+}
+
+// CPU time of a thread of the process, in clock ticks.
+struct ThreadCpu {
+  std::string name;
+  int64_t ticks = 0;
+};
+
+// Reads the CPU times of the threads of the process, by thread id.
+std::map<int, ThreadCpu> ReadThreadCpu() {
+  std::map<int, ThreadCpu> threads;
+  DIR* dir = opendir("/proc/self/task");
+  RTC_CHECK(dir);
+  while (dirent* entry = readdir(dir)) {
+    const int tid = atoi(entry->d_name);
+    if (tid <= 0) {
+      continue;
+    }
+    const std::string path =
+        std::string("/proc/self/task/") + entry->d_name + "/stat";
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+      // The thread has exited.
+      continue;
+    }
+    char line[1024];
+    const bool read = fgets(line, sizeof(line), file) != nullptr;
+    fclose(file);
+    if (!read) {
+      continue;
+    }
+    // The name is in parentheses, and may contain spaces and parentheses.
+    const std::string stat(line);
+    const size_t name_begin = stat.find('(');
+    const size_t name_end = stat.rfind(')');
+    if (name_begin == std::string::npos || name_end == std::string::npos) {
+      continue;
+    }
+    unsigned long utime = 0;
+    unsigned long stime = 0;
+    if (sscanf(stat.c_str() + name_end + 1,
+               " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime,
+               &stime) != 2) {
+      continue;
+    }
+    ThreadCpu& thread = threads[tid];
+    thread.name = stat.substr(name_begin + 1, name_end - name_begin - 1);
+    thread.ticks = utime + stime;
+  }
+  closedir(dir);
+  return threads;
+}
+
+int64_t ReadResidentBytes() {
+  FILE* file = fopen("/proc/self/statm", "r");
+  RTC_CHECK(file);
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  RTC_CHECK_EQ(2, fscanf(file, "%lu %lu", &size, &resident));
+  fclose(file);
+  return static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+}
+
+EmulatedNetworkStats GetNetworkStats(EmulatedNetworkManagerInterface* network) {
+  EmulatedNetworkStats stats;
+  rtc::Event done;
+  network->GetStats([&stats, &done](EmulatedNetworkStats s) {
+    stats = s;
+    done.Set();
+  });
+  RTC_CHECK(done.Wait(rtc::Event::kForever));
+  return stats;
+}
+
+void PrintThreadCpu(const std::map<int, ThreadCpu>& start,
+                    const std::map<int, ThreadCpu>& end,
+                    int64_t elapsed_us) {
+  // Threads that do the same work, such as the encoder queues of the streams,
+  // have the same name.
+  struct Usage {
+    int num_threads = 0;
+    int64_t ticks = 0;
+  };
+  std::map<std::string, Usage> usage_by_name;
+  for (const auto& it : end) {
+    auto start_it = start.find(it.first);
+    const int64_t start_ticks =
+        start_it == start.end() ? 0 : start_it->second.ticks;
+    Usage& usage = usage_by_name[it.second.name];
+    ++usage.num_threads;
+    usage.ticks += it.second.ticks - start_ticks;
+  }
+  std::vector<std::pair<std::string, Usage>> usages(usage_by_name.begin(),
+                                                    usage_by_name.end());
+  std::sort(usages.begin(), usages.end(),
+            [](const std::pair<std::string, Usage>& a,
+               const std::pair<std::string, Usage>& b) {
+              return a.second.ticks > b.second.ticks;
+            });
+  const double ticks_per_s = sysconf(_SC_CLK_TCK);
+  double total_percent = 0;
+  printf("CPU usage by thread name:\n");
+  for (const auto& it : usages) {
+    const double percent = 100.0 * it.second.ticks / ticks_per_s /
+                           (elapsed_us / 1e6);
+    total_percent += percent;
+    printf("  %-16s %5d threads %7.1f%%\n", it.first.c_str(),
+           it.second.num_threads, percent);
+  }
+  printf("  %-16s %5d threads %7.1f%%\n", "Total",
+         static_cast<int>(end.size()), total_percent);
+}
+
+int RunLoadTest() {
+  std::unique_ptr<NetworkEmulationManager> network_emulation_manager =
+      CreateNetworkEmulationManager();
+  EmulatedNetworkNode* caller_node =
+      network_emulation_manager->CreateEmulatedNode(
+          absl::make_unique<SimulatedNetwork>(BuiltInNetworkBehaviorConfig()));
+  EmulatedNetworkNode* callee_node =
+      network_emulation_manager->CreateEmulatedNode(
+          absl::make_unique<SimulatedNetwork>(BuiltInNetworkBehaviorConfig()));
+  EmulatedEndpoint* caller_endpoint =
+      network_emulation_manager->CreateEndpoint(EmulatedEndpointConfig());
+  EmulatedEndpoint* callee_endpoint =
+      network_emulation_manager->CreateEndpoint(EmulatedEndpointConfig());
+  network_emulation_manager->CreateRoute(caller_endpoint, {caller_node},
+                                         callee_endpoint);
+  network_emulation_manager->CreateRoute(callee_endpoint, {callee_node},
+                                         caller_endpoint);
+  EmulatedNetworkManagerInterface* caller_network =
+      network_emulation_manager->CreateEmulatedNetworkManagerInterface(
+          {caller_endpoint});
+  EmulatedNetworkManagerInterface* callee_network =
+      network_emulation_manager->CreateEmulatedNetworkManagerInterface(
+          {callee_endpoint});
+
+  const int64_t initial_resident_bytes = ReadResidentBytes();
+  std::unique_ptr<LoadTestSide> caller_side =
+      absl::make_unique<LoadTestSide>("Caller", caller_network);
+  std::unique_ptr<LoadTestSide> callee_side =
+      absl::make_unique<LoadTestSide>("Callee", callee_network);
+  const int64_t factory_resident_bytes = ReadResidentBytes();
+
+  // Ramp up.
+  LoadTestStats stats;
+  std::vector<std::unique_ptr<LoadTestCall>> calls;
+  const int64_t ramp_up_start_us = rtc::TimeMicros();
+  int64_t next_report_us = ramp_up_start_us + rtc::kNumMicrosecsPerSec;
+  for (int i = 0; i < FLAG_num_connections; ++i) {
+    calls.push_back(absl::make_unique<LoadTestCall>(
+        caller_side.get(), callee_side.get(), &stats));
+    calls.back()->Start();
+    const int64_t next_start_us =
+        ramp_up_start_us +
+        (i + 1) * rtc::kNumMicrosecsPerSec / FLAG_ramp_up_rate;
+    const int64_t now_us = rtc::TimeMicros();
+    if (now_us >= next_report_us) {
+      printf("Started %d calls, %d connected\n", i + 1,
+             stats.num_connected());
+      next_report_us += rtc::kNumMicrosecsPerSec;
+    }
+    if (next_start_us > now_us) {
+      SleepMs((next_start_us - now_us) / rtc::kNumMicrosecsPerMillisec);
+    }
+  }
+  const int64_t setup_deadline_us =
+      rtc::TimeMicros() + FLAG_setup_timeout_s * rtc::kNumMicrosecsPerSec;
+  while (stats.num_connected() + stats.num_failed() < FLAG_num_connections &&
+         rtc::TimeMicros() < setup_deadline_us) {
+    SleepMs(100);
+  }
+  const int64_t ramp_up_us = rtc::TimeMicros() - ramp_up_start_us;
+  const int num_connected = stats.num_connected();
+  const int num_failed = stats.num_failed();
+  const int64_t connected_resident_bytes = ReadResidentBytes();
+
+  // Steady state.
+  const std::map<int, ThreadCpu> start_cpu = ReadThreadCpu();
+  const EmulatedNetworkStats start_caller_stats =
+      GetNetworkStats(caller_network);
+  const EmulatedNetworkStats start_callee_stats =
+      GetNetworkStats(callee_network);
+  const int64_t start_us = rtc::TimeMicros();
+  SleepMs(FLAG_duration_s * 1000);
+  const std::map<int, ThreadCpu> end_cpu = ReadThreadCpu();
+  const EmulatedNetworkStats end_caller_stats = GetNetworkStats(caller_network);
+  const EmulatedNetworkStats end_callee_stats = GetNetworkStats(callee_network);
+  const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+
+  printf("\n%d calls: %d connected, %d failed, %d timed out in %.1f s\n",
+         FLAG_num_connections, num_connected, num_failed,
+         FLAG_num_connections - num_connected - num_failed, ramp_up_us / 1e6);
+  SamplesStatsCounter setup_latency_ms = stats.setup_latency_ms();
+  if (!setup_latency_ms.IsEmpty()) {
+    printf("Setup latency: p50 %.0f ms, p90 %.0f ms, p99 %.0f ms, "
+           "max %.0f ms\n",
+           setup_latency_ms.GetPercentile(0.5),
+           setup_latency_ms.GetPercentile(0.9),
+           setup_latency_ms.GetPercentile(0.99), setup_latency_ms.GetMax());
+  }
+  const int64_t call_resident_bytes =
+      connected_resident_bytes - factory_resident_bytes;
+  printf("Memory: %.1f MB for the factories, %.1f kB per call\n",
+         (factory_resident_bytes - initial_resident_bytes) / 1e6,
+         num_connected > 0 ? call_resident_bytes / 1e3 / num_connected : 0.0);
+  const int64_t packets_sent =
+      end_caller_stats.packets_sent - start_caller_stats.packets_sent +
+      end_callee_stats.packets_sent - start_callee_stats.packets_sent;
+  const int64_t bytes_sent =
+      end_caller_stats.bytes_sent.bytes() -
+      start_caller_stats.bytes_sent.bytes() +
+      end_callee_stats.bytes_sent.bytes() -
+      start_callee_stats.bytes_sent.bytes();
+  printf("Throughput: %.0f packets/s, %.1f Mbps\n",
+         packets_sent / (elapsed_us / 1e6), bytes_sent * 8.0 / elapsed_us);
+  PrintThreadCpu(start_cpu, end_cpu, elapsed_us);
+
+  // Tear down.
+  for (const std::unique_ptr<LoadTestCall>& call : calls) {
+    call->Close();
+  }
+  // A task of a call may post another one to the other signaling thread.
+  for (int i = 0; i < 2; ++i) {
+    caller_side->signaling_thread->Invoke<void>(RTC_FROM_HERE, [] {});
+    callee_side->signaling_thread->Invoke<void>(RTC_FROM_HERE, [] {});
+  }
+  calls.clear();
+  caller_side.reset();
+  callee_side.reset();
+  return num_connected == FLAG_num_connections ? 0 : 1;
+}
+
+}  // namespace
+}  // namespace webrtc_pc_e2e
+}  // namespace webrtc
+
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage =
+      "Load test of many PeerConnections in one process.\n"
+      "Usage: " +
+      program_name +
+      " [options]\n\n"
+      "  --num_connections=N    number of calls; default is 100\n"
+      "  --ramp_up_rate=N       calls started per second; default is 20\n"
+      "  --duration_s=N         time to run the connected calls; default is "
+      "10 s\n";
+  if (rtc::FlagList::SetFlagsFromCommandLine(&argc, argv, true) || FLAG_help ||
+      argc != 1) {
+    printf("%s", usage.c_str());
+    if (FLAG_help) {
+      rtc::FlagList::Print(nullptr, false);
+      return 0;
+    }
+    return 1;
+  }
+  RTC_CHECK_GT(FLAG_num_connections, 0);
+  RTC_CHECK_GT(FLAG_ramp_up_rate, 0);
+  RTC_CHECK_GE(FLAG_setup_timeout_s, 0);
+  RTC_CHECK_GT(FLAG_duration_s, 0);
+  // The calls log too much to be followed.
+  rtc::LogMessage::LogToDebug(rtc::LS_WARNING);
+
+  return webrtc::webrtc_pc_e2e::RunLoadTest();
+}
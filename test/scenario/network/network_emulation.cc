@@ -10,8 +10,10 @@
 
 #include "test/scenario/network/network_emulation.h"
 
+#include <algorithm>
 #include <limits>
 #include <memory>
+#include <utility>
 
 #include "absl/memory/memory.h"
 #include "api/units/data_size.h"
@@ -29,16 +31,87 @@ EmulatedIpPacket::EmulatedIpPacket(const rtc::SocketAddress& from,
       data(data),
       arrival_time(arrival_time) {}
 
+EmulatedPacketHandoff::EmulatedPacketHandoff(
+    rtc::TaskQueue* task_queue,
+    std::function<void(EmulatedIpPacket)> handler)
+    : task_queue_(task_queue), handler_(std::move(handler)) {}
+
+EmulatedPacketHandoff::~EmulatedPacketHandoff() = default;
+
+void EmulatedPacketHandoff::Post(EmulatedIpPacket packet) {
+  {
+    rtc::CritScope crit(&lock_);
+    if (stopped_)
+      return;
+    pending_packets_.push_back(std::move(packet));
+    // A task is already posted for the pending packets.
+    if (pending_packets_.size() > 1)
+      return;
+  }
+  task_queue_->PostTask([this] { HandlePendingPackets(); });
+}
+
+void EmulatedPacketHandoff::Stop() {
+  rtc::CritScope crit(&lock_);
+  stopped_ = true;
+  pending_packets_.clear();
+}
+
+bool EmulatedPacketHandoff::stopped() const {
+  rtc::CritScope crit(&lock_);
+  return stopped_;
+}
+
+void EmulatedPacketHandoff::HandlePendingPackets() {
+  RTC_DCHECK(task_queue_->IsCurrent());
+  std::vector<EmulatedIpPacket> packets;
+  {
+    rtc::CritScope crit(&lock_);
+    packets.swap(pending_packets_);
+  }
+  for (EmulatedIpPacket& packet : packets)
+    handler_(std::move(packet));
+  packets.clear();
+  rtc::CritScope crit(&lock_);
+  // Gives the storage back, unless packets were posted meanwhile.
+  if (pending_packets_.empty())
+    pending_packets_.swap(packets);
+}
+
+LinkEmulation::LinkEmulation(
+    Clock* clock,
+    rtc::TaskQueue* task_queue,
+    std::unique_ptr<NetworkBehaviorInterface> network_behavior,
+    EmulatedNetworkReceiverInterface* receiver)
+    : clock_(clock),
+      task_queue_(task_queue),
+      network_behavior_(std::move(network_behavior)),
+      receiver_(receiver),
+      handoff_(task_queue, [this](EmulatedIpPacket packet) {
+        RTC_DCHECK_RUN_ON(task_queue_);
+        HandlePacketReceived(std::move(packet));
+      }) {}
+
+LinkEmulation::~LinkEmulation() = default;
+
 void LinkEmulation::OnPacketReceived(EmulatedIpPacket packet) {
-  struct Closure {
-    void operator()() {
-      RTC_DCHECK_RUN_ON(link->task_queue_);
-      link->HandlePacketReceived(std::move(packet));
+  // The task queue may be destroyed once stopped.
+  if (handoff_.stopped())
+    return;
+  // The packets from the previous node or endpoint on the same task queue
+  // don't need a task of their own.
+  if (task_queue_->IsCurrent()) {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    if (!processing_) {
+      HandlePacketReceived(std::move(packet));
+      return;
     }
-    LinkEmulation* link;
-    EmulatedIpPacket packet;
-  };
-  task_queue_->PostTask(Closure{this, std::move(packet)});
+  }
+  handoff_.Post(std::move(packet));
+}
+
+void LinkEmulation::Stop() {
+  handoff_.Stop();
 }
 
 void LinkEmulation::HandlePacketReceived(EmulatedIpPacket packet) {
@@ -46,7 +119,7 @@ void LinkEmulation::HandlePacketReceived(EmulatedIpPacket packet) {
   bool sent = network_behavior_->EnqueuePacket(
       PacketInFlightInfo(packet.size(), packet.arrival_time.us(), packet_id));
   if (sent) {
-    packets_.emplace_back(StoredPacket{packet_id, std::move(packet), false});
+    packets_.push_back(StoredPacket{packet_id, std::move(packet), false});
   }
   if (process_task_.Running())
     return;
@@ -76,15 +149,14 @@ void LinkEmulation::HandlePacketReceived(EmulatedIpPacket packet) {
 void LinkEmulation::Process(Timestamp at_time) {
   std::vector<PacketDeliveryInfo> delivery_infos =
       network_behavior_->DequeueDeliverablePackets(at_time.us());
+  processing_ = true;
   for (PacketDeliveryInfo& delivery_info : delivery_infos) {
-    StoredPacket* packet = nullptr;
-    for (auto& stored_packet : packets_) {
-      if (stored_packet.id == delivery_info.packet_id) {
-        packet = &stored_packet;
-        break;
-      }
-    }
-    RTC_CHECK(packet);
+    auto it = std::lower_bound(
+        packets_.begin() + first_packet_, packets_.end(),
+        delivery_info.packet_id,
+        [](const StoredPacket& packet, uint64_t id) { return packet.id < id; });
+    RTC_CHECK(it != packets_.end() && it->id == delivery_info.packet_id);
+    StoredPacket* packet = &*it;
     RTC_DCHECK(!packet->removed);
     packet->removed = true;
 
@@ -93,9 +165,18 @@ void LinkEmulation::Process(Timestamp at_time) {
           Timestamp::us(delivery_info.receive_time_us);
       receiver_->OnPacketReceived(std::move(packet->packet));
     }
-    while (!packets_.empty() && packets_.front().removed) {
-      packets_.pop_front();
-    }
+  }
+  processing_ = false;
+  while (first_packet_ < packets_.size() && packets_[first_packet_].removed)
+    ++first_packet_;
+  if (first_packet_ == packets_.size()) {
+    packets_.clear();
+    first_packet_ = 0;
+  } else if (first_packet_ > packets_.size() / 2) {
+    // Packets that are held for long, e.g. reordered ones, would otherwise
+    // keep the storage growing.
+    packets_.erase(packets_.begin(), packets_.begin() + first_packet_);
+    first_packet_ = 0;
   }
 }
 
@@ -170,6 +251,14 @@ EmulatedEndpoint::EmulatedEndpoint(uint64_t id,
       clock_(clock),
       task_queue_(task_queue),
       router_(task_queue_),
+      send_handoff_(task_queue_,
+                    [this](EmulatedIpPacket packet) {
+                      SendPacketToNetwork(std::move(packet));
+                    }),
+      receive_handoff_(task_queue_,
+                       [this](EmulatedIpPacket packet) {
+                         DeliverPacket(std::move(packet));
+                       }),
       next_port_(kFirstEphemeralPort) {
   constexpr int kIPv4NetworkPrefixLength = 24;
   constexpr int kIPv6NetworkPrefixLength = 64;
@@ -198,17 +287,14 @@ void EmulatedEndpoint::SendPacket(const rtc::SocketAddress& from,
                                   const rtc::SocketAddress& to,
                                   rtc::CopyOnWriteBuffer packet) {
   RTC_CHECK(from.ipaddr() == peer_local_addr_);
-  struct Closure {
-    void operator()() {
-      endpoint->UpdateSendStats(packet);
-      endpoint->router_.OnPacketReceived(std::move(packet));
-    }
-    EmulatedEndpoint* endpoint;
-    EmulatedIpPacket packet;
-  };
-  task_queue_->PostTask(Closure{
-      this, EmulatedIpPacket(from, to, std::move(packet),
-                             Timestamp::us(clock_->TimeInMicroseconds()))});
+  send_handoff_.Post(
+      EmulatedIpPacket(from, to, std::move(packet),
+                       Timestamp::us(clock_->TimeInMicroseconds())));
+}
+
+void EmulatedEndpoint::SendPacketToNetwork(EmulatedIpPacket packet) {
+  UpdateSendStats(packet);
+  router_.OnPacketReceived(std::move(packet));
 }
 
 absl::optional<uint16_t> EmulatedEndpoint::BindReceiver(
@@ -262,6 +348,14 @@ rtc::IPAddress EmulatedEndpoint::GetPeerLocalAddress() const {
 }
 
 void EmulatedEndpoint::OnPacketReceived(EmulatedIpPacket packet) {
+  if (!task_queue_->IsCurrent()) {
+    receive_handoff_.Post(std::move(packet));
+    return;
+  }
+  DeliverPacket(std::move(packet));
+}
+
+void EmulatedEndpoint::DeliverPacket(EmulatedIpPacket packet) {
   RTC_DCHECK_RUN_ON(task_queue_);
   RTC_CHECK(packet.to.ipaddr() == peer_local_addr_)
       << "Routing error: wrong destination endpoint. Packet.to.ipaddr()=: "
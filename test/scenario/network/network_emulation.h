@@ -12,6 +12,7 @@
 #define TEST_SCENARIO_NETWORK_NETWORK_EMULATION_H_
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -23,6 +24,7 @@
 #include "api/test/simulated_network.h"
 #include "api/units/timestamp.h"
 #include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/network.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/task_queue_for_test.h"
@@ -62,17 +64,46 @@ class EmulatedNetworkReceiverInterface {
   virtual void OnPacketReceived(EmulatedIpPacket packet) = 0;
 };
 
+// Hands packets over to the task queue that handles them. The packets that
+// are posted before the task queue gets to them are handled by a single task,
+// and the storage of the batches is reused.
+class EmulatedPacketHandoff {
+ public:
+  EmulatedPacketHandoff(rtc::TaskQueue* task_queue,
+                        std::function<void(EmulatedIpPacket)> handler);
+  ~EmulatedPacketHandoff();
+
+  // Drops |packet| once stopped.
+  void Post(EmulatedIpPacket packet);
+  // Drops the packets posted later, and doesn't post to the task queue
+  // anymore, so that it can be destroyed.
+  void Stop();
+  bool stopped() const;
+
+ private:
+  void HandlePendingPackets();
+
+  rtc::TaskQueue* const task_queue_;
+  const std::function<void(EmulatedIpPacket)> handler_;
+  rtc::CriticalSection lock_;
+  std::vector<EmulatedIpPacket> pending_packets_ RTC_GUARDED_BY(lock_);
+  bool stopped_ RTC_GUARDED_BY(lock_) = false;
+};
+
 class LinkEmulation : public EmulatedNetworkReceiverInterface {
  public:
   LinkEmulation(Clock* clock,
                 rtc::TaskQueue* task_queue,
                 std::unique_ptr<NetworkBehaviorInterface> network_behavior,
-                EmulatedNetworkReceiverInterface* receiver)
-      : clock_(clock),
-        task_queue_(task_queue),
-        network_behavior_(std::move(network_behavior)),
-        receiver_(receiver) {}
+                EmulatedNetworkReceiverInterface* receiver);
+  ~LinkEmulation() override;
+
+  // Handles |packet| right away when called on the task queue of the link, and
+  // posts it there otherwise.
   void OnPacketReceived(EmulatedIpPacket packet) override;
+  // Drops the packets that arrive later. Unlike the other methods, it can be
+  // called from any thread.
+  void Stop();
 
  private:
   struct StoredPacket {
@@ -88,9 +119,16 @@ class LinkEmulation : public EmulatedNetworkReceiverInterface {
   const std::unique_ptr<NetworkBehaviorInterface> network_behavior_
       RTC_GUARDED_BY(task_queue_);
   EmulatedNetworkReceiverInterface* const receiver_;
+  EmulatedPacketHandoff handoff_;
   RepeatingTaskHandle process_task_ RTC_GUARDED_BY(task_queue_);
-  std::deque<StoredPacket> packets_ RTC_GUARDED_BY(task_queue_);
+  // By increasing id. The packets before |first_packet_| are removed, and
+  // the storage is reused once all are.
+  std::vector<StoredPacket> packets_ RTC_GUARDED_BY(task_queue_);
+  size_t first_packet_ RTC_GUARDED_BY(task_queue_) = 0;
   uint64_t next_packet_id_ RTC_GUARDED_BY(task_queue_) = 1;
+  // Set while delivering, when the packets that come back to the link are
+  // posted.
+  bool processing_ RTC_GUARDED_BY(task_queue_) = false;
 };
 
 class NetworkRouterNode : public EmulatedNetworkReceiverInterface {
@@ -185,7 +223,8 @@ class EmulatedEndpoint : public EmulatedNetworkReceiverInterface {
 
   rtc::IPAddress GetPeerLocalAddress() const;
 
-  // Will be called to deliver packet into endpoint from network node.
+  // Will be called to deliver packet into endpoint from network node. The
+  // nodes may run on other task queues, and then the packet is posted.
   void OnPacketReceived(EmulatedIpPacket packet) override;
 
   void Enable();
@@ -199,6 +238,8 @@ class EmulatedEndpoint : public EmulatedNetworkReceiverInterface {
  private:
   static constexpr uint16_t kFirstEphemeralPort = 49152;
   uint16_t NextPort() RTC_EXCLUSIVE_LOCKS_REQUIRED(receiver_lock_);
+  void SendPacketToNetwork(EmulatedIpPacket packet);
+  void DeliverPacket(EmulatedIpPacket packet);
   void UpdateSendStats(const EmulatedIpPacket& packet);
   void UpdateReceiveStats(const EmulatedIpPacket& packet);
 
@@ -213,6 +254,8 @@ class EmulatedEndpoint : public EmulatedNetworkReceiverInterface {
   rtc::TaskQueue* const task_queue_;
   std::unique_ptr<rtc::Network> network_;
   NetworkRouterNode router_;
+  EmulatedPacketHandoff send_handoff_;
+  EmulatedPacketHandoff receive_handoff_;
 
   uint16_t next_port_ RTC_GUARDED_BY(receiver_lock_);
   std::map<uint16_t, EmulatedNetworkReceiverInterface*> port_to_receiver_
@@ -57,24 +57,50 @@ NetworkEmulationManagerImpl::NetworkEmulationManagerImpl()
 
 NetworkEmulationManagerImpl::NetworkEmulationManagerImpl(
     TimeController* time_controller)
+    : NetworkEmulationManagerImpl(time_controller,
+                                  /*num_node_task_queues=*/0) {}
+
+NetworkEmulationManagerImpl::NetworkEmulationManagerImpl(
+    TimeController* time_controller,
+    int num_node_task_queues)
     : clock_(time_controller->GetClock()),
       next_node_id_(1),
       next_ip4_address_(kMinIPv4Address),
       task_queue_(time_controller->GetTaskQueueFactory()->CreateTaskQueue(
           "NetworkEmulation",
           TaskQueueFactory::Priority::NORMAL)) {
+  for (int i = 0; i < num_node_task_queues; ++i) {
+    node_task_queues_.push_back(absl::make_unique<TaskQueueForTest>(
+        time_controller->GetTaskQueueFactory()->CreateTaskQueue(
+            "NetworkEmulationNodes", TaskQueueFactory::Priority::NORMAL)));
+  }
 }
 
 // TODO(srte): Ensure that any pending task that must be run for consistency
 // (such as stats collection tasks) are not cancelled when the task queue is
 // destroyed.
-NetworkEmulationManagerImpl::~NetworkEmulationManagerImpl() = default;
+NetworkEmulationManagerImpl::~NetworkEmulationManagerImpl() {
+  // The node task queues post to |task_queue_| and the other way around. Once
+  // the links on the node task queues are stopped, nothing posts to these
+  // anymore, and they can be destroyed first.
+  for (auto& it : node_to_task_queue_)
+    it.first->link()->Stop();
+  node_task_queues_.clear();
+}
 
 EmulatedNetworkNode* NetworkEmulationManagerImpl::CreateEmulatedNode(
     std::unique_ptr<NetworkBehaviorInterface> network_behavior) {
+  TaskQueueForTest* task_queue = &task_queue_;
+  if (!node_task_queues_.empty()) {
+    task_queue = node_task_queues_[next_node_task_queue_].get();
+    next_node_task_queue_ =
+        (next_node_task_queue_ + 1) % node_task_queues_.size();
+  }
   auto node = absl::make_unique<EmulatedNetworkNode>(
-      clock_, &task_queue_, std::move(network_behavior));
+      clock_, task_queue, std::move(network_behavior));
   EmulatedNetworkNode* out = node.get();
+  if (task_queue != &task_queue_)
+    node_to_task_queue_[out] = task_queue;
   task_queue_.PostTask(CreateResourceOwningTask(
       std::move(node), [this](std::unique_ptr<EmulatedNetworkNode> node) {
         network_nodes_.push_back(std::move(node));
@@ -154,11 +180,13 @@ EmulatedRoute* NetworkEmulationManagerImpl::CreateRoute(
 
 void NetworkEmulationManagerImpl::ClearRoute(EmulatedRoute* route) {
   RTC_CHECK(route->active) << "Route already cleared";
-  task_queue_.SendTask([route]() {
-    // Remove receiver from intermediate nodes.
-    for (auto* node : route->via_nodes) {
+  // Remove receiver from intermediate nodes.
+  for (auto* node : route->via_nodes) {
+    GetTaskQueue(node)->SendTask([route, node]() {
       node->router()->RemoveReceiver(route->to->GetPeerLocalAddress());
-    }
+    });
+  }
+  task_queue_.SendTask([route]() {
     // Remove destination endpoint from source endpoint's router.
     route->from->router()->RemoveReceiver(route->to->GetPeerLocalAddress());
 
@@ -292,5 +320,11 @@ Timestamp NetworkEmulationManagerImpl::Now() const {
   return Timestamp::us(clock_->TimeInMicroseconds());
 }
 
+TaskQueueForTest* NetworkEmulationManagerImpl::GetTaskQueue(
+    EmulatedNetworkNode* node) {
+  auto it = node_to_task_queue_.find(node);
+  return it == node_to_task_queue_.end() ? &task_queue_ : it->second;
+}
+
 }  // namespace test
 }  // namespace webrtc
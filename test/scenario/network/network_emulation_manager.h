@@ -11,6 +11,7 @@
 #ifndef TEST_SCENARIO_NETWORK_NETWORK_EMULATION_MANAGER_H_
 #define TEST_SCENARIO_NETWORK_NETWORK_EMULATION_MANAGER_H_
 
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -39,6 +40,12 @@ class NetworkEmulationManagerImpl : public NetworkEmulationManager {
  public:
   NetworkEmulationManagerImpl();
   explicit NetworkEmulationManagerImpl(TimeController* time_controller);
+  // Spreads the nodes over |num_node_task_queues| task queues of their own, so
+  // that independent nodes are processed in parallel: on threads of their own
+  // in real time, and on the worker threads of a GlobalSimulatedTimeController
+  // that has some. With 0, the nodes run on the task queue of the manager.
+  NetworkEmulationManagerImpl(TimeController* time_controller,
+                              int num_node_task_queues);
   ~NetworkEmulationManagerImpl();
 
   EmulatedNetworkNode* CreateEmulatedNode(
@@ -75,6 +82,7 @@ class NetworkEmulationManagerImpl : public NetworkEmulationManager {
  private:
   absl::optional<rtc::IPAddress> GetNextIPv4Address();
   Timestamp Now() const;
+  TaskQueueForTest* GetTaskQueue(EmulatedNetworkNode* node);
 
   Clock* const clock_;
   int next_node_id_;
@@ -97,7 +105,11 @@ class NetworkEmulationManagerImpl : public NetworkEmulationManager {
 
   std::map<EmulatedEndpoint*, EmulatedNetworkManager*>
       endpoint_to_network_manager_;
+  // The nodes that run on |node_task_queues_|.
+  std::map<EmulatedNetworkNode*, TaskQueueForTest*> node_to_task_queue_;
 
+  std::vector<std::unique_ptr<TaskQueueForTest>> node_task_queues_;
+  size_t next_node_task_queue_ = 0;
   // Must be the last field, so it will be deleted first, because tasks
   // in the TaskQueue can access other fields of the instance of this class.
   TaskQueueForTest task_queue_;
@@ -8,8 +8,11 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "api/test/simulated_network.h"
@@ -18,11 +21,13 @@
 #include "rtc_base/event.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/time_utils.h"
 #include "system_wrappers/include/sleep.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 #include "test/scenario/network/network_emulation.h"
 #include "test/scenario/network/network_emulation_manager.h"
+#include "test/time_controller/simulated_time_controller.h"
 
 namespace webrtc {
 namespace test {
@@ -73,6 +78,15 @@ class MockReceiver : public EmulatedNetworkReceiverInterface {
   MOCK_METHOD1(OnPacketReceived, void(EmulatedIpPacket packet));
 };
 
+class CountingReceiver : public EmulatedNetworkReceiverInterface {
+ public:
+  void OnPacketReceived(EmulatedIpPacket packet) override { ++count_; }
+  int count() const { return count_; }
+
+ private:
+  std::atomic<int> count_{0};
+};
+
 class NetworkEmulationManagerThreeNodesRoutingTest : public ::testing::Test {
  public:
   NetworkEmulationManagerThreeNodesRoutingTest() {
@@ -370,5 +384,91 @@ TEST_F(NetworkEmulationManagerThreeNodesRoutingTest,
   SendPacketsAndValidateDelivery();
 }
 
+TEST(NetworkEmulationManagerTest, DeliversPacketsOverNodeTaskQueues) {
+  GlobalSimulatedTimeController time_controller(Timestamp::seconds(10000));
+  CountingReceiver receiver;
+  NetworkEmulationManagerImpl emulation(&time_controller,
+                                        /*num_node_task_queues=*/2);
+  BuiltInNetworkBehaviorConfig config;
+  config.queue_delay_ms = 10;
+  // The nodes of the route run on different task queues.
+  EmulatedNetworkNode* first_node = emulation.CreateEmulatedNode(
+      absl::make_unique<SimulatedNetwork>(config));
+  EmulatedNetworkNode* second_node = emulation.CreateEmulatedNode(
+      absl::make_unique<SimulatedNetwork>(config));
+  EmulatedEndpoint* sender = emulation.CreateEndpoint(EmulatedEndpointConfig());
+  EmulatedEndpoint* receiver_endpoint =
+      emulation.CreateEndpoint(EmulatedEndpointConfig());
+  emulation.CreateRoute(sender, {first_node, second_node}, receiver_endpoint);
+  rtc::SocketAddress from(sender->GetPeerLocalAddress(), 80);
+  rtc::SocketAddress to(receiver_endpoint->GetPeerLocalAddress(),
+                        receiver_endpoint->BindReceiver(0, &receiver).value());
+
+  for (int i = 0; i < 100; ++i)
+    sender->SendPacket(from, to, rtc::CopyOnWriteBuffer(100));
+  time_controller.Sleep(TimeDelta::ms(15));
+  EXPECT_EQ(receiver.count(), 0);
+  time_controller.Sleep(TimeDelta::ms(10));
+  EXPECT_EQ(receiver.count(), 100);
+}
+
+// Reports how many packets are emulated per second of wall clock time, for 20
+// independent 50 Mbps links that carry about 1 Gbps in total. The nodes run on
+// the task queue of the manager, or are spread over 4 task queues that run in
+// parallel.
+TEST(NetworkEmulationManagerTest, DISABLED_Benchmark) {
+  constexpr int kNumLinks = 20;
+  constexpr int kNumTaskQueues = 4;
+  constexpr size_t kPacketSize = 1200;
+  constexpr int kPacketsPerMs = 5;
+  constexpr int kDurationMs = 2000;
+  for (int num_task_queues : {0, kNumTaskQueues}) {
+    GlobalSimulatedTimeController time_controller(Timestamp::seconds(10000),
+                                                  num_task_queues);
+    std::vector<CountingReceiver> receivers(kNumLinks);
+    NetworkEmulationManagerImpl emulation(&time_controller, num_task_queues);
+    BuiltInNetworkBehaviorConfig config;
+    config.link_capacity_kbps = 50000;
+    config.queue_delay_ms = 20;
+    std::vector<EmulatedEndpoint*> senders;
+    std::vector<rtc::SocketAddress> from;
+    std::vector<rtc::SocketAddress> to;
+    for (int i = 0; i < kNumLinks; ++i) {
+      EmulatedNetworkNode* node = emulation.CreateEmulatedNode(
+          absl::make_unique<SimulatedNetwork>(config));
+      EmulatedEndpoint* sender =
+          emulation.CreateEndpoint(EmulatedEndpointConfig());
+      EmulatedEndpoint* receiver =
+          emulation.CreateEndpoint(EmulatedEndpointConfig());
+      emulation.CreateRoute(sender, {node}, receiver);
+      senders.push_back(sender);
+      from.emplace_back(sender->GetPeerLocalAddress(), 80);
+      to.emplace_back(receiver->GetPeerLocalAddress(),
+                      receiver->BindReceiver(0, &receivers[i]).value());
+    }
+
+    rtc::CopyOnWriteBuffer payload(kPacketSize);
+    const int64_t start_ms = rtc::SystemTimeMillis();
+    for (int ms = 0; ms < kDurationMs; ++ms) {
+      for (int i = 0; i < kNumLinks; ++i) {
+        for (int j = 0; j < kPacketsPerMs; ++j)
+          senders[i]->SendPacket(from[i], to[i], payload);
+      }
+      time_controller.Sleep(TimeDelta::ms(1));
+    }
+    time_controller.Sleep(TimeDelta::ms(100));
+    const int64_t elapsed_ms = rtc::SystemTimeMillis() - start_ms;
+    int num_received = 0;
+    for (const CountingReceiver& receiver : receivers)
+      num_received += receiver.count();
+    printf("%d node task queues: %d of %d packets received in %lld ms, "
+           "%.0f packets/s\n",
+           num_task_queues, num_received,
+           kNumLinks * kPacketsPerMs * kDurationMs,
+           static_cast<long long>(elapsed_ms),
+           num_received * 1000.0 / elapsed_ms);
+  }
+}
+
 }  // namespace test
 }  // namespace webrtc
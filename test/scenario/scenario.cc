@@ -68,8 +68,14 @@ Scenario::Scenario(std::string file_name, bool real_time)
 Scenario::Scenario(
     std::unique_ptr<LogWriterFactoryInterface> log_writer_factory,
     bool real_time)
+    : Scenario(std::move(log_writer_factory),
+               CreateTimeController(real_time)) {}
+
+Scenario::Scenario(
+    std::unique_ptr<LogWriterFactoryInterface> log_writer_factory,
+    std::unique_ptr<TimeController> time_controller)
     : log_writer_factory_(std::move(log_writer_factory)),
-      time_controller_(CreateTimeController(real_time)),
+      time_controller_(std::move(time_controller)),
       clock_(time_controller_->GetClock()),
       audio_decoder_factory_(CreateBuiltinAudioDecoderFactory()),
       audio_encoder_factory_(CreateBuiltinAudioEncoderFactory()),
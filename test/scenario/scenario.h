@@ -46,6 +46,10 @@ class Scenario {
   Scenario(std::string file_name, bool real_time);
   Scenario(std::unique_ptr<LogWriterFactoryInterface> log_writer_manager,
            bool real_time);
+  // Runs on |time_controller|, such as a GlobalSimulatedTimeController with
+  // worker threads.
+  Scenario(std::unique_ptr<LogWriterFactoryInterface> log_writer_manager,
+           std::unique_ptr<TimeController> time_controller);
   RTC_DISALLOW_COPY_AND_ASSIGN(Scenario);
   ~Scenario();
   NetworkEmulationManagerImpl* net() { return &network_manager_; }
@@ -7,12 +7,17 @@
  *  in the file PATENTS.  All contributing project authors may
  *  be found in the AUTHORS file in the root of the source tree.
  */
+#include <stdio.h>
+
 #include <atomic>
 
+#include "absl/memory/memory.h"
+#include "rtc_base/time_utils.h"
 #include "test/gtest.h"
 #include "test/logging/memory_log_writer.h"
 #include "test/scenario/scenario.h"
 #include "test/scenario/stats_collection.h"
+#include "test/time_controller/simulated_time_controller.h"
 
 namespace webrtc {
 namespace test {
@@ -145,5 +150,28 @@ TEST(ScenarioTest, WritesToRtcEventLog) {
   EXPECT_GE(storage.logs().at("alice.rtc.dat").size(), 1u);
 }
 
+// Reports the wall clock time of simulating 20 independent calls, with the
+// ready task queues run serially and on worker threads.
+TEST(ScenarioTest, DISABLED_ParallelSimulatedTimeBenchmark) {
+  constexpr int kNumCalls = 20;
+  constexpr int kNumWorkerThreads = 4;
+  int64_t elapsed_ms[2];
+  for (int parallel = 0; parallel < 2; ++parallel) {
+    Scenario s(nullptr, absl::make_unique<GlobalSimulatedTimeController>(
+                            Timestamp::seconds(100000),
+                            parallel ? kNumWorkerThreads : 0));
+    for (int i = 0; i < kNumCalls; ++i)
+      SetupVideoCall(s, nullptr);
+    const int64_t start_ms = rtc::SystemTimeMillis();
+    s.RunFor(TimeDelta::seconds(10));
+    elapsed_ms[parallel] = rtc::SystemTimeMillis() - start_ms;
+  }
+  printf("%d calls for 10 s: serial %lld ms, %d worker threads %lld ms, "
+         "speedup %.2f\n",
+         kNumCalls, static_cast<long long>(elapsed_ms[0]), kNumWorkerThreads,
+         static_cast<long long>(elapsed_ms[1]),
+         static_cast<double>(elapsed_ms[0]) / elapsed_ms[1]);
+}
+
 }  // namespace test
 }  // namespace webrtc
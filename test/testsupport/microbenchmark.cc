@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/testsupport/microbenchmark.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+
+#include "rtc_base/time_utils.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+constexpr int64_t kMinBatchTimeNs = 10 * rtc::kNumNanosecsPerMillisec;
+constexpr int kNumBatches = 5;
+
+int64_t RunBatch(rtc::FunctionView<void()> iteration, int64_t size) {
+  const int64_t start_ns = rtc::TimeNanos();
+  for (int64_t i = 0; i < size; ++i)
+    iteration();
+  return rtc::TimeNanos() - start_ns;
+}
+
+}  // namespace
+
+double RunMicrobenchmark(const std::string& name,
+                         rtc::FunctionView<void()> iteration) {
+  // The first batches also warm up the caches and the branch predictors.
+  int64_t batch_size = 1;
+  while (RunBatch(iteration, batch_size) < kMinBatchTimeNs)
+    batch_size *= 2;
+
+  double sum = 0;
+  double sum_of_squares = 0;
+  for (int i = 0; i < kNumBatches; ++i) {
+    double time_ns =
+        static_cast<double>(RunBatch(iteration, batch_size)) / batch_size;
+    sum += time_ns;
+    sum_of_squares += time_ns * time_ns;
+  }
+  const double mean = sum / kNumBatches;
+  const double variance = sum_of_squares / kNumBatches - mean * mean;
+  PrintResultMeanAndError("microbenchmark", "", name, mean,
+                          std::sqrt(std::max(variance, 0.0)), "ns", false);
+  return mean;
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,35 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef TEST_TESTSUPPORT_MICROBENCHMARK_H_
+#define TEST_TESTSUPPORT_MICROBENCHMARK_H_
+
+#include <string>
+
+#include "rtc_base/function_view.h"
+
+namespace webrtc {
+namespace test {
+
+// Measures how long one call to |iteration| takes. |iteration| is first
+// called in batches of doubling size until a batch takes at least 10 ms, and
+// then in 5 batches of that size. The mean and standard deviation of the time
+// per call over those batches are reported with PrintResultMeanAndError(), in
+// nanoseconds, as the trace |name| of the "microbenchmark" graph. |name|
+// should therefore not change between commits, so that the results written by
+// --isolated_script_test_perf_output can be compared. Returns the mean time
+// per call in nanoseconds.
+double RunMicrobenchmark(const std::string& name,
+                         rtc::FunctionView<void()> iteration);
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // TEST_TESTSUPPORT_MICROBENCHMARK_H_
@@ -0,0 +1,42 @@
+/*
+ *  Copyright (c) 2019 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/testsupport/microbenchmark.h"
+
+#include <string>
+
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace test {
+
+TEST(MicrobenchmarkTest, ReportsTimePerIteration) {
+  int num_iterations = 0;
+  ::testing::internal::CaptureStdout();
+  double mean_ns = RunMicrobenchmark("BusyWait", [&] {
+    const int64_t start_ns = rtc::TimeNanos();
+    while (rtc::TimeNanos() - start_ns < 20 * rtc::kNumNanosecsPerMicrosec) {
+    }
+    ++num_iterations;
+  });
+  std::string output = ::testing::internal::GetCapturedStdout();
+
+  EXPECT_GT(num_iterations, 5);
+  EXPECT_GE(mean_ns, 20 * rtc::kNumNanosecsPerMicrosec);
+  EXPECT_EQ(0u, output.find("RESULT microbenchmark: BusyWait= {"));
+  EXPECT_NE(std::string::npos,
+            GetPerfResultsJSON().find(R"("microbenchmark":{"BusyWait":{)"));
+  ClearPerfResults();
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -10,15 +10,20 @@
 #include "test/time_controller/simulated_time_controller.h"
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <iterator>
 #include <list>
 #include <map>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "absl/base/attributes.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
+#include "rtc_base/platform_thread.h"
+#include "system_wrappers/include/sleep.h"
 
 namespace webrtc {
 namespace {
@@ -38,9 +43,11 @@ class SimulatedSequenceRunner : public ProcessThread, public TaskQueueBase {
  public:
   SimulatedSequenceRunner(SimulatedTimeControllerImpl* handler,
                           absl::string_view queue_name)
-      : handler_(handler), name_(queue_name) {}
+      : handler_(handler), name_(queue_name), id_(handler->NextRunnerId()) {}
   ~SimulatedSequenceRunner() override { handler_->Unregister(this); }
 
+  uint64_t id() const { return id_; }
+
   // Provides next run time.
   Timestamp GetNextRunTime() const;
 
@@ -75,6 +82,7 @@ class SimulatedSequenceRunner : public ProcessThread, public TaskQueueBase {
 
   SimulatedTimeControllerImpl* const handler_;
   const std::string name_;
+  const uint64_t id_;
 
   rtc::CriticalSection lock_;
 
@@ -88,11 +96,73 @@ class SimulatedSequenceRunner : public ProcessThread, public TaskQueueBase {
   std::map<Timestamp, std::list<Module*>> delayed_modules_
       RTC_GUARDED_BY(lock_);
 
-  Timestamp next_run_time_ RTC_GUARDED_BY(lock_) = Timestamp::PlusInfinity();
+  // Written with |lock_| held, and read without it by the workers looking for
+  // ready runners.
+  std::atomic<Timestamp> next_run_time_{Timestamp::PlusInfinity()};
+};
+
+// A task, or a module to wake up, posted by a runner running in parallel.
+struct DeferredPost {
+  uint64_t source_id;
+  SimulatedSequenceRunner* target;
+  uint64_t target_id;
+  std::unique_ptr<QueuedTask> task;
+  absl::optional<uint32_t> delay_ms;
+  Module* module;
+};
+
+namespace {
+// A runner running in parallel on the current thread.
+struct RunFrame {
+  SimulatedTimeControllerImpl* handler;
+  SimulatedSequenceRunner* runner;
+  std::vector<DeferredPost>* deferred;
+  bool yielded;
+  // Of the runner whose blocked task runs this one.
+  RunFrame* previous;
+};
+
+ABSL_CONST_INIT thread_local RunFrame* current_frame = nullptr;
+}  // namespace
+
+class ParallelWorker {
+ public:
+  explicit ParallelWorker(SimulatedTimeControllerImpl* handler)
+      : handler_(handler),
+        thread_(&ParallelWorker::ThreadMain, this, "SimulatedTimeWorker") {
+    thread_.Start();
+  }
+  ~ParallelWorker() {
+    stopping_ = true;
+    wake_up_.Set();
+    thread_.Stop();
+  }
+
+  void StartRound() { wake_up_.Set(); }
+  // Only accessed by the worker during a round.
+  std::vector<DeferredPost>* deferred() { return &deferred_; }
+
+ private:
+  static void ThreadMain(void* worker) {
+    static_cast<ParallelWorker*>(worker)->Run();
+  }
+  void Run() {
+    while (true) {
+      wake_up_.Wait(rtc::Event::kForever);
+      if (stopping_)
+        return;
+      handler_->RunRound(&deferred_);
+    }
+  }
+
+  SimulatedTimeControllerImpl* const handler_;
+  std::atomic<bool> stopping_{false};
+  rtc::Event wake_up_;
+  std::vector<DeferredPost> deferred_;
+  rtc::PlatformThread thread_;
 };
 
 Timestamp SimulatedSequenceRunner::GetNextRunTime() const {
-  rtc::CritScope lock(&lock_);
   return next_run_time_;
 }
 
@@ -164,16 +234,18 @@ void SimulatedSequenceRunner::UpdateNextRunTime() {
   if (!ready_tasks_.empty() || !ready_modules_.empty()) {
     next_run_time_ = Timestamp::MinusInfinity();
   } else {
-    next_run_time_ = Timestamp::PlusInfinity();
+    Timestamp next_run_time = Timestamp::PlusInfinity();
     if (!delayed_tasks_.empty())
-      next_run_time_ = std::min(next_run_time_, delayed_tasks_.begin()->first);
+      next_run_time = std::min(next_run_time, delayed_tasks_.begin()->first);
     if (!delayed_modules_.empty())
-      next_run_time_ =
-          std::min(next_run_time_, delayed_modules_.begin()->first);
+      next_run_time = std::min(next_run_time, delayed_modules_.begin()->first);
+    next_run_time_ = next_run_time;
   }
 }
 
 void SimulatedSequenceRunner::PostTask(std::unique_ptr<QueuedTask> task) {
+  if (handler_->MaybeDefer(this, &task, absl::nullopt, nullptr))
+    return;
   rtc::CritScope lock(&lock_);
   ready_tasks_.emplace_back(std::move(task));
   next_run_time_ = Timestamp::MinusInfinity();
@@ -181,10 +253,12 @@ void SimulatedSequenceRunner::PostTask(std::unique_ptr<QueuedTask> task) {
 
 void SimulatedSequenceRunner::PostDelayedTask(std::unique_ptr<QueuedTask> task,
                                               uint32_t milliseconds) {
+  if (handler_->MaybeDefer(this, &task, milliseconds, nullptr))
+    return;
   rtc::CritScope lock(&lock_);
   Timestamp target_time = GetCurrentTime() + TimeDelta::ms(milliseconds);
   delayed_tasks_[target_time].push_back(std::move(task));
-  next_run_time_ = std::min(next_run_time_, target_time);
+  next_run_time_ = std::min(next_run_time_.load(), target_time);
 }
 
 void SimulatedSequenceRunner::Start() {
@@ -229,6 +303,8 @@ void SimulatedSequenceRunner::Stop() {
 }
 
 void SimulatedSequenceRunner::WakeUp(Module* module) {
+  if (handler_->MaybeDefer(this, nullptr, absl::nullopt, module))
+    return;
   rtc::CritScope lock(&lock_);
   // If we already are planning to run this module as soon as possible, we don't
   // need to do anything.
@@ -242,7 +318,7 @@ void SimulatedSequenceRunner::WakeUp(Module* module) {
   }
   Timestamp next_time = GetNextTime(module, GetCurrentTime());
   delayed_modules_[next_time].push_back(module);
-  next_run_time_ = std::min(next_run_time_, next_time);
+  next_run_time_ = std::min(next_run_time_.load(), next_time);
 }
 
 void SimulatedSequenceRunner::RegisterModule(Module* module,
@@ -254,7 +330,7 @@ void SimulatedSequenceRunner::RegisterModule(Module* module,
   } else {
     Timestamp next_time = GetNextTime(module, GetCurrentTime());
     delayed_modules_[next_time].push_back(module);
-    next_run_time_ = std::min(next_run_time_, next_time);
+    next_run_time_ = std::min(next_run_time_.load(), next_time);
   }
 }
 
@@ -285,10 +361,17 @@ Timestamp SimulatedSequenceRunner::GetNextTime(Module* module,
   return at_time + TimeDelta::ms(module->TimeUntilNextProcess());
 }
 
-SimulatedTimeControllerImpl::SimulatedTimeControllerImpl(Timestamp start_time)
-    : thread_id_(rtc::CurrentThreadId()), current_time_(start_time) {}
+SimulatedTimeControllerImpl::SimulatedTimeControllerImpl(
+    Timestamp start_time,
+    int num_worker_threads)
+    : thread_id_(rtc::CurrentThreadId()), current_time_(start_time) {
+  for (int i = 0; i < num_worker_threads; ++i)
+    workers_.push_back(absl::make_unique<ParallelWorker>(this));
+}
 
-SimulatedTimeControllerImpl::~SimulatedTimeControllerImpl() = default;
+SimulatedTimeControllerImpl::~SimulatedTimeControllerImpl() {
+  workers_.clear();
+}
 
 std::unique_ptr<TaskQueueBase, TaskQueueDeleter>
 SimulatedTimeControllerImpl::CreateTaskQueue(
@@ -312,7 +395,6 @@ std::unique_ptr<ProcessThread> SimulatedTimeControllerImpl::CreateProcessThread(
   return process_thread;
 }
 
-
 void SimulatedTimeControllerImpl::YieldExecution() {
   if (rtc::CurrentThreadId() == thread_id_) {
     TaskQueueBase* yielding_from = TaskQueueBase::Current();
@@ -330,11 +412,17 @@ void SimulatedTimeControllerImpl::YieldExecution() {
     RTC_DCHECK(inserted.second);
     RunReadyRunners();
     yielded_.erase(inserted.first);
+  } else if (current_frame && current_frame->handler == this) {
+    YieldFromWorker();
   }
 }
 
 void SimulatedTimeControllerImpl::RunReadyRunners() {
   RTC_DCHECK_RUN_ON(&thread_checker_);
+  if (!workers_.empty()) {
+    RunReadyRunnersInParallel();
+    return;
+  }
   rtc::CritScope lock(&lock_);
   RTC_DCHECK_EQ(rtc::CurrentThreadId(), thread_id_);
   Timestamp current_time = CurrentTime();
@@ -390,17 +478,229 @@ void SimulatedTimeControllerImpl::AdvanceTime(Timestamp target_time) {
 }
 
 void SimulatedTimeControllerImpl::Unregister(SimulatedSequenceRunner* runner) {
+  bool running_on_current_thread = false;
+  for (RunFrame* frame = current_frame; frame; frame = frame->previous) {
+    if (frame->runner == runner)
+      running_on_current_thread = true;
+  }
+  while (true) {
+    {
+      rtc::CritScope lock(&lock_);
+      if (running_on_current_thread ||
+          running_.find(runner) == running_.end()) {
+        bool removed = RemoveByValue(runners_, runner);
+        RTC_CHECK(removed);
+        RemoveByValue(ready_runners_, runner);
+        auto it = std::find(round_runners_.begin() + next_round_runner_,
+                            round_runners_.end(), runner);
+        if (it != round_runners_.end()) {
+          *it = nullptr;
+          --num_unfinished_;
+        }
+        return;
+      }
+    }
+    // Like a real task queue, lets the task that is running finish first.
+    SleepMs(1);
+  }
+}
+
+uint64_t SimulatedTimeControllerImpl::NextRunnerId() {
+  rtc::CritScope lock(&lock_);
+  return next_runner_id_++;
+}
+
+bool SimulatedTimeControllerImpl::MaybeDefer(
+    SimulatedSequenceRunner* target,
+    std::unique_ptr<QueuedTask>* task,
+    absl::optional<uint32_t> delay_ms,
+    Module* module) {
+  RunFrame* frame = current_frame;
+  if (!frame || frame->handler != this || !frame->deferred)
+    return false;
+  DeferredPost post;
+  post.source_id = frame->runner->id();
+  post.target = target;
+  post.target_id = target->id();
+  if (task)
+    post.task = std::move(*task);
+  post.delay_ms = delay_ms;
+  post.module = module;
+  frame->deferred->push_back(std::move(post));
+  return true;
+}
+
+void SimulatedTimeControllerImpl::RunReadyRunnersInParallel() {
+  Timestamp current_time = CurrentTime();
+  // Each round runs the runners that are ready after the previous one.
+  while (true) {
+    {
+      rtc::CritScope lock(&lock_);
+      round_runners_.clear();
+      for (auto* runner : runners_) {
+        if (runner->GetNextRunTime() <= current_time)
+          round_runners_.push_back(runner);
+      }
+      if (round_runners_.empty())
+        return;
+      next_round_runner_ = 0;
+      num_unfinished_ = round_runners_.size();
+      num_yielded_ = 0;
+      num_active_workers_ = workers_.size();
+    }
+    for (auto& worker : workers_)
+      worker->StartRound();
+    {
+      // Waiting must not run the runners on this thread as well.
+      rtc::ScopedYieldPolicy no_yield_policy(nullptr);
+      round_done_.Wait(rtc::Event::kForever);
+    }
+    std::vector<DeferredPost> posts;
+    for (auto& worker : workers_) {
+      std::vector<DeferredPost>* deferred = worker->deferred();
+      std::move(deferred->begin(), deferred->end(), std::back_inserter(posts));
+      deferred->clear();
+    }
+    Deliver(std::move(posts));
+  }
+}
+
+void SimulatedTimeControllerImpl::RunRound(
+    std::vector<DeferredPost>* deferred) {
+  while (true) {
+    SimulatedSequenceRunner* runner = nullptr;
+    {
+      rtc::CritScope lock(&lock_);
+      while (!runner && next_round_runner_ < round_runners_.size())
+        runner = round_runners_[next_round_runner_++];
+      if (runner) {
+        running_.insert(runner);
+      } else if (num_yielded_ == 0 || num_unfinished_ == 0) {
+        if (--num_active_workers_ == 0)
+          round_done_.Set();
+        return;
+      }
+    }
+    if (runner) {
+      RunInParallel(runner, deferred);
+      rtc::CritScope lock(&lock_);
+      running_.erase(runner);
+      --num_unfinished_;
+      continue;
+    }
+    // A blocked task may wait for any runner.
+    runner = TakeReadyRunner();
+    if (!runner) {
+      SleepMs(1);
+      continue;
+    }
+    RunInParallel(runner, nullptr);
+    rtc::CritScope lock(&lock_);
+    running_.erase(runner);
+  }
+}
+
+void SimulatedTimeControllerImpl::RunInParallel(
+    SimulatedSequenceRunner* runner,
+    std::vector<DeferredPost>* deferred) {
+  RunFrame frame = {this, runner, deferred, false, current_frame};
+  current_frame = &frame;
+  {
+    rtc::ScopedYieldPolicy yield_policy(this);
+    Timestamp current_time = CurrentTime();
+    runner->UpdateReady(current_time);
+    // Note that |runner| may be deleted by its tasks.
+    runner->Run(current_time);
+  }
+  current_frame = frame.previous;
+  if (frame.yielded) {
+    rtc::CritScope lock(&lock_);
+    --num_yielded_;
+  }
+}
+
+void SimulatedTimeControllerImpl::YieldFromWorker() {
+  RunFrame* frame = current_frame;
+  if (!frame->yielded) {
+    frame->yielded = true;
+    rtc::CritScope lock(&lock_);
+    ++num_yielded_;
+  }
+  // The task may wait for what it posted, so from now on its posts are
+  // delivered right away.
+  if (frame->deferred) {
+    std::vector<DeferredPost> posts;
+    posts.swap(*frame->deferred);
+    frame->deferred = nullptr;
+    Deliver(std::move(posts));
+  }
+  // Runs what is ready meanwhile. Once the task blocks, the other workers keep
+  // doing so until the round ends.
+  while (SimulatedSequenceRunner* runner = TakeReadyRunner()) {
+    RunInParallel(runner, nullptr);
+    rtc::CritScope lock(&lock_);
+    running_.erase(runner);
+  }
+}
+
+SimulatedSequenceRunner* SimulatedTimeControllerImpl::TakeReadyRunner() {
+  Timestamp current_time = CurrentTime();
   rtc::CritScope lock(&lock_);
-  bool removed = RemoveByValue(runners_, runner);
-  RTC_CHECK(removed);
-  RemoveByValue(ready_runners_, runner);
+  for (auto* runner : runners_) {
+    if (running_.find(runner) != running_.end() ||
+        runner->GetNextRunTime() > current_time) {
+      continue;
+    }
+    // A runner of the round that hasn't started may be what a blocked task
+    // waits for, and all the workers may be blocked, so it is taken out of
+    // the round, like in Unregister().
+    auto it = std::find(round_runners_.begin() + next_round_runner_,
+                        round_runners_.end(), runner);
+    if (it != round_runners_.end()) {
+      *it = nullptr;
+      --num_unfinished_;
+    }
+    running_.insert(runner);
+    return runner;
+  }
+  return nullptr;
+}
+
+void SimulatedTimeControllerImpl::Deliver(std::vector<DeferredPost> posts) {
+  // The posts of each runner are in order, so this orders them the same
+  // whichever worker ran which runner.
+  std::stable_sort(posts.begin(), posts.end(),
+                   [](const DeferredPost& a, const DeferredPost& b) {
+                     return a.source_id < b.source_id;
+                   });
+  rtc::CritScope lock(&lock_);
+  for (DeferredPost& post : posts) {
+    // The target may have been deleted during the round.
+    if (std::find(runners_.begin(), runners_.end(), post.target) ==
+            runners_.end() ||
+        post.target->id() != post.target_id) {
+      continue;
+    }
+    if (post.module) {
+      post.target->WakeUp(post.module);
+    } else if (post.delay_ms) {
+      post.target->PostDelayedTask(std::move(post.task), *post.delay_ms);
+    } else {
+      post.target->PostTask(std::move(post.task));
+    }
+  }
 }
 
 }  // namespace sim_time_impl
 
 GlobalSimulatedTimeController::GlobalSimulatedTimeController(
     Timestamp start_time)
-    : sim_clock_(start_time.us()), impl_(start_time) {
+    : GlobalSimulatedTimeController(start_time, /*num_worker_threads=*/0) {}
+
+GlobalSimulatedTimeController::GlobalSimulatedTimeController(
+    Timestamp start_time,
+    int num_worker_threads)
+    : sim_clock_(start_time.us()), impl_(start_time, num_worker_threads) {
   global_clock_.SetTime(start_time);
 }
 
@@ -10,16 +10,20 @@
 #ifndef TEST_TIME_CONTROLLER_SIMULATED_TIME_CONTROLLER_H_
 #define TEST_TIME_CONTROLLER_SIMULATED_TIME_CONTROLLER_H_
 
+#include <stdint.h>
+
 #include <list>
 #include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "api/units/timestamp.h"
 #include "modules/include/module.h"
 #include "modules/utility/include/process_thread.h"
 #include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
 #include "rtc_base/fake_clock.h"
 #include "rtc_base/platform_thread_types.h"
 #include "rtc_base/synchronization/yield_policy.h"
@@ -30,11 +34,15 @@ namespace webrtc {
 
 namespace sim_time_impl {
 class SimulatedSequenceRunner;
+struct DeferredPost;
+class ParallelWorker;
 
 class SimulatedTimeControllerImpl : public TaskQueueFactory,
                                     public rtc::YieldInterface {
  public:
-  explicit SimulatedTimeControllerImpl(Timestamp start_time);
+  // If |num_worker_threads| is more than 0, the runners that are ready at the
+  // same time run in parallel on that many threads, see RunReadyRunners().
+  SimulatedTimeControllerImpl(Timestamp start_time, int num_worker_threads);
   ~SimulatedTimeControllerImpl() override;
 
   std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateTaskQueue(
@@ -49,6 +57,15 @@ class SimulatedTimeControllerImpl : public TaskQueueFactory,
   std::unique_ptr<ProcessThread> CreateProcessThread(const char* thread_name);
   // Runs all runners in |runners_| that has tasks or modules ready for
   // execution.
+  //
+  // With worker threads, the ready runners run in rounds: all the runners that
+  // are ready at the start of a round run in parallel, and the tasks that they
+  // post to runners of this controller are only delivered at the end of the
+  // round, ordered by the runner that posted them. A runner therefore sees the
+  // same tasks in the same order whatever the scheduling of the threads. Only
+  // a task that blocks, for instance on an rtc::Event, breaks that: its posts
+  // are delivered right away, and the other threads run the runners that
+  // become ready until the round ends.
   void RunReadyRunners();
   // Return |current_time_|.
   Timestamp CurrentTime() const;
@@ -56,10 +73,37 @@ class SimulatedTimeControllerImpl : public TaskQueueFactory,
   Timestamp NextRunTime() const;
   // Set |current_time_| to |target_time|.
   void AdvanceTime(Timestamp target_time);
-  // Removes |runner| from |runners_|.
+  // Removes |runner| from |runners_|. With worker threads, waits for another
+  // thread to finish running |runner|.
   void Unregister(SimulatedSequenceRunner* runner);
 
+  // Returns an id ordering the runners by creation.
+  uint64_t NextRunnerId();
+  // If called from a runner that runs in parallel, takes |task|, or |module|
+  // to wake up, to deliver it to |target| at the end of the round, and returns
+  // true.
+  bool MaybeDefer(SimulatedSequenceRunner* target,
+                  std::unique_ptr<QueuedTask>* task,
+                  absl::optional<uint32_t> delay_ms,
+                  Module* module);
+
  private:
+  friend class ParallelWorker;
+
+  void RunReadyRunnersInParallel();
+  // Runs the runners of the current round, and then helps blocked tasks.
+  void RunRound(std::vector<DeferredPost>* deferred);
+  // Runs |runner| on the current worker thread. Its posts are added to
+  // |deferred| if not null, and delivered right away otherwise.
+  void RunInParallel(SimulatedSequenceRunner* runner,
+                     std::vector<DeferredPost>* deferred);
+  // Called when a task running in parallel blocks.
+  void YieldFromWorker();
+  // Returns a runner that is ready and not running, and marks it as running.
+  // Removes it from the current round if it hasn't started yet.
+  SimulatedSequenceRunner* TakeReadyRunner();
+  void Deliver(std::vector<DeferredPost> posts);
+
   const rtc::PlatformThreadId thread_id_;
   rtc::ThreadChecker thread_checker_;
   rtc::CriticalSection time_lock_;
@@ -73,6 +117,20 @@ class SimulatedTimeControllerImpl : public TaskQueueFactory,
 
   // Task queues on which YieldExecution has been called.
   std::unordered_set<TaskQueueBase*> yielded_ RTC_GUARDED_BY(thread_checker_);
+
+  uint64_t next_runner_id_ RTC_GUARDED_BY(lock_) = 0;
+  std::vector<std::unique_ptr<ParallelWorker>> workers_;
+  // Set by the last worker to finish a round.
+  rtc::Event round_done_;
+  // Runners of the current round, nulled when unregistered before they run.
+  std::vector<SimulatedSequenceRunner*> round_runners_ RTC_GUARDED_BY(lock_);
+  size_t next_round_runner_ RTC_GUARDED_BY(lock_) = 0;
+  // Runners of the current round that haven't finished.
+  size_t num_unfinished_ RTC_GUARDED_BY(lock_) = 0;
+  // Runners with a task that blocked during the current round.
+  int num_yielded_ RTC_GUARDED_BY(lock_) = 0;
+  size_t num_active_workers_ RTC_GUARDED_BY(lock_) = 0;
+  std::unordered_set<SimulatedSequenceRunner*> running_ RTC_GUARDED_BY(lock_);
 };
 }  // namespace sim_time_impl
 
@@ -81,9 +139,16 @@ class SimulatedTimeControllerImpl : public TaskQueueFactory,
 // when Sleep() is called. Overrides the global clock backing rtc::TimeMillis()
 // and rtc::TimeMicros(). Note that this is not thread safe since it modifies
 // global state.
+//
+// With |num_worker_threads|, the task queues and process threads that are
+// ready at the same time run in parallel, which speeds up simulations with
+// many independent task queues, such as calls. The runs stay deterministic
+// as long as the tasks don't block, see
+// SimulatedTimeControllerImpl::RunReadyRunners().
 class GlobalSimulatedTimeController : public TimeController {
  public:
   explicit GlobalSimulatedTimeController(Timestamp start_time);
+  GlobalSimulatedTimeController(Timestamp start_time, int num_worker_threads);
   ~GlobalSimulatedTimeController() override;
 
   Clock* GetClock() override;
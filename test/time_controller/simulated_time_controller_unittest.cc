@@ -10,10 +10,15 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
 #include "rtc_base/task_queue.h"
 #include "rtc_base/task_utils/repeating_task.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/sleep.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 #include "test/time_controller/simulated_time_controller.h"
@@ -28,6 +33,13 @@ using ::testing::MockFunction;
 using ::testing::NiceMock;
 using ::testing::Return;
 constexpr Timestamp kStartTime = Timestamp::Seconds<1000>();
+constexpr int kNumWorkerThreads = 4;
+
+std::unique_ptr<rtc::TaskQueue> CreateTaskQueue(TimeController* controller) {
+  return absl::make_unique<rtc::TaskQueue>(
+      controller->GetTaskQueueFactory()->CreateTaskQueue(
+          "TestQueue", TaskQueueFactory::Priority::NORMAL));
+}
 
 // Helper closure class to stop repeating task on a task queue. This is
 // equivalent to [handle{move(handle)}] { handle.Stop(); } in c++14.
@@ -117,4 +129,146 @@ TEST(SimulatedTimeControllerTest, Example) {
   };
   task_queue.PostTask(Destructor{std::move(object)});
 }
+
+TEST(SimulatedTimeControllerTest, RunsReadyTaskQueuesInParallel) {
+  GlobalSimulatedTimeController time_simulation(kStartTime, kNumWorkerThreads);
+  auto first = CreateTaskQueue(&time_simulation);
+  auto second = CreateTaskQueue(&time_simulation);
+  // Each task waits for the other to start, which only happens if they run at
+  // the same time.
+  std::atomic<int> started(0);
+  std::atomic<int> met(0);
+  auto meet = [&] {
+    ++started;
+    const int64_t deadline_ms = rtc::SystemTimeMillis() + 5000;
+    while (started < 2 && rtc::SystemTimeMillis() < deadline_ms)
+      SleepMs(1);
+    if (started == 2)
+      ++met;
+  };
+  first->PostTask(meet);
+  second->PostTask(meet);
+  time_simulation.Sleep(TimeDelta::ms(1));
+  EXPECT_EQ(met.load(), 2);
+}
+
+TEST(SimulatedTimeControllerTest, OrdersParallelPostsByPostingTaskQueue) {
+  constexpr int kNumSources = 10;
+  constexpr int kNumPosts = 3;
+  for (int run = 0; run < 5; ++run) {
+    GlobalSimulatedTimeController time_simulation(kStartTime,
+                                                  kNumWorkerThreads);
+    auto target = CreateTaskQueue(&time_simulation);
+    std::vector<std::unique_ptr<rtc::TaskQueue>> sources;
+    for (int i = 0; i < kNumSources; ++i)
+      sources.push_back(CreateTaskQueue(&time_simulation));
+    std::vector<int> received;
+    for (int i = kNumSources - 1; i >= 0; --i) {
+      sources[i]->PostDelayedTask(
+          [&, i] {
+            for (int j = 0; j < kNumPosts; ++j)
+              target->PostTask([&, i, j] { received.push_back(i * 10 + j); });
+          },
+          10);
+    }
+    time_simulation.Sleep(TimeDelta::ms(20));
+    // By creation order of the posting task queue, whatever order the tasks
+    // ran in.
+    std::vector<int> expected;
+    for (int i = 0; i < kNumSources; ++i) {
+      for (int j = 0; j < kNumPosts; ++j)
+        expected.push_back(i * 10 + j);
+    }
+    EXPECT_EQ(received, expected);
+  }
+}
+
+TEST(SimulatedTimeControllerTest, ParallelTaskCanWaitForAnotherTaskQueue) {
+  GlobalSimulatedTimeController time_simulation(kStartTime, kNumWorkerThreads);
+  auto first = CreateTaskQueue(&time_simulation);
+  auto second = CreateTaskQueue(&time_simulation);
+  std::atomic<bool> done(false);
+  first->PostTask([&] {
+    rtc::Event event;
+    second->PostTask([&event] { event.Set(); });
+    EXPECT_TRUE(event.Wait(5000));
+    done = true;
+  });
+  time_simulation.Sleep(TimeDelta::ms(1));
+  EXPECT_TRUE(done);
+}
+
+TEST(SimulatedTimeControllerTest,
+     ParallelTaskCanWaitForTaskQueueOfSameRoundOnSingleWorker) {
+  GlobalSimulatedTimeController time_simulation(kStartTime,
+                                                /*num_worker_threads=*/1);
+  auto first = CreateTaskQueue(&time_simulation);
+  auto second = CreateTaskQueue(&time_simulation);
+  std::atomic<bool> done(false);
+  // |second| is ready in the same round as |first|, but only runs after it
+  // unless the blocked task lets the only worker run it.
+  second->PostTask([] {});
+  first->PostTask([&] {
+    rtc::Event event;
+    second->PostTask([&event] { event.Set(); });
+    EXPECT_TRUE(event.Wait(5000));
+    done = true;
+  });
+  time_simulation.Sleep(TimeDelta::ms(1));
+  EXPECT_TRUE(done);
+}
+
+TEST(SimulatedTimeControllerTest, ParallelTaskCanDeleteAnotherTaskQueue) {
+  GlobalSimulatedTimeController time_simulation(kStartTime, kNumWorkerThreads);
+  auto deleter = CreateTaskQueue(&time_simulation);
+  auto deleted = CreateTaskQueue(&time_simulation);
+  std::atomic<int> counter(0);
+  RepeatingTaskHandle::Start(deleted->Get(), [&] {
+    ++counter;
+    return TimeDelta::ms(1);
+  });
+  deleter->PostDelayedTask([&] { deleted.reset(); }, 10);
+  time_simulation.Sleep(TimeDelta::ms(20));
+  EXPECT_FALSE(deleted);
+  EXPECT_GE(counter.load(), 10);
+  EXPECT_LE(counter.load(), 11);
+}
+
+TEST(SimulatedTimeControllerTest, ParallelRunsMatchSerialRuns) {
+  // Task queues that repeatedly post to each other at the same times.
+  constexpr int kNumQueues = 8;
+  auto run = [](int num_worker_threads) {
+    GlobalSimulatedTimeController time_simulation(kStartTime,
+                                                  num_worker_threads);
+    std::vector<std::unique_ptr<rtc::TaskQueue>> queues;
+    for (int i = 0; i < kNumQueues; ++i)
+      queues.push_back(CreateTaskQueue(&time_simulation));
+    rtc::CriticalSection crit;
+    std::vector<std::vector<int>> received(kNumQueues);
+    std::vector<RepeatingTaskHandle> handles;
+    for (int i = 0; i < kNumQueues; ++i) {
+      handles.push_back(RepeatingTaskHandle::Start(queues[i]->Get(), [&, i] {
+        for (int j = 0; j < kNumQueues; ++j) {
+          queues[j]->PostTask([&, i, j] {
+            rtc::CritScope cs(&crit);
+            received[j].push_back(i);
+          });
+        }
+        return TimeDelta::ms(5);
+      }));
+    }
+    time_simulation.Sleep(TimeDelta::ms(100));
+    for (int i = 0; i < kNumQueues; ++i)
+      queues[i]->PostTask(TaskHandleStopper(std::move(handles[i])));
+    time_simulation.Sleep(TimeDelta::ms(1));
+    return received;
+  };
+  const std::vector<std::vector<int>> parallel = run(kNumWorkerThreads);
+  EXPECT_EQ(parallel, run(kNumWorkerThreads));
+  // The serial runs deliver the posts as they are made, so only the number of
+  // posts is the same.
+  const std::vector<std::vector<int>> serial = run(0);
+  for (int i = 0; i < kNumQueues; ++i)
+    EXPECT_EQ(parallel[i].size(), serial[i].size());
+}
 }  // namespace webrtc